@@ -33,10 +33,21 @@
 #ifndef WIN32
 #	include <strings.h>	/* POSIX.1-2001: strcasecmp, strncasecmp */
 #endif
+#if defined(HAVE_IFADDRS_H) && HAVE_IFADDRS_H
+#	include <ifaddrs.h>	/* getifaddrs, freeifaddrs               */
+#endif
+#if defined(HAVE_LINUX_RTNETLINK_H) && HAVE_LINUX_RTNETLINK_H
+#	include <net/if.h>				/* if_indextoname                */
+#	include <linux/rtnetlink.h>	/* RTM_NEWADDR, RTMGRP_IPV4_IFADDR */
+#	define DDNS_SUPPORT_NETLINK	1
+#else
+#	define DDNS_SUPPORT_NETLINK	0
+#endif
 #include "ddns_string.h"
 #include "oraypeanut.h"
 #include "dnspod.h"
 #include "dyndns.h"
+#include "http.h"
 
 #ifdef TIME_WITH_SYS_TIME
 #	include <sys/time.h>
@@ -77,6 +88,9 @@ const char * ddns_getver()
  *	Initialize a DDNS context.
  *
  *	@param[in]	context		: pointer to the DDNS context to be initialized.
+ *
+ *	@note	Timeout, interval, auto-restart and parallel are left unset, so
+ *			an account may inherit them, the caller provides the defaults.
  */
 void ddns_initcontext(struct ddns_context * context)
 {
@@ -85,9 +99,11 @@ void ddns_initcontext(struct ddns_context * context)
 		memset(context, 0, sizeof(*context));
 
 		context->socket			= DDNS_INVALID_SOCKET;
-		context->timeout		= 15;
-		context->interval		= 60;
-		context->auto_restart	= 60;
+		/* 0 (-1 for auto_restart) is inherited, see [ddns_addaccount] */
+		context->timeout		= 0;
+		context->interval		= 0;
+		context->auto_restart	= -1;
+		context->parallel		= 0;
 		context->protocol		= proto_unknown;
 		context->verbose_mode	= verbose_normal;
 		context->server			= NULL;
@@ -99,6 +115,8 @@ void ddns_initcontext(struct ddns_context * context)
 		context->stream_err		= NULL;
 
 		ddns_sync_init(&(context->sync_object));
+		ddns_sync_init(&(context->log_sync));
+		ddns_sync_event_init(&(context->wakeup_event));
 	}
 }
 
@@ -115,6 +133,26 @@ void ddns_clearcontext(struct ddns_context* context)
 
 	ddns_remove_extra_param(context);
 
+	while ( NULL != context->next_account )
+	{
+		struct ddns_context * account = context->next_account;
+
+		context->next_account = account->next_account;
+		account->next_account = NULL;
+
+		/* log streams may be shared with the owner context */
+		if ( account->stream_out == context->stream_out )
+		{
+			account->stream_out = NULL;
+		}
+		if ( account->stream_err == context->stream_err )
+		{
+			account->stream_err = NULL;
+		}
+		ddns_clearcontext(account);
+		free(account);
+	}
+
 	if ( DDNS_INVALID_SOCKET != context->socket )
 	{
 		ddns_socket_close(context->socket);
@@ -141,13 +179,682 @@ void ddns_clearcontext(struct ddns_context* context)
 		context->stream_out = NULL;
 	}
 
-	if (NULL != context->stream_err)
+	if (NULL != context->stream_err)
+	{
+		fclose(context->stream_err);
+		context->stream_err = NULL;
+	}
+
+	ddns_sync_event_destroy(&(context->wakeup_event));
+	ddns_sync_destroy(&(context->sync_object));
+	ddns_sync_destroy(&(context->log_sync));
+}
+
+
+/**
+ *	States of an account scheduled by [ddns_execute].
+ */
+enum ddns_account_state
+{
+	ddns_account_initialize,	/* initialize (or restart) the protocol		*/
+	ddns_account_update,		/* check IP address, update it if changed	*/
+	ddns_account_pending,		/* [step_ip_changed] waits for [socket]		*/
+	ddns_account_stopped		/* stopped at error, no longer scheduled	*/
+};
+
+/**
+ *	An account (a DDNS context) scheduled by [ddns_execute].
+ */
+struct ddns_account
+{
+	struct ddns_context		*	context;
+	ddns_interface			*	ddns;
+	enum ddns_account_state		state;
+	ddns_error					error_code;	/* last error of the account	*/
+	unsigned long				deadline;	/* see [ddns_sync_clock]		*/
+	ddns_socket					socket;		/* socket of a pending step		*/
+	int							events;		/* [DDNS_EVENT_*] to wait for	*/
+	int							ready;		/* [DDNS_EVENT_*] occurred		*/
+};
+
+#define DDNS_WATCH_DEBOUNCE		2000	/* quiet time of a link, in ms		*/
+#define DDNS_WATCH_HOLDOFF		30000	/* max delay of a flapping link, in ms	*/
+
+/**
+ *	Watcher of the network interfaces of accounts, it wakes [ddns_execute]
+ *	up once an address is added to any of them.
+ */
+struct ddns_watcher
+{
+	struct ddns_context		*	context;	/* the context to be woken up	*/
+	int							socket;		/* rtnetlink socket, or -1		*/
+	struct ddns_sync_event		stop_event;	/* asks the thread to quit		*/
+	struct ddns_sync_thread		thread;
+};
+
+
+/**
+ *	Create protocol interface of a DDNS context.
+ *
+ *	@param[in]	context		: pointer to the DDNS context.
+ *
+ *	@return	Return the protocol interface, or NULL if the protocol is not
+ *			supported.
+ */
+static ddns_interface * ddns_create_interface(struct ddns_context * context)
+{
+	ddns_interface * ddns = NULL;
+
+	switch( context->protocol )
+	{
+#ifndef DISABLE_PEANUTHULL
+	case proto_peanuthull:
+		ddns = peanuthull_interface_create();
+		break;
+#endif
+
+#ifndef DISABLE_DNSPOD
+	case proto_dnspod:
+		ddns = dnspod_create_interface();
+		break;
+#endif
+
+#ifndef DISABLE_DYNDNS
+	case proto_dyndns:
+		ddns = dyndns_create_interface();
+		break;
+#endif
+
+	default:
+		break;
+	}
+
+	return ddns;
+}
+
+
+/**
+ *	Check if an account is due before another one.
+ *
+ *	@param[in]	account1	: the first account.
+ *	@param[in]	account2	: the second account.
+ *
+ *	@return	Return non-zero if [account1] is due first, otherwise 0.
+ */
+static int ddns_account_before(
+	const struct ddns_account	*	account1,
+	const struct ddns_account	*	account2
+	)
+{
+	/* the millisecond clock wraps around, compare the difference */
+	return (long)(account1->deadline - account2->deadline) < 0;
+}
+
+
+/**
+ *	Add an account to the deadline heap.
+ *
+ *	@param[in/out]	heap	: the min-heap of accounts, ordered by deadline.
+ *	@param[in/out]	count	: number of accounts in the heap.
+ *	@param[in]		account	: the account to be added.
+ */
+static void ddns_account_push(
+	struct ddns_account		**	heap,
+	int						*	count,
+	struct ddns_account		*	account
+	)
+{
+	int idx = (*count)++;
+
+	while ( idx > 0 )
+	{
+		int parent = (idx - 1) / 2;
+
+		if ( 0 == ddns_account_before(account, heap[parent]) )
+		{
+			break;
+		}
+		heap[idx] = heap[parent];
+		idx = parent;
+	}
+
+	heap[idx] = account;
+}
+
+
+/**
+ *	Remove the account with the earliest deadline from the deadline heap.
+ *
+ *	@param[in/out]	heap	: the min-heap of accounts, must not be empty.
+ *	@param[in/out]	count	: number of accounts in the heap.
+ *
+ *	@return	Return the removed account.
+ */
+static struct ddns_account * ddns_account_pop(
+	struct ddns_account		**	heap,
+	int						*	count
+	)
+{
+	struct ddns_account *	top		= heap[0];
+	struct ddns_account *	last	= heap[--(*count)];
+	int						idx		= 0;
+
+	while ( idx * 2 + 1 < (*count) )
+	{
+		int child = idx * 2 + 1;
+
+		if (	(child + 1 < (*count))
+			&&	ddns_account_before(heap[child + 1], heap[child]) )
+		{
+			++child;
+		}
+		if ( 0 == ddns_account_before(heap[child], last) )
+		{
+			break;
+		}
+		heap[idx] = heap[child];
+		idx = child;
+	}
+
+	heap[idx] = last;
+
+	return top;
+}
+
+
+/**
+ *	Rebuild the deadline heap after deadlines of accounts are changed.
+ *
+ *	@param[out]		heap		: the min-heap of accounts.
+ *	@param[out]		heap_count	: number of accounts in the heap.
+ *	@param[in]		accounts	: all accounts.
+ *	@param[in]		count		: number of accounts.
+ */
+static void ddns_account_heapify(
+	struct ddns_account		**	heap,
+	int						*	heap_count,
+	struct ddns_account		*	accounts,
+	int							count
+	)
+{
+	int idx = 0;
+
+	for ( (*heap_count) = 0; idx < count; ++idx )
+	{
+		if ( ddns_account_stopped != accounts[idx].state )
+		{
+			ddns_account_push(heap, heap_count, &(accounts[idx]));
+		}
+	}
+}
+
+
+/**
+ *	Wait until the wakeup event of [context] is set, or a socket of pending
+ *	accounts is ready, or the timeout elapses.
+ *
+ *	@param[in]		context		: the DDNS context to be woken up.
+ *	@param[in/out]	accounts	: all accounts, those got ready are due now.
+ *	@param[in]		count		: number of accounts.
+ *	@param[in]		timeout		: timeout in milliseconds.
+ *	@param[out]		ready_cnt	: number of accounts got ready.
+ *
+ *	@return	Return non-zero if the wakeup event is set, otherwise 0.
+ */
+static int ddns_account_wait(
+	struct ddns_context		*	context,
+	struct ddns_account		*	accounts,
+	int							count,
+	unsigned long				timeout,
+	int						*	ready_cnt
+	)
+{
+	struct ddns_socket_event	*	list		= NULL;
+	int								list_cnt	= 0;
+	int								event_fd	= -1;
+	int								signaled	= 0;
+	int								idx			= 0;
+
+	(*ready_cnt) = 0;
+
+	/* one more for the wakeup event */
+	list = (struct ddns_socket_event*)malloc((count + 1) * sizeof(*list));
+	for ( idx = 0; (NULL != list) && (idx < count); ++idx )
+	{
+		if ( ddns_account_pending != accounts[idx].state )
+		{
+			continue;
+		}
+		list[list_cnt].socket	= accounts[idx].socket;
+		list[list_cnt].events	= 0;
+		list[list_cnt].revents	= 0;
+		if ( 0 != (accounts[idx].events & DDNS_EVENT_READ) )
+		{
+			list[list_cnt].events |= DDNS_SOCKET_EVENT_READ;
+		}
+		if ( 0 != (accounts[idx].events & DDNS_EVENT_WRITE) )
+		{
+			list[list_cnt].events |= DDNS_SOCKET_EVENT_WRITE;
+		}
+		++list_cnt;
+	}
+
+	if ( 0 == list_cnt )
+	{
+		free(list);
+		return ddns_sync_event_wait(&(context->wakeup_event), timeout);
+	}
+
+	event_fd = ddns_sync_event_fd(&(context->wakeup_event));
+	if ( -1 != event_fd )
+	{
+		list[list_cnt].socket	= (ddns_socket)event_fd;
+		list[list_cnt].events	= DDNS_SOCKET_EVENT_READ;
+		list[list_cnt].revents	= 0;
+	}
+	else if ( timeout > 1000 )
+	{
+		/* the event can't be waited with sockets, check it every second */
+		timeout = 1000;
+	}
+
+	if ( ddns_socket_poll(list, list_cnt + ((-1 != event_fd) ? 1 : 0), timeout) > 0 )
+	{
+		unsigned long now = ddns_sync_clock();
+
+		if ( (-1 != event_fd) && (0 != list[list_cnt].revents) )
+		{
+			signaled = 1;
+		}
+
+		/* pending accounts are in [list] in the same order */
+		list_cnt = 0;
+		for ( idx = 0; idx < count; ++idx )
+		{
+			struct ddns_account * account = &(accounts[idx]);
+
+			if ( ddns_account_pending != account->state )
+			{
+				continue;
+			}
+			if ( 0 != (list[list_cnt].revents & DDNS_SOCKET_EVENT_READ) )
+			{
+				account->ready |= DDNS_EVENT_READ;
+			}
+			if ( 0 != (list[list_cnt].revents & DDNS_SOCKET_EVENT_WRITE) )
+			{
+				account->ready |= DDNS_EVENT_WRITE;
+			}
+			if ( 0 != account->ready )
+			{
+				account->deadline = now;
+				++(*ready_cnt);
+			}
+			++list_cnt;
+		}
+	}
+
+	free(list);
+
+	if ( -1 == event_fd )
+	{
+		signaled = ddns_sync_event_wait(&(context->wakeup_event), 0);
+	}
+
+	return signaled;
+}
+
+
+#if DDNS_SUPPORT_NETLINK
+/**
+ *	Check if rtnetlink messages add an IPv4 address to the network interface
+ *	of any account.
+ *
+ *	@param[in]	watcher	: the watcher.
+ *	@param[in]	buffer	: the received messages.
+ *	@param[in]	size	: size of the messages in bytes.
+ *
+ *	@return	Return non-zero if any message matches, otherwise 0.
+ */
+static int ddns_watcher_match(
+	struct ddns_watcher	*	watcher,
+	char				*	buffer,
+	int						size
+	)
+{
+	struct nlmsghdr	*	header	= (struct nlmsghdr*)buffer;
+	int					matched	= 0;
+
+	for ( ; NLMSG_OK(header, size); header = NLMSG_NEXT(header, size) )
+	{
+		struct ifaddrmsg	*	address	= (struct ifaddrmsg*)NLMSG_DATA(header);
+		struct ddns_context	*	account	= NULL;
+		char					name[IF_NAMESIZE];
+
+		if (	(RTM_NEWADDR != header->nlmsg_type)
+			||	(AF_INET != address->ifa_family)
+			||	(NULL == if_indextoname(address->ifa_index, name)) )
+		{
+			continue;
+		}
+
+		for (	account = watcher->context;
+				NULL != account;
+				account = account->next_account )
+		{
+			if ( 0 == strcmp(account->netif, name) )
+			{
+				matched = 1;
+			}
+		}
+	}
+
+	return matched;
+}
+
+
+/**
+ *	Entry of the watcher thread. It sets [wakeup_event] of the context once
+ *	the watched interfaces keep quiet for [DDNS_WATCH_DEBOUNCE] after a
+ *	change, or [DDNS_WATCH_HOLDOFF] after the first one of a flapping link.
+ *
+ *	@param[in]	param	: the watcher.
+ */
+static void ddns_watcher_main(void * param)
+{
+	struct ddns_watcher	*	watcher	= (struct ddns_watcher*)param;
+	int						stop_fd	= ddns_sync_event_fd(&(watcher->stop_event));
+	int						changed	= 0;
+	unsigned long			first	= 0;	/* time of the first change		*/
+	unsigned long			last	= 0;	/* time of the latest change	*/
+
+	for ( ;; )
+	{
+		struct ddns_socket_event	list[2];
+		unsigned long				timeout	= DDNS_SOCKET_INFINITE;
+		char						buffer[8192];
+		int							result	= 0;
+
+		if ( 0 != changed )
+		{
+			unsigned long	now		= ddns_sync_clock();
+			long			remain	= (long)(last + DDNS_WATCH_DEBOUNCE - now);
+			long			holdoff	= (long)(first + DDNS_WATCH_HOLDOFF - now);
+
+			if ( holdoff < remain )
+			{
+				remain = holdoff;
+			}
+			if ( remain <= 0 )
+			{
+				ddns_printf_v(	watcher->context,
+								msg_type_info,
+								"Network address changed, checking now.\n"
+								);
+				ddns_sync_event_set(&(watcher->context->wakeup_event));
+				changed = 0;
+				continue;
+			}
+
+			timeout = (unsigned long)remain;
+		}
+
+		list[0].socket	= watcher->socket;
+		list[0].events	= DDNS_SOCKET_EVENT_READ;
+		list[0].revents	= 0;
+		list[1].socket	= stop_fd;
+		list[1].events	= DDNS_SOCKET_EVENT_READ;
+		list[1].revents	= 0;
+
+		result = ddns_socket_poll(list, 2, timeout);
+		if ( (result < 0) && (EINTR != errno) )
+		{
+			break;
+		}
+		else if ( result <= 0 )
+		{
+			continue;
+		}
+		else if ( 0 != list[1].revents )
+		{
+			break;
+		}
+
+		result = (int)recv(watcher->socket, buffer, sizeof(buffer), 0);
+		if (	((result < 0) && (ENOBUFS == errno))
+			||	((result > 0) && ddns_watcher_match(watcher, buffer, result)) )
+		{
+			/* an overrun loses messages, take it as a change */
+			last = ddns_sync_clock();
+			if ( 0 == changed )
+			{
+				first	= last;
+				changed	= 1;
+			}
+		}
+	}
+}
+#endif
+
+
+/**
+ *	Start watching the network interfaces of accounts, if any account reads
+ *	its IP address from one.
+ *
+ *	@param[out]	watcher	: the watcher to be started.
+ *	@param[in]	context	: the context to be woken up, with all accounts.
+ *
+ *	@return	Return non-zero if the watcher is running, it must be stopped by
+ *			[ddns_watcher_stop]. Otherwise return 0.
+ */
+static int ddns_watcher_start(
+	struct ddns_watcher	*	watcher,
+	struct ddns_context	*	context
+	)
+{
+	watcher->context	= context;
+	watcher->socket		= -1;
+
+#if DDNS_SUPPORT_NETLINK
+	{
+		struct ddns_context	*	account	= context;
+		struct sockaddr_nl		address;
+
+		while ( (NULL != account) && ('\0' == account->netif[0]) )
+		{
+			account = account->next_account;
+		}
+
+		if ( NULL != account )
+		{
+			watcher->socket = socket(AF_NETLINK, SOCK_RAW, NETLINK_ROUTE);
+		}
+
+		if ( -1 != watcher->socket )
+		{
+			memset(&address, 0, sizeof(address));
+			address.nl_family	= AF_NETLINK;
+			address.nl_groups	= RTMGRP_IPV4_IFADDR;
+			if ( 0 != bind(	watcher->socket,
+							(struct sockaddr*)&address,
+							sizeof(address)
+							) )
+			{
+				close(watcher->socket);
+				watcher->socket = -1;
+			}
+		}
+
+		if ( -1 != watcher->socket )
+		{
+			ddns_sync_event_init(&(watcher->stop_event));
+			if ( 0 != ddns_sync_thread_create(	&(watcher->thread),
+												&ddns_watcher_main,
+												watcher
+												) )
+			{
+				ddns_sync_event_destroy(&(watcher->stop_event));
+				close(watcher->socket);
+				watcher->socket = -1;
+			}
+		}
+
+		if ( (NULL != account) && (-1 == watcher->socket) )
+		{
+			ddns_msg(	context,
+						msg_type_warning,
+						"Can't watch network interfaces, "
+						"IP address is checked at intervals only.\n"
+						);
+		}
+	}
+#endif
+
+	return -1 != watcher->socket;
+}
+
+
+/**
+ *	Stop a watcher started by [ddns_watcher_start].
+ *
+ *	@param[in/out]	watcher	: the watcher to be stopped.
+ */
+static void ddns_watcher_stop(struct ddns_watcher * watcher)
+{
+#if DDNS_SUPPORT_NETLINK
+	if ( -1 != watcher->socket )
+	{
+		ddns_sync_event_set(&(watcher->stop_event));
+		ddns_sync_thread_join(&(watcher->thread));
+		ddns_sync_event_destroy(&(watcher->stop_event));
+		close(watcher->socket);
+		watcher->socket = -1;
+	}
+#else
+	(void)watcher;
+#endif
+}
+
+
+/**
+ *	Run one step of an account: initialize it, or check & update its IP
+ *	address, then schedule its next step.
+ *
+ *	@param[in/out]	account	: the account to run.
+ */
+static void ddns_account_run(struct ddns_account * account)
+{
+	struct ddns_context *	context		= account->context;
+	ddns_interface		*	ddns		= account->ddns;
+	ddns_error				error_code	= DDNS_ERROR_SUCCESS;
+
+	if ( ddns_account_initialize == account->state )
+	{
+		ddns_printf_n(context, msg_type_info, "Initializing... ");
+		error_code = ddns->initialize(context);
+		if ( DDNS_ERROR_SUCCESS == error_code )
+		{
+			ddns_printf_n(context, msg_type_info, "done.\n");
+			account->state		= ddns_account_update;
+			account->error_code	= DDNS_ERROR_SUCCESS;
+		}
+		else
+		{
+			ddns_printf_n(context, msg_type_info, "failed.\n");
+		}
+	}
+	else
+	{
+		/**
+		 *	Keep check if ip address at specified interval. If it's changed,
+		 *	send update request to server. A protocol without
+		 *	[step_ip_changed] holds the other accounts until it returns.
+		 */
+		if ( NULL != ddns->step_ip_changed )
+		{
+			int events = 0;
+
+			if ( ddns_account_pending == account->state )
+			{
+				events = (0 != account->ready) ? account->ready : DDNS_EVENT_TIMEOUT;
+			}
+			account->ready = 0;
+
+			error_code = ddns->step_ip_changed(context, &(account->socket), &events);
+			if ( DDNS_ERROR_PENDING == error_code )
+			{
+				/* yield until the socket is ready, or it's timed out */
+				account->state		= ddns_account_pending;
+				account->events		= events;
+				account->deadline	= ddns_sync_clock()
+									+ context->timeout * 1000UL;
+				return;
+			}
+			account->state = ddns_account_update;
+		}
+		else
+		{
+			error_code = ddns->is_ip_changed(context);
+		}
+
+		if ( DDNS_ERROR_SUCCESS == error_code )
+		{
+			char		ip_address[16];
+			ddns_error	result = DDNS_ERROR_SUCCESS;
+
+			result = ddns->get_ip_address(	context,
+											ip_address,
+											_countof(ip_address)
+											);
+			if ( DDNS_ERROR_SUCCESS == result )
+			{
+				ddns_printf_n(	context,
+								msg_type_info,
+								"IP address changed to \"%s\".\n",
+								ip_address
+								);
+			}
+
+			ddns_printf_n(context, msg_type_info, "Updating DNS records... ");
+			error_code = ddns->do_update(context);
+			if ( DDNS_ERROR_SUCCESS == error_code )
+			{
+				ddns_printf_n(context, msg_type_info, "done.\n");
+			}
+			else
+			{
+				ddns_printf_n(context, msg_type_info, "failed.\n");
+			}
+		}
+		else if ( DDNS_ERROR_NOCHG == error_code )
+		{
+			/* ip address not changed, skip updating */
+			error_code = DDNS_ERROR_SUCCESS;
+		}
+	}
+
+	if ( DDNS_ERROR_SUCCESS == error_code )
 	{
-		fclose(context->stream_err);
-		context->stream_err = NULL;
+		account->deadline = ddns_sync_clock() + context->interval * 1000UL;
 	}
+	else
+	{
+		ddns->finalize(context);
 
-	ddns_sync_destroy(&(context->sync_object));
+		ddns_msg(context, msg_type_error, "%s.\n", ddns_err2str(error_code));
+		account->error_code = error_code;
+
+		if ( DDNS_IS_FATAL_ERROR(error_code) || (0 == context->auto_restart) )
+		{
+			account->state = ddns_account_stopped;
+		}
+		else
+		{
+			account->state		= ddns_account_initialize;
+			account->deadline	= ddns_sync_clock()
+								+ context->auto_restart * 1000UL;
+		}
+	}
 }
 
 
@@ -155,145 +862,214 @@ void ddns_clearcontext(struct ddns_context* context)
  *	Execute requested operation in a DDNS context.
  *
  *	@param[in]	context		: pointer to the DDNS context.
+ *
+ *	@note	All accounts chained by [next_account] are run in the calling
+ *			thread, each at its own interval, sharing the HTTP module (and
+ *			the pooled connections & TLS sessions of it). [exit_signal] and
+ *			[wakeup_event] of [context] control all of them.
+ *			On Linux, a new address on [netif] of any account wakes all of
+ *			them up at once, so [interval] only limits how stale DNS gets
+ *			when a change can't be seen locally.
  */
 ddns_error ddns_execute(struct ddns_context * context)
 {
-	ddns_interface * ddns = NULL;
-	ddns_error error_code = DDNS_ERROR_SUCCESS;
+	struct ddns_account		*	accounts	= NULL;
+	struct ddns_account		**	heap		= NULL;
+	struct ddns_context		*	account_ctx	= NULL;
+	struct ddns_watcher			watcher;
+	int							count		= 0;
+	int							heap_count	= 0;
+	int							idx			= 0;
+	ddns_error					error_code	= DDNS_ERROR_SUCCESS;
 
 	ddns_socket_init();
-
-	switch( context->protocol )
-	{
-#ifndef DISABLE_PEANUTHULL
-	case proto_peanuthull:
-		ddns = peanuthull_interface_create();
-		break;
+#if !defined(DISABLE_DNSPOD) || !defined(DISABLE_DYNDNS)
+	http_init();
 #endif
 
-#ifndef DISABLE_DNSPOD
-	case proto_dnspod:
-		ddns = dnspod_create_interface();
-		break;
-#endif
-
-#ifndef DISABLE_DYNDNS
-	case proto_dyndns:
-		ddns = dyndns_create_interface();
-		break;
-#endif
+	for ( account_ctx = context; NULL != account_ctx; account_ctx = account_ctx->next_account )
+	{
+		++count;
+	}
 
-	default:
-		error_code = DDNS_FATAL_ERROR(DDNS_ERROR_INVALID_PROTO);
+	accounts	= (struct ddns_account*)calloc(count, sizeof(*accounts));
+	heap		= (struct ddns_account**)calloc(count, sizeof(*heap));
+	if ( (NULL == accounts) || (NULL == heap) )
+	{
+		error_code = DDNS_FATAL_ERROR(DDNS_ERROR_INSUFFICIENT_MEMORY);
 		ddns_msg(context, msg_type_error, "%s.\n", ddns_err2str(error_code));
-		break;
+		count = 0;
 	}
 
-	while ( NULL != ddns )
+	/* Step 1: create protocol interfaces, initialize all accounts at once */
+	for (	idx = 0, account_ctx = context;
+			idx < count;
+			++idx, account_ctx = account_ctx->next_account )
 	{
-		ddns_printf_n(context, msg_type_info, "Initializing... ");
-		error_code = ddns->initialize(context);
-		if ( DDNS_ERROR_SUCCESS == error_code )
+		struct ddns_account * account = &(accounts[idx]);
+
+		account->context	= account_ctx;
+		account->ddns		= ddns_create_interface(account_ctx);
+		if ( NULL == account->ddns )
 		{
-			ddns_printf_n(context, msg_type_info, "done.\n");
+			account->state		= ddns_account_stopped;
+			account->error_code	= DDNS_FATAL_ERROR(DDNS_ERROR_INVALID_PROTO);
+			ddns_msg(	account_ctx,
+						msg_type_error,
+						"%s.\n",
+						ddns_err2str(account->error_code)
+						);
 		}
 		else
 		{
-			ddns_printf_n(context, msg_type_info, "failed.\n");
+			account->state		= ddns_account_initialize;
+			account->deadline	= ddns_sync_clock();
+			ddns_account_push(heap, &heap_count, account);
 		}
+	}
 
-		/**
-		 *	Main loop: keep check if ip address at specified interval. If it's
-		 *	changed, send update request to server.
-		 */
-		while ( DDNS_ERROR_SUCCESS == error_code )
+	ddns_watcher_start(&watcher, context);
+
+	/* Step 2: main loop, run the account due first, until user quits */
+	while ( heap_count > 0 )
+	{
+		long	remain		= (long)(heap[0]->deadline - ddns_sync_clock());
+		int		signaled	= 0;
+		int		ready_cnt	= 0;
+		int		end_prog	= 0;
+
+		if ( remain > 0 )
 		{
-			if ( 0 == ddns_wait(context) )
-			{
-				break;
-			}
+			signaled = ddns_account_wait(	context,
+											accounts,
+											count,
+											(unsigned long)remain,
+											&ready_cnt
+											);
+		}
 
-			error_code = ddns->is_ip_changed(context);
-			if ( DDNS_ERROR_NOCHG == error_code )
-			{
-				/* ip address not changed, skip updating */
-				error_code = DDNS_ERROR_SUCCESS;
-				continue;
-			}
+		ddns_sync_lock(&(context->sync_object));
+		end_prog = context->exit_signal;
+		if ( (0 != signaled) && (0 == end_prog) )
+		{
+			ddns_sync_event_reset(&(context->wakeup_event));
+		}
+		ddns_sync_unlock(&(context->sync_object));
 
-			if ( DDNS_ERROR_SUCCESS == error_code )
+		if ( 0 != end_prog )
+		{
+			break;
+		}
+		else if ( (0 != signaled) || (0 != ready_cnt) )
+		{
+			if ( 0 != signaled )
 			{
-				char		ip_address[16];
-				ddns_error	result = DDNS_ERROR_SUCCESS;
-
-				result = ddns->get_ip_address(	context,
-												ip_address,
-												_countof(ip_address)
-												);
-				if ( DDNS_ERROR_SUCCESS == result )
+				/* woken up for an early update, every idle account is due */
+				unsigned long now = ddns_sync_clock();
+
+				for ( idx = 0; idx < count; ++idx )
 				{
-					ddns_printf_n(	context,
-									msg_type_info,
-									"IP address changed to \"%s\".\n",
-									ip_address
-									);
+					if ( ddns_account_update == accounts[idx].state )
+					{
+						accounts[idx].deadline = now;
+					}
 				}
 			}
+			ddns_account_heapify(heap, &heap_count, accounts, count);
+		}
+		else if ( remain <= 0 )
+		{
+			struct ddns_account * account = ddns_account_pop(heap, &heap_count);
 
-			if ( DDNS_ERROR_SUCCESS == error_code )
+			ddns_account_run(account);
+			if ( ddns_account_stopped != account->state )
 			{
-				ddns_printf_n(context, msg_type_info, "Updating DNS records... ");
-				error_code = ddns->do_update(context);
-				if ( DDNS_ERROR_SUCCESS == error_code )
-				{
-					ddns_printf_n(context, msg_type_info, "done.\n");
-				}
-				else
-				{
-					ddns_printf_n(context, msg_type_info, "failed.\n");
-				}
+				ddns_account_push(heap, &heap_count, account);
 			}
 		}
+	}
 
-		ddns->finalize(context);
+	ddns_watcher_stop(&watcher);
 
-		if ( DDNS_ERROR_SUCCESS == error_code )
+	/* Step 3: stop all accounts, report the first error if any */
+	for ( idx = 0; idx < count; ++idx )
+	{
+		struct ddns_account * account = &(accounts[idx]);
+
+		if (	(ddns_account_update == account->state)
+			||	(ddns_account_pending == account->state) )
 		{
 			/* stop at user's request */
-			break;
+			account->ddns->finalize(account->context);
 		}
-		else
+		if ( NULL != account->ddns )
 		{
-			int interval = context->interval;
-
-			ddns_msg(context, msg_type_error, "%s.\n", ddns_err2str(error_code));
-			if (DDNS_IS_FATAL_ERROR(error_code))
-			{
-				break;
-			}
-
-			context->interval = context->auto_restart;
-			if ( (0 == context->auto_restart) || (0 == ddns_wait(context)) )
-			{
-				context->interval = interval;
-				break;
-			}
-			context->interval = interval;
+			account->ddns->destroy(account->ddns);
+			account->ddns = NULL;
+		}
+		if ( DDNS_ERROR_SUCCESS == error_code )
+		{
+			error_code = account->error_code;
 		}
 	}
 
-	if ( NULL != ddns )
-	{
-		ddns->destroy(ddns);
-		ddns = NULL;
-	}
+	free(heap);
+	free(accounts);
 
+#if !defined(DISABLE_DNSPOD) || !defined(DISABLE_DYNDNS)
+	http_uninit();
+#endif
 	ddns_socket_uninit();
 
 	return error_code;
 }
 
 
+/**
+ *	Add an account to a DDNS context, so that it'll be executed along with
+ *	the context by [ddns_execute].
+ *
+ *	@param[in/out]	context	: pointer to the DDNS context.
+ *
+ *	@note	The new account inherits protocol, timeout, interval, auto-restart,
+ *			parallel and verbose mode of [context].
+ *
+ *	@return	Return the new account, it's freed with [context]. If any error
+ *			occurred, NULL will be returned.
+ */
+struct ddns_context * ddns_addaccount(struct ddns_context * context)
+{
+	struct ddns_context * account = NULL;
+
+	if ( NULL != context )
+	{
+		account = (struct ddns_context*)malloc(sizeof(*account));
+	}
+
+	if ( NULL != account )
+	{
+		struct ddns_context * last = context;
+
+		ddns_initcontext(account);
+		account->protocol		= context->protocol;
+		account->timeout		= context->timeout;
+		account->interval		= context->interval;
+		account->auto_restart	= context->auto_restart;
+		account->parallel		= context->parallel;
+		account->verbose_mode	= context->verbose_mode;
+		c99_strncpy(account->netif, context->netif, _countof(account->netif));
+
+		while ( NULL != last->next_account )
+		{
+			last = last->next_account;
+		}
+		last->next_account = account;
+	}
+
+	return account;
+}
+
+
 /*
  *	Create an extra data block in a DDNS context.
  *
@@ -481,9 +1257,11 @@ ddns_socket ddns_connect(struct ddns_context* context)
 			(NULL != server) && (0 != continue_trying);
 			server = server->next )
 	{
-		char **in_addr = NULL;
-		struct hostent *addr = NULL;
+		int addr_idx = 0;
+		int addr_cnt = 0;
+		struct in_addr addr_list[16];
 		struct sockaddr_in svr_ip;
+		struct ddns_deadline deadline;
 
 		/* check exit signal */
 		if ( 0 != context->exit_signal )
@@ -501,8 +1279,13 @@ ddns_socket ddns_connect(struct ddns_context* context)
 
 		/* resolve server domain name to ip addresses. */
 		ddns_printf_v(context, msg_type_info, "Resolving '%s'... ", server->domain);
-		addr = (struct hostent*)gethostbyname(server->domain);
-		if ( (0 == addr) || (0 == addr->h_addr_list) )
+		ddns_deadline_init(&deadline, context->timeout * 1000UL);
+		addr_cnt = ddns_socket_resolve(	server->domain,
+										addr_list,
+										_countof(addr_list),
+										&deadline,
+										&(context->exit_signal) );
+		if ( addr_cnt <= 0 )
 		{
 			/* failed to resolve domain name, try next server. */
 			ddns_printf_v(context, msg_type_info, "failed.\n");
@@ -520,8 +1303,10 @@ ddns_socket ddns_connect(struct ddns_context* context)
 			ddns_printf_v(context, msg_type_info, "done.\n");
 
 			/* try each ip address of the DDNS server. */
-			for ( in_addr = addr->h_addr_list; *in_addr; ++in_addr )
+			for ( addr_idx = 0; addr_idx < addr_cnt; ++addr_idx )
 			{
+				const unsigned char * in_addr = (const unsigned char*)&addr_list[addr_idx];
+
 				/* check exit signal */
 				if ( 0 != context->exit_signal )
 				{
@@ -533,23 +1318,21 @@ ddns_socket ddns_connect(struct ddns_context* context)
 				/* construct server address */
 				svr_ip.sin_family	= AF_INET;
 				svr_ip.sin_port = htons(server->port);
-				memcpy(&(svr_ip.sin_addr), *in_addr, (int)addr->h_length);
+				svr_ip.sin_addr = addr_list[addr_idx];
 
 				/* preserve server address */
 				context->active_server.sin_port = svr_ip.sin_port;
 				context->active_server.sin_family = svr_ip.sin_family;
-				memcpy(	&(context->active_server.sin_addr),
-						*in_addr,
-						(int)addr->h_length );
+				context->active_server.sin_addr = svr_ip.sin_addr;
 
 				/* create socket */
 				ddns_printf_v(	context,
 								msg_type_info,
 								"Connecting to server[%d.%d.%d.%d:%d]... ",
-								(int)(((unsigned char*)(*in_addr))[0]),
-								(int)(((unsigned char*)(*in_addr))[1]),
-								(int)(((unsigned char*)(*in_addr))[2]),
-								(int)(((unsigned char*)(*in_addr))[3]),
+								(int)in_addr[0],
+								(int)in_addr[1],
+								(int)in_addr[2],
+								(int)in_addr[3],
 								(int)server->port );
 				context->socket = ddns_socket_create(AF_INET, SOCK_STREAM, 0);
 				if ( DDNS_INVALID_SOCKET == context->socket )
@@ -564,11 +1347,12 @@ ddns_socket ddns_connect(struct ddns_context* context)
 					/* successfully created a socket */
 					int result = -1;
 
-					/* connect to server */
+					/* connect to server, each address has its own budget */
+					ddns_deadline_init(&deadline, context->timeout * 1000UL);
 					result = ddns_socket_connect(	context->socket,
 													(struct sockaddr*)&svr_ip,
 													sizeof(svr_ip),
-													context->timeout,
+													&deadline,
 													&(context->exit_signal) );
 					if ( 0 == result )
 					{
@@ -627,6 +1411,9 @@ void ddns_vmsg(struct ddns_context * context, enum ddns_msg_type type, const cha
 	FILE * out = NULL;
 	FILE * out2 = NULL;
 
+	/* messages may come from worker threads, see [dnspod_interface_update_all] */
+	ddns_sync_lock(&(context->log_sync));
+
 	switch(type)
 	{
 	case msg_type_debug:
@@ -700,6 +1487,8 @@ void ddns_vmsg(struct ddns_context * context, enum ddns_msg_type type, const cha
 	{
 		context->log_status = 1;
 	}
+
+	ddns_sync_unlock(&(context->log_sync));
 }
 
 
@@ -763,38 +1552,178 @@ void ddns_printf_v(struct ddns_context *context, enum ddns_msg_type type, const
  *
  *	@param[in]	context	: the DDNS context.
  *
+ *	@note		The wait ends early when [wakeup_event] of the context is set,
+ *				e.g. by a signal handler after setting [exit_signal], or by
+ *				the interface watcher of [ddns_execute].
+ *
  *	@return		Return non-zero if the client should keep the domains on-line,
  *				otherwise return 0.
  */
 int ddns_wait(struct ddns_context * context)
 {
-	int interval	= 0;
 	int end_prog	= 1;
+	int signaled	= 0;
+
+	ddns_sync_lock(&(context->sync_object));
+	if ( context->exit_signal )
+	{
+		end_prog = 0;
+	}
+	ddns_sync_unlock(&(context->sync_object));
+
+	if ( (0 != end_prog) && (context->interval > 0) )
+	{
+		signaled = ddns_sync_event_wait(&(context->wakeup_event),
+										(unsigned long)context->interval * 1000
+										);
+	}
 
-	while ( interval < context->interval )
+	if ( 0 != signaled )
 	{
 		ddns_sync_lock(&(context->sync_object));
 		if ( context->exit_signal )
 		{
 			end_prog = 0;
 		}
+		else
+		{
+			/* woken up for an early update, wait again next time */
+			ddns_sync_event_reset(&(context->wakeup_event));
+		}
 		ddns_sync_unlock(&(context->sync_object));
+	}
+
+	return end_prog;
+}
+
+
+/**
+ *	Check if an IP address can be reached from the internet.
+ *
+ *	@param[in]	address	: the IP address, like "123.123.123.123".
+ *
+ *	@return		Return non-zero if it's a valid IPv4 address, and isn't in the
+ *				intranet, loopback or link-local ranges. Otherwise return 0.
+ */
+int ddns_is_internet_address(const char * address)
+{
+	int		d1			= 0;
+	int		d2			= 0;
+	int		d3			= 0;
+	int		d4			= 0;
+	char	extra_chr	= 0;
+
+	if (	(NULL == address)
+		||	(4 != sscanf(address, "%d.%d.%d.%d%c", &d1, &d2, &d3, &d4, &extra_chr)) )
+	{
+		return 0;
+	}
+
+	/* If it's a valid IP address? */
+	if (	(d1 < 0) || (d1 >= 256) || (d2 < 0) || (d2 >= 256)
+		||	(d3 < 0) || (d3 >= 256) || (d4 < 0) || (d4 >= 256)
+		||	((0 == d1) && (0 == d2) && (0 == d3) && (0 == d4))
+		||	((255 == d1) && (255 == d2) && (255 == d3) && (255 == d4)) )
+	{
+		return 0;
+	}
+
+	/* If it's a intranet, loopback or link-local address? */
+	if (	(10 == d1)
+		||	(127 == d1)
+		||	((172 == d1) && (16 <= d2) && (31>= d2))
+		||	((192 == d1) && (168 == d2))
+		||	((169 == d1) && (254 == d2)) )
+	{
+		return 0;
+	}
+
+	return 1;
+}
+
+
+/**
+ *	Get internet IP address of a local network interface.
+ *
+ *	@param[in]	name		: name of the interface, like "ppp0".
+ *	@param[out]	text_buffer	: buffer to save the IP address.
+ *	@param[in]	buffer_size	: size of the buffer.
+ *
+ *	@note		The returned IP address is like "123.123.123.123". Addresses
+ *				rejected by [ddns_is_internet_address] are ignored.
+ *
+ *	@return		Return [DDNS_ERROR_SUCCESS] if successfully get the address.
+ *				If the interface has no such address, [DDNS_ERROR_NOHOST] is
+ *				returned. [DDNS_ERROR_NOTIMPL] is returned if the platform
+ *				doesn't support it.
+ */
+ddns_error ddns_get_interface_address(
+	const char	*	name,
+	char		*	text_buffer,
+	int				buffer_size
+	)
+{
+	ddns_error	error_code	= DDNS_ERROR_SUCCESS;
+
+	if ( (NULL == name) || (NULL == text_buffer) || (buffer_size < 16) )
+	{
+		error_code = DDNS_ERROR_BADARG;
+	}
+
+#if defined(HAVE_IFADDRS_H) && HAVE_IFADDRS_H
+
+	if ( DDNS_ERROR_SUCCESS == error_code )
+	{
+		struct ifaddrs	*	if_list	= NULL;
+		struct ifaddrs	*	ifa		= NULL;
 
-		if ( 0 == end_prog )
+		if ( 0 != getifaddrs(&if_list) )
 		{
-			break;
+			error_code = DDNS_ERROR_UNKNOWN;
 		}
+		else
+		{
+			error_code = DDNS_ERROR_NOHOST;
+			for ( ifa = if_list; NULL != ifa; ifa = ifa->ifa_next )
+			{
+				const unsigned char * ip = NULL;
+
+				if (	(NULL == ifa->ifa_addr)
+					||	(AF_INET != ifa->ifa_addr->sa_family)
+					||	(0 != strcmp(name, ifa->ifa_name)) )
+				{
+					continue;
+				}
+
+				ip = (const unsigned char*)
+						&(((const struct sockaddr_in*)ifa->ifa_addr)->sin_addr);
+				c99_snprintf(text_buffer, buffer_size, "%u.%u.%u.%u",
+							 ip[0], ip[1], ip[2], ip[3]);
+				if ( 0 != ddns_is_internet_address(text_buffer) )
+				{
+					error_code = DDNS_ERROR_SUCCESS;
+					break;
+				}
+			}
+			freeifaddrs(if_list);
+		}
+
+		if ( DDNS_ERROR_SUCCESS != error_code )
+		{
+			text_buffer[0] = '\0';
+		}
+	}
 
-#if defined(WIN32)
-		Sleep(1000);
 #else
-		sleep(1);
-#endif
 
-		++interval;
+	if ( DDNS_ERROR_SUCCESS == error_code )
+	{
+		error_code = DDNS_ERROR_NOTIMPL;
 	}
 
-	return end_prog;
+#endif
+
+	return error_code;
 }
 
 
@@ -878,6 +1807,159 @@ const char * ddns_strcasestr(const char* str1, const char* str2)
 }
 
 
+/**
+ *	Build a matcher which searches several patterns in one pass (Aho-Corasick).
+ *
+ *	@param[out]	matcher		: the matcher to be initialized.
+ *	@param[in]	patterns	: the patterns, empty ones never match.
+ *	@param[in]	count		: number of patterns in [patterns].
+ *
+ *	@return		Return 0 on success, or non-zero if the patterns exceed the
+ *				limits of [DDNS_MATCHER_MAX_STATE] or [DDNS_MATCHER_MAX_PATTERN].
+ */
+int ddns_matcher_init(
+	struct ddns_matcher		*	matcher,
+	const char * const		*	patterns,
+	unsigned int				count
+	)
+{
+	unsigned char	fail[DDNS_MATCHER_MAX_STATE];
+	unsigned char	queue[DDNS_MATCHER_MAX_STATE];
+	unsigned int	head	= 0;
+	unsigned int	tail	= 0;
+	unsigned int	idx		= 0;
+	unsigned int	chr		= 0;
+	int				result	= 0;
+
+	memset(matcher, 0, sizeof(*matcher));
+	memset(fail, 0, sizeof(fail));
+	matcher->state_cnt = 1;
+
+	if ( count > DDNS_MATCHER_MAX_PATTERN )
+	{
+		result = -1;
+	}
+
+	/**
+	 *	Step 1: build the trie of patterns, state 0 is the root. A duplicated
+	 *			pattern is reported as the first one.
+	 */
+	for ( idx = 0; (0 == result) && (idx < count); ++idx )
+	{
+		const unsigned char	*	pattern = (const unsigned char*)patterns[idx];
+		unsigned int			state	= 0;
+
+		for ( ; (0 == result) && ('\0' != (*pattern)); ++pattern )
+		{
+			if ( 0 != matcher->next[state][*pattern] )
+			{
+				state = matcher->next[state][*pattern];
+			}
+			else if ( matcher->state_cnt < DDNS_MATCHER_MAX_STATE )
+			{
+				matcher->next[state][*pattern] = (unsigned char)matcher->state_cnt;
+				state = matcher->state_cnt++;
+			}
+			else
+			{
+				result = -1;
+			}
+		}
+
+		if ( (0 == result) && (0 != state) && (0 == matcher->output[state]) )
+		{
+			matcher->output[state] = (unsigned char)(idx + 1);
+		}
+	}
+
+	/**
+	 *	Step 2: resolve failures breadth first, so every missing transition
+	 *			goes where the longest suffix that's also a prefix goes.
+	 */
+	for ( chr = 0; (0 == result) && (chr < 256); ++chr )
+	{
+		if ( 0 != matcher->next[0][chr] )
+		{
+			queue[tail++] = matcher->next[0][chr];
+		}
+	}
+	while ( (0 == result) && (head < tail) )
+	{
+		unsigned int state		= queue[head++];
+		unsigned int fallback	= fail[state];
+
+		matcher->suffix[state] = (0 != matcher->output[fallback])
+							   ? (unsigned char)fallback
+							   : matcher->suffix[fallback];
+
+		for ( chr = 0; chr < 256; ++chr )
+		{
+			unsigned int target = matcher->next[state][chr];
+
+			if ( 0 != target )
+			{
+				fail[target] = matcher->next[fallback][chr];
+				queue[tail++] = (unsigned char)target;
+			}
+			else
+			{
+				matcher->next[state][chr] = matcher->next[fallback][chr];
+			}
+		}
+	}
+
+	return result;
+}
+
+
+/**
+ *	Search the patterns of a matcher in a block of a stream.
+ *
+ *	@param[in]		matcher		: the matcher.
+ *	@param[in/out]	state		: state of the stream, 0 for the beginning of
+ *								  it. It's kept between blocks, so a pattern can
+ *								  span them.
+ *	@param[in]		data		: the block to scan.
+ *	@param[in]		size		: size of the block in bytes.
+ *	@param[in]		callback	: called for each pattern found, the longest one
+ *								  goes first if several end at the same byte.
+ *	@param[in]		param		: extra parameter to be passed to [callback].
+ *
+ *	@return		Return number of bytes scanned. It's less than [size] only if
+ *				[callback] asks to stop, the byte ending the pattern is counted.
+ */
+size_t ddns_matcher_scan(
+	const struct ddns_matcher	*	matcher,
+	unsigned int				*	state,
+	const char					*	data,
+	size_t							size,
+	ddns_match_callback				callback,
+	void						*	param
+	)
+{
+	unsigned int	current	= *state;
+	size_t			idx		= 0;
+	int				stop	= 0;
+
+	while ( (0 == stop) && (idx < size) )
+	{
+		unsigned int found = 0;
+
+		current = matcher->next[current][(unsigned char)data[idx++]];
+
+		found = (0 != matcher->output[current]) ? current : matcher->suffix[current];
+		for ( ; (0 == stop) && (0 != found); found = matcher->suffix[found] )
+		{
+			stop = (*callback)(matcher->output[found] - 1, idx, param);
+		}
+	}
+
+	*state = current;
+
+	return idx;
+}
+
+
 /**
  *	Convert error code to human readable string.
  *
@@ -981,6 +2063,9 @@ const char * ddns_err2str(ddns_error error_code)
 	case DDNS_ERROR_INVALID_PROTO:
 		message = "unsupported DDNS protocol.";
 		break;
+	case DDNS_ERROR_PENDING:
+		message = "operation is in progress";
+		break;
 	case DDNS_ERROR_UNKNOWN:
 	default:
 		message = "unknown error";
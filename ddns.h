@@ -113,6 +113,9 @@ struct ddns_context
 	int						timeout;		/* connection timeout in seconds  */
 	int						interval;		/* keep-alive interval in seconds */
 	int						auto_restart;	/* if auto-restart at error       */
+	int						parallel;		/* concurrent updates, 0: inherit */
+	char					netif[32];		/* interface with our IP address  */
+	char					state_file[256];/* state kept between runs        */
 	int						exit_signal;	/* signal to quit                 */
 	int						log_status;		/* see [ddns_vprintf]             */
 	enum ddns_protocol		protocol;		/* DDNS protocol                  */
@@ -121,11 +124,51 @@ struct ddns_context
 	struct ddns_server		*domain;		/* list of domain names           */
 	struct sockaddr_in		active_server;	/* address of the active server   */
 	struct ddns_sync_object	sync_object;	/* sync object of the context     */
+	struct ddns_sync_object	log_sync;		/* serializes [ddns_vmsg]         */
+	struct ddns_sync_event	wakeup_event;	/* interrupts [ddns_wait]         */
 	void					*extra_data;	/* protocol specific data         */
 	FILE					*stream_out;	/* stream to output log           */
 	FILE					*stream_err;	/* stream to output error log     */
+	struct ddns_context		*next_account;	/* see [ddns_addaccount]          */
 };
 
+/**
+ *	Limits of [ddns_matcher].
+ */
+#define DDNS_MATCHER_MAX_STATE		64	/* total length of patterns plus 1 */
+#define DDNS_MATCHER_MAX_PATTERN	16
+
+/**
+ *	Multi-pattern string matcher, see [ddns_matcher_init]. It's read only once
+ *	initialized, so it can be shared by concurrent scans.
+ */
+struct ddns_matcher
+{
+	unsigned char			next[DDNS_MATCHER_MAX_STATE][256];	/* transitions */
+	unsigned char			output[DDNS_MATCHER_MAX_STATE];	/* 1 + pattern   */
+	unsigned char			suffix[DDNS_MATCHER_MAX_STATE];	/* next output   */
+	unsigned int			state_cnt;
+};
+
+/**
+ *	Callback of [ddns_matcher_scan], called for each pattern found.
+ *
+ *	@param[in]	pattern	: index of the pattern found.
+ *	@param[in]	offset	: offset of the byte following the pattern in the
+ *						  scanned block.
+ *	@param[in]	param	: the parameter passed to [ddns_matcher_scan].
+ *
+ *	@return		Return non-zero to stop scanning the block.
+ */
+typedef int (*ddns_match_callback)(unsigned int pattern, size_t offset, void * param);
+
+/**
+ *	Socket events for [step_ip_changed] of [ddns_interface].
+ */
+#define DDNS_EVENT_READ		0x01	/* socket is ready for read	*/
+#define DDNS_EVENT_WRITE	0x02	/* socket is ready for write	*/
+#define DDNS_EVENT_TIMEOUT	0x04	/* no event before timeout		*/
+
 DDNS_BEGIN_INTERFACE_(ddns_interface)
 
 	/**
@@ -142,6 +185,32 @@ DDNS_BEGIN_INTERFACE_(ddns_interface)
 		struct ddns_context	*	context
 		);
 
+	/**
+	 *	Non-blocking form of [is_ip_changed].
+	 *
+	 *	@param[out]		socket	: the socket to wait for.
+	 *	@param[in/out]	events	: [DDNS_EVENT_*] occurred on [socket] since the
+	 *							  previous call (0 for the first call), and
+	 *							  the events to wait for on return.
+	 *
+	 *	NOTE:
+	 *		It returns [DDNS_ERROR_PENDING] to yield, the caller waits until
+	 *		[events] occurs on [socket] or [timeout] of the context elapses,
+	 *		then call it again. Other return values are the same as
+	 *		[is_ip_changed].
+	 *
+	 *		This function is optional, set it to NULL if it's not
+	 *		implemented, [is_ip_changed] will be used instead. Only
+	 *		PeanutHull implements it: the HTTP module behind DNSPod and
+	 *		DynDNS has no resumable requests, so their checks block the
+	 *		scheduler for up to [timeout] of the context.
+	 */
+	DDNS_DECLARE_METHOD(ddns_error, step_ip_changed)(
+		struct ddns_context	*	context,
+		ddns_socket			*	socket,
+		int					*	events
+		);
+
 	/**
 	 *	Get current ip address.
 	 *
@@ -192,6 +261,9 @@ const char * ddns_getver();
  *	Initialize a DDNS context.
  *
  *	@param[in]	context		: pointer to the DDNS context to be initialized.
+ *
+ *	@note	Timeout, interval, auto-restart and parallel are left unset, so
+ *			an account may inherit them, the caller provides the defaults.
  */
 void ddns_initcontext(struct ddns_context *context);
 
@@ -201,12 +273,35 @@ void ddns_initcontext(struct ddns_context *context);
  *
  *	@param[in]	context		: pointer to the DDNS context.
  *
+ *	@note	All accounts chained by [next_account] are run in the calling
+ *			thread, each at its own interval, sharing the HTTP module (and
+ *			the pooled connections & TLS sessions of it). [exit_signal] and
+ *			[wakeup_event] of [context] control all of them.
+ *			On Linux, a new address on [netif] of any account wakes all of
+ *			them up at once, so [interval] only limits how stale DNS gets
+ *			when a change can't be seen locally.
+ *
  *	@return	DDNS_ERROR_SUCCESS if user request to quit, otherwise an error
  *			code will be returned.
  */
 ddns_error ddns_execute(struct ddns_context * context);
 
 
+/**
+ *	Add an account to a DDNS context, so that it'll be executed along with
+ *	the context by [ddns_execute].
+ *
+ *	@param[in/out]	context	: pointer to the DDNS context.
+ *
+ *	@note	The new account inherits protocol, timeout, interval, auto-restart,
+ *			parallel and verbose mode of [context].
+ *
+ *	@return	Return the new account, it's freed with [context]. If any error
+ *			occurred, NULL will be returned.
+ */
+struct ddns_context * ddns_addaccount(struct ddns_context * context);
+
+
 /**
  *	Free all resources associated with the DDNS context.
  *
@@ -337,6 +432,39 @@ void ddns_vmsg(
 int ddns_wait(struct ddns_context * context);
 
 
+/**
+ *	Check if an IP address can be reached from the internet.
+ *
+ *	@param[in]	address	: the IP address, like "123.123.123.123".
+ *
+ *	@return		Return non-zero if it's a valid IPv4 address, and isn't in the
+ *				intranet, loopback or link-local ranges. Otherwise return 0.
+ */
+int ddns_is_internet_address(const char * address);
+
+
+/**
+ *	Get internet IP address of a local network interface.
+ *
+ *	@param[in]	name		: name of the interface, like "ppp0".
+ *	@param[out]	text_buffer	: buffer to save the IP address.
+ *	@param[in]	buffer_size	: size of the buffer.
+ *
+ *	@note		The returned IP address is like "123.123.123.123". Addresses
+ *				rejected by [ddns_is_internet_address] are ignored.
+ *
+ *	@return		Return [DDNS_ERROR_SUCCESS] if successfully get the address.
+ *				If the interface has no such address, [DDNS_ERROR_NOHOST] is
+ *				returned. [DDNS_ERROR_NOTIMPL] is returned if the platform
+ *				doesn't support it.
+ */
+ddns_error ddns_get_interface_address(
+	const char	*	name,
+	char		*	text_buffer,
+	int				buffer_size
+	);
+
+
 /**
  *	Compare 2 strings without regard to case.
  *
@@ -383,6 +511,49 @@ int ddns_strncasecmp(const char* str1, const char* str2, size_t count);
 const char * ddns_strcasestr(const char* str1, const char* str2);
 
 
+/**
+ *	Build a matcher which searches several patterns in one pass (Aho-Corasick).
+ *
+ *	@param[out]	matcher		: the matcher to be initialized.
+ *	@param[in]	patterns	: the patterns, empty ones never match.
+ *	@param[in]	count		: number of patterns in [patterns].
+ *
+ *	@return		Return 0 on success, or non-zero if the patterns exceed the
+ *				limits of [DDNS_MATCHER_MAX_STATE] or [DDNS_MATCHER_MAX_PATTERN].
+ */
+int ddns_matcher_init(
+	struct ddns_matcher		*	matcher,
+	const char * const		*	patterns,
+	unsigned int				count
+	);
+
+
+/**
+ *	Search the patterns of a matcher in a block of a stream.
+ *
+ *	@param[in]		matcher		: the matcher.
+ *	@param[in/out]	state		: state of the stream, 0 for the beginning of
+ *								  it. It's kept between blocks, so a pattern can
+ *								  span them.
+ *	@param[in]		data		: the block to scan.
+ *	@param[in]		size		: size of the block in bytes.
+ *	@param[in]		callback	: called for each pattern found, the longest one
+ *								  goes first if several end at the same byte.
+ *	@param[in]		param		: extra parameter to be passed to [callback].
+ *
+ *	@return		Return number of bytes scanned. It's less than [size] only if
+ *				[callback] asks to stop, the byte ending the pattern is counted.
+ */
+size_t ddns_matcher_scan(
+	const struct ddns_matcher	*	matcher,
+	unsigned int				*	state,
+	const char					*	data,
+	size_t							size,
+	ddns_match_callback				callback,
+	void						*	param
+	);
+
+
 /**
  *	Convert error code to human readable string.
  *
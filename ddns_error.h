@@ -220,4 +220,10 @@ typedef unsigned long	ddns_error;
  */
 #define DDNS_ERROR_INVALID_PROTO		((ddns_error)(DDNS_ERROR_BASE + 29))
 
+
+/**
+ *	The operation is in progress, it will be resumed later.
+ */
+#define DDNS_ERROR_PENDING				((ddns_error)(DDNS_ERROR_BASE + 30))
+
 #endif	/* ! _INC_DDNS_ERROR */
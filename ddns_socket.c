@@ -24,8 +24,83 @@
  */
 
 #include "ddns_socket.h"
+#include <stdlib.h>		/* malloc, free */
 #include <string.h>		/* memcpy */
 #include "ddns.h"
+#include "ddns_string.h"
+
+/**
+ *	Maximum number of addresses of a host tried by [ddns_socket_create_tcp].
+ */
+#define DDNS_SOCKET_MAX_ADDR	16
+
+/**
+ *	Resolver cache, see [ddns_socket_resolve].
+ */
+#define DDNS_SOCKET_CACHE_SIZE			32		/* number of host names      */
+#define DDNS_SOCKET_CACHE_TTL			300		/* seconds to keep addresses */
+#define DDNS_SOCKET_CACHE_NEGATIVE_TTL	30		/* seconds to keep a failure */
+
+/**
+ *	Milliseconds to check [stop_wait] while waiting.
+ */
+#define DDNS_SOCKET_POLL		100
+
+/**
+ *	Number of sockets [ddns_socket_poll] handles without allocating memory.
+ */
+#define DDNS_SOCKET_POLL_BUFFER		16
+
+/**
+ *	Longest wait in milliseconds of a single [poll], which takes an int.
+ */
+#define DDNS_SOCKET_MAX_WAIT		0x7FFFFFFFUL
+
+/**
+ *	Milliseconds [ddns_socket_create_tcp] waits for a connection before it
+ *	tries the next address at the same time (RFC 8305 "Connection Attempt
+ *	Delay").
+ */
+#define DDNS_SOCKET_CONNECT_DELAY	250
+
+/**
+ *	A host name being resolved on a helper thread. It's shared by the thread
+ *	and all the callers waiting for it, the last one frees it.
+ */
+struct ddns_socket_lookup
+{
+	struct ddns_sync_thread		thread;
+	struct ddns_sync_event		done;		/* set once [addr_cnt] is valid  */
+	int							ref_cnt;	/* guarded by the cache lock     */
+	int							addr_cnt;
+	struct in_addr				addr_list[DDNS_SOCKET_MAX_ADDR];
+	char						host[256];
+};
+
+/**
+ *	Addresses of a host name, or the failure to resolve it.
+ */
+struct ddns_socket_cache_entry
+{
+	char						host[256];	/* empty if the entry is unused */
+	int							addr_cnt;	/* 0: failed to resolve         */
+	struct in_addr				addr_list[DDNS_SOCKET_MAX_ADDR];
+	unsigned long				stamp;		/* [ddns_sync_clock] resolved   */
+	unsigned long				ttl;		/* in milliseconds              */
+	struct ddns_socket_lookup*	lookup;		/* being resolved, or NULL      */
+	int							preferred;	/* if [winner] is valid         */
+	struct in_addr				winner;		/* last connected, goes first   */
+};
+
+/**
+ *	Resolver cache shared by all threads.
+ */
+static struct ddns_socket_cache
+{
+	int								initialized;
+	struct ddns_sync_object			lock;
+	struct ddns_socket_cache_entry	entries[DDNS_SOCKET_CACHE_SIZE];
+} g_resolver;
 
 /*
  *	Initialize socket environment, must be called before calling any of the
@@ -56,6 +131,13 @@ int ddns_socket_init()
 	}
 #endif
 
+	/* lookups may outlive [ddns_socket_uninit], keep the lock for them */
+	if ( (0 == err_code) && (0 == g_resolver.initialized) )
+	{
+		err_code = ddns_sync_init(&(g_resolver.lock));
+		g_resolver.initialized = (0 == err_code);
+	}
+
 	return err_code;
 }
 
@@ -68,6 +150,22 @@ int ddns_socket_init()
  */
 int ddns_socket_uninit()
 {
+	int i = 0;
+
+	/* forget resolved addresses, lookups in progress finish on their own */
+	if ( 0 != g_resolver.initialized )
+	{
+		ddns_sync_lock(&(g_resolver.lock));
+		for ( i = 0; i < DDNS_SOCKET_CACHE_SIZE; ++i )
+		{
+			if ( NULL == g_resolver.entries[i].lookup )
+			{
+				g_resolver.entries[i].host[0] = '\0';
+			}
+		}
+		ddns_sync_unlock(&(g_resolver.lock));
+	}
+
 #if DDNS_SOCKET_UNIX
 	return 0;
 #elif DDNS_SOCKET_WINSOCK_1 || DDNS_SOCKET_WINSOCK_2
@@ -161,7 +259,8 @@ int ddns_socket_close(ddns_socket sock)
  *	@param[in]	sock		: the socket to initiate the connection.
  *	@param[in]	addr		: target address.
  *	@param[in]	sz			: size of the target address in bytes.
- *	@param[in]	timeout		: time out in seconds to initiate the connection.
+ *	@param[in]	deadline	: deadline to initiate the connection, NULL for
+ *							  no limit.
  *	@param[in]	stop_wait	: pointer to the exit signal, will stop further
  *							  process when it's set to non-zero.
  *
@@ -175,7 +274,7 @@ int ddns_socket_connect(
 	ddns_socket			sock,
 	struct sockaddr	*	addr,
 	socklen_t			sz,
-	int					timeout,
+	const struct ddns_deadline	*	deadline,
 	int				*	stop_wait
 	)
 {
@@ -192,23 +291,28 @@ int ddns_socket_connect(
 		if ( -1 == result && EINPROGRESS == ddns_socket_get_errno() )
 #endif
 		{
-			int cnt = 0;
-			for ( ; cnt < timeout; ++cnt )
+			unsigned long remain = 0;
+
+			while ( 0 != (remain = ddns_deadline_remain(deadline)) )
 			{
-				fd_set fd;
-				struct timeval tv = { 1, 0 };
-				
 				if ( (NULL != stop_wait) && (0 != (*stop_wait)) )
 				{
 					result = -1;
 					break;
 				}
 
-				FD_ZERO(&fd);
-				FD_SET(sock, &fd);
+				/* wake up in time to check the exit signal */
+				if ( (NULL != stop_wait) && (remain > DDNS_SOCKET_POLL) )
+				{
+					remain = DDNS_SOCKET_POLL;
+				}
+				else if ( remain > 1000 )
+				{
+					remain = 1000;
+				}
 
-				result = select(sock + 1, 0, &fd, 0, &tv);
-				if ( 1 == result )
+				result = ddns_socket_wait(sock, DDNS_SOCKET_EVENT_WRITE, remain);
+				if ( result > 0 )
 				{
 					/* connected */
 					result = 0;
@@ -250,12 +354,370 @@ int ddns_socket_connect(
 }
 
 
+/**
+ *	Resolve host name to IPv4 addresses, it blocks until the resolver answers.
+ *
+ *	@param[in]	addr		: the host name, ex.: "www.website.com".
+ *	@param[out]	addr_list	: buffer to receive the addresses.
+ *	@param[in]	count		: capacity of [addr_list].
+ *
+ *	@return	number of addresses written into [addr_list].
+ *
+ *	@note	It may be called from several threads at the same time, so it
+ *			doesn't use [gethostbyname] unless the platform keeps the result
+ *			per thread (Winsock does).
+ */
+static int ddns_socket_resolve_host(
+	const char		*	addr,
+	struct in_addr	*	addr_list,
+	int					count
+	)
+{
+	int addr_cnt = 0;
+
+#if DDNS_SOCKET_UNIX
+
+	struct addrinfo		hints;
+	struct addrinfo	*	result	= NULL;
+	struct addrinfo	*	ai		= NULL;
+
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family		= AF_INET;
+	hints.ai_socktype	= SOCK_STREAM;
+
+	if ( 0 == getaddrinfo(addr, NULL, &hints, &result) )
+	{
+		for ( ai = result; (NULL != ai) && (addr_cnt < count); ai = ai->ai_next )
+		{
+			if ( (AF_INET == ai->ai_family)
+				&& (ai->ai_addrlen >= sizeof(struct sockaddr_in)) )
+			{
+				addr_list[addr_cnt++] = ((struct sockaddr_in*)ai->ai_addr)->sin_addr;
+			}
+		}
+		freeaddrinfo(result);
+	}
+
+#elif DDNS_SOCKET_WINSOCK_1 || DDNS_SOCKET_WINSOCK_2
+
+	char			**	in_addr	= NULL;
+	struct hostent	*	host	= NULL;
+
+	host = (struct hostent*)gethostbyname(addr);
+	if ( (NULL != host) && (NULL != host->h_addr_list) )
+	{
+		for ( in_addr = host->h_addr_list; (*in_addr) && (addr_cnt < count); ++in_addr )
+		{
+			memcpy(&addr_list[addr_cnt++], *in_addr, sizeof(addr_list[0]));
+		}
+	}
+
+#else
+#	error "socket is not supported on target platform!!!"
+#endif
+
+	return addr_cnt;
+}
+
+
+/**
+ *	Move an address to the front of an address list, the others keep their
+ *	order.
+ *
+ *	@param[in/out]	addr_list	: the address list.
+ *	@param[in]		count		: number of addresses in [addr_list].
+ *	@param[in]		addr		: the address to move, it's ignored if it's not
+ *								  in the list.
+ */
+static void ddns_socket_move_front(
+	struct in_addr			*	addr_list,
+	int							count,
+	const struct in_addr	*	addr
+	)
+{
+	int i = 0;
+
+	for ( i = 0; i < count; ++i )
+	{
+		if ( 0 == memcmp(&addr_list[i], addr, sizeof(*addr)) )
+		{
+			memmove(&addr_list[1], &addr_list[0], i * sizeof(addr_list[0]));
+			addr_list[0] = (*addr);
+			break;
+		}
+	}
+}
+
+
+/**
+ *	Remember the address of a host connected at last, it's returned first by
+ *	[ddns_socket_resolve] since then.
+ *
+ *	@param[in]	host		: the host name.
+ *	@param[in]	addr		: the connected address.
+ */
+static void ddns_socket_prefer(
+	const char				*	host,
+	const struct in_addr	*	addr
+	)
+{
+	int i = 0;
+
+	if ( 0 != g_resolver.initialized )
+	{
+		ddns_sync_lock(&(g_resolver.lock));
+		for ( i = 0; i < DDNS_SOCKET_CACHE_SIZE; ++i )
+		{
+			struct ddns_socket_cache_entry * entry = &(g_resolver.entries[i]);
+
+			if ( 0 == strcmp(entry->host, host) )
+			{
+				entry->preferred	= 1;
+				entry->winner		= (*addr);
+				ddns_socket_move_front(entry->addr_list, entry->addr_cnt, addr);
+				break;
+			}
+		}
+		ddns_sync_unlock(&(g_resolver.lock));
+	}
+}
+
+
+/**
+ *	Release a lookup, it's freed when nobody refers to it any more.
+ *
+ *	@param[in]	lookup		: the lookup.
+ *
+ *	@note	The cache lock must be held.
+ */
+static void ddns_socket_lookup_release(
+	struct ddns_socket_lookup	*	lookup
+	)
+{
+	if ( 0 == --(lookup->ref_cnt) )
+	{
+		ddns_sync_event_destroy(&(lookup->done));
+		free(lookup);
+	}
+}
+
+
+/**
+ *	Entry of the helper thread of a lookup, it resolves the host name and
+ *	keeps the result in the cache.
+ *
+ *	@param[in]	lookup		: the lookup.
+ */
+static void ddns_socket_lookup_main(
+	struct ddns_socket_lookup	*	lookup
+	)
+{
+	int i		= 0;
+	int count	= 0;
+
+	count = ddns_socket_resolve_host(lookup->host,
+									 lookup->addr_list,
+									 DDNS_SOCKET_MAX_ADDR
+									 );
+
+	ddns_sync_lock(&(g_resolver.lock));
+
+	lookup->addr_cnt = count;
+	for ( i = 0; i < DDNS_SOCKET_CACHE_SIZE; ++i )
+	{
+		struct ddns_socket_cache_entry * entry = &(g_resolver.entries[i]);
+
+		if ( lookup == entry->lookup )
+		{
+			entry->addr_cnt	= count;
+			entry->stamp	= ddns_sync_clock();
+			entry->ttl		= (count > 0)
+							? DDNS_SOCKET_CACHE_TTL * 1000UL
+							: DDNS_SOCKET_CACHE_NEGATIVE_TTL * 1000UL;
+			entry->lookup	= NULL;
+			memcpy(entry->addr_list, lookup->addr_list, sizeof(entry->addr_list));
+			if ( 0 != entry->preferred )
+			{
+				ddns_socket_move_front(entry->addr_list, count, &(entry->winner));
+			}
+			break;
+		}
+	}
+	ddns_sync_event_set(&(lookup->done));
+	ddns_socket_lookup_release(lookup);
+
+	ddns_sync_unlock(&(g_resolver.lock));
+}
+
+
+/**
+ *	Resolve host name to IPv4 addresses, with the help of a cache shared by
+ *	all threads.
+ *
+ *	@param[in]	addr		: the host name, ex.: "www.website.com".
+ *	@param[out]	addr_list	: buffer to receive the addresses.
+ *	@param[in]	count		: capacity of [addr_list].
+ *	@param[in]	deadline	: deadline to wait for the resolver, NULL to wait
+ *							  until it answers.
+ *	@param[in]	stop_wait	: pointer to the exit signal, will stop waiting
+ *							  when it's set to non-zero.
+ *
+ *	@return	number of addresses written into [addr_list].
+ *
+ *	@note	Addresses are kept for [DDNS_SOCKET_CACHE_TTL] seconds, and a
+ *			failure for [DDNS_SOCKET_CACHE_NEGATIVE_TTL] seconds. The address
+ *			connected at last by [ddns_socket_create_tcp] goes first. A host name
+ *			missing in the cache is resolved on a helper thread, so that the
+ *			caller can give up on timeout or exit signal. The lookup goes on
+ *			and fills the cache, threads asking for the same host name in the
+ *			meantime wait for the same lookup.
+ */
+int ddns_socket_resolve(
+	const char		*	addr,
+	struct in_addr	*	addr_list,
+	int					count,
+	const struct ddns_deadline	*	deadline,
+	int				*	stop_wait
+	)
+{
+	struct ddns_socket_cache_entry	*	entry		= NULL;
+	struct ddns_socket_lookup		*	lookup		= NULL;
+	unsigned long						now			= ddns_sync_clock();
+	unsigned long						oldest		= 0;
+	int									addr_cnt	= -1;
+	int									i			= 0;
+
+	/**
+	 *	Step 1: an IP address or an over long name is resolved in place.
+	 */
+	if (	(0 == g_resolver.initialized)
+		||	(strlen(addr) >= sizeof(entry->host))
+		||	(strlen(addr) == strspn(addr, "0123456789.")) )
+	{
+		return ddns_socket_resolve_host(addr, addr_list, count);
+	}
+
+	/**
+	 *	Step 2: look up the cache, or start a lookup in place of the oldest
+	 *			entry.
+	 */
+	ddns_sync_lock(&(g_resolver.lock));
+	for ( i = 0; i < DDNS_SOCKET_CACHE_SIZE; ++i )
+	{
+		struct ddns_socket_cache_entry * candidate = &(g_resolver.entries[i]);
+
+		if ( 0 == strcmp(candidate->host, addr) )
+		{
+			entry = candidate;
+			break;
+		}
+		else if (	(NULL == candidate->lookup)
+				&&	(	('\0' == candidate->host[0])
+					||	(now - candidate->stamp >= oldest) ) )
+		{
+			entry	= candidate;
+			oldest	= ('\0' == candidate->host[0]) ? (unsigned long)-1 : now - candidate->stamp;
+		}
+	}
+
+	if ( (NULL != entry) && (0 == strcmp(entry->host, addr)) )
+	{
+		if ( NULL != entry->lookup )
+		{
+			lookup = entry->lookup;
+			++(lookup->ref_cnt);
+		}
+		else if ( now - entry->stamp < entry->ttl )
+		{
+			addr_cnt = (entry->addr_cnt < count) ? entry->addr_cnt : count;
+			memcpy(addr_list, entry->addr_list, addr_cnt * sizeof(addr_list[0]));
+		}
+	}
+
+	if ( (NULL != entry) && (NULL == lookup) && (-1 == addr_cnt) )
+	{
+		lookup = (struct ddns_socket_lookup*)malloc(sizeof(*lookup));
+		if ( NULL != lookup )
+		{
+			memset(lookup, 0, sizeof(*lookup));
+			c99_strncpy(lookup->host, addr, sizeof(lookup->host));
+			lookup->ref_cnt = 2;	/* the helper thread and the caller */
+		}
+		if (	(NULL != lookup)
+			&&	(0 == ddns_sync_event_init(&(lookup->done))) )
+		{
+			if ( 0 == ddns_sync_thread_create(&(lookup->thread),
+											  (ddns_sync_routine)&ddns_socket_lookup_main,
+											  lookup
+											  ) )
+			{
+				ddns_sync_thread_detach(&(lookup->thread));
+				if ( 0 != strcmp(entry->host, addr) )
+				{
+					c99_strncpy(entry->host, addr, sizeof(entry->host));
+					entry->preferred = 0;
+				}
+				entry->lookup = lookup;
+			}
+			else
+			{
+				ddns_sync_event_destroy(&(lookup->done));
+				free(lookup);
+				lookup = NULL;
+			}
+		}
+		else if ( NULL != lookup )
+		{
+			free(lookup);
+			lookup = NULL;
+		}
+	}
+	ddns_sync_unlock(&(g_resolver.lock));
+
+	/**
+	 *	Step 3: wait for the lookup, the cache is full of lookups or the helper
+	 *			thread isn't available, resolve in place.
+	 */
+	if ( NULL != lookup )
+	{
+		unsigned long remain = 0;
+
+		while (	(0 != (remain = ddns_deadline_remain(deadline)))
+			&&	((NULL == stop_wait) || (0 == (*stop_wait))) )
+		{
+			if ( 0 != ddns_sync_event_wait(&(lookup->done),
+										   (remain < DDNS_SOCKET_POLL) ? remain : DDNS_SOCKET_POLL) )
+			{
+				break;
+			}
+		}
+
+		ddns_sync_lock(&(g_resolver.lock));
+		addr_cnt = 0;
+		if ( 0 != ddns_sync_event_wait(&(lookup->done), 0) )
+		{
+			addr_cnt = (lookup->addr_cnt < count) ? lookup->addr_cnt : count;
+			memcpy(addr_list, lookup->addr_list, addr_cnt * sizeof(addr_list[0]));
+		}
+		ddns_socket_lookup_release(lookup);
+		ddns_sync_unlock(&(g_resolver.lock));
+	}
+	else if ( -1 == addr_cnt )
+	{
+		addr_cnt = ddns_socket_resolve_host(addr, addr_list, count);
+	}
+
+	return addr_cnt;
+}
+
+
 /**
  *	Create a SOCK_STREAM socket and initiate a TCP connection on it.
  *
  *	@param[in]	address		: address of remote host, ex.: "www.website.com".
  *	@param[in]	port		: the remote port to connect to.
- *	@param[in]	timeout		: time out in seconds to initiate the connection.
+ *	@param[in]	deadline	: deadline to initiate the connection, NULL for
+ *							  no limit.
  *	@param[in]	stop_wait	: pointer to the exit signal, will stop further
  *							  process when it's set to non-zero.
  *
@@ -263,77 +725,427 @@ int ddns_socket_connect(
  *			mode. Use ddns_socket_close to free resources allocated for the
  *			communication endpoint. If it failed to connect to the remote host,
  *			[DDNS_INVALID_SOCKET] will be returned.
+ *
+ *	@note	Addresses of the host are raced (RFC 8305): a connection to the
+ *			next address is started every [DDNS_SOCKET_CONNECT_DELAY]
+ *			milliseconds, or as soon as one fails, the first one connected
+ *			wins and the others are closed. [deadline] covers resolving the
+ *			host name and the whole race.
  */
 ddns_socket ddns_socket_create_tcp(
 	const char		*	addr,
 	unsigned short		port,
-	int					timeout,
+	const struct ddns_deadline	*	deadline,
 	int				*	stop_wait
 	)
 {
-	char				**	in_addr	= NULL;
-	ddns_socket				sock	= DDNS_INVALID_SOCKET;
-	struct hostent		*	host	= NULL;
+	int						i			= 0;
+	int						addr_cnt	= 0;
+	int						started		= 0;
+	int						pending		= 0;
+	int						winner		= -1;
+	int						error		= ETIMEDOUT;
+	unsigned long			next_start	= ddns_sync_clock();
+	ddns_socket				sock		= DDNS_INVALID_SOCKET;
+	ddns_socket				sock_list[DDNS_SOCKET_MAX_ADDR];
+	struct in_addr			addr_list[DDNS_SOCKET_MAX_ADDR];
 	struct sockaddr_in		svr_ip;
 
 	/* resolve host name to ip addresses. */
-	host = (struct hostent*)gethostbyname(addr);
-	if ( (NULL != host) && (NULL != host->h_addr_list) )
+	addr_cnt = ddns_socket_resolve(addr,
+								   addr_list,
+								   DDNS_SOCKET_MAX_ADDR,
+								   deadline,
+								   stop_wait
+								   );
+	if ( addr_cnt <= 0 )
+	{
+		error = ENETUNREACH;
+	}
+
+	while ( (-1 == winner) && ((started < addr_cnt) || (pending > 0)) )
 	{
-		/* try each ip address of the DDNS server. */
-		for ( in_addr = host->h_addr_list; *in_addr; ++in_addr )
+		unsigned long	now			= ddns_sync_clock();
+		unsigned long				wait	= ddns_deadline_remain(deadline);
+		struct ddns_socket_event	wait_list[DDNS_SOCKET_MAX_ADDR];
+
+		/* check exit signal and deadline */
+		if ( ((NULL != stop_wait) && (0 != (*stop_wait))) || (0 == wait) )
 		{
-			/* check exit signal */
-			if ( (NULL != stop_wait) && (0 != (*stop_wait)) )
-			{
-				break;
-			}
+			break;
+		}
 
-			/* construct server address */
+		/**
+		 *	Step 1: start connecting to the next address when it's time, or
+		 *			nothing else is in progress.
+		 */
+		if (	(started < addr_cnt)
+			&&	((0 == pending) || ((long)(now - next_start) >= 0)) )
+		{
+			memset(&svr_ip, 0, sizeof(svr_ip));
 			svr_ip.sin_family	= AF_INET;
 			svr_ip.sin_port		= htons(port);
-			memcpy(&(svr_ip.sin_addr), *in_addr, (int)host->h_length);
+			svr_ip.sin_addr		= addr_list[started];
 
 			sock = ddns_socket_create(AF_INET, SOCK_STREAM, IPPROTO_TCP);
 			if ( DDNS_INVALID_SOCKET == sock )
 			{
 				/* create socket failed, stop further process. */
+				error = ddns_socket_get_errno();
 				break;
 			}
+			else if ( 0 != ddns_socket_set_blocking(sock, 0) )
+			{
+				error = ddns_socket_get_errno();
+				ddns_socket_close(sock);
+				sock = DDNS_INVALID_SOCKET;
+			}
+			else if ( 0 == connect(sock, (struct sockaddr*)&svr_ip, sizeof(svr_ip)) )
+			{
+				winner = started;
+			}
+#if DDNS_SOCKET_WINSOCK_1 || DDNS_SOCKET_WINSOCK_2
+			else if ( EWOULDBLOCK == ddns_socket_get_errno() )
+#else
+			else if ( EINPROGRESS == ddns_socket_get_errno() )
+#endif
+			{
+				++pending;
+			}
 			else
 			{
-				/* succesfully created a socket */
-				int result = -1;
-
-				/* connect to server */
-				result = ddns_socket_connect(	sock,
-												(struct sockaddr*)&svr_ip,
-												sizeof(svr_ip),
-												timeout,
-												stop_wait
-												);
-				if ( 0 == result )
-				{
-					/* connected */
-					break;
-				}
-				else
-				{
-					ddns_socket_close(sock);
-					sock = DDNS_INVALID_SOCKET;
-				}
+				error = ddns_socket_get_errno();
+				ddns_socket_close(sock);
+				sock = DDNS_INVALID_SOCKET;
+			}
+
+			sock_list[started++]	= sock;
+			next_start				= now + DDNS_SOCKET_CONNECT_DELAY;
+			continue;
+		}
+
+		/**
+		 *	Step 2: wait for the connections in progress, until the next one
+		 *			is due.
+		 */
+		if ( DDNS_DEADLINE_NEVER == wait )
+		{
+			wait = 1000;
+		}
+		if ( (started < addr_cnt) && (next_start - now < wait) )
+		{
+			wait = next_start - now;
+		}
+		if ( (NULL != stop_wait) && (wait > DDNS_SOCKET_POLL) )
+		{
+			wait = DDNS_SOCKET_POLL;
+		}
+
+		for ( i = 0; i < started; ++i )
+		{
+			/* failed ones are closed, and skipped as invalid sockets */
+			wait_list[i].socket		= sock_list[i];
+			wait_list[i].events		= DDNS_SOCKET_EVENT_WRITE;
+			wait_list[i].revents	= 0;
+		}
+
+		if ( ddns_socket_poll(wait_list, started, wait) <= 0 )
+		{
+			continue;
+		}
+
+		/**
+		 *	Step 3: the first connected one wins, a failed one makes way for
+		 *			the next address at once.
+		 */
+		for ( i = 0; (i < started) && (-1 == winner); ++i )
+		{
+			int			result	= 0;
+			int			so_err	= 0;
+			socklen_t	len		= sizeof(so_err);
+
+			if ( (DDNS_INVALID_SOCKET == sock_list[i]) || (0 == wait_list[i].revents) )
+			{
+				continue;
+			}
+
+			result = getsockopt(sock_list[i], SOL_SOCKET, SO_ERROR, (char*)&so_err, &len);
+			if (	(0 == result)
+				&&	(0 == so_err)
+				&&	(0 == (wait_list[i].revents & DDNS_SOCKET_EVENT_ERROR)) )
+			{
+				winner = i;
+			}
+			else
+			{
+				error = (0 != so_err) ? so_err : ECONNREFUSED;
+				ddns_socket_close(sock_list[i]);
+				sock_list[i]	= DDNS_INVALID_SOCKET;
+				next_start		= now;
+				--pending;
 			}
 		}
 	}
-	else
+
+	/* keep the winner, and remember it for next time */
+	sock = DDNS_INVALID_SOCKET;
+	for ( i = 0; i < started; ++i )
+	{
+		if ( i == winner )
+		{
+			sock = sock_list[i];
+			ddns_socket_prefer(addr, &addr_list[i]);
+		}
+		else if ( DDNS_INVALID_SOCKET != sock_list[i] )
+		{
+			ddns_socket_close(sock_list[i]);
+		}
+	}
+
+	if ( DDNS_INVALID_SOCKET == sock )
 	{
-		ddns_socket_set_errno(ENETUNREACH);
+		ddns_socket_set_errno(error);
 	}
 
 	return sock;
 }
 
 
+/**
+ *	Wait until any of the sockets is ready, or the timeout elapses.
+ *
+ *	@param[in/out]	list	: the sockets and the events to wait for, the
+ *							  occurred events are stored in [revents].
+ *	@param[in]		count	: number of sockets in [list].
+ *	@param[in]		timeout	: timeout in milliseconds, or
+ *							  [DDNS_SOCKET_INFINITE] to wait forever.
+ *
+ *	@return	Return the number of ready sockets, 0 on timeout. Otherwise, a
+ *			value of -1 is returned, use ddns_socket_get_errno to get the
+ *			error code.
+ *
+ *	@note	Unlike [select], it works for sockets of any descriptor value, and
+ *			the cost depends on [count] only. A socket with an error or hung
+ *			up reports the events it waits for along with
+ *			[DDNS_SOCKET_EVENT_ERROR], so the next call on it fails and tells
+ *			the reason.
+ */
+int ddns_socket_poll(
+	struct ddns_socket_event	*	list,
+	int								count,
+	unsigned long					timeout
+	)
+{
+	int ready	= -1;
+	int i		= 0;
+
+#if DDNS_SOCKET_HAVE_POLL
+
+	struct pollfd		fd_buf[DDNS_SOCKET_POLL_BUFFER];
+	struct pollfd	*	fd_list	= fd_buf;
+	int					wait	= -1;
+
+	/**
+	 *	Step 1: Arguments validity check.
+	 */
+	if ( (count < 0) || ((count > 0) && (NULL == list)) )
+	{
+		ddns_socket_set_errno(EINVAL);
+		return -1;
+	}
+
+	/**
+	 *	Step 2: Translate the list, the stack buffer covers all but the
+	 *			largest lists.
+	 */
+	if ( count > DDNS_SOCKET_POLL_BUFFER )
+	{
+		fd_list = (struct pollfd*)malloc(count * sizeof(struct pollfd));
+	}
+	if ( NULL == fd_list )
+	{
+		ddns_socket_set_errno(ENOMEM);
+	}
+	else
+	{
+		for ( i = 0; i < count; ++i )
+		{
+			/* a negative descriptor is ignored by [poll] */
+			fd_list[i].fd		= list[i].socket;
+			fd_list[i].events	= 0;
+			fd_list[i].revents	= 0;
+			if ( 0 != (list[i].events & DDNS_SOCKET_EVENT_READ) )
+			{
+				fd_list[i].events |= POLLIN;
+			}
+			if ( 0 != (list[i].events & DDNS_SOCKET_EVENT_WRITE) )
+			{
+				fd_list[i].events |= POLLOUT;
+			}
+		}
+
+		/**
+		 *	Step 3: Wait, and translate the result back.
+		 */
+		if ( DDNS_SOCKET_INFINITE != timeout )
+		{
+			wait = (int)((timeout > DDNS_SOCKET_MAX_WAIT) ? DDNS_SOCKET_MAX_WAIT : timeout);
+		}
+		ready = poll(fd_list, (nfds_t)count, wait);
+
+		for ( i = 0; i < count; ++i )
+		{
+			list[i].revents = 0;
+			if ( ready <= 0 )
+			{
+				continue;
+			}
+			if ( 0 != (fd_list[i].revents & POLLIN) )
+			{
+				list[i].revents |= DDNS_SOCKET_EVENT_READ;
+			}
+			if ( 0 != (fd_list[i].revents & POLLOUT) )
+			{
+				list[i].revents |= DDNS_SOCKET_EVENT_WRITE;
+			}
+			if ( 0 != (fd_list[i].revents & (POLLERR | POLLHUP | POLLNVAL)) )
+			{
+				list[i].revents |= list[i].events | DDNS_SOCKET_EVENT_ERROR;
+			}
+		}
+
+		if ( fd_buf != fd_list )
+		{
+			free(fd_list);
+		}
+	}
+
+#else	/* ! DDNS_SOCKET_HAVE_POLL */
+
+	fd_set			fd_read;
+	fd_set			fd_write;
+	fd_set			fd_except;
+	struct timeval	tv;
+	int				max_fd	= -1;
+
+	/**
+	 *	Step 1: Arguments validity check.
+	 */
+	if ( (count < 0) || ((count > 0) && (NULL == list)) )
+	{
+		ddns_socket_set_errno(EINVAL);
+		return -1;
+	}
+
+	/**
+	 *	Step 2: Fill the descriptor sets, winsock reports a failed connection
+	 *			in the exception set.
+	 */
+	FD_ZERO(&fd_read);
+	FD_ZERO(&fd_write);
+	FD_ZERO(&fd_except);
+	for ( i = 0; i < count; ++i )
+	{
+		if ( DDNS_INVALID_SOCKET == list[i].socket )
+		{
+			continue;
+		}
+#if DDNS_SOCKET_UNIX
+		if ( (int)list[i].socket >= FD_SETSIZE )
+		{
+			/* out of the range of [fd_set] */
+			ddns_socket_set_errno(EINVAL);
+			return -1;
+		}
+#endif
+		if ( 0 != (list[i].events & DDNS_SOCKET_EVENT_READ) )
+		{
+			FD_SET(list[i].socket, &fd_read);
+		}
+		if ( 0 != (list[i].events & DDNS_SOCKET_EVENT_WRITE) )
+		{
+			FD_SET(list[i].socket, &fd_write);
+		}
+		FD_SET(list[i].socket, &fd_except);
+		if ( (int)list[i].socket > max_fd )
+		{
+			max_fd = (int)list[i].socket;
+		}
+	}
+
+	/**
+	 *	Step 3: Wait, and translate the result back.
+	 */
+	tv.tv_sec	= timeout / 1000;
+	tv.tv_usec	= (timeout % 1000) * 1000;
+	ready = select(	max_fd + 1,
+					&fd_read,
+					&fd_write,
+					&fd_except,
+					(DDNS_SOCKET_INFINITE != timeout) ? &tv : NULL
+					);
+
+	for ( i = 0; i < count; ++i )
+	{
+		list[i].revents = 0;
+		if ( (ready <= 0) || (DDNS_INVALID_SOCKET == list[i].socket) )
+		{
+			continue;
+		}
+		if ( FD_ISSET(list[i].socket, &fd_read) )
+		{
+			list[i].revents |= DDNS_SOCKET_EVENT_READ;
+		}
+		if ( FD_ISSET(list[i].socket, &fd_write) )
+		{
+			list[i].revents |= DDNS_SOCKET_EVENT_WRITE;
+		}
+		if ( FD_ISSET(list[i].socket, &fd_except) )
+		{
+			list[i].revents |= list[i].events | DDNS_SOCKET_EVENT_ERROR;
+		}
+	}
+
+#endif	/* DDNS_SOCKET_HAVE_POLL */
+
+	return ready;
+}
+
+
+/**
+ *	Wait until a socket is ready, or the timeout elapses.
+ *
+ *	@param[in]	sock		: the socket to wait for.
+ *	@param[in]	events		: DDNS_SOCKET_EVENT_XXX to wait for.
+ *	@param[in]	timeout		: timeout in milliseconds, or
+ *							  [DDNS_SOCKET_INFINITE] to wait forever.
+ *
+ *	@return	Return the occurred events, 0 on timeout. Otherwise, a value of -1
+ *			is returned, use ddns_socket_get_errno to get the error code.
+ */
+int ddns_socket_wait(
+	ddns_socket			sock,
+	int					events,
+	unsigned long		timeout
+	)
+{
+	int							result	= 0;
+	struct ddns_socket_event	item;
+
+	item.socket		= sock;
+	item.events		= events;
+	item.revents	= 0;
+
+	result = ddns_socket_poll(&item, 1, timeout);
+	if ( result > 0 )
+	{
+		result = item.revents;
+	}
+
+	return result;
+}
+
+
 /**
  *	Get blocking mode of a socket.
  *
@@ -86,6 +86,10 @@
 #	if !defined(HAVE_CONFIG_H) || (defined(HAVE_SYS_SELECT_H) && HAVE_SYS_SELECT_H)
 #		include <sys/select.h>	/* POSIX.1-2001: 'select', 'fd_set', etc. */
 #	endif
+#	if !defined(HAVE_CONFIG_H) || (defined(HAVE_POLL_H) && HAVE_POLL_H)
+#		include <poll.h>		/* POSIX.1-2001: 'poll' */
+#		define DDNS_SOCKET_HAVE_POLL	1
+#	endif
 #	if !defined(HAVE_CONFIG_H) || (defined(HAVE_UNISTD_H) && HAVE_UNISTD_H)
 #		include <unistd.h>		/* POSIX.1-2001: 'fcntl', 'close'. */
 #	endif
@@ -474,6 +478,34 @@ extern "C" {
 	
 #define DDNS_INVALID_SOCKET		((ddns_socket)(-1))
 
+#if !defined(DDNS_SOCKET_HAVE_POLL)
+#	define DDNS_SOCKET_HAVE_POLL	0
+#endif
+
+/**
+ *	Events for [ddns_socket_poll] and [ddns_socket_wait]
+ */
+#define DDNS_SOCKET_EVENT_READ		0x01	/* ready for read                */
+#define DDNS_SOCKET_EVENT_WRITE		0x02	/* ready for write               */
+#define DDNS_SOCKET_EVENT_ERROR		0x04	/* error or hang up, output only */
+
+/**
+ *	Timeout for [ddns_socket_poll] and [ddns_socket_wait] to wait forever.
+ */
+#define DDNS_SOCKET_INFINITE		((unsigned long)-1)
+
+/**
+ *	A socket to be waited by [ddns_socket_poll].
+ */
+struct ddns_socket_event
+{
+	ddns_socket					socket;		/* DDNS_INVALID_SOCKET: skipped   */
+	int							events;		/* DDNS_SOCKET_EVENT_XXX to wait  */
+	int							revents;	/* DDNS_SOCKET_EVENT_XXX occurred */
+};
+
+struct ddns_deadline;	/* see "ddns_sync.h" */
+
 
 /*
  *	Initialize socket environment, must be called before calling any of the
@@ -538,7 +570,8 @@ ddns_socket ddns_socket_create(int af, int type, int protocol);
  *
  *	@param[in]	address		: address of remote host, ex.: "www.website.com".
  *	@param[in]	port		: the remote port to connect to.
- *	@param[in]	timeout		: time out in seconds to initiate the connection.
+ *	@param[in]	deadline	: deadline to initiate the connection, NULL for
+ *							  no limit.
  *	@param[in]	stop_wait	: pointer to the exit signal, will stop further
  *							  process when it's set to non-zero.
  *
@@ -550,7 +583,37 @@ ddns_socket ddns_socket_create(int af, int type, int protocol);
 ddns_socket ddns_socket_create_tcp(
 	const char		*	addr,
 	unsigned short		port,
-	int					timeout,
+	const struct ddns_deadline	*	deadline,
+	int				*	stop_wait
+	);
+
+
+/**
+ *	Resolve host name to IPv4 addresses, with the help of a cache shared by
+ *	all threads.
+ *
+ *	@param[in]	addr		: the host name, ex.: "www.website.com".
+ *	@param[out]	addr_list	: buffer to receive the addresses.
+ *	@param[in]	count		: capacity of [addr_list].
+ *	@param[in]	deadline	: deadline to wait for the resolver, NULL to wait
+ *							  until it answers.
+ *	@param[in]	stop_wait	: pointer to the exit signal, will stop waiting
+ *							  when it's set to non-zero.
+ *
+ *	@return	number of addresses written into [addr_list].
+ *
+ *	@note	Addresses are kept for [DDNS_SOCKET_CACHE_TTL] seconds, and a
+ *			failure for [DDNS_SOCKET_CACHE_NEGATIVE_TTL] seconds. A host name
+ *			missing in the cache is resolved on a helper thread, so that the
+ *			caller can give up on timeout or exit signal. The lookup goes on
+ *			and fills the cache, threads asking for the same host name in the
+ *			meantime wait for the same lookup.
+ */
+int ddns_socket_resolve(
+	const char		*	addr,
+	struct in_addr	*	addr_list,
+	int					count,
+	const struct ddns_deadline	*	deadline,
 	int				*	stop_wait
 	);
 
@@ -569,7 +632,8 @@ int ddns_socket_close(ddns_socket sock);
  *	@param[in]	sock		: the socket to initiate the connection.
  *	@param[in]	addr		: target address.
  *	@param[in]	sz			: size of the target address in bytes.
- *	@param[in]	timeout		: time out in seconds to initiate the connection.
+ *	@param[in]	deadline	: deadline to initiate the connection, NULL for
+ *							  no limit.
  *	@param[in]	stop_wait	: pointer to the exit signal, will stop further
  *							  process when it's set to non-zero.
  *
@@ -583,11 +647,55 @@ int ddns_socket_connect(
 	ddns_socket			sock,
 	struct sockaddr	*	addr,
 	socklen_t			sz,
-	int					timeout,
+	const struct ddns_deadline	*	deadline,
 	int				*	stop_wait
 	);
 
 
+/**
+ *	Wait until any of the sockets is ready, or the timeout elapses.
+ *
+ *	@param[in/out]	list	: the sockets and the events to wait for, the
+ *							  occurred events are stored in [revents].
+ *	@param[in]		count	: number of sockets in [list].
+ *	@param[in]		timeout	: timeout in milliseconds, or
+ *							  [DDNS_SOCKET_INFINITE] to wait forever.
+ *
+ *	@return	Return the number of ready sockets, 0 on timeout. Otherwise, a
+ *			value of -1 is returned, use ddns_socket_get_errno to get the
+ *			error code.
+ *
+ *	@note	Unlike [select], it works for sockets of any descriptor value, and
+ *			the cost depends on [count] only. A socket with an error or hung
+ *			up reports the events it waits for along with
+ *			[DDNS_SOCKET_EVENT_ERROR], so the next call on it fails and tells
+ *			the reason.
+ */
+int ddns_socket_poll(
+	struct ddns_socket_event	*	list,
+	int								count,
+	unsigned long					timeout
+	);
+
+
+/**
+ *	Wait until a socket is ready, or the timeout elapses.
+ *
+ *	@param[in]	sock		: the socket to wait for.
+ *	@param[in]	events		: DDNS_SOCKET_EVENT_XXX to wait for.
+ *	@param[in]	timeout		: timeout in milliseconds, or
+ *							  [DDNS_SOCKET_INFINITE] to wait forever.
+ *
+ *	@return	Return the occurred events, 0 on timeout. Otherwise, a value of -1
+ *			is returned, use ddns_socket_get_errno to get the error code.
+ */
+int ddns_socket_wait(
+	ddns_socket			sock,
+	int					events,
+	unsigned long		timeout
+	);
+
+
 /**
  *	Get blocking mode of a socket.
  *
@@ -25,6 +25,23 @@
 
 #include "ddns_sync.h"
 
+#if DDNS_SYNC_UNIX
+#	include <errno.h>		/* errno, EINTR	*/
+#	include <fcntl.h>		/* fcntl		*/
+#	include <unistd.h>		/* pipe, read	*/
+#	include <time.h>		/* clock_gettime	*/
+#	include <sys/time.h>	/* gettimeofday	*/
+#	if !defined(HAVE_CONFIG_H) || (defined(HAVE_POLL_H) && HAVE_POLL_H)
+#		include <poll.h>		/* poll			*/
+#		define DDNS_SYNC_HAVE_POLL	1
+#	else
+#		include <sys/ioctl.h>	/* ioctl, FIONREAD	*/
+#		if !defined(HAVE_CONFIG_H) || (defined(HAVE_SYS_SELECT_H) && HAVE_SYS_SELECT_H)
+#			include <sys/select.h>	/* select	*/
+#		endif
+#	endif
+#endif
+
 /**
  *	Initialize a synchronize object
  *
@@ -181,3 +198,538 @@ int ddns_sync_destroy(
 
 	return status;
 }
+
+
+/**
+ *	Get a millisecond clock for measuring time intervals.
+ *
+ *	@note	The clock is monotonic where the platform supports it, and wraps
+ *			around, so compare the difference of two readings only.
+ *
+ *	@return	Return milliseconds since an unspecified point.
+ */
+unsigned long ddns_sync_clock()
+{
+#if DDNS_SYNC_UNIX
+
+#if defined(CLOCK_MONOTONIC)
+	struct timespec ts;
+
+	if ( 0 == clock_gettime(CLOCK_MONOTONIC, &ts) )
+	{
+		return (unsigned long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+	}
+#endif
+	{
+		struct timeval tv;
+
+		gettimeofday(&tv, NULL);
+		return (unsigned long)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+	}
+
+#elif DDNS_SYNC_WINDOWS
+
+	return (unsigned long)GetTickCount();
+
+#endif
+}
+
+
+/**
+ *	Set a deadline from now on.
+ *
+ *	@param deadline	: the deadline to be set.
+ *	@param budget	: milliseconds from now on, [DDNS_DEADLINE_NEVER] for no
+ *					  deadline.
+ */
+void ddns_deadline_init(
+	struct ddns_deadline	*	deadline,
+	unsigned long				budget )
+{
+	deadline->start		= ddns_sync_clock();
+	deadline->budget	= budget;
+}
+
+
+/**
+ *	Get time left before a deadline.
+ *
+ *	@param deadline	: the deadline, NULL for no deadline.
+ *
+ *	@return	Return milliseconds left, 0 if the deadline has passed, or
+ *			[DDNS_DEADLINE_NEVER] if there's no deadline.
+ */
+unsigned long ddns_deadline_remain(
+	const struct ddns_deadline * deadline )
+{
+	unsigned long remain	= DDNS_DEADLINE_NEVER;
+	unsigned long elapsed	= 0;
+
+	if ( (NULL != deadline) && (DDNS_DEADLINE_NEVER != deadline->budget) )
+	{
+		/* the clock wraps around, only the difference is meaningful */
+		elapsed	= ddns_sync_clock() - deadline->start;
+		remain	= (elapsed < deadline->budget) ? deadline->budget - elapsed : 0;
+	}
+
+	return remain;
+}
+
+
+/**
+ *	Initialize an event, the event is not signaled initially.
+ *
+ *	@param event	: the event to be initialized.
+ *
+ *	@return If successful, it will return zero. Otherwise, an error number will
+ *			be returned to indicate the error.
+ */
+int ddns_sync_event_init(
+	struct ddns_sync_event * event )
+{
+	int status = 0;
+
+#if DDNS_SYNC_UNIX
+
+	int i = 0;
+
+	if ( 0 != pipe(event->native_pipe) )
+	{
+		status = errno;
+		event->native_pipe[0] = -1;
+		event->native_pipe[1] = -1;
+	}
+
+	/**
+	 *	Both ends are non-blocking: a full pipe means the event is already
+	 *	set, and draining an empty pipe must not block.
+	 */
+	for ( i = 0; (0 == status) && (i < 2); ++i )
+	{
+		int flags = fcntl(event->native_pipe[i], F_GETFL);
+
+		if (	(-1 == flags)
+			||	(-1 == fcntl(event->native_pipe[i], F_SETFL, flags | O_NONBLOCK))
+			||	(-1 == fcntl(event->native_pipe[i], F_SETFD, FD_CLOEXEC)) )
+		{
+			status = errno;
+		}
+	}
+
+	if ( (0 != status) && (-1 != event->native_pipe[0]) )
+	{
+		close(event->native_pipe[0]);
+		close(event->native_pipe[1]);
+		event->native_pipe[0] = -1;
+		event->native_pipe[1] = -1;
+	}
+
+#elif DDNS_SYNC_WINDOWS
+
+	event->native_event = CreateEvent(NULL, TRUE, FALSE, NULL);
+	if ( NULL == event->native_event )
+	{
+		status = (int)GetLastError();
+	}
+
+#endif
+
+	return status;
+}
+
+
+/**
+ *	Set an event to signaled state, and wake up all threads waiting for it.
+ *
+ *	@param event	: the event to be set.
+ *
+ *	@note	It's safe to call it from a signal handler.
+ *
+ *	@return If successful, it will return zero. Otherwise, an error number will
+ *			be returned to indicate the error.
+ */
+int ddns_sync_event_set(
+	struct ddns_sync_event * event )
+{
+	int status = 0;
+
+#if DDNS_SYNC_UNIX
+
+	/* only async-signal-safe calls here, and keep [errno] intact */
+	int		saved_errno	= errno;
+	char	signaled	= 1;
+
+	if (	(-1 == write(event->native_pipe[1], &signaled, 1))
+		&&	(EAGAIN != errno) )
+	{
+		status = errno;
+	}
+
+	errno = saved_errno;
+
+#elif DDNS_SYNC_WINDOWS
+
+	if ( FALSE == SetEvent(event->native_event) )
+	{
+		status = (int)GetLastError();
+	}
+
+#endif
+
+	return status;
+}
+
+
+/**
+ *	Reset an event to non-signaled state.
+ *
+ *	@param event	: the event to be reset.
+ *
+ *	@return If successful, it will return zero. Otherwise, an error number will
+ *			be returned to indicate the error.
+ */
+int ddns_sync_event_reset(
+	struct ddns_sync_event * event )
+{
+	int status = 0;
+
+#if DDNS_SYNC_UNIX
+
+	char buffer[64];
+
+	while ( read(event->native_pipe[0], buffer, sizeof(buffer)) > 0 )
+	{
+		/* drain the pipe */
+	}
+
+#elif DDNS_SYNC_WINDOWS
+
+	if ( FALSE == ResetEvent(event->native_event) )
+	{
+		status = (int)GetLastError();
+	}
+
+#endif
+
+	return status;
+}
+
+
+/**
+ *	Wait until an event is signaled, or the timeout elapses.
+ *
+ *	@param event	: the event to wait for.
+ *	@param timeout	: timeout in milliseconds.
+ *
+ *	@return Return non-zero if the event is signaled, otherwise return 0.
+ */
+int ddns_sync_event_wait(
+	struct ddns_sync_event	*	event,
+	unsigned long				timeout )
+{
+	int signaled = 0;
+
+#if DDNS_SYNC_UNIX
+
+	unsigned long start = ddns_sync_clock();
+
+	while ( 1 )
+	{
+		unsigned long	elapsed = ddns_sync_clock() - start;
+		unsigned long	remain	= 0;
+		int				count;
+#if DDNS_SYNC_HAVE_POLL
+		struct pollfd	fd;
+#else
+		fd_set			fd_read;
+		struct timeval	tv;
+		int				fd		= event->native_pipe[0];
+		int				pending	= 0;
+#endif
+
+		if ( elapsed > timeout )
+		{
+			elapsed = timeout;
+		}
+		remain = timeout - elapsed;
+
+		/* [poll] takes an int, a longer wait is done in pieces */
+		if ( remain > 0x7FFFFFFFUL )
+		{
+			remain = 0x7FFFFFFFUL;
+		}
+
+#if DDNS_SYNC_HAVE_POLL
+
+		/* without a pipe (failed to initialize), it's a plain sleep: a
+		 * negative descriptor is ignored by [poll] */
+		fd.fd		= event->native_pipe[0];
+		fd.events	= POLLIN;
+		fd.revents	= 0;
+
+		count = poll(&fd, 1, (int)remain);
+
+#else	/* ! DDNS_SYNC_HAVE_POLL */
+
+		/**
+		 *	A pipe out of the range of [fd_set] can't be selected, it's
+		 *	checked for pending bytes every 100ms instead.
+		 */
+		FD_ZERO(&fd_read);
+		if ( (fd >= 0) && (fd < FD_SETSIZE) )
+		{
+			FD_SET(fd, &fd_read);
+		}
+		else if ( fd >= 0 )
+		{
+			if ( (0 == ioctl(fd, FIONREAD, &pending)) && (pending > 0) )
+			{
+				signaled = 1;
+				break;
+			}
+			if ( remain > 100 )
+			{
+				remain = 100;
+			}
+		}
+
+		tv.tv_sec	= (long)(remain / 1000);
+		tv.tv_usec	= (long)(remain % 1000) * 1000;
+		count = select(	(fd >= 0) && (fd < FD_SETSIZE) ? fd + 1 : 0,
+						&fd_read,
+						NULL,
+						NULL,
+						&tv
+						);
+
+#endif	/* DDNS_SYNC_HAVE_POLL */
+
+		if ( count > 0 )
+		{
+			signaled = 1;
+			break;
+		}
+		else if ( (0 == count) && (timeout - elapsed == remain) )
+		{
+			break;
+		}
+		else if ( (count < 0) && (EINTR != errno) )
+		{
+			break;
+		}
+		/* interrupted by a signal, wait for the rest of the time */
+	}
+
+#elif DDNS_SYNC_WINDOWS
+
+	if ( WAIT_OBJECT_0 == WaitForSingleObject(event->native_event, timeout) )
+	{
+		signaled = 1;
+	}
+
+#endif
+
+	return signaled;
+}
+
+
+/**
+ *	Get a file descriptor that becomes readable when an event is set, so the
+ *	event can be waited along with sockets in [ddns_socket_poll].
+ *
+ *	@param event	: the event.
+ *
+ *	@return Return the file descriptor, or -1 if it's not supported on the
+ *			platform.
+ */
+int ddns_sync_event_fd(
+	struct ddns_sync_event * event )
+{
+#if DDNS_SYNC_UNIX
+
+	return event->native_pipe[0];
+
+#elif DDNS_SYNC_WINDOWS
+
+	/* an event object can't be waited along with sockets */
+	(void)event;
+	return -1;
+
+#endif
+}
+
+
+/**
+ *	Free resources allocated for an event.
+ *
+ *	@param event	: the event to be freed.
+ *
+ *	@return If successful, it will return zero. Otherwise, an error number will
+ *			be returned to indicate the error.
+ */
+int ddns_sync_event_destroy(
+	struct ddns_sync_event * event )
+{
+	int status = 0;
+
+#if DDNS_SYNC_UNIX
+
+	if ( -1 != event->native_pipe[0] )
+	{
+		close(event->native_pipe[0]);
+		close(event->native_pipe[1]);
+		event->native_pipe[0] = -1;
+		event->native_pipe[1] = -1;
+	}
+
+#elif DDNS_SYNC_WINDOWS
+
+	if ( NULL != event->native_event )
+	{
+		CloseHandle(event->native_event);
+		event->native_event = NULL;
+	}
+
+#endif
+
+	return status;
+}
+
+
+#if DDNS_SYNC_UNIX
+/**
+ *	Native entry of threads created by [ddns_sync_thread_create].
+ */
+static void * ddns_sync_thread_main(void * param)
+{
+	struct ddns_sync_thread * thread = (struct ddns_sync_thread*)param;
+
+	thread->routine(thread->param);
+
+	return NULL;
+}
+#elif DDNS_SYNC_WINDOWS
+/**
+ *	Native entry of threads created by [ddns_sync_thread_create].
+ */
+static DWORD WINAPI ddns_sync_thread_main(LPVOID param)
+{
+	struct ddns_sync_thread * thread = (struct ddns_sync_thread*)param;
+
+	thread->routine(thread->param);
+
+	return 0;
+}
+#endif
+
+
+/**
+ *	Create a thread.
+ *
+ *	@param thread	: the thread to be created.
+ *	@param routine	: entry of the thread.
+ *	@param param	: parameter to be passed to [routine].
+ *
+ *	@return If successful, it will return zero. Otherwise, an error number will
+ *			be returned to indicate the error.
+ */
+int ddns_sync_thread_create(
+	struct ddns_sync_thread	*	thread,
+	ddns_sync_routine			routine,
+	void					*	param )
+{
+	int status = 0;
+
+	thread->routine	= routine;
+	thread->param	= param;
+
+#if DDNS_SYNC_UNIX
+
+	status = pthread_create(&(thread->native_thread),
+							NULL,
+							&ddns_sync_thread_main,
+							thread
+							);
+
+#elif DDNS_SYNC_WINDOWS
+
+	thread->native_thread = CreateThread(	NULL,
+											0,
+											&ddns_sync_thread_main,
+											thread,
+											0,
+											NULL
+											);
+	if ( NULL == thread->native_thread )
+	{
+		status = (int)GetLastError();
+	}
+
+#endif
+
+	return status;
+}
+
+
+/**
+ *	Wait until a thread exits, and free resources allocated for it.
+ *
+ *	@param thread	: the thread to wait for.
+ *
+ *	@return If successful, it will return zero. Otherwise, an error number will
+ *			be returned to indicate the error.
+ */
+int ddns_sync_thread_join(
+	struct ddns_sync_thread * thread )
+{
+	int status = 0;
+
+#if DDNS_SYNC_UNIX
+
+	status = pthread_join(thread->native_thread, NULL);
+
+#elif DDNS_SYNC_WINDOWS
+
+	if ( WAIT_OBJECT_0 != WaitForSingleObject(thread->native_thread, INFINITE) )
+	{
+		status = (int)GetLastError();
+	}
+	CloseHandle(thread->native_thread);
+	thread->native_thread = NULL;
+
+#endif
+
+	return status;
+}
+
+
+/**
+ *	Let a thread go on its own, its resources are freed once it exits. The
+ *	thread can't be joined any more.
+ *
+ *	@param thread	: the thread to detach, it may be freed by the thread
+ *					  itself after this call.
+ *
+ *	@return If successful, it will return zero. Otherwise, an error number will
+ *			be returned to indicate the error.
+ */
+int ddns_sync_thread_detach(
+	struct ddns_sync_thread * thread )
+{
+	int status = 0;
+
+#if DDNS_SYNC_UNIX
+
+	status = pthread_detach(thread->native_thread);
+
+#elif DDNS_SYNC_WINDOWS
+
+	if ( !CloseHandle(thread->native_thread) )
+	{
+		status = (int)GetLastError();
+	}
+
+#endif
+
+	return status;
+}
@@ -63,6 +63,49 @@ struct ddns_sync_object
 #endif
 };
 
+/**
+ *	Entry of a thread created by [ddns_sync_thread_create].
+ */
+typedef void (*ddns_sync_routine)(void * param);
+
+/**
+ *	A thread, see [ddns_sync_thread_create].
+ */
+struct ddns_sync_thread
+{
+#if DDNS_SYNC_UNIX
+	pthread_t			native_thread;
+#elif DDNS_SYNC_WINDOWS
+	HANDLE				native_thread;
+#endif
+	ddns_sync_routine	routine;
+	void			*	param;
+};
+
+/**
+ *	A deadline by [ddns_sync_clock], see [ddns_deadline_init].
+ */
+struct ddns_deadline
+{
+	unsigned long		start;		/* [ddns_sync_clock] when it's set  */
+	unsigned long		budget;		/* milliseconds since [start]       */
+};
+
+#define DDNS_DEADLINE_NEVER		((unsigned long)-1)
+
+/**
+ *	A manual-reset event, once set, it stays signaled until it's reset.
+ */
+struct ddns_sync_event
+{
+#if DDNS_SYNC_UNIX
+	/* self-pipe, so that the event can be set from a signal handler */
+	int					native_pipe[2];
+#elif DDNS_SYNC_WINDOWS
+	HANDLE				native_event;
+#endif
+};
+
 /**
  *	Initialize a synchronize object
  *
@@ -128,6 +171,170 @@ int ddns_sync_destroy(
 	);
 
 
+/**
+ *	Get a millisecond clock for measuring time intervals.
+ *
+ *	@note	The clock is monotonic where the platform supports it, and wraps
+ *			around, so compare the difference of two readings only.
+ *
+ *	@return	Return milliseconds since an unspecified point.
+ */
+unsigned long ddns_sync_clock();
+
+
+/**
+ *	Set a deadline from now on.
+ *
+ *	@param deadline	: the deadline to be set.
+ *	@param budget	: milliseconds from now on, [DDNS_DEADLINE_NEVER] for no
+ *					  deadline.
+ */
+void ddns_deadline_init(
+	struct ddns_deadline	*	deadline,
+	unsigned long				budget
+	);
+
+
+/**
+ *	Get time left before a deadline.
+ *
+ *	@param deadline	: the deadline, NULL for no deadline.
+ *
+ *	@return	Return milliseconds left, 0 if the deadline has passed, or
+ *			[DDNS_DEADLINE_NEVER] if there's no deadline.
+ */
+unsigned long ddns_deadline_remain(
+	const struct ddns_deadline * deadline
+	);
+
+
+/**
+ *	Initialize an event, the event is not signaled initially.
+ *
+ *	@param event	: the event to be initialized.
+ *
+ *	@return If successful, it will return zero. Otherwise, an error number will
+ *			be returned to indicate the error.
+ */
+int ddns_sync_event_init(
+	struct ddns_sync_event * event
+	);
+
+
+/**
+ *	Set an event to signaled state, and wake up all threads waiting for it.
+ *
+ *	@param event	: the event to be set.
+ *
+ *	@note	It's safe to call it from a signal handler.
+ *
+ *	@return If successful, it will return zero. Otherwise, an error number will
+ *			be returned to indicate the error.
+ */
+int ddns_sync_event_set(
+	struct ddns_sync_event * event
+	);
+
+
+/**
+ *	Reset an event to non-signaled state.
+ *
+ *	@param event	: the event to be reset.
+ *
+ *	@return If successful, it will return zero. Otherwise, an error number will
+ *			be returned to indicate the error.
+ */
+int ddns_sync_event_reset(
+	struct ddns_sync_event * event
+	);
+
+
+/**
+ *	Wait until an event is signaled, or the timeout elapses.
+ *
+ *	@param event	: the event to wait for.
+ *	@param timeout	: timeout in milliseconds.
+ *
+ *	@return Return non-zero if the event is signaled, otherwise return 0.
+ */
+int ddns_sync_event_wait(
+	struct ddns_sync_event	*	event,
+	unsigned long				timeout
+	);
+
+
+/**
+ *	Get a file descriptor that becomes readable when an event is set, so the
+ *	event can be waited along with sockets in [ddns_socket_poll].
+ *
+ *	@param event	: the event.
+ *
+ *	@return Return the file descriptor, or -1 if it's not supported on the
+ *			platform.
+ */
+int ddns_sync_event_fd(
+	struct ddns_sync_event * event
+	);
+
+
+/**
+ *	Free resources allocated for an event.
+ *
+ *	@param event	: the event to be freed.
+ *
+ *	@return If successful, it will return zero. Otherwise, an error number will
+ *			be returned to indicate the error.
+ */
+int ddns_sync_event_destroy(
+	struct ddns_sync_event * event
+	);
+
+
+/**
+ *	Create a thread.
+ *
+ *	@param thread	: the thread to be created.
+ *	@param routine	: entry of the thread.
+ *	@param param	: parameter to be passed to [routine].
+ *
+ *	@return If successful, it will return zero. Otherwise, an error number will
+ *			be returned to indicate the error.
+ */
+int ddns_sync_thread_create(
+	struct ddns_sync_thread	*	thread,
+	ddns_sync_routine			routine,
+	void					*	param
+	);
+
+
+/**
+ *	Wait until a thread exits, and free resources allocated for it.
+ *
+ *	@param thread	: the thread to wait for.
+ *
+ *	@return If successful, it will return zero. Otherwise, an error number will
+ *			be returned to indicate the error.
+ */
+int ddns_sync_thread_join(
+	struct ddns_sync_thread * thread
+	);
+
+
+/**
+ *	Let a thread go on its own, its resources are freed once it exits. The
+ *	thread can't be joined any more.
+ *
+ *	@param thread	: the thread to detach, it may be freed by the thread
+ *					  itself after this call.
+ *
+ *	@return If successful, it will return zero. Otherwise, an error number will
+ *			be returned to indicate the error.
+ */
+int ddns_sync_thread_detach(
+	struct ddns_sync_thread * thread
+	);
+
+
 #ifdef __cplusplus
 }	/* extern "C" */
 #endif
@@ -31,6 +31,8 @@
 #include <stdlib.h>		/* malloc		  */
 #include <string.h>		/* memset, strlen */
 #include <assert.h>		/* assert		  */
+#include <ctype.h>		/* tolower		  */
+#include <time.h>		/* time			  */
 #include "json.h"
 #include "http.h"
 #include "ddns_string.h"
@@ -49,9 +51,30 @@
 #	define DNSPOD_USE_IP138		3
 #endif
 
+/* Number of servers queried at the same time for the IP address, 1: no race */
+#ifndef DNSPOD_GETIP_RACE
+#	define DNSPOD_GETIP_RACE	2
+#endif
+/* Number of the same answers required to win a race */
+#ifndef DNSPOD_GETIP_QUORUM
+#	define DNSPOD_GETIP_QUORUM	1
+#endif
+
+/* Maximum number of servers for getting IP address */
+#define DNSPOD_GETIP_MAX_SERVER	3
+
 /* Maximum length of URL */
 #define DNSPOD_MAX_URL_LENGTH	1024
 
+/* Signature & format version of the state file, see [dnspod_state_save] */
+#define DNSPOD_STATE_MAGIC		0x54534E44	/* "DNST" */
+#define DNSPOD_STATE_VERSION	1
+
+/* Seconds a saved state is trusted after its lists are got from server */
+#ifndef DNSPOD_STATE_MAX_AGE
+#	define DNSPOD_STATE_MAX_AGE	86400
+#endif
+
 /* User-Agent to be used in contacting with server. */
 #define DNSPOD_USER_AGENT		"ddns-r%s (github.com/NeverMin/ddns/issues)"
 
@@ -127,18 +150,53 @@ const ddns_ulong32	DNSPOD_MAX_API_VERSION	= DNSPOD_API_VERSION_4_6;
  *	Declaration of Local Types & Functions
  *============================================================================*/
 struct dnspod_context;
-struct dnspod_buffer;
+struct dnspod_index;
+struct dnspod_index_entry;
+struct dnspod_record_stream;
 struct dnspod_line_table_record;
 struct dnspod_getip_table_entry;
+struct dnspod_getip_rule;
+struct dnspod_getip_matcher;
+struct dnspod_getip_stream;
+struct dnspod_getip_stats;
+struct dnspod_getip_racer;
+struct dnspod_getip_race;
+struct dnspod_update_job;
+struct dnspod_state_header;
+struct dnspod_state_domain;
+struct dnspod_state_record;
 
 /**
- * Prototype of functions used to get IP address.
+ *	Case-insensitive hash index over a domain list or a DNS record list. Slots
+ *	are resolved by linear probing, and the table is never more than half full.
  */
-typedef ddns_error (*DNSPOD_GETIP)(
-	struct dnspod_buffer	*	server_buffer,
-	char					*	text_buffer,
-	int							buffer_size
-	);
+struct dnspod_index
+{
+	unsigned long					capacity;	/* power of 2, 0 if not built */
+	struct dnspod_index_entry	*	entries;
+};
+
+/**
+ *	Slot of [dnspod_index], [item] is NULL if the slot is empty.
+ */
+struct dnspod_index_entry
+{
+	unsigned long					hash;
+	unsigned long					order;		/* position in the list */
+	const void					*	item;
+};
+
+/**
+ *	Statistics of a server for getting IP address, servers of less cost are
+ *	queried first, see [dnspod_get_ip_address].
+ */
+struct dnspod_getip_stats
+{
+	unsigned long					attempts;	/* finished queries           */
+	unsigned long					failures;	/* queries without an answer  */
+	unsigned long					latency;	/* moving average, in ms      */
+	unsigned long					samples;	/* samples of [latency]       */
+};
 
 /**
  *	Structure to keep DNSPod specific information in DDNS context.
@@ -148,6 +206,11 @@ struct dnspod_context
 	char							ip_address[16];
 	ddns_ulong32					api_version;
 	struct dnspod_domain		*	domain_list;
+	struct dnspod_index				domain_index;	/* over [domain_list] */
+	struct dnspod_getip_stats		getip_stats[DNSPOD_GETIP_MAX_SERVER];
+	struct dnspod_getip_matcher	*	getip_matcher;	/* signatures of
+													   [dnspod_getip_table] */
+	ddns_ulong32					state_time;		/* see [dnspod_state_save] */
 };
 
 /**
@@ -159,6 +222,7 @@ struct dnspod_domain
 	char							domain[256];
 	int								min_ttl;		/* minimum allowed TTL */
 	struct dnspod_record		*	records;
+	struct dnspod_index				record_index;	/* over [records] */
 	struct dnspod_domain		*	next;
 };
 
@@ -180,13 +244,40 @@ struct dnspod_record
 };
 
 /**
- *	HTTP response buffer.
+ *	Members of a record object in [DNSPOD_RECORD_LIST] response.
+ */
+enum dnspod_record_field
+{
+	DNSPOD_FIELD_ID			= 0x0001,
+	DNSPOD_FIELD_NAME		= 0x0002,
+	DNSPOD_FIELD_LINE		= 0x0004,
+	DNSPOD_FIELD_TYPE		= 0x0008,
+	DNSPOD_FIELD_TTL		= 0x0010,
+	DNSPOD_FIELD_VALUE		= 0x0020,
+	DNSPOD_FIELD_MX			= 0x0040,
+	DNSPOD_FIELD_ENABLED	= 0x0080,
+	DNSPOD_FIELD_UPDATED_ON	= 0x0100,
+	DNSPOD_FIELD_ALL		= 0x01FF
+};
+
+/**
+ *	State of parsing [DNSPOD_RECORD_LIST] response as json events.
  */
-struct dnspod_buffer
+struct dnspod_record_stream
 {
-	char			*	buffer;
-	unsigned int		used;
-	unsigned int		size;
+	const struct ddns_context	*	context;
+	ddns_ulong32					api_version;
+	int								depth;		/* current json depth		 */
+	int								list_depth;	/* depth of records array	 */
+	int								has_list;	/* records are found		 */
+	char							section[16];/* member of the root object */
+	char							key[16];	/* current member name		 */
+	char							code[16];	/* value of "status.code"	 */
+	unsigned int					fields;		/* fields got for the record */
+	struct dnspod_record		*	record;		/* record being parsed		 */
+	struct dnspod_record		*	list;		/* the parsed records		 */
+	struct dnspod_record		**	tail;		/* end of [list]			 */
+	ddns_error						error_code;
 };
 
 /**
@@ -207,7 +298,131 @@ struct dnspod_getip_table_entry
 	const char					*	name;
 	const char					*	url;
 	ddns_long32						priority;
-	DNSPOD_GETIP					func;
+	const struct dnspod_getip_rule*	rules;		/* NULL for the interface     */
+	struct dnspod_getip_stats	*	stats;		/* may be NULL                */
+	unsigned long					cost;		/* expected latency, by stats */
+	const struct dnspod_getip_matcher*	matcher;	/* shared by all servers  */
+};
+
+/**
+ *	A rule to scrape a token from the page of a server for getting IP address,
+ *	the token follows [signature] and ends before any of [terminator].
+ */
+struct dnspod_getip_rule
+{
+	const char					*	signature;	/* "": the page starts with it */
+	const char					*	terminator;
+	const char					*	base;		/* NULL: the token is the IP
+												   address, otherwise it's
+												   the URL to redirect to,
+												   relative to [base]         */
+};
+
+/**
+ *	Signatures of all servers for getting IP address, searched in one pass.
+ */
+struct dnspod_getip_matcher
+{
+	struct ddns_matcher					matcher;
+	const struct dnspod_getip_rule	*	rules[DDNS_MATCHER_MAX_PATTERN];
+};
+
+/**
+ *	State of scraping a page as it arrives, see [dnspod_getip_stream_read].
+ */
+struct dnspod_getip_stream
+{
+	struct http_request				*	request;	/* stopped once answered   */
+	const struct dnspod_getip_matcher*	matcher;
+	const struct dnspod_getip_rule	*	rules;		/* rules of the page       */
+	const struct dnspod_getip_rule	*	rule;		/* rule of [token], or NULL */
+	unsigned int						state;		/* state of [matcher]      */
+	unsigned int						length;		/* length of [token]       */
+	ddns_error							error_code;	/* DDNS_ERROR_PENDING until
+													   the page is answered    */
+	char								token[DNSPOD_MAX_URL_LENGTH];
+};
+
+/**
+ *	A server queried by [dnspod_get_ip_address_race].
+ */
+struct dnspod_getip_racer
+{
+	struct dnspod_getip_race				*	race;
+	const struct dnspod_getip_table_entry	*	entry;
+	struct ddns_sync_thread						thread;
+	ddns_error									error_code;
+	int											cancelled;	/* lost the race  */
+	ddns_ulong32								latency;	/* in ms          */
+	char										address[16];
+};
+
+/**
+ *	Servers queried at the same time by [dnspod_get_ip_address_race].
+ */
+struct dnspod_getip_race
+{
+	struct ddns_context			*	context;
+	struct dnspod_getip_racer		racers[DNSPOD_GETIP_RACE];
+	int								racer_cnt;
+	int								quorum;			/* answers needed to win  */
+	int								stop;			/* set once it's answered */
+	char							address[16];	/* the answer             */
+	struct ddns_sync_object			sync_object;	/* guards the race        */
+};
+
+/**
+ *	Hosts shared by workers of [dnspod_interface_update_all].
+ */
+struct dnspod_update_job
+{
+	struct ddns_context			*	context;
+	struct dnspod_domain		*	domain_list;
+	const char					*	address;
+	const struct ddns_server	**	hosts;			/* requested hosts         */
+	ddns_error					*	results;		/* result of each host     */
+	unsigned int					host_cnt;
+	unsigned int					next_host;		/* next host to be updated */
+	struct ddns_sync_object			sync_object;	/* guards [next_host]      */
+};
+
+/**
+ *	Header of the state file. It's followed by [domain_cnt] domains, and
+ *	each domain is followed by its A records.
+ */
+struct dnspod_state_header
+{
+	ddns_ulong32					magic;			/* [DNSPOD_STATE_MAGIC]    */
+	ddns_ulong32					version;		/* [DNSPOD_STATE_VERSION]  */
+	ddns_ulong32					fetched;		/* lists got from server   */
+	ddns_ulong32					api_version;
+	ddns_ulong32					domain_cnt;
+	char							username[32];
+	char							ip_address[16];	/* last known IP address   */
+};
+
+/**
+ *	A domain in the state file.
+ */
+struct dnspod_state_domain
+{
+	ddns_ulong32					domain_id;
+	ddns_long32						min_ttl;
+	ddns_ulong32					record_cnt;
+	char							domain[256];
+};
+
+/**
+ *	An A record in the state file.
+ */
+struct dnspod_state_record
+{
+	ddns_ulong32					host_id;
+	ddns_ulong32					line;
+	ddns_ulong32					ttl;
+	ddns_ulong32					enabled;
+	char							name[128];
+	char							value[16];
 };
 
 /**
@@ -297,10 +512,13 @@ static ddns_error dnspod_interface_destroy(ddns_interface* interface);
  *				requested address with the address on server. If the 2 addresses
  *				are the same, it'll ignore the request and return 0.
  *
+ *	@note		Up to [parallel] of the context records are updated at the same
+ *				time, and every record is tried even if some of them failed.
+ *
  *	@note		It's safe to pass [NULL] to [update_cnt].
  *
  *	@return		Return [DNSPOD_ERROR_SUCCESS] if update of all DNS records are
- *				successful, otherwise return an error code.
+ *				successful, otherwise return the error of the first failed one.
  */
 static ddns_error dnspod_interface_update_all(
 	struct ddns_context		*	context,
@@ -310,6 +528,60 @@ static ddns_error dnspod_interface_update_all(
 	);
 
 
+/**
+ *	Get records of every domain that a requested host belongs to, so workers of
+ *	[dnspod_interface_update_all] never load them at the same time.
+ *
+ *	@param[in/out]	job			: the update job, hosts whose domain can't be
+ *								  loaded are marked as failed.
+ */
+static void dnspod_update_prepare(
+	struct dnspod_update_job	*	job
+	);
+
+
+/**
+ *	Worker of [dnspod_interface_update_all], it keeps updating the next pending
+ *	host of the job until all of them are done.
+ *
+ *	@param[in/out]	param		: the [dnspod_update_job].
+ */
+static void dnspod_update_worker(
+	void					*	param
+	);
+
+
+/**
+ *	Load domains & records of the requested hosts saved by a previous run.
+ *
+ *	@param[in/out]	context		: the DDNS context, its domain list and API
+ *								  version are set if the state is loaded.
+ *
+ *	@note		The state is ignored if it's saved for another account, or
+ *				older than [DNSPOD_STATE_MAX_AGE], or any requested host
+ *				isn't found in it.
+ *
+ *	@return		Return non-zero if the state is loaded, otherwise 0.
+ */
+static int dnspod_state_load(
+	struct ddns_context		*	context
+	);
+
+
+/**
+ *	Save domains & records of the requested hosts, so that the next run can
+ *	update the changed records without listing them again.
+ *
+ *	@param[in]	context		: the DDNS context.
+ *
+ *	@note		The file is written aside and renamed, so it's never seen
+ *				half written.
+ */
+static void dnspod_state_save(
+	struct ddns_context		*	context
+	);
+
+
 /**
  *	Get all A records in the domains and fill them to DDNS context.
  *
@@ -378,22 +650,132 @@ static ddns_error dnspod_send_command(
 
 
 /**
- *	HTTP callback function, it will be called for each received byte and
- *	transfer to byte to json parser.
+ *	Send a command to DNSPod server, and feed the response into the given
+ *	json parse context.
+ *
+ *	@param[in]	context :	the DDNS context
+ *	@param[in]	url		:	the target URL to send the command
+ *	@param[in]	cmd		:	the command to be sent to server
+ *	@param[in]	json_ctx:	the json parse context to receive the response,
+ *							it may be an event driven one.
+ *
+ *	@return		Return [DNSPOD_ERROR_SUCCESS] if the command is successfully
+ *				sent to server and a complete json expression is returned.
+ *				Otherwise a error code will be returned.
+ */
+static ddns_error dnspod_send_command_ex(
+	const struct ddns_context	*	context,
+	const char					*	url,
+	const char					*	cmd,
+	struct json_context			*	json_ctx
+	);
+
+
+/**
+ *	Json event handler which builds the record list from the response of
+ *	[DNSPOD_RECORD_LIST] command, without building the json_value objects.
+ */
+static int dnspod_record_stream_callback(
+	enum json_event_type			event,
+	struct json_value			*	value,
+	struct dnspod_record_stream	*	stream
+	);
+
+
+/**
+ *	HTTP callback function, it will be called for each received block and
+ *	transfer the bytes to json parser.
  */
 static void dnspod_http2json(
-	char						chr,
+	const char				*	data,
+	size_t						size,
 	struct json_context		*	context
 	);
 
 
 /**
- *	HTTP callback function, it will be called for each received byte and
- *	keep the received bytes.
+ *	Calculate case-insensitive hash value of a name.
+ *
+ *	@param[in]	type	: record type mixed into the hash, 0 for domains.
+ *	@param[in]	name	: the name to be hashed.
+ *
+ *	@return		Return the 32-bit FNV-1a hash of the lower-cased name.
+ */
+static unsigned long dnspod_hash(
+	int							type,
+	const char				*	name
+	);
+
+
+/**
+ *	Allocate an empty index large enough for [count] items.
+ *
+ *	@param[out]	index	: the index to be allocated, previous content of the
+ *						  index is freed.
+ *	@param[in]	count	: number of items to be indexed.
+ *
+ *	@return		Return non-zero on success, otherwise 0 will be returned and
+ *				the index is left empty.
+ */
+static int dnspod_index_create(
+	struct dnspod_index		*	index,
+	unsigned long				count
+	);
+
+
+/**
+ *	Free resources allocated for an index.
+ *
+ *	@param[in]	index	: the index to be freed.
+ */
+static void dnspod_index_destroy(struct dnspod_index * index);
+
+
+/**
+ *	Build index over a domain list, keyed by the case-folded domain name.
+ *
+ *	@param[out]	index	: the index to be built.
+ *	@param[in]	list	: the domain list.
+ *
+ *	@note		If a domain appears more than once, the first one wins, which
+ *				is what a linear search of the list finds.
+ */
+static void dnspod_index_domains(
+	struct dnspod_index			*	index,
+	const struct dnspod_domain	*	list
+	);
+
+
+/**
+ *	Build index over a DNS record list, keyed by record type and the
+ *	case-folded host name.
+ *
+ *	@param[out]	index	: the index to be built.
+ *	@param[in]	list	: the DNS record list.
+ *
+ *	@note		If several records share the same type and name (e.g. the
+ *				same host on different lines), the first one wins, which is
+ *				what a linear search of the list finds.
+ */
+static void dnspod_index_records(
+	struct dnspod_index			*	index,
+	const struct dnspod_record	*	list
+	);
+
+
+/**
+ *	Look up a DNS record in the record index.
+ *
+ *	@param[in]	index		: the record index.
+ *	@param[in]	record_type : type of the record searching for.
+ *	@param[in]	host_name	: the host name searching for.
+ *
+ *	@return		Return the index slot of the record, or NULL if not found.
  */
-static void dnspod_http2buffer(
-	char						chr,
-	struct dnspod_buffer	*	buffer
+static const struct dnspod_index_entry * dnspod_index_find_record(
+	const struct dnspod_index	*	index,
+	enum dnspod_record_type			record_type,
+	const char					*	host_name
 	);
 
 
@@ -401,6 +783,8 @@ static void dnspod_http2buffer(
  *	Get domain information from the domain name list.
  *
  *	@param[in]	domain_list :	domain name list
+ *	@param[in]	index		:	index over [domain_list], it's safe to pass
+ *								NULL if the list isn't indexed.
  *	@param[in]	domain_name :	the domain name to be searched
  *
  *	@note		Ex.: [domain_name] = "www.website.com", it will search for
@@ -411,6 +795,7 @@ static void dnspod_http2buffer(
  */
 static const struct dnspod_domain * dnspod_find_domain(
 	const struct dnspod_domain	*	domain_list,
+	const struct dnspod_index	*	index,
 	const char					*	domain_name
 	);
 
@@ -419,6 +804,8 @@ static const struct dnspod_domain * dnspod_find_domain(
  *	Get DNS record information from the DNS record list.
  *
  *	@param[in]	host_list	:	domain name list
+ *	@param[in]	index		:	index over [host_list], it's safe to pass NULL
+ *								if the list isn't indexed.
  *	@param[in]	record_type :	type of the record searching for.
  *	@param[in]	domain_name :	the domain name to be searched for.
  *
@@ -430,6 +817,7 @@ static const struct dnspod_domain * dnspod_find_domain(
  */
 static const struct dnspod_record * dnspod_find_record(
 	const struct dnspod_record	*	host_list,
+	const struct dnspod_index	*	index,
 	enum dnspod_record_type			record_type,
 	const char					*	domain_name
 	);
@@ -454,38 +842,130 @@ static ddns_error dnspod_get_ip_address(
 	);
 
 /**
- *	Parse server response when getting IP address from server.
+ *	Query several servers at the same time for the internet IP address of
+ *	local computer, the first [DNSPOD_GETIP_QUORUM] agreeing answers win and
+ *	the other queries are cancelled. Statistics of the servers are updated.
  *
- *	@param[in/out]	server_buffer	: server response
- *	@param[out]		text_buffer		: parsed ip address
- *	@param[in]		buffer_size		: size of text_buffer in bytes
+ *	@param[in]	context		: the DDNS context.
+ *	@param[in]	entries		: the servers to query.
+ *	@param[in]	entry_cnt	: number of servers in [entries].
+ *	@param[out] text_buffer : buffer to save the IP address.
+ *	@param[in]	buffer_size : size of the buffer.
+ *
+ *	@return		Return [DNSPOD_ERROR_SUCCESS] if successfully get the internet
+ *				IP address, otherwise return the error of the first server.
+ */
+static ddns_error dnspod_get_ip_address_race(
+	struct ddns_context						*	context,
+	const struct dnspod_getip_table_entry	*	entries,
+	int											entry_cnt,
+	char									*	text_buffer,
+	int											buffer_size
+	);
+
+/**
+ *	Worker of [dnspod_get_ip_address_race], it queries one server.
+ *
+ *	@param[in/out]	param		: the [dnspod_getip_racer].
+ */
+static void dnspod_get_ip_address_racer(
+	void					*	param
+	);
+
+/**
+ *	Decide a race of [dnspod_get_ip_address_race] once an answer is agreed by
+ *	[quorum] of the servers. The race must be locked by the caller.
+ *
+ *	@param[in/out]	race		: the [dnspod_getip_race].
+ */
+static void dnspod_get_ip_address_judge(
+	struct dnspod_getip_race	*	race
+	);
+
+/**
+ *	Get internet IP address of local computer from one server.
+ *
+ *	@param[in]	context		: the DDNS context.
+ *	@param[in]	entry		: the server to query, if its URL is NULL, the
+ *							  network interface of [context] is read.
+ *	@param[out] text_buffer : buffer to save the IP address.
+ *	@param[in]	buffer_size : size of the buffer.
+ *	@param[in]	stop_wait	: pointer to the stop signal, it gives up as soon
+ *							  as the signal is set to non-zero. May be NULL.
+ *
+ *	@return		Return [DNSPOD_ERROR_SUCCESS] if successfully get the internet
+ *				IP address, otherwise return an error code.
+ */
+static ddns_error dnspod_get_ip_address_from(
+	struct ddns_context						*	context,
+	const struct dnspod_getip_table_entry	*	entry,
+	char									*	text_buffer,
+	int											buffer_size,
+	int										*	stop_wait
+	);
+
+/**
+ *	Build the matcher of signatures of servers for getting IP address.
+ *
+ *	@param[out]	matcher		: the matcher to be initialized.
+ *	@param[in]	entries		: the servers, ended by a NULL name.
+ *
+ *	@return		Return 0 on success, otherwise the signatures are too many.
+ */
+static int dnspod_getip_matcher_init(
+	struct dnspod_getip_matcher				*	matcher,
+	const struct dnspod_getip_table_entry	*	entries
+	);
+
+/**
+ *	Start scraping a page for the IP address.
  *
- *	@return The following value may be returned:
- *				- DDNS_ERROR_SUCCESS:	legal server response is detected
- *				- DDNS_ERROR_REDIRECT:	redirection is required, redirect URL
- *										is saved in server_buffer.
- *				- DDNS_ERROR_BADSVR:    fail, shall not retry any more.
- *				- Others:				error occurred.
+ *	@param[out]	stream	: the scraping state.
+ *	@param[in]	matcher	: signatures of all servers.
+ *	@param[in]	rules	: rules of the page, ended by a NULL signature.
+ *	@param[in]	request	: the request of the page, its response is stopped
+ *						  as soon as the page is answered.
  */
-static ddns_error dnspod_get_ip_address_dnspod(
-	struct dnspod_buffer	*	server_buffer,
-	char					*	text_buffer,
-	int							buffer_size
+static void dnspod_getip_stream_init(
+	struct dnspod_getip_stream			*	stream,
+	const struct dnspod_getip_matcher	*	matcher,
+	const struct dnspod_getip_rule		*	rules,
+	struct http_request					*	request
 	);
-static ddns_error dnspod_get_ip_address_baidu(
-	struct dnspod_buffer	*	server_buffer,
-	char					*	text_buffer,
-	int							buffer_size
+
+/**
+ *	HTTP callback, scrape a block of the page as soon as it arrives. No more
+ *	than a token is kept, and the response is stopped once it's answered.
+ *
+ *	@param[in]		data	: newly received data.
+ *	@param[in]		size	: size of the received data in bytes.
+ *	@param[in/out]	stream	: the scraping state.
+ */
+static void dnspod_getip_stream_read(
+	const char					*	data,
+	size_t							size,
+	struct dnspod_getip_stream	*	stream
 	);
-static ddns_error dnspod_get_ip_address_ip138(
-	struct dnspod_buffer	*	server_buffer,
-	char					*	text_buffer,
-	int							buffer_size
+
+/**
+ *	Finish scraping a page at the end of it.
+ *
+ *	@param[in/out]	stream	: the scraping state, its [error_code] is:
+ *								- DDNS_ERROR_SUCCESS:	[token] is the IP
+ *														address.
+ *								- DDNS_ERROR_REDIRECT:	[token] is the URL to
+ *														redirect to.
+ *								- DDNS_ERROR_BADSVR:	nothing is found, shall
+ *														not retry any more.
+ */
+static void dnspod_getip_stream_end(
+	struct dnspod_getip_stream	*	stream
 	);
 
 
 /**
- *	Compare priority of 2 servers for getting IP address.
+ *	Compare priority of 2 servers for getting IP address, the one of less
+ *	cost goes first, see [dnspod_get_ip_address].
  *
  *	@param[in]	entry1	: the first server record
  *	@param[in]	entry2	: the second server record
@@ -581,6 +1061,19 @@ static ddns_error dnspod_handle_common_error(
 	ddns_error					*	error_code
 	);
 
+/**
+ *	Convert server status code into ours.
+ *
+ *	@param[in]	code		: value of "status.code" returned from server.
+ *	@param[out]	error_code	: the converted error code.
+ *
+ *	@return		The same as [dnspod_handle_common_error].
+ */
+static ddns_error dnspod_handle_status_code(
+	const char					*	code,
+	ddns_error					*	error_code
+	);
+
 /*============================================================================*
  *	Implementation of mapping tables
  *============================================================================*/
@@ -602,6 +1095,43 @@ static struct dnspod_line_table_record dnspod_record_line_table[] =
 	{ DNSPOD_API_VERSION_2_0,	"\xe5\x9b\xbd\xe5\xa4\x96", DNSPOD_LINE_FRGN}
 };
 
+/* The page is the IP address only */
+static const struct dnspod_getip_rule dnspod_getip_rules_dnspod[] =
+{
+	{ "",						" \t\r\n",	NULL					},
+	{ NULL,						NULL,		NULL					}
+};
+
+static const struct dnspod_getip_rule dnspod_getip_rules_baidu[] =
+{
+	{ ",query:'ip',key:'",		"'",		NULL					},
+	{ NULL,						NULL,		NULL					}
+};
+
+/* The page may redirect to another one by script */
+static const struct dnspod_getip_rule dnspod_getip_rules_ip138[] =
+{
+	{ "location.href=\"",		"\"",		"http://www.ip138.com/"	},
+	{ "[",						"]",		NULL					},
+	{ NULL,						NULL,		NULL					}
+};
+
+/* Servers for getting IP address, copied and sorted by every query */
+static const struct dnspod_getip_table_entry dnspod_getip_table[] =
+{
+#if defined(DNSPOD_USE_DNSPOD) && DNSPOD_USE_DNSPOD > 0
+	{ "DNSPod", "http://www.dnspod.cn/About/IP",		DNSPOD_USE_DNSPOD,	dnspod_getip_rules_dnspod,	NULL,	0,	NULL	},
+#endif
+#if defined(DNSPOD_USE_BAIDU) && DNSPOD_USE_BAIDU > 0
+	{ "Baidu",	"http://www.baidu.com/s?wd=ip",			DNSPOD_USE_BAIDU,	dnspod_getip_rules_baidu,	NULL,	0,	NULL	},
+#endif
+#if defined(DNSPOD_USE_IP138) && DNSPOD_USE_IP138 > 0
+	{ "IP138",	"http://iframe.ip138.com/ipcity.asp",	DNSPOD_USE_IP138,	dnspod_getip_rules_ip138,	NULL,	0,	NULL	},
+#endif
+	{ "Interface",	NULL,								0,					NULL,						NULL,	0,	NULL	},
+	{ NULL,		NULL,									INT_MAX,			NULL,						NULL,	0,	NULL	}
+};
+
 
 /*============================================================================*
  *	Implementation of Functions
@@ -624,6 +1154,7 @@ ddns_interface * dnspod_create_interface(void)
 
 		ddns->initialize		= &dnspod_interface_initialize;
 		ddns->is_ip_changed		= &dnspod_interface_is_ip_changed;
+		ddns->step_ip_changed	= NULL;	/* HTTP requests are blocking */
 		ddns->get_ip_address	= &dnspod_interface_get_ip_address;
 		ddns->do_update			= &dnspod_interface_do_update;
 		ddns->finalize			= &dnspod_interface_finalize;
@@ -646,11 +1177,18 @@ static ddns_error dnspod_interface_initialize(struct ddns_context * context)
 {
 	ddns_error					error_code	= DDNS_ERROR_SUCCESS;
 	struct dnspod_context	*	dnspod		= NULL;
+	int							use_state	= 0;
+	int							cached		= 0;
 
 	if ( (NULL == context) || (proto_dnspod != context->protocol) )
 	{
 		error_code = DDNS_ERROR_BADARG;
 	}
+	else
+	{
+		/* records are only kept for the requested hosts */
+		use_state = ('\0' != context->state_file[0]) && (NULL != context->domain);
+	}
 
 #if !defined(HTTP_SUPPORT_SSL) || 0 == HTTP_SUPPORT_SSL
 	return DDNS_FATAL_ERROR(DDNS_ERROR_SSL_REQUIRED);
@@ -664,11 +1202,18 @@ static ddns_error dnspod_interface_initialize(struct ddns_context * context)
 		if ( 0 != ddns_create_extra_param(context, sizeof(*dnspod)) )
 		{
 			dnspod = (struct dnspod_context*)context->extra_data;
+			dnspod->getip_matcher = (struct dnspod_getip_matcher*)malloc(
+											sizeof(*dnspod->getip_matcher));
 		}
-		else
+		if ( (NULL == dnspod) || (NULL == dnspod->getip_matcher) )
 		{
 			error_code = DDNS_ERROR_INSUFFICIENT_MEMORY;
 		}
+		else if ( 0 != dnspod_getip_matcher_init(dnspod->getip_matcher,
+												 dnspod_getip_table) )
+		{
+			error_code = DDNS_ERROR_INSUFFICIENT_BUFFER;
+		}
 	}
 
 	/**
@@ -692,9 +1237,18 @@ static ddns_error dnspod_interface_initialize(struct ddns_context * context)
 	}
 
 	/**
-	 *	Step 3: Check if the DNSPod API is supported by us.
+	 *	Step 3: Load domains & records saved by the previous run, if any, the
+	 *			server is then only asked to update the changed records.
 	 */
-	if ( DDNS_ERROR_SUCCESS == error_code )
+	if ( (DDNS_ERROR_SUCCESS == error_code) && (0 != use_state) )
+	{
+		cached = dnspod_state_load(context);
+	}
+
+	/**
+	 *	Step 4: Check if the DNSPod API is supported by us.
+	 */
+	if ( (DDNS_ERROR_SUCCESS == error_code) && (0 == cached) )
 	{
 		ddns_printf_v(context, msg_type_info, "Checking DNSPod API version... ");
 		error_code = dnspod_get_api_version(context, &(dnspod->api_version));
@@ -725,12 +1279,14 @@ static ddns_error dnspod_interface_initialize(struct ddns_context * context)
 	}
 
 	/**
-	 *	Step 4: Get domain list.
+	 *	Step 5: Get domain list.
 	 */
-	if ( DDNS_ERROR_SUCCESS == error_code )
+	if ( (DDNS_ERROR_SUCCESS == error_code) && (0 == cached) )
 	{
 		ddns_printf_v(context, msg_type_info, "Retrieving domain list... ");
-		dnspod->domain_list = dnspod_list_domain(context, &error_code);
+		dnspod->state_time	= (ddns_ulong32)time(NULL);
+		dnspod->domain_list	= dnspod_list_domain(context, &error_code);
+		dnspod_index_domains(&dnspod->domain_index, dnspod->domain_list);
 		if ( DDNS_ERROR_SUCCESS == error_code )
 		{
 			struct dnspod_domain * domain = dnspod->domain_list;
@@ -756,7 +1312,7 @@ static ddns_error dnspod_interface_initialize(struct ddns_context * context)
 	}
 
 	/**
-	 *	Step 5: get all hosts under your DDNS account if necessary.
+	 *	Step 6: get all hosts under your DDNS account if necessary.
 	 */
 	if ( (DDNS_ERROR_SUCCESS == error_code) )
 	{
@@ -769,7 +1325,7 @@ static ddns_error dnspod_interface_initialize(struct ddns_context * context)
 	}
 
 	/**
-	 *	Step 6: Do initial update, make sure we're synchronized with server.
+	 *	Step 7: Do initial update, make sure we're synchronized with server.
 	 */
 	if ( DDNS_ERROR_SUCCESS == error_code )
 	{
@@ -780,6 +1336,19 @@ static ddns_error dnspod_interface_initialize(struct ddns_context * context)
 													);
 	}
 
+	/**
+	 *	Step 8: Save the state for the next run. If the saved one is used but
+	 *			failed, it may be out of date, drop it.
+	 */
+	if ( (DDNS_ERROR_SUCCESS == error_code) && (0 != use_state) )
+	{
+		dnspod_state_save(context);
+	}
+	else if ( 0 != cached )
+	{
+		remove(context->state_file);
+	}
+
 	return error_code;
 }
 
@@ -930,6 +1499,13 @@ static ddns_error dnspod_interface_do_update(struct ddns_context * context)
 													);
 	}
 
+	if (	(DDNS_ERROR_SUCCESS == error_code)
+		&&	('\0' != context->state_file[0])
+		&&	(NULL != context->domain) )
+	{
+		dnspod_state_save(context);
+	}
+
 	return error_code;
 }
 
@@ -963,11 +1539,14 @@ static ddns_error dnspod_interface_finalize(struct ddns_context * context)
 
 	if ( DDNS_ERROR_SUCCESS == error_code )
 	{
+		dnspod_index_destroy(&dnspod->domain_index);
 		if ( NULL != dnspod->domain_list )
 		{
 			dnspod_destroy_domain_list(dnspod->domain_list);
 			dnspod->domain_list = NULL;
 		}
+		free(dnspod->getip_matcher);
+		dnspod->getip_matcher = NULL;
 	}
 
 	if ( DDNS_ERROR_SUCCESS == error_code )
@@ -1025,10 +1604,13 @@ static ddns_error dnspod_interface_destroy(ddns_interface* ddns)
  *				requested address with the address on server. If the 2 addresses
  *				are the same, it'll ignore the request and return 0.
  *
+ *	@note		Up to [parallel] of the context records are updated at the same
+ *				time, and every record is tried even if some of them failed.
+ *
  *	@note		It's safe to pass [NULL] to [update_cnt].
  *
  *	@return		Return [DNSPOD_ERROR_SUCCESS] if update of all DNS records are
- *				successful, otherwise return an error code.
+ *				successful, otherwise return the error of the first failed one.
  */
 static ddns_error dnspod_interface_update_all(
 	struct ddns_context		*	context,
@@ -1039,12 +1621,21 @@ static ddns_error dnspod_interface_update_all(
 {
 	ddns_error						error_code	= DDNS_ERROR_SUCCESS;
 	const struct ddns_server	*	domain		= NULL;
+	struct ddns_sync_thread		*	threads		= NULL;
+	unsigned int					thread_cnt	= 0;
+	unsigned int					i			= 0;
+	struct dnspod_update_job		job;
+
+	memset(&job, 0, sizeof(job));
 
 	if ( (NULL == context) || (NULL == domain_list) || (NULL == address) )
 	{
 		error_code = DDNS_ERROR_BADARG;
 	}
 
+	/**
+	 *	Step 1: Collect requested hosts.
+	 */
 	if ( DDNS_ERROR_SUCCESS == error_code )
 	{
 		if ( NULL != update_cnt )
@@ -1052,42 +1643,488 @@ static ddns_error dnspod_interface_update_all(
 			(*update_cnt) = 0;
 		}
 
+		job.context		= context;
+		job.domain_list	= domain_list;
+		job.address		= address;
+
 		for ( domain = context->domain; NULL != domain; domain = domain->next )
 		{
-			ddns_printf_v(context,	msg_type_info,
-									"Updating domain name \"%s\"... ",
-									domain->domain
-									);
-			error_code = dnspod_update_address( context,
-												domain_list,
-												domain->domain,
-												address
-												);
-			if ( DDNS_ERROR_SUCCESS == error_code)
+			++job.host_cnt;
+		}
+
+		if ( job.host_cnt > 0 )
+		{
+			job.hosts	= (const struct ddns_server**)malloc(
+									job.host_cnt * sizeof(*job.hosts));
+			job.results	= (ddns_error*)malloc(
+									job.host_cnt * sizeof(*job.results));
+			if ( (NULL == job.hosts) || (NULL == job.results) )
+			{
+				error_code = DDNS_ERROR_INSUFFICIENT_MEMORY;
+			}
+		}
+	}
+
+	if ( (DDNS_ERROR_SUCCESS == error_code) && (job.host_cnt > 0) )
+	{
+		for ( i = 0, domain = context->domain; NULL != domain; ++i, domain = domain->next )
+		{
+			job.hosts[i]	= domain;
+			job.results[i]	= DDNS_ERROR_PENDING;
+		}
+
+		/**
+		 *	Step 2: Load records of the requested domains one by one, workers
+		 *			only modify the records of their own hosts.
+		 */
+		dnspod_update_prepare(&job);
+
+		/**
+		 *	Step 3: Update hosts by up to [context->parallel] workers, this
+		 *			thread is one of them. If a worker can't be started, the
+		 *			others take over its hosts.
+		 */
+		if ( (context->parallel > 1) && (job.host_cnt > 1) )
+		{
+			thread_cnt = (unsigned int)context->parallel;
+			if ( thread_cnt > job.host_cnt )
+			{
+				thread_cnt = job.host_cnt;
+			}
+			--thread_cnt;
+
+			threads = (struct ddns_sync_thread*)malloc(
+									thread_cnt * sizeof(*threads));
+			if ( NULL == threads )
+			{
+				thread_cnt = 0;
+			}
+		}
+
+		ddns_sync_init(&job.sync_object);
+
+		for ( i = 0; i < thread_cnt; ++i )
+		{
+			if ( 0 != ddns_sync_thread_create(&threads[i],
+											  &dnspod_update_worker,
+											  &job
+											  ) )
+			{
+				thread_cnt = i;
+				break;
+			}
+		}
+
+		dnspod_update_worker(&job);
+
+		for ( i = 0; i < thread_cnt; ++i )
+		{
+			ddns_sync_thread_join(&threads[i]);
+		}
+
+		ddns_sync_destroy(&job.sync_object);
+
+		/**
+		 *	Step 4: Report the first failure in the order of the hosts.
+		 */
+		for ( i = 0; i < job.host_cnt; ++i )
+		{
+			if ( DDNS_ERROR_SUCCESS == job.results[i] )
 			{
-				ddns_printf_v(context, msg_type_info, "done.\n");
 				if ( NULL != update_cnt )
 				{
 					++(*update_cnt);
 				}
 			}
-			else if ( DDNS_ERROR_NOCHG == error_code )
+			else if ( (DDNS_ERROR_NOCHG != job.results[i])
+				&& (DDNS_ERROR_SUCCESS == error_code) )
 			{
-				ddns_printf_v(context, msg_type_info, "skipped.\n");
-				error_code = DDNS_ERROR_SUCCESS;
+				error_code = job.results[i];
 			}
-			else
+		}
+	}
+
+	free(threads);
+	free(job.hosts);
+	free(job.results);
+
+	return error_code;
+}
+
+
+/**
+ *	Get records of every domain that a requested host belongs to, so workers of
+ *	[dnspod_interface_update_all] never load them at the same time.
+ *
+ *	@param[in/out]	job			: the update job, hosts whose domain can't be
+ *								  loaded are marked as failed.
+ */
+static void dnspod_update_prepare(
+	struct dnspod_update_job	*	job
+	)
+{
+	const struct dnspod_context	*	dnspod	= NULL;
+	const struct dnspod_index	*	index	= NULL;
+	struct dnspod_domain		*	domain	= NULL;
+	ddns_error						error	= DDNS_ERROR_SUCCESS;
+	unsigned int					i		= 0;
+
+	/* the index is only valid for the domain list kept in context */
+	dnspod = (const struct dnspod_context*)job->context->extra_data;
+	if ( (NULL != dnspod) && (job->domain_list == dnspod->domain_list) )
+	{
+		index = &dnspod->domain_index;
+	}
+
+	for ( i = 0; i < job->host_cnt; ++i )
+	{
+		domain = (struct dnspod_domain*)dnspod_find_domain(job->domain_list,
+														   index,
+														   job->hosts[i]->domain
+														   );
+
+		/* leave unknown domains to [dnspod_update_address] */
+		if ( (NULL != domain) && (NULL == domain->records) )
+		{
+			error			= DDNS_ERROR_SUCCESS;
+			domain->records	= dnspod_list_record(job->context,
+												 domain,
+												 &error
+												 );
+			dnspod_index_records(&domain->record_index, domain->records);
+
+			if ( NULL == domain->records )
+			{
+				job->results[i] = (DDNS_ERROR_SUCCESS == error)
+								? DDNS_ERROR_CONNECTION
+								: error;
+			}
+		}
+	}
+}
+
+
+/**
+ *	Worker of [dnspod_interface_update_all], it keeps updating the next pending
+ *	host of the job until all of them are done.
+ *
+ *	@param[in/out]	param		: the [dnspod_update_job].
+ */
+static void dnspod_update_worker(
+	void					*	param
+	)
+{
+	struct dnspod_update_job	*	job		= (struct dnspod_update_job*)param;
+	const char					*	status	= NULL;
+	unsigned int					i		= 0;
+
+	while ( 1 )
+	{
+		ddns_sync_lock(&job->sync_object);
+		i = job->next_host;
+		if ( i < job->host_cnt )
+		{
+			++job->next_host;
+		}
+		ddns_sync_unlock(&job->sync_object);
+
+		if ( i >= job->host_cnt )
+		{
+			break;
+		}
+
+		if ( DDNS_ERROR_PENDING == job->results[i] )
+		{
+			job->results[i] = dnspod_update_address(job->context,
+													job->domain_list,
+													job->hosts[i]->domain,
+													job->address
+													);
+		}
+
+		if ( DDNS_ERROR_SUCCESS == job->results[i] )
+		{
+			status = "done";
+		}
+		else if ( DDNS_ERROR_NOCHG == job->results[i] )
+		{
+			status = "skipped";
+		}
+		else
+		{
+			status = "failed";
+		}
+
+		/* one line per host, so lines of different workers don't interleave */
+		ddns_printf_v(job->context,	msg_type_info,
+									"Updating domain name \"%s\"... %s.\n",
+									job->hosts[i]->domain,
+									status
+									);
+	}
+}
+
+
+/**
+ *	Load domains & records of the requested hosts saved by a previous run.
+ *
+ *	@param[in/out]	context		: the DDNS context, its domain list and API
+ *								  version are set if the state is loaded.
+ *
+ *	@note		The state is ignored if it's saved for another account, or
+ *				older than [DNSPOD_STATE_MAX_AGE], or any requested host
+ *				isn't found in it.
+ *
+ *	@return		Return non-zero if the state is loaded, otherwise 0.
+ */
+static int dnspod_state_load(
+	struct ddns_context		*	context
+	)
+{
+	struct dnspod_context		*	dnspod	= NULL;
+	struct dnspod_domain		*	list	= NULL;
+	struct dnspod_domain		**	tail	= &list;
+	const struct ddns_server	*	host	= NULL;
+	FILE						*	file	= NULL;
+	int								loaded	= 0;
+	ddns_ulong32					i		= 0;
+	struct dnspod_state_header		header;
+
+	dnspod = (struct dnspod_context*)context->extra_data;
+
+	/**
+	 *	Step 1: Check if the state is saved for this account recently.
+	 */
+	file = fopen(context->state_file, "rb");
+	if ( NULL != file )
+	{
+		loaded = (1 == fread(&header, sizeof(header), 1, file))
+			&&	(DNSPOD_STATE_MAGIC == header.magic)
+			&&	(DNSPOD_STATE_VERSION == header.version)
+			&&	((ddns_ulong32)time(NULL) - header.fetched <= DNSPOD_STATE_MAX_AGE)
+			&&	(0 == strncmp(header.username, context->username, sizeof(header.username)));
+	}
+
+	/**
+	 *	Step 2: Read domains, and A records of them.
+	 */
+	for ( i = 0; (0 != loaded) && (i < header.domain_cnt); ++i )
+	{
+		struct dnspod_domain		*	domain	= NULL;
+		struct dnspod_record		**	records	= NULL;
+		ddns_ulong32					j		= 0;
+		struct dnspod_state_domain		saved;
+
+		if ( 1 == fread(&saved, sizeof(saved), 1, file) )
+		{
+			domain = (struct dnspod_domain*)calloc(1, sizeof(*domain));
+		}
+		loaded = (NULL != domain);
+		if ( 0 != loaded )
+		{
+			domain->domain_id	= saved.domain_id;
+			domain->min_ttl		= saved.min_ttl;
+			c99_strncpy(domain->domain, saved.domain, _countof(domain->domain));
+
+			(*tail)	= domain;
+			tail	= &domain->next;
+			records	= &domain->records;
+		}
+
+		for ( j = 0; (0 != loaded) && (j < saved.record_cnt); ++j )
+		{
+			struct dnspod_record		*	record	= NULL;
+			struct dnspod_state_record		item;
+
+			if ( 1 == fread(&item, sizeof(item), 1, file) )
+			{
+				record = (struct dnspod_record*)calloc(1, sizeof(*record));
+			}
+			loaded = (NULL != record);
+			if ( 0 != loaded )
+			{
+				record->host_id	= item.host_id;
+				record->line	= (enum dnspod_record_line)item.line;
+				record->type	= DNSPOD_RECORD_TYPE_A;
+				record->ttl		= item.ttl;
+				record->enabled	= (int)item.enabled;
+				c99_strncpy(record->name, item.name, _countof(record->name));
+				c99_strncpy(record->value, item.value, _countof(record->value));
+
+				(*records)	= record;
+				records		= &record->next;
+			}
+		}
+
+		if ( 0 != loaded )
+		{
+			dnspod_index_records(&domain->record_index, domain->records);
+		}
+	}
+
+	if ( NULL != file )
+	{
+		fclose(file);
+		file = NULL;
+	}
+
+	/**
+	 *	Step 3: Every requested host must be found in the saved domains.
+	 */
+	if ( 0 != loaded )
+	{
+		dnspod_index_domains(&dnspod->domain_index, list);
+		for ( host = context->domain; NULL != host; host = host->next )
+		{
+			const struct dnspod_domain * domain = NULL;
+
+			domain = dnspod_find_domain(list, &dnspod->domain_index, host->domain);
+			if ( (NULL == domain) || (NULL == domain->records) )
 			{
-				ddns_printf_v(context, msg_type_info, "failed.\n");
+				loaded = 0;
 				break;
 			}
 		}
 	}
 
-	return error_code;
+	if ( 0 != loaded )
+	{
+		dnspod->domain_list	= list;
+		dnspod->api_version	= header.api_version;
+		dnspod->state_time	= header.fetched;
+		ddns_printf_v(context,	msg_type_info,
+								"Loaded state of \"%s\", last IP address is %.*s.\n",
+								context->state_file,
+								(int)sizeof(header.ip_address),
+								header.ip_address
+								);
+	}
+	else
+	{
+		dnspod_index_destroy(&dnspod->domain_index);
+		dnspod_destroy_domain_list(list);
+	}
+
+	return loaded;
+}
+
+
+/**
+ *	Save domains & records of the requested hosts, so that the next run can
+ *	update the changed records without listing them again.
+ *
+ *	@param[in]	context		: the DDNS context.
+ *
+ *	@note		The file is written aside and renamed, so it's never seen
+ *				half written.
+ */
+static void dnspod_state_save(
+	struct ddns_context		*	context
+	)
+{
+	const struct dnspod_context	*	dnspod	= NULL;
+	const struct dnspod_domain	*	domain	= NULL;
+	const struct dnspod_record	*	record	= NULL;
+	FILE						*	file	= NULL;
+	int								saved	= 0;
+	char							temp_file[_countof(context->state_file) + 4];
+	struct dnspod_state_header		header;
+
+	dnspod = (const struct dnspod_context*)context->extra_data;
+
+	memset(&header, 0, sizeof(header));
+	header.magic		= DNSPOD_STATE_MAGIC;
+	header.version		= DNSPOD_STATE_VERSION;
+	header.fetched		= dnspod->state_time;
+	header.api_version	= dnspod->api_version;
+	c99_strncpy(header.username, context->username, _countof(header.username));
+	c99_strncpy(header.ip_address, dnspod->ip_address, _countof(header.ip_address));
+
+	/* only domains of the requested hosts are loaded with records */
+	for ( domain = dnspod->domain_list; NULL != domain; domain = domain->next )
+	{
+		if ( NULL != domain->records )
+		{
+			++header.domain_cnt;
+		}
+	}
+
+	c99_snprintf(temp_file, _countof(temp_file), "%s.tmp", context->state_file);
+	file = fopen(temp_file, "wb");
+	if ( NULL != file )
+	{
+		saved = (1 == fwrite(&header, sizeof(header), 1, file));
+	}
+
+	for ( domain = dnspod->domain_list; (0 != saved) && (NULL != domain); domain = domain->next )
+	{
+		struct dnspod_state_domain item;
+
+		if ( NULL == domain->records )
+		{
+			continue;
+		}
+
+		memset(&item, 0, sizeof(item));
+		item.domain_id	= domain->domain_id;
+		item.min_ttl	= domain->min_ttl;
+		c99_strncpy(item.domain, domain->domain, _countof(item.domain));
+		for ( record = domain->records; NULL != record; record = record->next )
+		{
+			if ( DNSPOD_RECORD_TYPE_A == record->type )
+			{
+				++item.record_cnt;
+			}
+		}
+		saved = (1 == fwrite(&item, sizeof(item), 1, file));
+
+		for ( record = domain->records; (0 != saved) && (NULL != record); record = record->next )
+		{
+			struct dnspod_state_record value;
+
+			if ( DNSPOD_RECORD_TYPE_A != record->type )
+			{
+				continue;
+			}
+
+			memset(&value, 0, sizeof(value));
+			value.host_id	= record->host_id;
+			value.line		= (ddns_ulong32)record->line;
+			value.ttl		= record->ttl;
+			value.enabled	= (ddns_ulong32)record->enabled;
+			c99_strncpy(value.name, record->name, _countof(value.name));
+			c99_strncpy(value.value, record->value, _countof(value.value));
+			saved = (1 == fwrite(&value, sizeof(value), 1, file));
+		}
+	}
+
+	if ( NULL != file )
+	{
+		saved = (0 == fclose(file)) && (0 != saved);
+		file = NULL;
+	}
+
+	if ( 0 != saved )
+	{
+#ifdef WIN32
+		/* rename() doesn't replace an existing file on Windows */
+		remove(context->state_file);
+#endif
+		saved = (0 == rename(temp_file, context->state_file));
+	}
+
+	if ( 0 == saved )
+	{
+		remove(temp_file);
+		ddns_msg(context,	msg_type_warning,
+							"can't save state to \"%s\".\n",
+							context->state_file
+							);
+	}
 }
 
 
+
 /**
  *	Get all A records in the domains and fill them to DDNS context.
  *
@@ -1127,6 +2164,7 @@ ddns_error dnspod_interface_list_record(
 											 domain,
 											 &error_code
 											 );
+		dnspod_index_records(&domain->record_index, domain->records);
 		if ( DDNS_ERROR_SUCCESS == error_code )
 		{
 			struct dnspod_record *record = domain->records;
@@ -1268,7 +2306,7 @@ unsigned long dnspod_create_domain(
 	if ( DDNS_ERROR_SUCCESS == status_code )
 	{
 		struct json_value	*	id		= NULL;
-		struct json_value	*	result	= json_object_get(json, "domain");
+		struct json_value	*	result	= json_object_peek(json, "domain");
 
 		ddns_error err = dnspod_handle_common_error(json, &status_code);
 		switch (err)
@@ -1307,7 +2345,7 @@ unsigned long dnspod_create_domain(
 
 		if ( DDNS_ERROR_SUCCESS == status_code )
 		{
-			id = json_object_get(result, "id");
+			id = json_object_peek(result, "id");
 			if ( 0 == json_to_number(id) )
 			{
 				status_code = DDNS_ERROR_BADSVR;
@@ -1318,9 +2356,6 @@ unsigned long dnspod_create_domain(
 		{
 			domain_id = (int)json_number_get(id);
 		}
-
-		json_destroy(id);		id		= NULL;
-		json_destroy(result);	result	= NULL;
 	}
 
 	/**
@@ -1454,7 +2489,7 @@ struct dnspod_domain * dnspod_list_domain(
 		struct json_value	*	domain	= NULL;
 		struct json_value	*	ary		= NULL;
 
-		domain = json_object_get(response, "domains");
+		domain = json_object_peek(response, "domains");
 		if (	(dnspod->api_version < DNSPOD_API_VERSION_2_0)
 			&&	(json_type_object != json_get_type(domain)) )
 		{
@@ -1465,11 +2500,11 @@ struct dnspod_domain * dnspod_list_domain(
 		{
 			if ( dnspod->api_version >= DNSPOD_API_VERSION_2_0 )
 			{
-				ary = json_duplicate(domain);
+				ary = domain;
 			}
 			else
 			{
-				ary = json_object_get(domain, "domain");
+				ary = json_object_peek(domain, "domain");
 			}
 
 			if ( json_type_array != json_get_type(ary) )
@@ -1483,24 +2518,18 @@ struct dnspod_domain * dnspod_list_domain(
 			signed long domain_count = (signed long)json_array_size(ary);
 			for ( idx = domain_count - 1; idx >= 0; --idx )
 			{
-				struct json_value * domain_info = json_array_get(ary, idx);
+				struct json_value * domain_info = json_array_peek(ary, idx);
 
 				status_code = dnspod_domain_list_push(	context,
 														domain_info,
 														&domain_list );
 
-				json_destroy(domain_info);
-				domain_info = NULL;
-
 				if ( DDNS_ERROR_SUCCESS != status_code )
 				{
 					break;
 				}
 			}
 		}
-
-		json_destroy(ary);		ary = NULL;
-		json_destroy(domain);	domain	= NULL;
 	}
 
 	json_destroy(response);
@@ -1538,6 +2567,7 @@ void dnspod_destroy_domain_list(struct dnspod_domain * list)
 			dnspod_destroy_record_list(list->records);
 			list->records = NULL;
 		}
+		dnspod_index_destroy(&list->record_index);
 
 		free(list);
 
@@ -1722,14 +2752,16 @@ struct dnspod_record * dnspod_list_record(
 	)
 {
 	ddns_error						status_code = DDNS_ERROR_SUCCESS;
-	struct json_value			*	json		= NULL;
+	struct json_context			*	json_ctx	= NULL;
 	struct dnspod_context		*	dnspod		= NULL;
 	struct dnspod_record		*	list		= NULL;
+	struct dnspod_record_stream		stream;
 
 	char command[512];
 	char username[sizeof(context->username) * 3];
 	char password[sizeof(context->password) * 3];
 
+	memset(&stream, 0, sizeof(stream));
 	memset(&command, 0, sizeof(command));
 	memset(&username, 0, sizeof(username));
 	memset(&password, 0, sizeof(password));
@@ -1747,6 +2779,25 @@ struct dnspod_record * dnspod_list_record(
 		}
 	}
 
+	/* records are parsed as the response arrives, no json tree is built */
+	if ( DDNS_ERROR_SUCCESS == status_code )
+	{
+		stream.context		= context;
+		stream.api_version	= dnspod->api_version;
+		stream.tail			= &(stream.list);
+		stream.error_code	= DDNS_ERROR_SUCCESS;
+
+		json_ctx = json_create_event_context(
+						20,
+						(json_event_callback)&dnspod_record_stream_callback,
+						&stream
+						);
+		if ( NULL == json_ctx )
+		{
+			status_code = DDNS_ERROR_INSUFFICIENT_MEMORY;
+		}
+	}
+
 	if ( DDNS_ERROR_SUCCESS == status_code )
 	{
 		size_t length = 0;
@@ -1767,13 +2818,17 @@ struct dnspod_record * dnspod_list_record(
 		}
 		else
 		{
-			status_code = dnspod_send_command(	context,
-												DNSPOD_RECORD_LIST,
-												command,
-												&json
-												);
-			if (	(DDNS_ERROR_SUCCESS == status_code)
-				&&	(json_type_object != json_get_type(json)) )
+			status_code = dnspod_send_command_ex(	context,
+													DNSPOD_RECORD_LIST,
+													command,
+													json_ctx
+													);
+			if ( DDNS_ERROR_SUCCESS != stream.error_code )
+			{
+				status_code = stream.error_code;
+			}
+			else if (	(DDNS_ERROR_SUCCESS == status_code)
+					&&	('\0' == stream.code[0]) )
 			{
 				status_code = DDNS_ERROR_BADSVR;
 			}
@@ -1782,7 +2837,7 @@ struct dnspod_record * dnspod_list_record(
 
 	if ( DDNS_ERROR_SUCCESS == status_code )
 	{
-		ddns_error err = dnspod_handle_common_error(json, &status_code);
+		ddns_error err = dnspod_handle_status_code(stream.code, &status_code);
 		switch (err)
 		{
 		case DDNS_ERROR_SUCCESS:
@@ -1822,191 +2877,26 @@ struct dnspod_record * dnspod_list_record(
 		}
 	}
 
+	if ( (DDNS_ERROR_SUCCESS == status_code) && (0 == stream.has_list) )
+	{
+		status_code = DDNS_ERROR_BADSVR;
+	}
+
 	if ( DDNS_ERROR_SUCCESS == status_code )
 	{
-		struct json_value	*	records		= json_object_get(json, "records");
-		struct json_value	*	host_list	= NULL;
+		list = stream.list;
+	}
+	else
+	{
+		dnspod_destroy_record_list(stream.list);
+	}
+	stream.list = NULL;
 
-		if (	(dnspod->api_version < DNSPOD_API_VERSION_2_0)
-			&&	(json_type_object != json_get_type(records)) )
-		{
-			status_code = DDNS_ERROR_BADSVR;
-		}
+	dnspod_destroy_record_list(stream.record);
+	stream.record = NULL;
 
-		if ( DDNS_ERROR_SUCCESS == status_code )
-		{
-			if ( dnspod->api_version >= DNSPOD_API_VERSION_2_0 )
-			{
-				host_list = json_duplicate(records);
-			}
-			else
-			{
-				host_list = json_object_get(records, "record");
-			}
-			if ( json_type_array != json_get_type(host_list) )
-			{
-				status_code = DDNS_ERROR_BADSVR;
-			}
-		}
-
-		if ( DDNS_ERROR_SUCCESS == status_code )
-		{
-			signed long idx			= 0;
-			signed long host_count	= (signed long)json_array_size(host_list);
-			for ( idx = host_count - 1; idx >= 0; --idx )
-			{
-				struct json_value * host	= json_array_get(host_list, idx);
-				struct json_value * id		= NULL;
-				struct json_value * name	= NULL;
-				struct json_value * line	= NULL;
-				struct json_value * type	= NULL;
-				struct json_value * ttl		= NULL;
-				struct json_value * value	= NULL;
-				struct json_value * mx		= NULL;
-				struct json_value * enabled = NULL;
-				struct json_value * last_update = NULL;
-				struct dnspod_record * record	= NULL;
-				if ( json_type_object != json_get_type(host) )
-				{
-					status_code = DDNS_ERROR_BADSVR;
-				}
-
-				if ( DDNS_ERROR_SUCCESS == status_code )
-				{
-					id = json_object_get(host, "id");
-					if ( 0 == json_to_number(id) )
-					{
-						status_code = DDNS_ERROR_BADSVR;
-					}
-				}
-
-				if ( DDNS_ERROR_SUCCESS == status_code )
-				{
-					name = json_object_get(host, "name");
-					if ( json_type_string != json_get_type(name) )
-					{
-						status_code = DDNS_ERROR_BADSVR;
-					}
-				}
-
-				if ( DDNS_ERROR_SUCCESS == status_code )
-				{
-					line = json_object_get(host, "line");
-					if ( json_type_string != json_get_type(line) )
-					{
-						status_code = DDNS_ERROR_BADSVR;
-					}
-				}
-
-				if ( DDNS_ERROR_SUCCESS == status_code )
-				{
-					type = json_object_get(host, "type");
-					if ( json_type_string != json_get_type(type) )
-					{
-						status_code = DDNS_ERROR_BADSVR;
-					}
-				}
-
-				if ( DDNS_ERROR_SUCCESS == status_code )
-				{
-					ttl = json_object_get(host, "ttl");
-					if ( json_type_string != json_get_type(ttl) )
-					{
-						status_code = DDNS_ERROR_BADSVR;
-					}
-				}
-
-				if ( DDNS_ERROR_SUCCESS == status_code )
-				{
-					value = json_object_get(host, "value");
-					if ( json_type_string != json_get_type(value) )
-					{
-						status_code = DDNS_ERROR_BADSVR;
-					}
-				}
-
-				if ( DDNS_ERROR_SUCCESS == status_code )
-				{
-					mx = json_object_get(host, "mx");
-					if ( json_type_string != json_get_type(mx) )
-					{
-						status_code = DDNS_ERROR_BADSVR;
-					}
-				}
-
-				if ( DDNS_ERROR_SUCCESS == status_code )
-				{
-					enabled = json_object_get(host, "enabled");
-					if ( json_type_string != json_get_type(enabled) )
-					{
-						status_code = DDNS_ERROR_BADSVR;
-					}
-				}
-
-				if ( DDNS_ERROR_SUCCESS == status_code )
-				{
-					last_update = json_object_get(host, "updated_on");
-					if ( json_type_string != json_get_type(last_update) )
-					{
-						status_code = DDNS_ERROR_BADSVR;
-					}
-				}
-
-				if ( DDNS_ERROR_SUCCESS == status_code )
-				{
-					record = malloc(sizeof(*record));
-					if ( NULL != record )
-					{
-						memset(record, 0, sizeof(*record));
-						record->host_id = (int)json_number_get(id);
-						record->line	= dnspod_get_record_line(context, json_string_get(line));
-						record->type	= dnspod_get_record_type(json_string_get(type));
-						record->ttl		= strtoul(json_string_get(ttl), NULL, 10);
-						record->mx		= strtoul(json_string_get(mx), NULL, 10);
-						record->enabled = (0 != atol(json_string_get(enabled)));
-						c99_strncpy(record->name,
-									json_string_get(name),
-									_countof(record->name));
-						c99_strncpy(record->value,
-									json_string_get(value),
-									_countof(record->value));
-						c99_strncpy(record->last_update,
-									json_string_get(last_update),
-									_countof(record->last_update));
-
-						record->next = list;
-						list = record;
-					}
-					else
-					{
-						status_code = DDNS_ERROR_INSUFFICIENT_MEMORY;
-					}
-				}
-
-				json_destroy(last_update);	last_update = NULL;
-				json_destroy(enabled);		enabled		= NULL;
-				json_destroy(mx);			mx			= NULL;
-				json_destroy(value);		value		= NULL;
-				json_destroy(ttl);			ttl			= NULL;
-				json_destroy(type);			type		= NULL;
-				json_destroy(line);			line		= NULL;
-				json_destroy(name);			name		= NULL;
-				json_destroy(id);			id			= NULL;
-				json_destroy(host);			host		= NULL;
-
-				if ( DDNS_ERROR_SUCCESS != status_code )
-				{
-					break;
-				}
-			}
-		}
-
-		json_destroy(host_list);	host_list	= NULL;
-		json_destroy(records);		records		= NULL;
-	}
-
-	json_destroy(json);
-	json = NULL;
+	json_destroy_context(json_ctx);
+	json_ctx = NULL;
 
 	/* Special case: successful, no no record returned from server */
 	if ( DDNS_ERROR_EMPTY == status_code )
@@ -2072,6 +2962,16 @@ ddns_error dnspod_update_address(
 	 */
 	if ( DDNS_ERROR_SUCCESS == error_code )
 	{
+		const struct dnspod_context *	dnspod	= NULL;
+		const struct dnspod_index	*	index	= NULL;
+
+		/* the index is only valid for the domain list kept in context */
+		dnspod = (const struct dnspod_context*)context->extra_data;
+		if ( (NULL != dnspod) && (domain_list == dnspod->domain_list) )
+		{
+			index = &dnspod->domain_index;
+		}
+
 		/**
 		 *	Oh yeah, you found it, don't you!
 		 *
@@ -2079,6 +2979,7 @@ ddns_error dnspod_update_address(
 		 *	domain element in the list is not 'const' too.
 		 */
 		domain = (struct dnspod_domain*)dnspod_find_domain(domain_list,
+														   index,
 														   domain_name
 														   );
 		if ( NULL == domain )
@@ -2099,6 +3000,7 @@ ddns_error dnspod_update_address(
 												 domain,
 												 &error_code
 												 );
+			dnspod_index_records(&domain->record_index, domain->records);
 		}
 		if ( (DDNS_ERROR_SUCCESS == error_code) && (NULL == domain->records) )
 		{
@@ -2112,6 +3014,7 @@ ddns_error dnspod_update_address(
 	if ( DDNS_ERROR_SUCCESS == error_code )
 	{
 		record = (struct dnspod_record*)dnspod_find_record(domain->records,
+														   &domain->record_index,
 														   DNSPOD_RECORD_TYPE_A,
 														   domain_name);
 		if ( NULL == record )
@@ -2473,6 +3376,9 @@ ddns_error dnspod_update_ddns(
 		}
 	}
 
+	json_destroy(json);
+	json = NULL;
+
 	return error_code;
 }
 
@@ -2496,24 +3402,60 @@ static ddns_error dnspod_send_command(
 	)
 {
 	ddns_error					error_code	= DDNS_ERROR_SUCCESS;
-	struct http_request		*	request		= NULL;
 	struct json_context		*	json_ctx	= NULL;
 
+	json_ctx = json_create_arena_context(20);
+	if ( NULL == json_ctx )
+	{
+		error_code = DDNS_ERROR_INSUFFICIENT_MEMORY;
+	}
+	else
+	{
+		error_code = dnspod_send_command_ex(context, path, cmd, json_ctx);
+	}
+
+	if ( (DDNS_ERROR_SUCCESS == error_code) && (NULL != json_value) )
+	{
+		(*json_value) = json_get_value(json_ctx);
+	}
+
+	json_destroy_context(json_ctx);
+	json_ctx = NULL;
+
+	return error_code;
+}
+
+
+/**
+ *	Send a command to DNSPod server, and feed the response into the given
+ *	json parse context.
+ *
+ *	@param[in]	context :	the DDNS context
+ *	@param[in]	path	:	the target URL to send the command
+ *	@param[in]	cmd		:	the command to be sent to server
+ *	@param[in]	json_ctx:	the json parse context to receive the response.
+ *
+ *	@return		Return [DNSPOD_ERROR_SUCCESS] if the command is successfully
+ *				sent to server and a complete json expression is returned.
+ *				Otherwise a error code will be returned.
+ */
+static ddns_error dnspod_send_command_ex(
+	const struct ddns_context	*	context,
+	const char					*	path,
+	const char					*	cmd,
+	struct json_context			*	json_ctx
+	)
+{
+	ddns_error					error_code	= DDNS_ERROR_SUCCESS;
+	struct http_request		*	request		= NULL;
+
 	/**
 	 *	Step 1: Arguments validity check.
 	 */
-	if ( (NULL == context) || (NULL == path) )
+	if ( (NULL == context) || (NULL == path) || (NULL == json_ctx) )
 	{
 		error_code = DDNS_ERROR_BADARG;
 	}
-	if ( DDNS_ERROR_SUCCESS == error_code )
-	{
-		json_ctx = json_create_context(20);
-		if ( NULL == json_ctx )
-		{
-			error_code = DDNS_ERROR_INSUFFICIENT_MEMORY;
-		}
-	}
 
 	/**
 	 *	Step 2: Create HTTP request.
@@ -2547,6 +3489,11 @@ static ddns_error dnspod_send_command(
 			{
 				error_code = DDNS_ERROR_BADURL;
 			}
+			else
+			{
+				/* API calls of an update cycle share one connection */
+				http_set_option(request, HTTP_OPTION_KEEPALIVE, 1);
+			}
 		}
 	}
 
@@ -2646,10 +3593,10 @@ static ddns_error dnspod_send_command(
 	 */
 	if ( DDNS_ERROR_SUCCESS == error_code )
 	{
-		int result = http_get_response( request,
-										(http_callback)&dnspod_http2json,
-										json_ctx
-										);
+		int result = http_get_response_ex(	request,
+											(http_data_callback)&dnspod_http2json,
+											json_ctx
+											);
 		if ( 0 == result )
 		{
 			if ( ETIMEDOUT == ddns_socket_get_errno() )
@@ -2661,13 +3608,6 @@ static ddns_error dnspod_send_command(
 				error_code = DDNS_ERROR_CONNECTION;
 			}
 		}
-		else
-		{
-			if ( NULL != json_value )
-			{
-				(*json_value) = json_get_value(json_ctx);
-			}
-		}
 	}
 
 	/**
@@ -2684,8 +3624,6 @@ static ddns_error dnspod_send_command(
 	/**
 	 *	Step 8: Clean up.
 	 */
-	json_destroy_context(json_ctx);
-	json_ctx	= NULL;
 	http_destroy_request(request);
 	request		= NULL;
 
@@ -2694,111 +3632,528 @@ static ddns_error dnspod_send_command(
 
 
 /**
- *	HTTP callback function, it will be called for each received byte and
- *	transfer to byte to json parser.
+ *	HTTP callback function, it will be called for each received block and
+ *	transfer the bytes to json parser.
  */
 static void dnspod_http2json(
-	char						chr,
+	const char				*	data,
+	size_t						size,
 	struct json_context		*	context
 	)
 {
 	if ( NULL != context )
 	{
-		json_readchr(context, chr);
+		json_read(context, data, size);
 	}
 }
 
 
 /**
- *	HTTP callback function, it will be called for each received byte and
- *	keep the received bytes.
+ *	Json event handler which builds the record list from the response of
+ *	[DNSPOD_RECORD_LIST] command. The response looks like:
+ *
+ *		{"status":{"code":"1",...},...,"records":[{"id":"1",...},...]}
+ *
+ *	and before API 2.0, the array is "records.record". Members of a record are
+ *	copied as soon as they are parsed, the json tree is never built.
+ *
+ *	@return		Return 0 to continue parsing, otherwise the parsing is stopped
+ *				and [stream->error_code] keeps the reason.
  */
-static void dnspod_http2buffer(
-	char						chr,
-	struct dnspod_buffer	*	buffer
+static int dnspod_record_stream_callback(
+	enum json_event_type			event,
+	struct json_value			*	value,
+	struct dnspod_record_stream	*	stream
 	)
 {
-	if ( (NULL != buffer) && (NULL != buffer->buffer) )
+	const char				*	string	= json_string_get(value);
+	struct dnspod_record	*	record	= stream->record;
+
+	switch ( event )
 	{
-		if ( buffer->used < buffer->size )
+	case json_event_start_object:
+	case json_event_start_array:
+		if ( (0 != stream->list_depth) && (stream->list_depth == stream->depth) )
+		{
+			/* element of the records array */
+			if ( json_event_start_object != event )
+			{
+				stream->error_code = DDNS_ERROR_BADSVR;
+			}
+			else
+			{
+				record = malloc(sizeof(*record));
+				if ( NULL != record )
+				{
+					memset(record, 0, sizeof(*record));
+					stream->record = record;
+					stream->fields = 0;
+				}
+				else
+				{
+					stream->error_code = DDNS_ERROR_INSUFFICIENT_MEMORY;
+				}
+			}
+		}
+		else if (	(json_event_start_array == event)
+				&&	(0 == stream->has_list)
+				&&	(0 == strcmp(stream->section, "records")) )
+		{
+			if (	(stream->api_version >= DNSPOD_API_VERSION_2_0)
+				?	(1 == stream->depth)
+				:	((2 == stream->depth) && (0 == strcmp(stream->key, "record"))) )
+			{
+				stream->list_depth	= stream->depth + 1;
+				stream->has_list	= 1;
+			}
+		}
+		++(stream->depth);
+		break;
+
+	case json_event_end_object:
+	case json_event_end_array:
+		--(stream->depth);
+		if ( (NULL != record) && (stream->list_depth == stream->depth) )
+		{
+			if ( DNSPOD_FIELD_ALL == stream->fields )
+			{
+				*(stream->tail) = record;
+				stream->tail	= &(record->next);
+				stream->record	= NULL;
+			}
+			else
+			{
+				stream->error_code = DDNS_ERROR_BADSVR;
+			}
+		}
+		else if ( stream->list_depth == stream->depth + 1 )
+		{
+			/* end of the records array */
+			stream->list_depth = 0;
+		}
+		break;
+
+	case json_event_key:
+		c99_strncpy(stream->key, string, _countof(stream->key));
+		if ( 1 == stream->depth )
+		{
+			c99_strncpy(stream->section, string, _countof(stream->section));
+		}
+		break;
+
+	default:
+		if ( (0 != stream->list_depth) && (stream->list_depth == stream->depth) )
 		{
-			buffer->buffer[buffer->used] = chr;
-			++(buffer->used);
+			/* element of the records array must be an object */
+			stream->error_code = DDNS_ERROR_BADSVR;
+		}
+		else if (	(2 == stream->depth)
+				&&	(0 == strcmp(stream->section, "status"))
+				&&	(0 == strcmp(stream->key, "code")) )
+		{
+			if ( NULL != string )
+			{
+				c99_strncpy(stream->code, string, _countof(stream->code));
+			}
+		}
+		else if ( (NULL != record) && (stream->list_depth + 1 == stream->depth) )
+		{
+			unsigned int field = 0;
+
+			if ( 0 == strcmp(stream->key, "id") )
+			{
+				char * end = NULL;
+
+				field = DNSPOD_FIELD_ID;
+				if ( json_event_number == event )
+				{
+					record->host_id = (unsigned long)json_number_get(value);
+				}
+				else if ( (NULL != string) && ('\0' != string[0]) )
+				{
+					record->host_id = strtoul(string, &end, 10);
+					if ( '\0' != *end )
+					{
+						field = 0;
+					}
+				}
+				else
+				{
+					field = 0;
+				}
+			}
+			else if ( NULL == string )
+			{
+				/* other members are always strings */
+			}
+			else if ( 0 == strcmp(stream->key, "name") )
+			{
+				field = DNSPOD_FIELD_NAME;
+				c99_strncpy(record->name, string, _countof(record->name));
+			}
+			else if ( 0 == strcmp(stream->key, "line") )
+			{
+				field = DNSPOD_FIELD_LINE;
+				record->line = dnspod_get_record_line(stream->context, string);
+			}
+			else if ( 0 == strcmp(stream->key, "type") )
+			{
+				field = DNSPOD_FIELD_TYPE;
+				record->type = dnspod_get_record_type(string);
+			}
+			else if ( 0 == strcmp(stream->key, "ttl") )
+			{
+				field = DNSPOD_FIELD_TTL;
+				record->ttl = strtoul(string, NULL, 10);
+			}
+			else if ( 0 == strcmp(stream->key, "value") )
+			{
+				field = DNSPOD_FIELD_VALUE;
+				c99_strncpy(record->value, string, _countof(record->value));
+			}
+			else if ( 0 == strcmp(stream->key, "mx") )
+			{
+				field = DNSPOD_FIELD_MX;
+				record->mx = strtoul(string, NULL, 10);
+			}
+			else if ( 0 == strcmp(stream->key, "enabled") )
+			{
+				field = DNSPOD_FIELD_ENABLED;
+				record->enabled = (0 != atol(string));
+			}
+			else if ( 0 == strcmp(stream->key, "updated_on") )
+			{
+				field = DNSPOD_FIELD_UPDATED_ON;
+				c99_strncpy(record->last_update, string, _countof(record->last_update));
+			}
+			stream->fields |= field;
 		}
+		break;
 	}
+
+	return (DDNS_ERROR_SUCCESS == stream->error_code) ? 0 : -1;
 }
 
 
 /**
- *	Get domain information from the domain name list.
+ *	Calculate case-insensitive hash value of a name.
  *
- *	@param[in]	domain_list :	domain name list
- *	@param[in]	domain_name :	the domain name to be searched
- *
- *	@note		Ex.: [domain_name] = "www.website.com", it will search for
- *				domain "website.com"
+ *	@param[in]	type	: record type mixed into the hash, 0 for domains.
+ *	@param[in]	name	: the name to be hashed.
  *
- *	@return		Find domain and return information of the domain in the domain
- *				list. If it's not found, NULL will be returned.
+ *	@return		Return the 32-bit FNV-1a hash of the lower-cased name.
  */
-static const struct dnspod_domain * dnspod_find_domain(
-	const struct dnspod_domain	*	domain_list,
-	const char					*	domain_name
+static unsigned long dnspod_hash(
+	int							type,
+	const char				*	name
 	)
 {
-	const struct dnspod_domain * domain = NULL;
+	unsigned long hash = 2166136261UL;
 
-	/* Get domain of the domain name (exclude host name) */
-	if ( NULL != domain_name )
-	{
-		domain_name = ddns_strcasestr(domain_name, ".");
-		if ( NULL != domain_name )
-		{
-			++domain_name;
-		}
-	}
+	hash ^= (unsigned char)type;
+	hash = (hash * 16777619UL) & 0xFFFFFFFFUL;
 
-	/* Search domain name in the domain list */
-	if ( NULL != domain_name )
+	for ( ; '\0' != *name; ++name )
 	{
-		for ( ; NULL != domain_list; domain_list = domain_list->next )
-		{
-			if ( 0 == ddns_strcasecmp(domain_list->domain, domain_name) )
-			{
-				domain = domain_list;
-				break;
-			}
-		}
+		hash ^= (unsigned char)tolower((unsigned char)(*name));
+		hash = (hash * 16777619UL) & 0xFFFFFFFFUL;
 	}
 
-	return domain;
+	return hash;
 }
 
 
 /**
- *	Get DNS record information from the DNS record list.
+ *	Allocate an empty index large enough for [count] items.
  *
- *	@param[in]	host_list	:	domain name list
- *	@param[in]	record_type :	type of the record searching for.
- *	@param[in]	domain_name :	the domain name to be searched for.
- *
- *	@note		Ex.: if [domain_name] = "www.website.com", if will search for
- *				host "www".
+ *	@param[out]	index	: the index to be allocated, previous content of the
+ *						  index is freed.
+ *	@param[in]	count	: number of items to be indexed.
  *
- *	@return		Find DNS host and return information of the host in the host
- *				list. If it's not found, NULL will be returned.
+ *	@return		Return non-zero on success, otherwise 0 will be returned and
+ *				the index is left empty.
  */
-static const struct dnspod_record * dnspod_find_record(
-	const struct dnspod_record	*	host_list,
-	enum dnspod_record_type			record_type,
-	const char					*	domain_name
+static int dnspod_index_create(
+	struct dnspod_index		*	index,
+	unsigned long				count
 	)
 {
-	const struct dnspod_record	*	host	= NULL;
-	const char					*	domain	= NULL;
-	char							host_name[256];
+	unsigned long capacity = 8;
 
-	memset(host_name, 0, sizeof(host_name));
+	dnspod_index_destroy(index);
+
+	/* keep the table at most half full, so probing always terminates */
+	while ( capacity < count * 2 )
+	{
+		capacity <<= 1;
+	}
+
+	index->entries = (struct dnspod_index_entry*)calloc(capacity,
+														sizeof(*index->entries));
+	if ( NULL != index->entries )
+	{
+		index->capacity = capacity;
+	}
+
+	return NULL != index->entries;
+}
+
+
+/**
+ *	Free resources allocated for an index.
+ *
+ *	@param[in]	index	: the index to be freed.
+ */
+static void dnspod_index_destroy(struct dnspod_index * index)
+{
+	free(index->entries);
+	index->entries	= NULL;
+	index->capacity	= 0;
+}
+
+
+/**
+ *	Build index over a domain list, keyed by the case-folded domain name.
+ *
+ *	@param[out]	index	: the index to be built.
+ *	@param[in]	list	: the domain list.
+ *
+ *	@note		If a domain appears more than once, the first one wins, which
+ *				is what a linear search of the list finds.
+ */
+static void dnspod_index_domains(
+	struct dnspod_index			*	index,
+	const struct dnspod_domain	*	list
+	)
+{
+	const struct dnspod_domain	*	domain	= NULL;
+	unsigned long					count	= 0;
+
+	for ( domain = list; NULL != domain; domain = domain->next )
+	{
+		++count;
+	}
+
+	if ( 0 == dnspod_index_create(index, count) )
+	{
+		return;
+	}
+
+	for ( count = 0, domain = list; NULL != domain; domain = domain->next )
+	{
+		unsigned long	hash	= dnspod_hash(0, domain->domain);
+		unsigned long	mask	= index->capacity - 1;
+		unsigned long	slot	= hash & mask;
+
+		for ( ; NULL != index->entries[slot].item; slot = (slot + 1) & mask )
+		{
+			const struct dnspod_domain * item = index->entries[slot].item;
+
+			if (	(hash == index->entries[slot].hash)
+				&&	(0 == ddns_strcasecmp(item->domain, domain->domain)) )
+			{
+				break;
+			}
+		}
+
+		if ( NULL == index->entries[slot].item )
+		{
+			index->entries[slot].hash	= hash;
+			index->entries[slot].order	= count;
+			index->entries[slot].item	= domain;
+		}
+		++count;
+	}
+}
+
+
+/**
+ *	Build index over a DNS record list, keyed by record type and the
+ *	case-folded host name.
+ *
+ *	@param[out]	index	: the index to be built.
+ *	@param[in]	list	: the DNS record list.
+ *
+ *	@note		If several records share the same type and name (e.g. the
+ *				same host on different lines), the first one wins, which is
+ *				what a linear search of the list finds.
+ */
+static void dnspod_index_records(
+	struct dnspod_index			*	index,
+	const struct dnspod_record	*	list
+	)
+{
+	const struct dnspod_record	*	record	= NULL;
+	unsigned long					count	= 0;
+
+	for ( record = list; NULL != record; record = record->next )
+	{
+		++count;
+	}
+
+	if ( 0 == dnspod_index_create(index, count) )
+	{
+		return;
+	}
+
+	for ( count = 0, record = list; NULL != record; record = record->next )
+	{
+		unsigned long	hash	= dnspod_hash(record->type, record->name);
+		unsigned long	mask	= index->capacity - 1;
+		unsigned long	slot	= hash & mask;
+
+		for ( ; NULL != index->entries[slot].item; slot = (slot + 1) & mask )
+		{
+			const struct dnspod_record * item = index->entries[slot].item;
+
+			if (	(hash == index->entries[slot].hash)
+				&&	(item->type == record->type)
+				&&	(0 == ddns_strcasecmp(item->name, record->name)) )
+			{
+				break;
+			}
+		}
+
+		if ( NULL == index->entries[slot].item )
+		{
+			index->entries[slot].hash	= hash;
+			index->entries[slot].order	= count;
+			index->entries[slot].item	= record;
+		}
+		++count;
+	}
+}
+
+
+/**
+ *	Look up a DNS record in the record index.
+ *
+ *	@param[in]	index		: the record index.
+ *	@param[in]	record_type : type of the record searching for.
+ *	@param[in]	host_name	: the host name searching for.
+ *
+ *	@return		Return the index slot of the record, or NULL if not found.
+ */
+static const struct dnspod_index_entry * dnspod_index_find_record(
+	const struct dnspod_index	*	index,
+	enum dnspod_record_type			record_type,
+	const char					*	host_name
+	)
+{
+	unsigned long	hash	= dnspod_hash(record_type, host_name);
+	unsigned long	mask	= index->capacity - 1;
+	unsigned long	slot	= hash & mask;
+
+	for ( ; NULL != index->entries[slot].item; slot = (slot + 1) & mask )
+	{
+		const struct dnspod_record * item = index->entries[slot].item;
+
+		if (	(hash == index->entries[slot].hash)
+			&&	(item->type == record_type)
+			&&	(0 == ddns_strcasecmp(item->name, host_name)) )
+		{
+			return &index->entries[slot];
+		}
+	}
+
+	return NULL;
+}
+
+
+/**
+ *	Get domain information from the domain name list.
+ *
+ *	@param[in]	domain_list :	domain name list
+ *	@param[in]	index		:	index over [domain_list], it's safe to pass
+ *								NULL if the list isn't indexed.
+ *	@param[in]	domain_name :	the domain name to be searched
+ *
+ *	@note		Ex.: [domain_name] = "www.website.com", it will search for
+ *				domain "website.com"
+ *
+ *	@return		Find domain and return information of the domain in the domain
+ *				list. If it's not found, NULL will be returned.
+ */
+static const struct dnspod_domain * dnspod_find_domain(
+	const struct dnspod_domain	*	domain_list,
+	const struct dnspod_index	*	index,
+	const char					*	domain_name
+	)
+{
+	const struct dnspod_domain * domain = NULL;
+
+	/* Get domain of the domain name (exclude host name) */
+	if ( NULL != domain_name )
+	{
+		domain_name = ddns_strcasestr(domain_name, ".");
+		if ( NULL != domain_name )
+		{
+			++domain_name;
+		}
+	}
+
+	/* Search domain name in the domain list */
+	if ( (NULL != domain_name) && (NULL != index) && (0 != index->capacity) )
+	{
+		unsigned long	hash	= dnspod_hash(0, domain_name);
+		unsigned long	mask	= index->capacity - 1;
+		unsigned long	slot	= hash & mask;
+
+		for ( ; NULL != index->entries[slot].item; slot = (slot + 1) & mask )
+		{
+			const struct dnspod_domain * item = index->entries[slot].item;
+
+			if (	(hash == index->entries[slot].hash)
+				&&	(0 == ddns_strcasecmp(item->domain, domain_name)) )
+			{
+				domain = item;
+				break;
+			}
+		}
+	}
+	else if ( NULL != domain_name )
+	{
+		for ( ; NULL != domain_list; domain_list = domain_list->next )
+		{
+			if ( 0 == ddns_strcasecmp(domain_list->domain, domain_name) )
+			{
+				domain = domain_list;
+				break;
+			}
+		}
+	}
+
+	return domain;
+}
+
+
+/**
+ *	Get DNS record information from the DNS record list.
+ *
+ *	@param[in]	host_list	:	domain name list
+ *	@param[in]	index		:	index over [host_list], it's safe to pass NULL
+ *								if the list isn't indexed.
+ *	@param[in]	record_type :	type of the record searching for.
+ *	@param[in]	domain_name :	the domain name to be searched for.
+ *
+ *	@note		Ex.: if [domain_name] = "www.website.com", if will search for
+ *				host "www".
+ *
+ *	@return		Find DNS host and return information of the host in the host
+ *				list. If it's not found, NULL will be returned.
+ */
+static const struct dnspod_record * dnspod_find_record(
+	const struct dnspod_record	*	host_list,
+	const struct dnspod_index	*	index,
+	enum dnspod_record_type			record_type,
+	const char					*	domain_name
+	)
+{
+	const struct dnspod_record	*	host	= NULL;
+	const char					*	domain	= NULL;
+	char							host_name[256];
+
+	memset(host_name, 0, sizeof(host_name));
 
 	/* Get host name from domain name */
 	if ( NULL != domain_name )
@@ -2821,7 +4176,33 @@ static const struct dnspod_record * dnspod_find_record(
 		}
 	}
 
-	if ( NULL != domain )
+	if ( (NULL != domain) && (NULL != index) && (0 != index->capacity) )
+	{
+		const struct dnspod_index_entry *	entry	= NULL;
+		const struct dnspod_index_entry *	any		= NULL;
+
+		/**
+		 *	Records of type [DNSPOD_RECORD_TYPE_ALL] match any requested type,
+		 *	take the one comes first in the list if both are present.
+		 */
+		entry = dnspod_index_find_record(index, record_type, host_name);
+		if ( DNSPOD_RECORD_TYPE_ALL != record_type )
+		{
+			any = dnspod_index_find_record(	index,
+											DNSPOD_RECORD_TYPE_ALL,
+											host_name
+											);
+			if ( (NULL == entry) || ((NULL != any) && (any->order < entry->order)) )
+			{
+				entry = any;
+			}
+		}
+		if ( NULL != entry )
+		{
+			host = entry->item;
+		}
+	}
+	else if ( NULL != domain )
 	{
 		for ( ; NULL != host_list; host_list = host_list->next )
 		{
@@ -2861,99 +4242,424 @@ static ddns_error dnspod_get_ip_address(
 	int						buffer_size
 	)
 {
-	struct dnspod_getip_table_entry FUNC_TABLE[] =
-	{
-#if defined(DNSPOD_USE_DNSPOD) && DNSPOD_USE_DNSPOD > 0
-		{ "DNSPod", "http://www.dnspod.cn/About/IP",		DNSPOD_USE_DNSPOD,	&dnspod_get_ip_address_dnspod	},
-#endif
-#if defined(DNSPOD_USE_BAIDU) && DNSPOD_USE_BAIDU > 0
-		{ "Baidu",	"http://www.baidu.com/s?wd=ip",			DNSPOD_USE_BAIDU,	&dnspod_get_ip_address_baidu	},
-#endif
-#if defined(DNSPOD_USE_IP138) && DNSPOD_USE_IP138 > 0
-		{ "IP138",	"http://iframe.ip138.com/ipcity.asp",	DNSPOD_USE_IP138,	&dnspod_get_ip_address_ip138	},
-#endif
-		{ NULL,		NULL,									INT_MAX,			NULL							}
-	};
-
-	struct dnspod_buffer	buffer;
-	struct http_request *	request		= NULL;
+	struct dnspod_getip_table_entry FUNC_TABLE[_countof(dnspod_getip_table)];
+	struct dnspod_context *	dnspod		= NULL;
 	ddns_error				error_code	= DDNS_ERROR_SUCCESS;
-	char					server_buffer[1024 * 100];
+	int						func_cnt	= sizeof(FUNC_TABLE)/sizeof(FUNC_TABLE[0]) - 1;
 	int						func_idx	= 0;
+	int						race_cnt	= 0;
+	int						raced		= 0;
 
 	/**
 	 *	Step 1: argument validity check.
 	 */
 	if ( (NULL == context) || (NULL == text_buffer) || (buffer_size < 16) )
 	{
-		error_code = DDNS_ERROR_BADARG;
+		return DDNS_ERROR_BADARG;
+	}
+
+	dnspod = (struct dnspod_context*)context->extra_data;
+	if ( (NULL == dnspod) || (NULL == dnspod->getip_matcher) )
+	{
+		return DDNS_ERROR_UNINIT;
 	}
 
 	/**
-	 *	Step 2: sort list of servers for getting IP address.
+	 *	Step 2: sort list of servers for getting IP address. A server which
+	 *			answered fast is preferred, every failure costs a timeout.
+	 *			Servers never queried keep their priority and go first. Pages
+	 *			of all servers are scraped by the same signature matcher.
 	 */
-	qsort(FUNC_TABLE, sizeof(FUNC_TABLE)/sizeof(FUNC_TABLE[0]) - 1, sizeof(FUNC_TABLE[0]), (void*)&dnspod_compare_entry);
+	memcpy(FUNC_TABLE, dnspod_getip_table, sizeof(FUNC_TABLE));
+	for (func_idx = 0; func_idx < func_cnt; ++func_idx)
+	{
+		struct dnspod_getip_stats * stats = NULL;
+
+		FUNC_TABLE[func_idx].matcher = dnspod->getip_matcher;
+
+		if (	(NULL != FUNC_TABLE[func_idx].url)
+			&&	(func_idx < DNSPOD_GETIP_MAX_SERVER) )
+		{
+			stats = &(dnspod->getip_stats[func_idx]);
+			FUNC_TABLE[func_idx].stats = stats;
+		}
+		if ( (NULL != stats) && (0 != stats->attempts) )
+		{
+			FUNC_TABLE[func_idx].cost = stats->latency
+									  + stats->failures * context->timeout * 1000UL
+									  / stats->attempts;
+		}
+		else if ( NULL != stats )
+		{
+			FUNC_TABLE[func_idx].cost = stats->latency;
+		}
+	}
+	qsort(FUNC_TABLE, func_cnt, sizeof(FUNC_TABLE[0]), (void*)&dnspod_compare_entry);
 
 	/**
-	 *	Step 3: get IP address.
+	 *	Step 3: get IP address. The configured network interface goes first,
+	 *			then race the first [DNSPOD_GETIP_RACE] servers, and try the
+	 *			others one by one.
 	 */
 	error_code = DDNS_ERROR_NO_SERVER;
-	for (func_idx = 0; func_idx < sizeof(FUNC_TABLE)/sizeof(FUNC_TABLE[0]); ++func_idx)
+	for (func_idx = 0; func_idx < func_cnt; func_idx += race_cnt)
 	{
-		int retry_count = 1;
-		char url[DNSPOD_MAX_URL_LENGTH];
+		if ( NULL == FUNC_TABLE[func_idx].url )
+		{
+			race_cnt = 1;
+			if ( '\0' == context->netif[0] )
+			{
+				continue;
+			}
+		}
+		else
+		{
+			race_cnt = (0 == raced) ? DNSPOD_GETIP_RACE : 1;
+			raced = 1;
+		}
+		if ( race_cnt > func_cnt - func_idx )
+		{
+			race_cnt = func_cnt - func_idx;
+		}
 
-		if (NULL == FUNC_TABLE[func_idx].name)
+		error_code = dnspod_get_ip_address_race(context,
+												&FUNC_TABLE[func_idx],
+												race_cnt,
+												text_buffer,
+												buffer_size
+												);
+		if (DDNS_ERROR_SUCCESS == error_code)
 		{
 			break;
 		}
+	}
 
-		c99_strncpy(url, FUNC_TABLE[func_idx].url, sizeof(url));
+	return error_code;
+}
 
-		ddns_printf_v(context, msg_type_info, "[%s] ", FUNC_TABLE[func_idx].name);
 
-		for ( ; retry_count >= 0; --retry_count)
+/**
+ *	Query several servers at the same time for the internet IP address of
+ *	local computer, the first [DNSPOD_GETIP_QUORUM] agreeing answers win and
+ *	the other queries are cancelled. Statistics of the servers are updated.
+ *
+ *	@param[in]	context		: the DDNS context.
+ *	@param[in]	entries		: the servers to query.
+ *	@param[in]	entry_cnt	: number of servers in [entries].
+ *	@param[out] text_buffer : buffer to save the IP address.
+ *	@param[in]	buffer_size : size of the buffer.
+ *
+ *	@return		Return [DNSPOD_ERROR_SUCCESS] if successfully get the internet
+ *				IP address, otherwise return the error of the first server.
+ */
+static ddns_error dnspod_get_ip_address_race(
+	struct ddns_context						*	context,
+	const struct dnspod_getip_table_entry	*	entries,
+	int											entry_cnt,
+	char									*	text_buffer,
+	int											buffer_size
+	)
+{
+	ddns_error					error_code	= DDNS_ERROR_SUCCESS;
+	struct dnspod_getip_race	race;
+	int							idx			= 0;
+	int							thread_cnt	= 0;
+
+	memset(&race, 0, sizeof(race));
+	race.context	= context;
+	race.racer_cnt	= (entry_cnt < DNSPOD_GETIP_RACE) ? entry_cnt : DNSPOD_GETIP_RACE;
+	race.quorum		= (race.racer_cnt < DNSPOD_GETIP_QUORUM) ? race.racer_cnt : DNSPOD_GETIP_QUORUM;
+
+	for (idx = 0; idx < race.racer_cnt; ++idx)
+	{
+		race.racers[idx].race		= &race;
+		race.racers[idx].entry		= &entries[idx];
+		race.racers[idx].error_code	= DDNS_ERROR_PENDING;
+		ddns_printf_v(context, msg_type_info, "[%s] ", entries[idx].name);
+	}
+
+	/**
+	 *	Step 1: query the servers, this thread queries the first one.
+	 */
+	ddns_sync_init(&race.sync_object);
+
+	for (thread_cnt = 1; thread_cnt < race.racer_cnt; ++thread_cnt)
+	{
+		if ( 0 != ddns_sync_thread_create(&race.racers[thread_cnt].thread,
+										  &dnspod_get_ip_address_racer,
+										  &race.racers[thread_cnt]
+										  ) )
 		{
-			memset(&buffer, 0, sizeof(buffer));
-			memset(text_buffer, 0, buffer_size);
-			memset(&server_buffer, 0, sizeof(server_buffer));
-			buffer.buffer	= server_buffer;
-			buffer.used		= 0;
-			buffer.size		= sizeof(server_buffer);
+			break;
+		}
+	}
 
-			error_code = DDNS_ERROR_SUCCESS;
+	/* racers that failed to start never answer, count the started ones only */
+	ddns_sync_lock(&race.sync_object);
+	race.racer_cnt	= thread_cnt;
+	race.quorum		= (thread_cnt < DNSPOD_GETIP_QUORUM) ? thread_cnt : DNSPOD_GETIP_QUORUM;
+	dnspod_get_ip_address_judge(&race);
+	ddns_sync_unlock(&race.sync_object);
 
-			/**
-			 *	Step 2.1: construct HTTP request.
-			 */
-			if ( DDNS_ERROR_SUCCESS == error_code )
+	dnspod_get_ip_address_racer(&race.racers[0]);
+
+	for (idx = 1; idx < thread_cnt; ++idx)
+	{
+		ddns_sync_thread_join(&race.racers[idx].thread);
+	}
+
+	ddns_sync_destroy(&race.sync_object);
+
+	/**
+	 *	Step 2: update statistics. A cancelled server is at least as slow as
+	 *			the time it has spent.
+	 */
+	for (idx = 0; idx < thread_cnt; ++idx)
+	{
+		const struct dnspod_getip_racer	*	racer = &race.racers[idx];
+		struct dnspod_getip_stats		*	stats = racer->entry->stats;
+
+		if ( NULL == stats )
+		{
+			continue;
+		}
+
+		if ( 0 == racer->cancelled )
+		{
+			++(stats->attempts);
+			if ( DDNS_ERROR_SUCCESS != racer->error_code )
 			{
-				request = http_create_request(	http_method_get,
-												url,
-												context->timeout
-												);
-				if ( NULL == request )
-				{
-					error_code = DDNS_ERROR_BADURL;
-				}
-				else
-				{
-					http_set_option(request, HTTP_OPTION_REDIRECT, 5);
-				}
+				++(stats->failures);
+			}
+		}
+		if ( (0 != racer->cancelled) || (DDNS_ERROR_SUCCESS == racer->error_code) )
+		{
+			stats->latency = (0 == stats->samples)
+						   ? racer->latency
+						   : (stats->latency * 3 + racer->latency) / 4;
+			++(stats->samples);
+		}
+	}
+
+	/**
+	 *	Step 3: get the answer.
+	 */
+	if ( 0 != race.stop )
+	{
+		c99_strncpy(text_buffer, race.address, buffer_size);
+	}
+	else
+	{
+		/* no quorum, or the first server's error */
+		error_code = race.racers[0].error_code;
+		for (idx = 0; idx < thread_cnt; ++idx)
+		{
+			if ( DDNS_ERROR_SUCCESS == race.racers[idx].error_code )
+			{
+				error_code = DDNS_ERROR_BADSVR;
+				break;
+			}
+		}
+	}
+
+	return error_code;
+}
+
+
+/**
+ *	Worker of [dnspod_get_ip_address_race], it queries one server.
+ *
+ *	@param[in/out]	param		: the [dnspod_getip_racer].
+ */
+static void dnspod_get_ip_address_racer(
+	void					*	param
+	)
+{
+	struct dnspod_getip_racer	*	racer	= (struct dnspod_getip_racer*)param;
+	struct dnspod_getip_race	*	race	= racer->race;
+	ddns_ulong32					started	= ddns_sync_clock();
+	ddns_error						error	= DDNS_ERROR_SUCCESS;
+	char							address[16];
+
+	memset(address, 0, sizeof(address));
+
+	error = dnspod_get_ip_address_from(	race->context,
+										racer->entry,
+										address,
+										sizeof(address),
+										&race->stop
+										);
+
+	ddns_sync_lock(&race->sync_object);
+
+	racer->latency		= ddns_sync_clock() - started;
+	racer->error_code	= error;
+	if ( DDNS_ERROR_SUCCESS == error )
+	{
+		c99_strncpy(racer->address, address, sizeof(racer->address));
+		dnspod_get_ip_address_judge(race);
+	}
+	else if ( 0 != race->stop )
+	{
+		racer->cancelled = 1;
+	}
+
+	ddns_sync_unlock(&race->sync_object);
+}
+
+
+/**
+ *	Decide a race of [dnspod_get_ip_address_race] once an answer is agreed by
+ *	[quorum] of the servers. The race must be locked by the caller.
+ *
+ *	@param[in/out]	race		: the [dnspod_getip_race].
+ */
+static void dnspod_get_ip_address_judge(
+	struct dnspod_getip_race	*	race
+	)
+{
+	int agreed	= 0;
+	int idx		= 0;
+	int other	= 0;
+
+	for (idx = 0; (0 == race->stop) && (idx < race->racer_cnt); ++idx)
+	{
+		if ( DDNS_ERROR_SUCCESS != race->racers[idx].error_code )
+		{
+			continue;
+		}
+
+		agreed = 0;
+		for (other = 0; other < race->racer_cnt; ++other)
+		{
+			if (	(DDNS_ERROR_SUCCESS == race->racers[other].error_code)
+				&&	(0 == strcmp(race->racers[other].address,
+								 race->racers[idx].address)) )
+			{
+				++agreed;
+			}
+		}
+		if ( agreed >= race->quorum )
+		{
+			c99_strncpy(race->address,
+						race->racers[idx].address,
+						sizeof(race->address)
+						);
+			race->stop = 1;
+		}
+	}
+}
+
+
+/**
+ *	Get internet IP address of local computer from one server.
+ *
+ *	@param[in]	context		: the DDNS context.
+ *	@param[in]	entry		: the server to query, if its URL is NULL, the
+ *							  network interface of [context] is read.
+ *	@param[out] text_buffer : buffer to save the IP address.
+ *	@param[in]	buffer_size : size of the buffer.
+ *	@param[in]	stop_wait	: pointer to the stop signal, it gives up as soon
+ *							  as the signal is set to non-zero. May be NULL.
+ *
+ *	@return		Return [DNSPOD_ERROR_SUCCESS] if successfully get the internet
+ *				IP address, otherwise return an error code.
+ */
+static ddns_error dnspod_get_ip_address_from(
+	struct ddns_context						*	context,
+	const struct dnspod_getip_table_entry	*	entry,
+	char									*	text_buffer,
+	int											buffer_size,
+	int										*	stop_wait
+	)
+{
+	struct dnspod_getip_stream	stream;
+	struct http_request		*	request		= NULL;
+	ddns_error					error_code	= DDNS_ERROR_SUCCESS;
+	int							retry_count = 1;
+	char						url[DNSPOD_MAX_URL_LENGTH];
+
+	/* the local network interface, no HTTP request is required */
+	if ( NULL == entry->url )
+	{
+		return ddns_get_interface_address(context->netif, text_buffer, buffer_size);
+	}
+
+	c99_strncpy(url, entry->url, sizeof(url));
+
+	for ( ; retry_count >= 0; --retry_count)
+	{
+		memset(text_buffer, 0, buffer_size);
+
+		error_code = DDNS_ERROR_SUCCESS;
+
+		/* someone else has answered */
+		if ( (NULL != stop_wait) && (0 != (*stop_wait)) )
+		{
+			error_code = DDNS_ERROR_TIMEOUT;
+			break;
+		}
+
+		/**
+		 *	Step 1: construct HTTP request.
+		 */
+		if ( DDNS_ERROR_SUCCESS == error_code )
+		{
+			request = http_create_request(	http_method_get,
+											url,
+											context->timeout
+											);
+			if ( NULL == request )
+			{
+				error_code = DDNS_ERROR_BADURL;
+			}
+			else
+			{
+				http_set_option(request, HTTP_OPTION_REDIRECT, 5);
+				http_set_stop_signal(request, stop_wait);
+			}
+		}
+
+		/**
+		 *	Step 2: connect to server.
+		 */
+		if ( DDNS_ERROR_SUCCESS == error_code )
+		{
+			int result = http_connect(request);
+			switch( result )
+			{
+			case 0:
+				/* successful, do nothing */
+				break;
+
+			case ETIMEDOUT:
+				error_code = DDNS_ERROR_TIMEOUT;
+				break;
+
+			case ENETUNREACH:
+				error_code = DDNS_ERROR_UNREACHABLE;
+				break;
+
+			default:
+				error_code = DDNS_ERROR_CONNECTION;
+				break;
+			}
+		}
+
+		/**
+		 *	Step 3: send request to server via HTTP.
+		 */
+		if ( DDNS_ERROR_SUCCESS == error_code )
+		{
+			int http_status = http_send_request(request, NULL, 0);
+			if ( 302 == http_status )
+			{
+				error_code = DDNS_ERROR_BADSVR;
 			}
-
-			/**
-			 *	Step 2.2: connect to server.
-			 */
-			if ( DDNS_ERROR_SUCCESS == error_code )
+			else if ( (http_status < 200) || (http_status >= 300) )
 			{
-				int result = http_connect(request);
-				switch( result )
+				switch( ddns_socket_get_errno() )
 				{
-				case 0:
-					/* successful, do nothing */
-					break;
-
 				case ETIMEDOUT:
 					error_code = DDNS_ERROR_TIMEOUT;
 					break;
@@ -2967,139 +4673,68 @@ static ddns_error dnspod_get_ip_address(
 					break;
 				}
 			}
+		}
 
-			/**
-			 *	Step 2.3: send request to server via HTTP.
-			 */
-			if ( DDNS_ERROR_SUCCESS == error_code )
-			{
-				int http_status = http_send_request(request, NULL, 0);
-				if ( 302 == http_status )
-				{
-					error_code = DDNS_ERROR_BADSVR;
-				}
-				else if ( (http_status < 200) || (http_status >= 300) )
-				{
-					switch( ddns_socket_get_errno() )
-					{
-					case ETIMEDOUT:
-						error_code = DDNS_ERROR_TIMEOUT;
-						break;
-
-					case ENETUNREACH:
-						error_code = DDNS_ERROR_UNREACHABLE;
-						break;
-
-					default:
-						error_code = DDNS_ERROR_CONNECTION;
-						break;
-					}
-				}
-			}
-
-			/**
-			 *	Step 2.4: get response from server via HTTP.
-			 */
-			if ( DDNS_ERROR_SUCCESS == error_code )
-			{
-				int result = http_get_response(request,
-											   (http_callback)&dnspod_http2buffer,
-											   &buffer
-											   );
-				if ( 0 == result )
-				{
-					if ( ETIMEDOUT == ddns_socket_get_errno() )
-					{
-						error_code = DDNS_ERROR_TIMEOUT;
-					}
-					else
-					{
-						error_code = DDNS_ERROR_CONNECTION;
-					}
-				}
-			}
-
-			/**
-			 *	Step 2.5: parse IP address from server response.
-			 */
-			if (DDNS_ERROR_SUCCESS == error_code)
-			{
-				error_code = (*FUNC_TABLE[func_idx].func)(&buffer, text_buffer, buffer_size);
-			}
-
-			/**
-			 *	Step 2.6: IP address validity check.
-			 */
-			if ( DDNS_ERROR_SUCCESS == error_code )
+		/**
+		 *	Step 4: get response from server via HTTP, the page is scraped as
+		 *			it arrives, the rest of it is skipped once it's answered.
+		 */
+		if ( DDNS_ERROR_SUCCESS == error_code )
+		{
+			int result = 0;
+
+			dnspod_getip_stream_init(&stream, entry->matcher, entry->rules, request);
+			result = http_get_response_ex(request,
+										  (http_data_callback)&dnspod_getip_stream_read,
+										  &stream
+										  );
+			if ( 0 == result )
 			{
-				int d1 = 0;
-				int d2 = 0;
-				int d3 = 0;
-				int d4 = 0;
-
-				if ( '\0' != text_buffer[0] )
-				{
-					char extra_chr = 0;
-					if ( 4 != sscanf(text_buffer, "%d.%d.%d.%d%c", &d1, &d2, &d3, &d4, &extra_chr) )
-					{
-						d1 = 0;
-						d2 = 0;
-						d3 = 0;
-						d4 = 0;
-					}
-				}
-
-				/* If it's a valid IP address? */
-				if (	(d1 < 0) || (d1 >= 256) || (d2 < 0) || (d2 >= 256)
-					||	(d3 < 0) || (d3 >= 256) || (d4 < 0) || (d4 >= 256)
-					||	((0 == d1) && (0 == d2) && (0 == d3) && (0 == d4))
-					||	((255 == d1) && (255 == d2) && (255 == d3) && (255 == d4)) )
-				{
-					error_code = DDNS_ERROR_BADSVR;
-				}
-
-				/* If it's a intranet address? */
-				if (	(10 == d1)
-					||	((172 == d1) && (16 <= d2) && (31>= d2))
-					||	((192 == d1) && (168 == d2) && (0 == d3))
-					||	((169 == d1) && (254 == d2)) )
+				if ( ETIMEDOUT == ddns_socket_get_errno() )
 				{
-					error_code = DDNS_ERROR_BADSVR;
+					error_code = DDNS_ERROR_TIMEOUT;
 				}
-			}
-
-			if (DDNS_ERROR_SUCCESS == error_code)
-			{
-				break;
-			}
-			else if (DDNS_ERROR_BADSVR == error_code)
-			{
-				break;
-			}
-			else
-			{
-				if (DDNS_ERROR_REDIRECT == error_code)
+				else
 				{
-					memset(url, 0, sizeof(url));
-					c99_strncpy(url, server_buffer, buffer.used < sizeof(url) ? buffer.used : sizeof(url));
+					error_code = DDNS_ERROR_CONNECTION;
 				}
-
-				http_destroy_request(request);
-				request = NULL;
 			}
+		}
 
-		}	/* for ( ; retry_count > 0; --retry_count) */
+		/**
+		 *	Step 5: take the IP address, it's validated as it's scraped.
+		 */
+		if (DDNS_ERROR_SUCCESS == error_code)
+		{
+			dnspod_getip_stream_end(&stream);
+			error_code = stream.error_code;
+		}
+		if (DDNS_ERROR_SUCCESS == error_code)
+		{
+			c99_strncpy(text_buffer, stream.token, buffer_size);
+		}
 
 		if (DDNS_ERROR_SUCCESS == error_code)
 		{
 			break;
 		}
+		else if (DDNS_ERROR_BADSVR == error_code)
+		{
+			break;
+		}
+		else
+		{
+			if (DDNS_ERROR_REDIRECT == error_code)
+			{
+				c99_strncpy(url, stream.token, sizeof(url));
+			}
+
+			http_destroy_request(request);
+			request = NULL;
+		}
 
-	}	/* for (func_idx = 0; ... */
+	}	/* for ( ; retry_count > 0; --retry_count) */
 
-	/**
-	 *	Step 4: clean up
-	 */
 	http_destroy_request(request);
 	request = NULL;
 
@@ -3107,7 +4742,8 @@ static ddns_error dnspod_get_ip_address(
 }
 
 /**
- *	Compare priority of 2 servers for getting IP address.
+ *	Compare priority of 2 servers for getting IP address, the one of less
+ *	cost goes first, see [dnspod_get_ip_address].
  *
  *	@param[in]	entry1	: the first server record
  *	@param[in]	entry2	: the second server record
@@ -3122,7 +4758,11 @@ static int dnspod_compare_entry(
 	const struct dnspod_getip_table_entry * entry2
 	)
 {
-	if (entry1->priority < entry2->priority)
+	if (entry1->cost != entry2->cost)
+	{
+		return (entry1->cost < entry2->cost) ? -1 : 1;
+	}
+	else if (entry1->priority < entry2->priority)
 	{
 		return -1;
 	}
@@ -3137,193 +4777,252 @@ static int dnspod_compare_entry(
 }
 
 /**
- *	Parse server response when getting IP address from server.
+ *	Build the matcher of signatures of servers for getting IP address.
  *
- *	@param[in/out]	server_buffer	: server response
- *	@param[out]		text_buffer		: parsed ip address
- *	@param[in]		buffer_size		: size of text_buffer in bytes
+ *	@param[out]	matcher		: the matcher to be initialized.
+ *	@param[in]	entries		: the servers, ended by a NULL name.
  *
- *	@return The following value may be returned:
- *				- DDNS_ERROR_SUCCESS:	legal server response is detected
- *				- DDNS_ERROR_REDIRECT:	redirection is required, redirect URL
- *										is saved in server_buffer.
- *				- Others:				error occurred.
+ *	@return		Return 0 on success, otherwise the signatures are too many.
  */
-static ddns_error dnspod_get_ip_address_dnspod(
-	struct dnspod_buffer	*	server_buffer,
-	char					*	text_buffer,
-	int							buffer_size
+static int dnspod_getip_matcher_init(
+	struct dnspod_getip_matcher				*	matcher,
+	const struct dnspod_getip_table_entry	*	entries
 	)
 {
-	ddns_error error_code = DDNS_ERROR_SUCCESS;
+	const char		*	signatures[DDNS_MATCHER_MAX_PATTERN];
+	unsigned int		count	= 0;
+	int					result	= 0;
 
-	if (NULL == server_buffer || NULL == server_buffer->buffer || NULL == text_buffer)
-	{
-		error_code = DDNS_ERROR_BADARG;
-	}
-	else
+	memset(matcher, 0, sizeof(*matcher));
+
+	for ( ; (0 == result) && (NULL != entries->name); ++entries )
 	{
-		int length = server_buffer->used + 1;
-		if (length > buffer_size)
+		const struct dnspod_getip_rule * rule = entries->rules;
+
+		for ( ; (NULL != rule) && (NULL != rule->signature); ++rule )
 		{
-			length = buffer_size;
+			if ( count >= _countof(signatures) )
+			{
+				result = -1;
+				break;
+			}
+			signatures[count]		= rule->signature;
+			matcher->rules[count]	= rule;
+			++count;
 		}
+	}
 
-		c99_strncpy(text_buffer, server_buffer->buffer, length);
+	if ( 0 == result )
+	{
+		result = ddns_matcher_init(&(matcher->matcher), signatures, count);
 	}
 
-	return error_code;
+	return result;
 }
 
+
 /**
- *	Parse server response when getting IP address from server.
+ *	Start scraping a page for the IP address.
  *
- *	@param[in/out]	server_buffer	: server response
- *	@param[out]		text_buffer		: parsed ip address
- *	@param[in]		buffer_size		: size of text_buffer in bytes
- *
- *	@return The following value may be returned:
- *				- DDNS_ERROR_SUCCESS:	legal server response is detected
- *				- DDNS_ERROR_REDIRECT:	redirection is required, redirect URL
- *										is saved in server_buffer.
- *				- Others:				error occurred.
+ *	@param[out]	stream	: the scraping state.
+ *	@param[in]	matcher	: signatures of all servers.
+ *	@param[in]	rules	: rules of the page, ended by a NULL signature.
+ *	@param[in]	request	: the request of the page, its response is stopped
+ *						  as soon as the page is answered.
  */
-static ddns_error dnspod_get_ip_address_baidu(
-	struct dnspod_buffer	*	server_buffer,
-	char					*	text_buffer,
-	int							buffer_size
+static void dnspod_getip_stream_init(
+	struct dnspod_getip_stream			*	stream,
+	const struct dnspod_getip_matcher	*	matcher,
+	const struct dnspod_getip_rule		*	rules,
+	struct http_request					*	request
 	)
 {
-	static const char signature[] = ",query:'ip',key:'";
+	const struct dnspod_getip_rule * rule = NULL;
 
-	ddns_error error_code = DDNS_ERROR_SUCCESS;
+	memset(stream, 0, sizeof(*stream));
+	stream->request		= request;
+	stream->matcher		= matcher;
+	stream->rules		= rules;
+	stream->error_code	= DDNS_ERROR_PENDING;
 
-	if (NULL == server_buffer || NULL == server_buffer->buffer || NULL == text_buffer)
-	{
-		error_code = DDNS_ERROR_BADARG;
-	}
-	else
+	/* a token without signature starts at the first byte */
+	for ( rule = rules; NULL != rule->signature; ++rule )
 	{
-		const char * str = NULL;
-		if (server_buffer->used < server_buffer->size)
+		if ( '\0' == rule->signature[0] )
 		{
-			server_buffer->buffer[server_buffer->used] = 0;
+			stream->rule = rule;
+			break;
 		}
-		else
+	}
+}
+
+
+/**
+ *	Callback of [ddns_matcher_scan], a signature is found in the page. The
+ *	signatures of other servers are ignored.
+ *
+ *	@param[in]		pattern	: index of the signature.
+ *	@param[in]		offset	: offset following the signature, unused.
+ *	@param[in/out]	stream	: the scraping state.
+ *
+ *	@return		Return non-zero to read the token following the signature.
+ */
+static int dnspod_getip_stream_found(
+	unsigned int					pattern,
+	size_t							offset,
+	struct dnspod_getip_stream	*	stream
+	)
+{
+	const struct dnspod_getip_rule	*	found	= stream->matcher->rules[pattern];
+	const struct dnspod_getip_rule	*	rule	= NULL;
+
+	DDNS_UNUSED(offset);
+
+	for ( rule = stream->rules; NULL != rule->signature; ++rule )
+	{
+		if ( rule == found )
 		{
-			server_buffer->buffer[server_buffer->used - 1] = 0;
+			stream->rule	= rule;
+			stream->state	= 0;
+			break;
 		}
+	}
+
+	return (NULL != stream->rule);
+}
+
+
+/**
+ *	A token of the page is read completely, answer the page with it if it's
+ *	valid, otherwise go on searching.
+ *
+ *	@param[in/out]	stream	: the scraping state.
+ */
+static void dnspod_getip_stream_token(
+	struct dnspod_getip_stream	*	stream
+	)
+{
+	const struct dnspod_getip_rule	*	rule	= stream->rule;
+	unsigned int						prefix	= 0;
 
-		str = strstr(server_buffer->buffer, signature);
-		if (NULL != str)
+	stream->token[stream->length] = '\0';
+
+	if ( NULL == rule->base )
+	{
+		if ( 0 != ddns_is_internet_address(stream->token) )
 		{
-			const char * ip = strpbrk(str, "123456789");
-			if ((NULL == ip) || (ip != (str + _countof(signature) - 1)))
-			{
-				error_code = DDNS_ERROR_BADSVR;
-			}
-			else
-			{
-				str = ip;
-			}
+			stream->error_code = DDNS_ERROR_SUCCESS;
 		}
-		if (NULL != str)
+	}
+	else if (	(0 == ddns_strncasecmp(stream->token, "http://", 7))
+			||	(0 == ddns_strncasecmp(stream->token, "https://", 8)) )
+	{
+		stream->error_code = DDNS_ERROR_REDIRECT;
+	}
+	else
+	{
+		prefix = (unsigned int)strlen(rule->base);
+		if ( prefix + stream->length < _countof(stream->token) )
 		{
-			const char * end = strstr(str, "'");
-			if (NULL == end)
-			{
-				error_code = DDNS_ERROR_BADSVR;
-			}
-			else
-			{
-				int length = length = end - str + 1;
-				if (length > buffer_size)
-				{
-					length = buffer_size;
-				}
-
-				c99_strncpy(text_buffer, str, length);
-			}
+			memmove(stream->token + prefix, stream->token, stream->length + 1);
+			memcpy(stream->token, rule->base, prefix);
+			stream->error_code = DDNS_ERROR_REDIRECT;
 		}
 	}
 
-	return error_code;
+	stream->rule	= NULL;
+	stream->length	= 0;
 }
 
+
 /**
- *	Parse server response when getting IP address from server.
+ *	HTTP callback, scrape a block of the page as soon as it arrives. No more
+ *	than a token is kept, and the response is stopped once it's answered.
  *
- *	@param[in/out]	server_buffer	: server response
- *	@param[out]		text_buffer		: parsed ip address
- *	@param[in]		buffer_size		: size of text_buffer in bytes
- *
- *	@return The following value may be returned:
- *				- DDNS_ERROR_SUCCESS:	legal server response is detected
- *				- DDNS_ERROR_REDIRECT:	redirection is required, redirect URL
- *										is saved in server_buffer.
- *				- Others:				error occurred.
+ *	@param[in]		data	: newly received data.
+ *	@param[in]		size	: size of the received data in bytes.
+ *	@param[in/out]	stream	: the scraping state.
  */
-static ddns_error dnspod_get_ip_address_ip138(
-	struct dnspod_buffer		*	server_buffer,
-	char						*	text_buffer,
-	int								buffer_size
+static void dnspod_getip_stream_read(
+	const char					*	data,
+	size_t							size,
+	struct dnspod_getip_stream	*	stream
 	)
 {
-	ddns_error				error_code	= DDNS_ERROR_SUCCESS;
-	static const char		signature[] = "location.href=\"";
-	char				*	start		= NULL;
-	char				*	end			= NULL;
-	int						length		= 0;
+	size_t idx = 0;
 
-	start = strstr(server_buffer->buffer, signature);
-	if (NULL != start)
+	while ( (idx < size) && (DDNS_ERROR_PENDING == stream->error_code) )
 	{
-		start += strlen(signature);
-		end = strchr(start, '\"');
-		if (NULL != end)
-		{
-			length = end - start;
+		const struct dnspod_getip_rule	*	rule	= stream->rule;
+		char								chr		= data[idx];
 
-			if (0 == ddns_strncasecmp(start, "http://", 7))
-			{
-				memmove(server_buffer->buffer, start, length);
-				server_buffer->buffer[length] = 0;
-				server_buffer->used = length + 1;
-			}
-			else
-			{
-				static const char prefix[] = "http://www.ip138.com/";
-				memmove(server_buffer->buffer + sizeof(prefix) - 1, start, length);
-				memcpy(server_buffer->buffer, prefix, sizeof(prefix) - 1);
-				server_buffer->buffer[length] = 0;
-				server_buffer->used = sizeof(prefix) + length;
-			}
+		/* Step 1: search signatures of the page, up to the end of one */
+		if ( NULL == rule )
+		{
+			idx += ddns_matcher_scan(&(stream->matcher->matcher),
+									 &(stream->state),
+									 data + idx,
+									 size - idx,
+									 (ddns_match_callback)&dnspod_getip_stream_found,
+									 stream
+									 );
 		}
 
-		error_code = DDNS_ERROR_REDIRECT;
-	}
-	else
-	{
-		start	= strchr(server_buffer->buffer, '[');
-		end		= strchr(server_buffer->buffer, ']');
-		length	= end - start;
-		if ((NULL == start) || (NULL == end) || (length <= 0))
+		/* Step 2: read the token, an IP address has only digits and dots */
+		else if ( ('\0' != chr) && (NULL != strchr(rule->terminator, chr)) )
 		{
-			error_code = DDNS_ERROR_CONNECTION;
+			dnspod_getip_stream_token(stream);
+			++idx;
 		}
-		else
+		else if (	(stream->length + 1 < _countof(stream->token))
+				&&	(	(NULL != rule->base)
+					||	(('0' <= chr) && (chr <= '9'))
+					||	('.' == chr) ) )
 		{
-			if (length > buffer_size)
-			{
-				length = buffer_size;
-			}
+			stream->token[stream->length++] = chr;
+			++idx;
+		}
 
-			c99_strncpy(text_buffer, start + 1, length);
+		/* not a token, search signatures from this character again */
+		else
+		{
+			stream->rule	= NULL;
+			stream->length	= 0;
 		}
 	}
 
+	if ( DDNS_ERROR_PENDING != stream->error_code )
+	{
+		http_stop_response(stream->request);
+	}
+}
+
 
-	return error_code;
+/**
+ *	Finish scraping a page at the end of it.
+ *
+ *	@param[in/out]	stream	: the scraping state, its [error_code] is:
+ *								- DDNS_ERROR_SUCCESS:	[token] is the IP
+ *														address.
+ *								- DDNS_ERROR_REDIRECT:	[token] is the URL to
+ *														redirect to.
+ *								- DDNS_ERROR_BADSVR:	nothing is found, shall
+ *														not retry any more.
+ */
+static void dnspod_getip_stream_end(
+	struct dnspod_getip_stream	*	stream
+	)
+{
+	/* the page may end with the token, e.g. a page of the IP address only */
+	if ( (DDNS_ERROR_PENDING == stream->error_code) && (NULL != stream->rule) )
+	{
+		dnspod_getip_stream_token(stream);
+	}
+
+	if ( DDNS_ERROR_PENDING == stream->error_code )
+	{
+		stream->error_code = DDNS_ERROR_BADSVR;
+	}
 }
 
 /**
@@ -3359,10 +5058,10 @@ static ddns_error dnspod_domain_list_push(
 
 	if ( DDNS_ERROR_SUCCESS == error_code )
 	{
-		id		= json_object_get(domain_info, "id");
-		name	= json_object_get(domain_info, "name");
-		status	= json_object_get(domain_info, "status");
-		records = json_object_get(domain_info, "records");
+		id		= json_object_peek(domain_info, "id");
+		name	= json_object_peek(domain_info, "name");
+		status	= json_object_peek(domain_info, "status");
+		records = json_object_peek(domain_info, "records");
 
 		if ( 0 == json_to_number(id) )
 		{
@@ -3412,11 +5111,6 @@ static ddns_error dnspod_domain_list_push(
 				error_code = DDNS_ERROR_INSUFFICIENT_MEMORY;
 			}
 		}
-
-		json_destroy(id);		id		= NULL;
-		json_destroy(name);		name	= NULL;
-		json_destroy(status);	status	= NULL;
-		json_destroy(records);	records = NULL;
 	}
 
 	return error_code;
@@ -3699,8 +5393,8 @@ static ddns_error dnspod_get_api_version(
 
 	if ( DDNS_ERROR_SUCCESS == error_code )
 	{
-		struct json_value	*	status	= json_object_get(json, "status");
-		struct json_value	*	message = json_object_get(status, "message");
+		struct json_value	*	status	= json_object_peek(json, "status");
+		struct json_value	*	message = json_object_peek(status, "message");
 		if (json_type_string == json_get_type(message))
 		{
 			char			*	decimal		= NULL;
@@ -3722,11 +5416,11 @@ static ddns_error dnspod_get_api_version(
 		{
 			error_code = DDNS_ERROR_BADSVR;
 		}
-
-		json_destroy(message);	message = NULL;
-		json_destroy(status);	status = NULL;
 	}
 
+	json_destroy(json);
+	json = NULL;
+
 	return error_code;
 }
 
@@ -3819,7 +5513,7 @@ static ddns_error dnspod_get_domain_priv(
 	{
 		static const char signature[] = "\xe8\xae\xb0\xe5\xbd\x95"
 										"TTL\xe6\x9c\x80\xe4\xbd\x8e";
-		struct json_value * purview = json_object_get(json, "purview");
+		struct json_value * purview = json_object_peek(json, "purview");
 
 		if (json_type_array != json_get_type(purview))
 		{
@@ -3831,9 +5525,9 @@ static ddns_error dnspod_get_domain_priv(
 			int cnt = json_array_size(purview);
 			for (idx = 0; idx < cnt; ++idx)
 			{
-				struct json_value * pair = json_array_get(purview, idx);
-				struct json_value * name = json_object_get(pair, "name");
-				struct json_value * value = json_object_get(pair, "value");
+				struct json_value * pair = json_array_peek(purview, idx);
+				struct json_value * name = json_object_peek(pair, "name");
+				struct json_value * value = json_object_peek(pair, "value");
 				if (json_type_string != json_get_type(name))
 				{
 					error_code = DDNS_ERROR_BADSVR;
@@ -3855,6 +5549,9 @@ static ddns_error dnspod_get_domain_priv(
 		}
 	}
 
+	json_destroy(json);
+	json = NULL;
+
 	return error_code;
 }
 
@@ -3887,7 +5584,7 @@ static ddns_error dnspod_handle_common_error(
 	}
 	else
 	{
-		struct json_value	*	status	= json_object_get(json, "status");
+		struct json_value	*	status	= json_object_peek(json, "status");
 		struct json_value	*	code	= NULL;
 
 		if ( json_type_object != json_get_type(status) )
@@ -3897,7 +5594,7 @@ static ddns_error dnspod_handle_common_error(
 
 		if ( DDNS_ERROR_SUCCESS == err )
 		{
-			code = json_object_get(status, "code");
+			code = json_object_peek(status, "code");
 			if ( json_type_string != json_get_type(code) )
 			{
 				err = DDNS_ERROR_BADSVR;
@@ -3906,53 +5603,78 @@ static ddns_error dnspod_handle_common_error(
 
 		if ( DDNS_ERROR_SUCCESS == err )
 		{
-			ddns_ulong32 status_code = strtoul(json_string_get(code), NULL, 10);
-			switch (status_code)
-			{
-			case -99:	/* API closed temporarily, try later */
-				*error_code = DDNS_ERROR_SVRDOWN;
-				break;
-			case -8:	/* Login failed too many times, blocked temporarily */
-				*error_code = DDNS_ERROR_BLOCKED;
-				break;
-			case -7:	/* Not allowed to use this API */
-				*error_code = DDNS_FATAL_ERROR(DDNS_ERROR_PAIDFEATURE);
-				break;
-			case -4:	/* Account not under the agent (agent API only) */
-				*error_code = DDNS_ERROR_UNKNOWN;
-				break;
-			case -3:	/* Illegal agent (agent API only) */
-				*error_code = DDNS_ERROR_UNKNOWN;
-				break;
-			case -2:	/* Exceed the maximum allowed usage (API) */
-				*error_code = DDNS_FATAL_ERROR(DDNS_ERROR_BLOCKED);
-				break;
-			case -1:	/* login failed */
-				*error_code = DDNS_FATAL_ERROR(DDNS_ERROR_BADAUTH);
-				break;
-			case 1:		/* Good */
-				*error_code = DDNS_ERROR_SUCCESS;
-				break;
-			case 2:		/* POST method only */
-				*error_code = DDNS_FATAL_ERROR(DDNS_ERROR_BADAGENT);
-				break;
-			case 3:		/* Unknown error */
-				*error_code = DDNS_ERROR_UNKNOWN;
-				break;
-			case 85:	/* Login remotely, rejected */
-				*error_code = DDNS_FATAL_ERROR(DDNS_ERROR_BADAUTH);
-				break;
-			case 6:		/* Illegal user id (agent API only) */
-			case 7:		/* Account not under the agent (agent API only) */
-			default:
-				err = DDNS_ERROR_NOTIMPL;
-				*error_code = status_code;
-				break;
-			}
+			err = dnspod_handle_status_code(json_string_get(code), error_code);
 		}
+	}
+
+	return err;
+}
+
+
+/**
+ *	Convert server status code into ours.
+ *
+ *	@param[in]	code		: value of "status.code" returned from server.
+ *	@param[out]	error_code	: the converted error code.
+ *
+ *	@return		The same as [dnspod_handle_common_error].
+ */
+static ddns_error dnspod_handle_status_code(
+	const char					*	code,
+	ddns_error					*	error_code
+	)
+{
+	ddns_error err = DDNS_ERROR_SUCCESS;
 
-		json_destroy(code);		code = NULL;
-		json_destroy(status);	status = NULL;
+	if (NULL == code || NULL == error_code)
+	{
+		err = DDNS_ERROR_BADARG;
+	}
+	else
+	{
+		ddns_ulong32 status_code = strtoul(code, NULL, 10);
+		switch (status_code)
+		{
+		case -99:	/* API closed temporarily, try later */
+			*error_code = DDNS_ERROR_SVRDOWN;
+			break;
+		case -8:	/* Login failed too many times, blocked temporarily */
+			*error_code = DDNS_ERROR_BLOCKED;
+			break;
+		case -7:	/* Not allowed to use this API */
+			*error_code = DDNS_FATAL_ERROR(DDNS_ERROR_PAIDFEATURE);
+			break;
+		case -4:	/* Account not under the agent (agent API only) */
+			*error_code = DDNS_ERROR_UNKNOWN;
+			break;
+		case -3:	/* Illegal agent (agent API only) */
+			*error_code = DDNS_ERROR_UNKNOWN;
+			break;
+		case -2:	/* Exceed the maximum allowed usage (API) */
+			*error_code = DDNS_FATAL_ERROR(DDNS_ERROR_BLOCKED);
+			break;
+		case -1:	/* login failed */
+			*error_code = DDNS_FATAL_ERROR(DDNS_ERROR_BADAUTH);
+			break;
+		case 1:		/* Good */
+			*error_code = DDNS_ERROR_SUCCESS;
+			break;
+		case 2:		/* POST method only */
+			*error_code = DDNS_FATAL_ERROR(DDNS_ERROR_BADAGENT);
+			break;
+		case 3:		/* Unknown error */
+			*error_code = DDNS_ERROR_UNKNOWN;
+			break;
+		case 85:	/* Login remotely, rejected */
+			*error_code = DDNS_FATAL_ERROR(DDNS_ERROR_BADAUTH);
+			break;
+		case 6:		/* Illegal user id (agent API only) */
+		case 7:		/* Account not under the agent (agent API only) */
+		default:
+			err = DDNS_ERROR_NOTIMPL;
+			*error_code = status_code;
+			break;
+		}
 	}
 
 	return err;
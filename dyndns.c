@@ -37,6 +37,7 @@
  *============================================================================*/
 
 #define DYNDNS_MAX_HOASTNAME	20l
+#define DYNDNS_MAX_URL_PATH		1024l	/* path size of [http_create_request] */
 
 static const char	DYNDNS_URL_GETIP[]			= "http://checkip.dyndns.com/";
 
@@ -119,6 +120,24 @@ struct dyndns_error_code_map
 	const char					*	ret_code;
 };
 
+/**
+ *	Chunks of host names shared by workers of [dyndns_interface_do_update],
+ *	chunk [i] holds hosts from [firsts[i]] to [firsts[i + 1]].
+ */
+struct dyndns_update_job
+{
+	struct ddns_context			*	context;
+	const struct ddns_server	**	hosts;			/* requested hosts          */
+	ddns_error					*	results;		/* result of each host      */
+	char						**	urls;			/* update URL of each chunk */
+	unsigned int				*	firsts;			/* first host of each chunk */
+	unsigned int					host_cnt;
+	unsigned int					chunk_cnt;
+	unsigned int					next_chunk;		/* next chunk to be sent    */
+	ddns_error						critical;		/* stops sending the rest   */
+	struct ddns_sync_object			sync_object;	/* guards the two above     */
+};
+
 
 /*============================================================================*
  *	Declaration of Local Functions
@@ -161,12 +180,16 @@ static ddns_error dyndns_interface_is_ip_changed(struct ddns_context * context);
 
 
 /**
- *	Determine if IP address is changed since last call.
+ *	Update IP address of all the host names.
  *
  *	@param[in]	context		: the DDNS context to operate.
  *
- *	@return		Return DDNS_ERROR_SUCCESS on success, otherwise an error code
- *				will be returned.
+ *	@note		Host names are sent in chunks of up to [DYNDNS_MAX_HOASTNAME],
+ *				as long as the url fits in [DYNDNS_MAX_URL_PATH]. Up to
+ *				[parallel] of the context chunks are sent at the same time.
+ *
+ *	@return		Return DDNS_ERROR_SUCCESS on success, otherwise the error of
+ *				the first failed host name will be returned.
  */
 static ddns_error dyndns_interface_do_update(struct ddns_context * context);
 
@@ -200,7 +223,9 @@ static ddns_error dyndns_interface_destroy(ddns_interface* interface);
  *	@param[out]	text_buffer	: buffer to save the IP address.
  *	@param[in[	buffer_size	: size of the buffer.
  *
- *	@note		The returned IP address is like "123.123.123.123".
+ *	@note		The returned IP address is like "123.123.123.123". If the
+ *				network interface of [context] has an internet address, it's
+ *				returned without asking the server.
  *
  *	@return		Return [DDNS_ERROR_SUCCESS] if successfully get the internet
  *				IP address, otherwise return an error code.
@@ -215,19 +240,29 @@ static ddns_error dyndns_get_ip_address(
 /**
  *	HTTP callback, save all received bytes to a buffer.
  *
- *	@param[in]	chr		: newly received data.
+ *	@param[in]	data	: newly received data.
+ *	@param[in]	size	: size of the received data in bytes.
  *	@param[in]	buffer	: buffer to save the received data.
  */
-static void dyndns_http_callback(char chr, struct dyndns_buffer* buffer);
+static void dyndns_http_callback(
+	const char				*	data,
+	size_t						size,
+	struct dyndns_buffer	*	buffer
+	);
 
 
 /**
  *	Callback function to parse host name list.
  *
- *	@param[in]	chr		: newly received data.
+ *	@param[in]	data	: newly received data.
+ *	@param[in]	size	: size of the received data in bytes.
  *	@param[out]	list	: the host name list.
  */
-static void dyndns_parse_hostname(char chr, struct dyndns_hostname_buffer *list);
+static void dyndns_parse_hostname(
+	const char						*	data,
+	size_t								size,
+	struct dyndns_hostname_buffer	*	list
+	);
 
 
 /**
@@ -244,7 +279,7 @@ static void dyndns_parse_hostname(char chr, struct dyndns_hostname_buffer *list)
 static ddns_error dyndns_send_command(
 	struct ddns_context		*	context,
 	const char				*	command,
-	http_callback				callback,
+	http_data_callback			callback,
 	void					*	buffer
 	);
 
@@ -264,25 +299,74 @@ static ddns_error dyndns_get_hostlist(
 
 
 /**
- *	Append host names to a url, separated by comma.
+ *	Get the size of the update url of some host names.
  *
- *	@param[in/out]	host_list	: list of host names
- *	@param[in]		max_cnt		: maximum count of host names appended to url.
- *	@param[out]		buffer		: the url to append host names to.
- *	@param[in]		buffer_size	: size of [buffer] in characters.
+ *	@param[in]		hosts		: the host names.
+ *	@param[in]		count		: number of host names.
  *
- *	@note		It will add 20 host names at maximum for each call. After
- *				returned, [host_list] will point to the list of the remaining
- *				host names.
+ *	@return		Return the size in characters, including the null terminator.
+ */
+static size_t dyndns_url_size(
+	const struct ddns_server	**	hosts,
+	unsigned int					count
+	);
+
+
+/**
+ *	Build the update url of some host names, separated by comma.
+ *
+ *	@param[in]		hosts		: the host names.
+ *	@param[in]		count		: number of host names.
+ *	@param[out]		buffer		: buffer to store the url.
+ *	@param[in]		buffer_size	: size of [buffer] in characters, see
+ *								  [dyndns_url_size].
  *
  *	@return		Return [DDNS_ERROR_SUCCESS] on success, otherwise an error code
  *				will be returned.
  */
-static ddns_error dyndns_url_append_hostnames(
-	struct ddns_server	**	host_list,
-	int						max_cnt,
-	char				*	buffer,
-	size_t					buffer_size
+static ddns_error dyndns_url_build(
+	const struct ddns_server	**	hosts,
+	unsigned int					count,
+	char						*	buffer,
+	size_t							buffer_size
+	);
+
+
+/**
+ *	Worker of [dyndns_interface_do_update], it keeps sending the next chunk of
+ *	the job until all of them are sent, or a critical error is returned.
+ *
+ *	@param[in/out]	param		: the [dyndns_update_job].
+ */
+static void dyndns_update_worker(
+	void					*	param
+	);
+
+
+/**
+ *	Parse the return codes of a chunk in one pass, one line for each host.
+ *
+ *	@param[in/out]	job			: the update job to store the results.
+ *	@param[in]		first		: index of the first host of the chunk.
+ *	@param[in]		count		: number of hosts in the chunk.
+ *	@param[in/out]	response	: response of the server, line ends are
+ *								  replaced with null terminators.
+ *	@param[in]		size		: size of the response in bytes, [response]
+ *								  must have room for one more byte.
+ *
+ *	@note		For a critical error, the server only returns one code for
+ *				the whole request. Hosts without a return code fail with
+ *				[DDNS_ERROR_UNKNOWN].
+ *
+ *	@return		Return the critical error if the server returns one,
+ *				otherwise [DDNS_ERROR_SUCCESS].
+ */
+static ddns_error dyndns_update_parse(
+	struct dyndns_update_job	*	job,
+	unsigned int					first,
+	unsigned int					count,
+	char						*	response,
+	size_t							size
 	);
 
 
@@ -330,6 +414,7 @@ ddns_interface * dyndns_create_interface(void)
 	{
 		ddns->initialize		= &dyndns_interface_initialize;
 		ddns->is_ip_changed		= &dyndns_interface_is_ip_changed;
+		ddns->step_ip_changed	= NULL;	/* HTTP requests are blocking */
 		ddns->get_ip_address	= &dyndns_interface_get_ip_address;
 		ddns->do_update			= &dyndns_interface_do_update;
 		ddns->finalize			= &dyndns_interface_finalize;
@@ -540,17 +625,31 @@ static ddns_error dyndns_interface_get_ip_address(
 
 
 /**
- *	Determine if IP address is changed since last call.
+ *	Update IP address of all the host names.
  *
  *	@param[in]	context		: the DDNS context to operate.
  *
- *	@return		Return DDNS_ERROR_SUCCESS on success, otherwise an error code
- *				will be returned.
+ *	@note		Host names are sent in chunks of up to [DYNDNS_MAX_HOASTNAME],
+ *				as long as the url fits in [DYNDNS_MAX_URL_PATH]. Up to
+ *				[parallel] of the context chunks are sent at the same time.
+ *
+ *	@return		Return DDNS_ERROR_SUCCESS on success, otherwise the error of
+ *				the first failed host name will be returned.
  */
 static ddns_error dyndns_interface_do_update(struct ddns_context * context)
 {
 	ddns_error					error_code	= DDNS_ERROR_SUCCESS;
 	struct dyndns_context	*	dyndns		= NULL;
+	const struct ddns_server*	domain		= NULL;
+	struct ddns_sync_thread	*	threads		= NULL;
+	char					*	urls		= NULL;
+	unsigned int				thread_cnt	= 0;
+	unsigned int				first		= 0;
+	unsigned int				count		= 0;
+	unsigned int				i			= 0;
+	struct dyndns_update_job	job;
+
+	memset(&job, 0, sizeof(job));
 
 	if ( (NULL == context) || (proto_dyndns != context->protocol) )
 	{
@@ -566,142 +665,168 @@ static ddns_error dyndns_interface_do_update(struct ddns_context * context)
 		}
 	}
 
+	/**
+	 *	Step 1: Collect requested hosts.
+	 */
 	if ( DDNS_ERROR_SUCCESS == error_code )
 	{
-		size_t					size	= 0;
-		char				*	command	= NULL;
-		struct ddns_server	*	domain	= NULL;
-
-		domain = context->domain;
-		while ( (NULL != domain) && (DDNS_ERROR_SUCCESS == error_code) )
+		job.context = context;
+		for ( domain = context->domain; NULL != domain; domain = domain->next )
 		{
-			size_t						len			= 0;
-			const size_t				step		= 1024;
-			struct ddns_server		*	domain_list	= domain;
-			struct dyndns_buffer		buffer;
-			char						response[1024] = { 0 };
+			++job.host_cnt;
+		}
 
-			len = c99_snprintf(command,	size,
-										"%s?hostname=",
-										DYNDNS_CMD_UPDATE
-										);
-			if ( len >= size )
+		/* a chunk holds one host at least, size for the worst case */
+		if ( job.host_cnt > 0 )
+		{
+			job.hosts	= (const struct ddns_server**)malloc(
+									job.host_cnt * sizeof(*job.hosts));
+			job.results	= (ddns_error*)malloc(
+									job.host_cnt * sizeof(*job.results));
+			job.urls	= (char**)malloc(
+									job.host_cnt * sizeof(*job.urls));
+			job.firsts	= (unsigned int*)malloc(
+									(job.host_cnt + 1) * sizeof(*job.firsts));
+			if (	(NULL == job.hosts)
+				||	(NULL == job.results)
+				||	(NULL == job.urls)
+				||	(NULL == job.firsts) )
 			{
-				/* insufficient buffer: retry with a larger buffer */
-				char * new_command = realloc(command, size + step);
-				if ( NULL != new_command )
-				{
-					size	+= step;
-					command	= new_command;
-					continue;
-				}
-				else
-				{
-					error_code = DDNS_ERROR_INSUFFICIENT_MEMORY;
-					break;
-				}
+				error_code = DDNS_ERROR_INSUFFICIENT_MEMORY;
 			}
+		}
+	}
 
-			error_code = dyndns_url_append_hostnames(	&domain,
-														DYNDNS_MAX_HOASTNAME,
-														command + len,
-														size - len
-														);
-			if ( DDNS_ERROR_INSUFFICIENT_BUFFER == error_code )
+	/**
+	 *	Step 2: Split the hosts into chunks, a chunk ends at
+	 *			[DYNDNS_MAX_HOASTNAME] hosts or before its url outgrows
+	 *			[DYNDNS_MAX_URL_PATH], then build the url of every chunk in
+	 *			a buffer sized up front.
+	 */
+	if ( (DDNS_ERROR_SUCCESS == error_code) && (job.host_cnt > 0) )
+	{
+		size_t url_size = 0;
+
+		for ( i = 0, domain = context->domain; NULL != domain; ++i, domain = domain->next )
+		{
+			job.hosts[i]	= domain;
+			job.results[i]	= DDNS_ERROR_PENDING;
+		}
+
+		for ( first = 0; first < job.host_cnt; first += count )
+		{
+			count = 1;
+			while (		(first + count < job.host_cnt)
+					&&	(count < (unsigned int)DYNDNS_MAX_HOASTNAME)
+					&&	(dyndns_url_size(job.hosts + first, count + 1)
+							<= (size_t)DYNDNS_MAX_URL_PATH) )
 			{
-				/* insufficient buffer: retry with a larger buffer */
-				char * new_command = realloc(command, size + step);
-				if ( NULL != new_command )
-				{
-					size		+= step;
-					command		= new_command;
-					error_code	= DDNS_ERROR_SUCCESS;
-					continue;
-				}
-				else
-				{
-					error_code = DDNS_ERROR_INSUFFICIENT_MEMORY;
-					break;
-				}
+				++count;
 			}
-			else if ( DDNS_ERROR_SUCCESS != error_code )
+
+			job.firsts[job.chunk_cnt++] = first;
+			url_size += dyndns_url_size(job.hosts + first, count);
+		}
+		job.firsts[job.chunk_cnt] = job.host_cnt;
+
+		urls = (char*)malloc(url_size);
+		if ( NULL == urls )
+		{
+			error_code = DDNS_ERROR_INSUFFICIENT_MEMORY;
+		}
+
+		for ( i = 0; (DDNS_ERROR_SUCCESS == error_code) && (i < job.chunk_cnt); ++i )
+		{
+			first	= job.firsts[i];
+			count	= job.firsts[i + 1] - first;
+
+			job.urls[i]	= (0 == i) ? urls : (job.urls[i - 1] + strlen(job.urls[i - 1]) + 1);
+			error_code	= dyndns_url_build(	job.hosts + first,
+											count,
+											job.urls[i],
+											url_size - (job.urls[i] - urls)
+											);
+		}
+	}
+
+	/**
+	 *	Step 3: Send the chunks by up to [context->parallel] workers over
+	 *			pooled connections, this thread is one of them. If a worker
+	 *			can't be started, the others take over its chunks.
+	 */
+	if ( (DDNS_ERROR_SUCCESS == error_code) && (job.host_cnt > 0) )
+	{
+		ddns_printf_v(context,	msg_type_info,
+								"Updating IP address(es) of %u host name(s)...\n",
+								job.host_cnt
+								);
+
+		if ( (context->parallel > 1) && (job.chunk_cnt > 1) )
+		{
+			thread_cnt = (unsigned int)context->parallel;
+			if ( thread_cnt > job.chunk_cnt )
 			{
-				break;
+				thread_cnt = job.chunk_cnt;
 			}
+			--thread_cnt;
 
-			ddns_printf_v(context, msg_type_info, "Updating IP address(es)... ");
-			buffer.size		= sizeof(response);
-			buffer.used		= 0;
-			buffer.buffer	= &(response[0]);
-			error_code = dyndns_send_command(	context,
-												command,
-												NULL,
-												&buffer
-												);
-			if ( DDNS_ERROR_SUCCESS == error_code )
+			threads = (struct ddns_sync_thread*)malloc(
+									thread_cnt * sizeof(*threads));
+			if ( NULL == threads )
 			{
-				size_t idx = 0;
+				thread_cnt = 0;
+			}
+		}
 
-				if ( buffer.used >= buffer.size )
-				{
-					error_code = DDNS_ERROR_INSUFFICIENT_BUFFER;
-					break;
-				}
+		ddns_sync_init(&job.sync_object);
 
-				/* replace line-feed/carriage return to '\0' */
-				for ( idx = 0; idx < buffer.used; ++idx )
-				{
-					switch ( buffer.buffer[idx] )
-					{
-					case '\r':
-					case '\n':
-						buffer.buffer[idx] = '\0';
-						break;
+		for ( i = 0; i < thread_cnt; ++i )
+		{
+			if ( 0 != ddns_sync_thread_create(&threads[i],
+											  &dyndns_update_worker,
+											  &job
+											  ) )
+			{
+				thread_cnt = i;
+				break;
+			}
+		}
 
-					default:
-						break;
-					}
-				}
+		dyndns_update_worker(&job);
 
-				for ( ; NULL != domain_list; domain_list = domain_list->next )
-				{
-					ddns_error sub_err = DDNS_ERROR_SUCCESS;
-					sub_err = dyndns_check_return_code(buffer.buffer);
-					ddns_printf_v(context,	msg_type_info,
-											"\n  * %-32s : %s.",
-											domain_list->domain,
-											buffer.buffer
-											);
-					if ( (DDNS_ERROR_NOCHG != sub_err) && (DDNS_ERROR_SUCCESS != sub_err) )
-					{
-						error_code = sub_err;
-					}
+		for ( i = 0; i < thread_cnt; ++i )
+		{
+			ddns_sync_thread_join(&threads[i]);
+		}
 
-					if ( 0 == dyndns_is_critical_err(sub_err) )
-					{
-						buffer.buffer += strlen(buffer.buffer) + 1;
-					}
-				}
-				ddns_printf_v(context, msg_type_info, "\n");
+		ddns_sync_destroy(&job.sync_object);
 
-				if ( DDNS_ERROR_SUCCESS != error_code )
-				{
-					break;
-				}
+		/**
+		 *	Step 4: Report the first failure in the order of the hosts, hosts
+		 *			not sent after a critical error fail with it.
+		 */
+		for ( i = 0; i < job.host_cnt; ++i )
+		{
+			if ( DDNS_ERROR_PENDING == job.results[i] )
+			{
+				job.results[i] = job.critical;
 			}
-			else
+			if (	(DDNS_ERROR_NOCHG != job.results[i])
+				&&	(DDNS_ERROR_SUCCESS != job.results[i])
+				&&	(DDNS_ERROR_SUCCESS == error_code) )
 			{
-				ddns_printf_v(context, msg_type_info, "failed.\n");
+				error_code = job.results[i];
 			}
 		}
-
-		if ( NULL != command )
-		{
-			free(command);
-			command = NULL;
-		}
 	}
 
+	free(threads);
+	free(urls);
+	free(job.urls);
+	free(job.firsts);
+	free(job.hosts);
+	free(job.results);
+
 	return error_code;
 }
 
@@ -795,7 +920,9 @@ static ddns_error dyndns_interface_destroy(ddns_interface* interface)
  *	@param[out]	text_buffer	: buffer to save the IP address.
  *	@param[in[	buffer_size	: size of the buffer.
  *
- *	@note		The returned IP address is like "123.123.123.123".
+ *	@note		The returned IP address is like "123.123.123.123". If the
+ *				network interface of [context] has an internet address, it's
+ *				returned without asking the server.
  *
  *	@return		Return [DDNS_ERROR_SUCCESS] if successfully get the internet
  *				IP address, otherwise return an error code.
@@ -808,13 +935,25 @@ static ddns_error dyndns_get_ip_address(
 {
 	ddns_error				error_code	= DDNS_ERROR_SUCCESS;
 	struct http_request	*	request		= NULL;
+	int						local		= 0;
 
 	if ( (NULL == context) || (buffer_size <= 0) )
 	{
 		error_code = DDNS_ERROR_BADARG;
 	}
 
-	if ( DDNS_ERROR_SUCCESS == error_code )
+	/* The local network interface is preferred, the server is only asked when
+	 * it has no internet address. */
+	if ( (DDNS_ERROR_SUCCESS == error_code) && ('\0' != context->netif[0]) )
+	{
+		local = (DDNS_ERROR_SUCCESS == ddns_get_interface_address(
+													context->netif,
+													text_buffer,
+													buffer_size
+													));
+	}
+
+	if ( (DDNS_ERROR_SUCCESS == error_code) && (0 == local) )
 	{
 		request = http_create_request(	http_method_get,
 										DYNDNS_URL_GETIP,
@@ -826,7 +965,7 @@ static ddns_error dyndns_get_ip_address(
 		}
 	}
 
-	if ( DDNS_ERROR_SUCCESS == error_code )
+	if ( (DDNS_ERROR_SUCCESS == error_code) && (0 == local) )
 	{
 		switch ( http_connect(request) )
 		{
@@ -848,7 +987,7 @@ static ddns_error dyndns_get_ip_address(
 		}
 	}
 
-	if ( DDNS_ERROR_SUCCESS == error_code )
+	if ( (DDNS_ERROR_SUCCESS == error_code) && (0 == local) )
 	{
 		int http_status = http_send_request(request, "", 0);
 		if ( http_status < 200 || http_status >= 300 )
@@ -870,7 +1009,7 @@ static ddns_error dyndns_get_ip_address(
 		}
 	}
 
-	if ( DDNS_ERROR_SUCCESS == error_code )
+	if ( (DDNS_ERROR_SUCCESS == error_code) && (0 == local) )
 	{
 		struct dyndns_buffer	buffer;
 		int						result		= 0;
@@ -879,10 +1018,10 @@ static ddns_error dyndns_get_ip_address(
 		buffer.size		= _countof(html);
 		buffer.buffer	= html;
 		buffer.used		= 0;
-		result = http_get_response(	request,
-									(http_callback)&dyndns_http_callback,
-									&buffer
-									);
+		result = http_get_response_ex(	request,
+										(http_data_callback)&dyndns_http_callback,
+										&buffer
+										);
 		if ( (0 == result) || (buffer.used <= 0) )
 		{
 			error_code = DDNS_ERROR_CONNECTION;
@@ -925,37 +1064,10 @@ static ddns_error dyndns_get_ip_address(
 		}
 	}
 
-	if ( DDNS_ERROR_SUCCESS == error_code )
+	if (	(DDNS_ERROR_SUCCESS == error_code)
+		&&	(0 == ddns_is_internet_address(text_buffer)) )
 	{
-		int		d1		= 0;
-		int		d2		= 0;
-		int		d3		= 0;
-		int		d4		= 0;
-
-		if ( 4 != sscanf(text_buffer, "%d.%d.%d.%d", &d1, &d2, &d3, &d4) )
-		{
-			error_code = DDNS_ERROR_CONNECTION;
-		}
-		else
-		{
-			/* If it's a valid IP address? */
-			if (	(d1 < 0) || (d1 >= 256) || (d2 < 0) || (d2 >= 256)
-				||	(d3 < 0) || (d3 >= 256) || (d4 < 0) || (d4 >= 256)
-				||	((0 == d1) && (0 == d2) && (0 == d3) && (0 == d4))
-				||	((255 == d1) && (255 == d2) && (255 == d3) && (255 == d4)) )
-			{
-				error_code = DDNS_ERROR_CONNECTION;
-			}
-
-			/* If it's a intranet address? */
-			if (	(10 == d1)
-				||	((172 == d1) && (16 <= d2) && (31>= d2))
-				||	((192 == d1) && (168 == d2) && (0 == d3))
-				||	((169 == d1) && (254 == d2)) )
-			{
-				error_code = DDNS_ERROR_CONNECTION;
-			}
-		}
+		error_code = DDNS_ERROR_CONNECTION;
 	}
 
 	http_destroy_request(request);
@@ -968,23 +1080,27 @@ static ddns_error dyndns_get_ip_address(
 /**
  *	HTTP callback, save all received bytes to a buffer.
  *
- *	@param[in]	chr		: newly received data.
+ *	@param[in]	data	: newly received data.
+ *	@param[in]	size	: size of the received data in bytes.
  *	@param[in]	buffer	: buffer to save the received data.
  */
-static void dyndns_http_callback(char chr, struct dyndns_buffer* buffer)
+static void dyndns_http_callback(
+	const char				*	data,
+	size_t						size,
+	struct dyndns_buffer	*	buffer
+	)
 {
 	if ( (NULL != buffer) && (NULL != buffer->buffer) )
 	{
-		if ( buffer->used < buffer->size )
-		{
-			buffer->buffer[buffer->used] = chr;
-			++(buffer->used);
-		}
-		else
+		if ( size > buffer->size - buffer->used )
 		{
 			/* buffer overflow */
 			assert(0);
+			size = buffer->size - buffer->used;
 		}
+
+		memcpy(buffer->buffer + buffer->used, data, size);
+		buffer->used += size;
 	}
 }
 
@@ -1003,7 +1119,7 @@ static void dyndns_http_callback(char chr, struct dyndns_buffer* buffer)
 static ddns_error dyndns_send_command(
 	struct ddns_context		*	context,
 	const char				*	command,
-	http_callback				callback,
+	http_data_callback			callback,
 	void					*	buffer
 	)
 {
@@ -1017,29 +1133,37 @@ static ddns_error dyndns_send_command(
 
 	if ( NULL == callback )
 	{
-		callback = (http_callback)&dyndns_http_callback;
+		callback = (http_data_callback)&dyndns_http_callback;
 	}
 
 	if ( DDNS_ERROR_SUCCESS == error_code )
 	{
-		size_t	length		= 0;
-		char	url[1024]	= { 0 };
-		length = c99_snprintf(url,	_countof(url),
 #if defined(HTTP_SUPPORT_SSL) && HTTP_SUPPORT_SSL
-									"https://%s:%d%s",
+		static const char	format[]	= "https://%s:%d%s";
 #else
-									"http://%s:%d%s",
+		static const char	format[]	= "http://%s:%d%s";
 #endif
-									context->server->domain,
-									(int)context->server->port,
-									command
-									);
-		if ( length >= _countof(url) )
+		size_t				length		= 0;
+		char			*	url			= NULL;
+
+		/* the url is as long as the command, size it before building it */
+		length	= c99_snprintf(	NULL, 0, format,
+								context->server->domain,
+								(int)context->server->port,
+								command
+								) + 1;
+		url		= (char*)malloc(length);
+		if ( NULL == url )
 		{
-			error_code = DDNS_ERROR_INSUFFICIENT_BUFFER;
+			error_code = DDNS_ERROR_INSUFFICIENT_MEMORY;
 		}
 		else
 		{
+			c99_snprintf(	url, length, format,
+							context->server->domain,
+							(int)context->server->port,
+							command
+							);
 			request = http_create_request(	http_method_get,
 											url,
 											context->timeout
@@ -1048,6 +1172,12 @@ static ddns_error dyndns_send_command(
 			{
 				error_code = DDNS_ERROR_BADURL;
 			}
+			else
+			{
+				/* update chunks of a cycle share pooled connections */
+				http_set_option(request, HTTP_OPTION_KEEPALIVE, 1);
+			}
+			free(url);
 		}
 	}
 
@@ -1145,10 +1275,10 @@ static ddns_error dyndns_send_command(
 
 	if ( DDNS_ERROR_SUCCESS == error_code )
 	{
-		int result = http_get_response(	request,
-										(http_callback)callback,
-										buffer
-										);
+		int result = http_get_response_ex(	request,
+											callback,
+											buffer
+											);
 		if ( 0 == result )
 		{
 			if ( ETIMEDOUT == ddns_socket_get_errno() )
@@ -1171,13 +1301,22 @@ static ddns_error dyndns_send_command(
 /**
  *	Callback function to parse host name list.
  *
- *	@param[in]	chr		: newly received data.
+ *	@param[in]	data	: newly received data.
+ *	@param[in]	size	: size of the received data in bytes.
  *	@param[out]	list	: the host name list.
  */
-static void dyndns_parse_hostname(char chr, struct dyndns_hostname_buffer* list)
+static void dyndns_parse_hostname(
+	const char						*	data,
+	size_t								size,
+	struct dyndns_hostname_buffer	*	list
+	)
 {
-	if ( NULL != list )
+	size_t idx = 0;
+
+	for ( idx = 0; (NULL != list) && (idx < size); ++idx )
 	{
+		char chr = data[idx];
+
 		switch ( list->status )
 		{
 		case dyndns_account_type:
@@ -1259,7 +1398,7 @@ static ddns_error dyndns_get_hostlist(
 
 	error_code = dyndns_send_command(	context,
 										DYNDNS_CMD_HOSTLIST,
-										(http_callback)&dyndns_parse_hostname,
+										(http_data_callback)&dyndns_parse_hostname,
 										&buffer
 										);
 	if ( (DDNS_ERROR_SUCCESS == error_code) && (NULL == buffer.host_list) )
@@ -1281,96 +1420,276 @@ static ddns_error dyndns_get_hostlist(
 
 
 /**
- *	Append host names to a url, separated by comma.
+ *	Get the size of the update url of some host names.
  *
- *	@param[in/out]	host_list	: list of host names
- *	@param[in]		max_cnt		: maximum count of host names appended to url.
- *	@param[out]		buffer		: the url to append host names to.
- *	@param[in]		buffer_size	: size of [buffer] in characters.
+ *	@param[in]		hosts		: the host names.
+ *	@param[in]		count		: number of host names.
  *
- *	@note		It will add 20 host names at maximum for each call. In successful
- *				return, [host_list] will point to the list of the remaining
- *				host names, otherwise it keeps unchanged.
+ *	@return		Return the size in characters, including the null terminator.
+ */
+static size_t dyndns_url_size(
+	const struct ddns_server	**	hosts,
+	unsigned int					count
+	)
+{
+	size_t			size	= 0;
+	unsigned int	i		= 0;
+
+	/* "/nic/update?hostname=" and the null terminator */
+	size = strlen(DYNDNS_CMD_UPDATE) + strlen("?hostname=") + 1;
+
+	for ( i = 0; (NULL != hosts) && (i < count); ++i )
+	{
+		if ( 0 != i )
+		{
+			size += http_urlencode(",", NULL, 0) - 1;
+		}
+		size += http_urlencode(hosts[i]->domain, NULL, 0) - 1;
+	}
+
+	return size;
+}
+
+
+/**
+ *	Build the update url of some host names, separated by comma.
+ *
+ *	@param[in]		hosts		: the host names.
+ *	@param[in]		count		: number of host names.
+ *	@param[out]		buffer		: buffer to store the url.
+ *	@param[in]		buffer_size	: size of [buffer] in characters, see
+ *								  [dyndns_url_size].
  *
  *	@return		Return [DDNS_ERROR_SUCCESS] on success, otherwise an error code
  *				will be returned.
  */
-static ddns_error dyndns_url_append_hostnames(
-	struct ddns_server	**	host_list,
-	int						max_cnt,
-	char				*	buffer,
-	size_t					buffer_size
+static ddns_error dyndns_url_build(
+	const struct ddns_server	**	hosts,
+	unsigned int					count,
+	char						*	buffer,
+	size_t							buffer_size
 	)
 {
-	int						domain_cnt		= 0;
-	size_t					length			= 0;
-	ddns_error				error_code		= DDNS_ERROR_SUCCESS;
-	struct ddns_server	*	original_list	= NULL;
+	size_t			length		= 0;
+	size_t			host_len	= 0;
+	ddns_error		error_code	= DDNS_ERROR_SUCCESS;
+	unsigned int	i			= 0;
 
-	if ( (NULL == buffer) || (0 == buffer_size) )
+	if ( (NULL == buffer) || (0 == buffer_size) || (NULL == hosts) )
 	{
 		error_code = DDNS_ERROR_BADARG;
 	}
-	if ( (NULL == host_list) || (NULL == (*host_list)) )
-	{
-		error_code = DDNS_ERROR_BADARG;
-	}
-	else
-	{
-		original_list = (*host_list);
-	}
 
 	if ( DDNS_ERROR_SUCCESS == error_code )
 	{
-		for (domain_cnt = 0; domain_cnt < max_cnt; ++domain_cnt)
+		length = c99_snprintf(buffer,	buffer_size,
+										"%s?hostname=",
+										DYNDNS_CMD_UPDATE
+										);
+		if ( length >= buffer_size )
 		{
-			size_t domain_len = 0;
-
-			if ( 0 != domain_cnt )
-			{
-				domain_len = http_urlencode(",",
-											buffer + length,
-											buffer_size - length
-											);
-				if ( domain_len < buffer_size - length )
-				{
-					length += domain_len;
-				}
-				else
-				{
-					error_code = DDNS_ERROR_INSUFFICIENT_BUFFER;
-					break;
-				}
-			}
+			error_code = DDNS_ERROR_INSUFFICIENT_BUFFER;
+		}
+	}
 
-			domain_len = http_urlencode((*host_list)->domain,
-										buffer + length,
-										buffer_size - length
-										);
-			if ( domain_len < buffer_size - length )
+	for ( i = 0; (DDNS_ERROR_SUCCESS == error_code) && (i < count); ++i )
+	{
+		if ( 0 != i )
+		{
+			host_len = http_urlencode(",", buffer + length, buffer_size - length);
+			if ( host_len < buffer_size - length )
 			{
-				length += domain_len;
+				length += host_len;
 			}
 			else
 			{
 				error_code = DDNS_ERROR_INSUFFICIENT_BUFFER;
 				break;
 			}
+		}
+
+		host_len = http_urlencode(	hosts[i]->domain,
+									buffer + length,
+									buffer_size - length
+									);
+		if ( host_len < buffer_size - length )
+		{
+			length += host_len;
+		}
+		else
+		{
+			error_code = DDNS_ERROR_INSUFFICIENT_BUFFER;
+		}
+	}
+
+	return error_code;
+}
+
+
+/**
+ *	Worker of [dyndns_interface_do_update], it keeps sending the next chunk of
+ *	the job until all of them are sent, or a critical error is returned.
+ *
+ *	@param[in/out]	param		: the [dyndns_update_job].
+ */
+static void dyndns_update_worker(
+	void					*	param
+	)
+{
+	struct dyndns_update_job	*	job			= (struct dyndns_update_job*)param;
+	ddns_error						error_code	= DDNS_ERROR_SUCCESS;
+	unsigned int					i			= 0;
+	unsigned int					first		= 0;
+	unsigned int					count		= 0;
+	unsigned int					idx			= 0;
+	struct dyndns_buffer			buffer;
+	char							response[1024];
+
+	while ( 1 )
+	{
+		ddns_sync_lock(&job->sync_object);
+		i = job->next_chunk;
+		if ( DDNS_ERROR_SUCCESS != job->critical )
+		{
+			/* the rest would fail the same way */
+			i = job->chunk_cnt;
+		}
+		else if ( i < job->chunk_cnt )
+		{
+			++job->next_chunk;
+		}
+		ddns_sync_unlock(&job->sync_object);
+
+		if ( i >= job->chunk_cnt )
+		{
+			break;
+		}
+
+		first	= job->firsts[i];
+		count	= job->firsts[i + 1] - first;
+
+		/* leave room for the null terminator */
+		buffer.size		= sizeof(response) - 1;
+		buffer.used		= 0;
+		buffer.buffer	= &(response[0]);
+		error_code = dyndns_send_command(	job->context,
+											job->urls[i],
+											NULL,
+											&buffer
+											);
+		if ( DDNS_ERROR_SUCCESS == error_code )
+		{
+			error_code = dyndns_update_parse(	job,
+												first,
+												count,
+												response,
+												buffer.used
+												);
+		}
+		else
+		{
+			for ( idx = first; idx < first + count; ++idx )
+			{
+				job->results[idx] = error_code;
+				ddns_printf_v(job->context,	msg_type_info,
+											"  * %-32s : failed.\n",
+											job->hosts[idx]->domain
+											);
+			}
+		}
 
-			(*host_list) = (*host_list)->next;
-			if ( NULL == (*host_list) )
+		if ( 0 != dyndns_is_critical_err(error_code) )
+		{
+			ddns_sync_lock(&job->sync_object);
+			if ( DDNS_ERROR_SUCCESS == job->critical )
 			{
-				break;
+				job->critical = error_code;
 			}
+			ddns_sync_unlock(&job->sync_object);
+		}
+	}
+}
+
+
+/**
+ *	Parse the return codes of a chunk in one pass, one line for each host.
+ *
+ *	@param[in/out]	job			: the update job to store the results.
+ *	@param[in]		first		: index of the first host of the chunk.
+ *	@param[in]		count		: number of hosts in the chunk.
+ *	@param[in/out]	response	: response of the server, line ends are
+ *								  replaced with null terminators.
+ *	@param[in]		size		: size of the response in bytes, [response]
+ *								  must have room for one more byte.
+ *
+ *	@note		For a critical error, the server only returns one code for
+ *				the whole request. Hosts without a return code fail with
+ *				[DDNS_ERROR_UNKNOWN].
+ *
+ *	@return		Return the critical error if the server returns one,
+ *				otherwise [DDNS_ERROR_SUCCESS].
+ */
+static ddns_error dyndns_update_parse(
+	struct dyndns_update_job	*	job,
+	unsigned int					first,
+	unsigned int					count,
+	char						*	response,
+	size_t							size
+	)
+{
+	ddns_error		critical	= DDNS_ERROR_SUCCESS;
+	ddns_error		error_code	= DDNS_ERROR_SUCCESS;
+	size_t			start		= 0;
+	size_t			pos			= 0;
+	unsigned int	idx			= 0;
+
+	for ( pos = 0; (pos <= size) && (idx < count); ++pos )
+	{
+		if ( (pos < size) && ('\r' != response[pos]) && ('\n' != response[pos]) )
+		{
+			continue;
 		}
+
+		/* the last line may not be terminated */
+		response[pos] = '\0';
+		if ( pos == start )
+		{
+			/* empty line, or '\n' of "\r\n" */
+			start = pos + 1;
+			continue;
+		}
+
+		error_code = dyndns_check_return_code(response + start);
+		if ( 0 != dyndns_is_critical_err(error_code) )
+		{
+			critical = error_code;
+		}
+
+		/* a critical error is the only code for all the hosts */
+		do
+		{
+			job->results[first + idx] = error_code;
+			ddns_printf_v(job->context,	msg_type_info,
+										"  * %-32s : %s.\n",
+										job->hosts[first + idx]->domain,
+										response + start
+										);
+			++idx;
+		} while ( (DDNS_ERROR_SUCCESS != critical) && (idx < count) );
+
+		start = pos + 1;
 	}
 
-	if ( DDNS_ERROR_INSUFFICIENT_BUFFER == error_code )
+	for ( ; idx < count; ++idx )
 	{
-		(*host_list) = original_list;
+		job->results[first + idx] = DDNS_ERROR_UNKNOWN;
+		ddns_printf_v(job->context,	msg_type_info,
+									"  * %-32s : no response.\n",
+									job->hosts[first + idx]->domain
+									);
 	}
 
-	return error_code;
+	return critical;
 }
 
 
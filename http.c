@@ -69,6 +69,9 @@
 #ifndef HTTP_VERSION
 #define HTTP_VERSION	"HTTP/1.1"
 #endif
+#ifndef HTTP_RECV_BUFFER_SIZE
+#define HTTP_RECV_BUFFER_SIZE	(16 * 1024)	/* receive buffer of a connection */
+#endif
 
 /**
  *	Function result value definition.
@@ -79,6 +82,21 @@
 static const int RESULT_FAILURE = 0;
 static const int RESULT_SUCCESS = 1;
 
+#if (!defined(HTTP_SUPPORT_SSL_WININET)) || (0 == HTTP_SUPPORT_SSL_WININET)
+#ifndef HTTP_POOL_SIZE
+#define HTTP_POOL_SIZE			4	/* idle keep-alive connections kept */
+#endif
+#ifndef HTTP_POOL_IDLE_TIMEOUT
+#define HTTP_POOL_IDLE_TIMEOUT	30	/* seconds an idle connection is kept */
+#endif
+#endif	/* ! HTTP_SUPPORT_SSL_WININET */
+
+#if defined(HTTP_SUPPORT_SSL_OPENSSL) && HTTP_SUPPORT_SSL_OPENSSL
+#ifndef HTTP_SSL_SESSION_CACHE_SIZE
+#define HTTP_SSL_SESSION_CACHE_SIZE	16	/* cached TLS sessions, by server */
+#endif
+#endif	/* HTTP_SUPPORT_SSL_OPENSSL */
+
 /*============================================================================*
  *	Declaration of Local Types & Functions
  *============================================================================*/
@@ -102,6 +120,9 @@ struct http_header
 struct http_connection
 {
 	int								timeout;
+	struct ddns_deadline			deadline;	/* see [http_set_deadline]    */
+	int							*	stop_wait;	/* see [http_set_stop_signal] */
+	int								stopped;	/* see [http_stop_response]   */
 #if defined(HTTP_SUPPORT_SSL_WININET) && HTTP_SUPPORT_SSL_WININET
 	int								use_ssl;
 	HINTERNET						handle_connect;
@@ -111,6 +132,12 @@ struct http_connection
 #if defined(HTTP_SUPPORT_SSL_OPENSSL) && HTTP_SUPPORT_SSL_OPENSSL
 	SSL							*	ssl;		/* SSL layer over socket     */
 #endif
+	int								reused;		/* taken from connection pool  */
+	int								reusable;	/* response is completely read */
+	int								sent;		/* bytes of the request sent   */
+	int								recv_pos;	/* first unread byte in buffer */
+	int								recv_len;	/* bytes received into buffer  */
+	char							recv_buf[HTTP_RECV_BUFFER_SIZE];
 #endif
 };
 
@@ -133,6 +160,8 @@ struct http_request
 	unsigned short					port;		/* TCP port of HTTP server */
 	char							path[1024];	/* path of the resource    */
 	int								max_redirection;/* maximum redirection count */
+	int								keep_alive;	/* HTTP_OPTION_KEEPALIVE   */
+	int								status;		/* status of the response  */
 #if (!defined(HTTP_SUPPORT_SSL_WININET)) ||(0 == HTTP_SUPPORT_SSL_WININET)
 	struct http_header			*	request_hdr;	/* request headers     */
 	struct http_header			*	response_hdr;	/* response headers    */
@@ -140,6 +169,51 @@ struct http_request
 };
 
 
+/**
+ *	Parameter of [http_char_callback], it passes the response body to a per
+ *	byte callback of type [http_callback].
+ */
+struct http_char_adapter
+{
+	http_callback					callback;	/* the per byte callback  */
+	void						*	param;		/* parameter for callback */
+};
+
+
+#if (!defined(HTTP_SUPPORT_SSL_WININET)) || (0 == HTTP_SUPPORT_SSL_WININET)
+/**
+ *	Idle keep-alive connection kept in the connection pool.
+ */
+struct http_pool_entry
+{
+	int								in_use;		/* the entry is occupied   */
+	char							server[64];	/* name of the HTTP server */
+	unsigned short					port;		/* TCP port of HTTP server */
+	int								use_ssl;	/* connected over SSL      */
+	time_t							idle_since;	/* time it became idle     */
+	ddns_socket						socket;		/* the idle connection     */
+#if defined(HTTP_SUPPORT_SSL_OPENSSL) && HTTP_SUPPORT_SSL_OPENSSL
+	SSL							*	ssl;		/* SSL layer over socket   */
+#endif
+};
+#endif	/* ! HTTP_SUPPORT_SSL_WININET */
+
+
+#if defined(HTTP_SUPPORT_SSL_OPENSSL) && HTTP_SUPPORT_SSL_OPENSSL
+/**
+ *	TLS session kept for a server, so later connections to the same server
+ *	can be resumed with an abbreviated handshake.
+ */
+struct http_ssl_session
+{
+	char							server[64];	/* name of the HTTP server */
+	unsigned short					port;		/* TCP port of HTTP server */
+	unsigned long					last_used;	/* for LRU replacement     */
+	SSL_SESSION					*	session;	/* the TLS session         */
+};
+#endif	/* HTTP_SUPPORT_SSL_OPENSSL */
+
+
 /**
  *	statsu code when parsing a uri.
  */
@@ -205,6 +279,127 @@ static struct http_header * http_free_request_header(
 static void http_free_connection(struct http_connection * connection);
 
 
+#if (!defined(HTTP_SUPPORT_SSL_WININET)) || (0 == HTTP_SUPPORT_SSL_WININET)
+/**
+ *	Close the connection of a request, including its SSL layer.
+ *
+ *	@param[in]		request		: the request whose connection is closed.
+ */
+static void http_close_connection(struct http_request * request);
+#endif	/* ! HTTP_SUPPORT_SSL_WININET */
+
+
+#if (!defined(HTTP_SUPPORT_SSL_WININET)) || (0 == HTTP_SUPPORT_SSL_WININET)
+/**
+ *	Open a new connection to the HTTP server of a request.
+ *
+ *	@param[in]	request			: the http request.
+ *
+ *	@return		Return 0 on success, otherwise an error code is returned.
+ */
+static int http_open_connection(struct http_request * request);
+#endif	/* ! HTTP_SUPPORT_SSL_WININET */
+
+
+#if (!defined(HTTP_SUPPORT_SSL_WININET)) || (0 == HTTP_SUPPORT_SSL_WININET)
+/**
+ *	Send a request over the connection, including request headers and body,
+ *	then read the response headers.
+ *
+ *	@param[in]	request			: http request header.
+ *	@param[in]	request_body	: http request body.
+ *	@param[in]	request_size	: size of request body in bytes.
+ *
+ *	@return		Return HTTP response status on success, otherwise return 0.
+ */
+static int http_transmit(
+	struct http_request		*	request,
+	const char				*	request_body,
+	int							request_size
+	);
+#endif	/* ! HTTP_SUPPORT_SSL_WININET */
+
+
+#if (!defined(HTTP_SUPPORT_SSL_WININET)) || (0 == HTTP_SUPPORT_SSL_WININET)
+/**
+ *	Determine if a request method is idempotent, so that the request can be
+ *	sent again safely after the connection failed.
+ *
+ *	@param[in]	method		: the request method.
+ *
+ *	@return		Return non-zero if the method is idempotent, otherwise 0.
+ */
+static int http_is_idempotent(
+	enum http_request_type		method
+	);
+#endif	/* ! HTTP_SUPPORT_SSL_WININET */
+
+
+#if (!defined(HTTP_SUPPORT_SSL_WININET)) || (0 == HTTP_SUPPORT_SSL_WININET)
+/**
+ *	Take an idle connection to the server of a request from the connection
+ *	pool. Connections closed by server while idle are dropped.
+ *
+ *	@param[in]	request		: the HTTP request to be connected.
+ *
+ *	@return		Return non-zero if a connection is taken, otherwise 0.
+ */
+static int http_pool_take(
+	struct http_request		*	request
+	);
+#endif	/* ! HTTP_SUPPORT_SSL_WININET */
+
+
+#if (!defined(HTTP_SUPPORT_SSL_WININET)) || (0 == HTTP_SUPPORT_SSL_WININET)
+/**
+ *	Put the connection of a request into the connection pool, so it can be
+ *	reused by following requests to the same server.
+ *
+ *	@param[in]	request		: the HTTP request to be destroyed.
+ *
+ *	@return		Return non-zero if the connection is kept in the pool, then the
+ *				request doesn't own it any more. Otherwise, 0 is returned.
+ */
+static int http_pool_put(
+	struct http_request		*	request
+	);
+#endif	/* ! HTTP_SUPPORT_SSL_WININET */
+
+
+#if (!defined(HTTP_SUPPORT_SSL_WININET)) || (0 == HTTP_SUPPORT_SSL_WININET)
+/**
+ *	Close an idle connection removed from the connection pool.
+ *
+ *	@param[in]	entry		: the connection to be closed.
+ */
+static void http_pool_close(
+	struct http_pool_entry	*	entry
+	);
+#endif	/* ! HTTP_SUPPORT_SSL_WININET */
+
+
+#if (!defined(HTTP_SUPPORT_SSL_WININET)) || (0 == HTTP_SUPPORT_SSL_WININET)
+/**
+ *	Wait until a connection is ready for read or write, or its deadline expires.
+ *
+ *	@param[in]	connection	: the HTTP connection.
+ *	@param[in]	for_read	: non-zero to wait until it's ready for read.
+ *	@param[in]	for_write	: non-zero to wait until it's ready for write.
+ *
+ *	@return		Return 1 if the connection is ready, 0 if it timed out or the
+ *				stop signal of the connection was set, otherwise -1.
+ *
+ *	@note		With a stop signal, it waits in slices of 100 ms, so the wait
+ *				stops soon after the signal is set.
+ */
+static int http_wait(
+	struct http_connection	*	connection,
+	int							for_read,
+	int							for_write
+	);
+#endif	/* ! HTTP_SUPPORT_SSL_WININET */
+
+
 #if (!defined(HTTP_SUPPORT_SSL_WININET)) || (0 == HTTP_SUPPORT_SSL_WININET)
 /**
  *	Send data through a HTTP connection.
@@ -247,6 +442,40 @@ static int http_read(
 #endif	/* ! HTTP_SUPPORT_SSL_WININET */
 
 
+#if (!defined(HTTP_SUPPORT_SSL_WININET)) || (0 == HTTP_SUPPORT_SSL_WININET)
+/**
+ *	Make sure there is unread data in the receive buffer of a connection. If
+ *	the buffer is drained, it will be refilled by a single [http_read].
+ *
+ *	@param[in]	connection	: the HTTP connection to read data from.
+ *
+ *	@return		Number of unread bytes in the receive buffer. If the peer has
+ *				closed the connection, 0 is returned. Otherwise, -1 is returned
+ *				and [ddns_socket_get_errno] can be used to retrieve the error.
+ */
+static int http_fill_buffer(
+	struct http_connection	*	connection
+	);
+#endif	/* ! HTTP_SUPPORT_SSL_WININET */
+
+
+#if (!defined(HTTP_SUPPORT_SSL_WININET)) || (0 == HTTP_SUPPORT_SSL_WININET)
+/**
+ *	Read a single byte from the receive buffer of a connection.
+ *
+ *	@param[in]	connection	: the HTTP connection to read data from.
+ *	@param[out]	chr			: the byte read from the connection.
+ *
+ *	@return		Return 1 on success, 0 if the peer has closed the connection,
+ *				or -1 if any error occurred.
+ */
+static int http_read_char(
+	struct http_connection	*	connection,
+	char					*	chr
+	);
+#endif	/* ! HTTP_SUPPORT_SSL_WININET */
+
+
 #if (!defined(HTTP_SUPPORT_SSL_WININET)) || (0 == HTTP_SUPPORT_SSL_WININET)
 /**
  *	Read HTTP response headers.
@@ -266,17 +495,33 @@ static int http_read_headers(
  *	Read HTTP response body.
  *
  *	@param[in]	request		: the HTTP request to be processed.
+ *	@param[in]	callback	: callback to receive blocks of the response body.
+ *	@param[in]	param		: extra parameter to be passed to callback function
  *
  *	@return		Upon successful completion, the size of HTTP response body is
  *				returned. Otherwise -1 will be returned.
  */
 static int http_read_body(
 	struct http_request		*	request,
-	http_callback				callback,
+	http_data_callback			callback,
 	void					*	param
 	);
 
 
+/**
+ *	Pass a block of response body to a per byte callback one by one.
+ *
+ *	@param[in]	data		: the received data.
+ *	@param[in]	size		: size of the received data in bytes.
+ *	@param[in]	adapter		: the per byte callback and its parameter.
+ */
+static void http_char_callback(
+	const char					*	data,
+	size_t							size,
+	struct http_char_adapter	*	adapter
+	);
+
+
 #if (!defined(HTTP_SUPPORT_SSL_WININET)) || (0 == HTTP_SUPPORT_SSL_WININET)
 /**
  *	Append a HTTP header to a header list.
@@ -343,6 +588,60 @@ static void http_replace_connection(
 	);
 #endif	/* ! HTTP_SUPPORT_SSL_WININET */
 
+
+#if defined(HTTP_SUPPORT_SSL_OPENSSL) && HTTP_SUPPORT_SSL_OPENSSL
+/**
+ *	Get the SSL context shared by all HTTPS requests, it will be created on
+ *	first use.
+ *
+ *	@return	Return the shared SSL context, or NULL if it can't be created.
+ */
+static SSL_CTX * http_ssl_get_context();
+#endif	/* HTTP_SUPPORT_SSL_OPENSSL */
+
+
+#if defined(HTTP_SUPPORT_SSL_OPENSSL) && HTTP_SUPPORT_SSL_OPENSSL
+/**
+ *	Attach the cached TLS session of the server to a request, if any. It must
+ *	be called before the TLS handshake.
+ *
+ *	@param[in]	request		: the HTTP request to be connected.
+ */
+static void http_ssl_resume_session(
+	struct http_request		*	request
+	);
+#endif	/* HTTP_SUPPORT_SSL_OPENSSL */
+
+
+#if defined(HTTP_SUPPORT_SSL_OPENSSL) && HTTP_SUPPORT_SSL_OPENSSL
+/**
+ *	Keep the TLS session of a connection in the session cache, and free the
+ *	SSL layer of the connection.
+ *
+ *	@param[in]	server		: name of the HTTP server.
+ *	@param[in]	port		: TCP port of the HTTP server.
+ *	@param[in]	ssl			: the SSL layer to be freed.
+ */
+static void http_ssl_close(
+	const char				*	server,
+	unsigned short				port,
+	SSL						*	ssl
+	);
+#endif	/* HTTP_SUPPORT_SSL_OPENSSL */
+
+
+/**
+ *	Lock global data of the HTTP module. It does nothing if [http_init] has
+ *	not been called.
+ */
+static void http_lock();
+
+
+/**
+ *	Unlock global data of the HTTP module, see [http_lock].
+ */
+static void http_unlock();
+
 #if defined(HTTP_SUPPORT_SSL_WININET) && HTTP_SUPPORT_SSL_WININET
 /**
  *	WinInet status callback function.
@@ -363,10 +662,123 @@ static VOID CALLBACK http_status_callback(
 #endif	/* HTTP_SUPPORT_SSL_WININET */
 
 
+/**
+ *	Global data shared by all HTTP requests, protected by [http_sync].
+ */
+static int							http_init_count	= 0;
+static struct ddns_sync_object		http_sync;
+#if (!defined(HTTP_SUPPORT_SSL_WININET)) || (0 == HTTP_SUPPORT_SSL_WININET)
+static struct http_pool_entry		http_pool[HTTP_POOL_SIZE];
+#endif
+#if defined(HTTP_SUPPORT_SSL_OPENSSL) && HTTP_SUPPORT_SSL_OPENSSL
+static SSL_CTX					*	http_ssl_ctx	= NULL;
+static struct http_ssl_session		http_ssl_sessions[HTTP_SSL_SESSION_CACHE_SIZE];
+static unsigned long				http_ssl_clock	= 0;
+#endif
+static unsigned long				http_ssl_handshakes	= 0;
+static unsigned long				http_ssl_resumed	= 0;
+
+
 /*============================================================================*
  *	Implementation of Functions
  *============================================================================*/
 
+/**
+ *	Initialize the HTTP module.
+ *
+ *	@return		Return 0 on success, otherwise an error code is returned.
+ */
+int http_init()
+{
+	int error_code = 0;
+
+	if ( 0 == http_init_count )
+	{
+		error_code = ddns_sync_init(&http_sync);
+	}
+	if ( 0 == error_code )
+	{
+		++http_init_count;
+	}
+
+	return error_code;
+}
+
+
+/**
+ *	Free global resources of the HTTP module, such as the shared SSL context
+ *	and the cached TLS sessions.
+ */
+void http_uninit()
+{
+	if ( http_init_count <= 0 )
+	{
+		return;
+	}
+
+	if ( 1 == http_init_count )
+	{
+		int idx = 0;
+
+#if (!defined(HTTP_SUPPORT_SSL_WININET)) || (0 == HTTP_SUPPORT_SSL_WININET)
+		for ( idx = 0; idx < _countof(http_pool); ++idx )
+		{
+			if ( 0 != http_pool[idx].in_use )
+			{
+				http_pool_close(&(http_pool[idx]));
+			}
+		}
+#endif
+
+#if defined(HTTP_SUPPORT_SSL_OPENSSL) && HTTP_SUPPORT_SSL_OPENSSL
+
+		for ( idx = 0; idx < _countof(http_ssl_sessions); ++idx )
+		{
+			if ( NULL != http_ssl_sessions[idx].session )
+			{
+				SSL_SESSION_free(http_ssl_sessions[idx].session);
+			}
+		}
+		memset(http_ssl_sessions, 0, sizeof(http_ssl_sessions));
+
+		if ( NULL != http_ssl_ctx )
+		{
+			SSL_CTX_free(http_ssl_ctx);
+			http_ssl_ctx = NULL;
+		}
+#endif
+
+		ddns_sync_destroy(&http_sync);
+	}
+
+	--http_init_count;
+}
+
+
+/**
+ *	Get statistics of TLS handshakes made by the HTTP module.
+ *
+ *	@param[out]	handshakes	: number of full TLS handshakes.
+ *	@param[out]	resumed		: number of TLS sessions resumed from cache.
+ */
+void http_get_ssl_statistics(
+	unsigned long		*	handshakes,
+	unsigned long		*	resumed
+	)
+{
+	http_lock();
+	if ( NULL != handshakes )
+	{
+		*handshakes = http_ssl_handshakes;
+	}
+	if ( NULL != resumed )
+	{
+		*resumed = http_ssl_resumed;
+	}
+	http_unlock();
+}
+
+
 /**
  *	Connect to HTTP server
  *
@@ -378,17 +790,19 @@ static VOID CALLBACK http_status_callback(
 int http_connect(struct http_request* request)
 {
 	int							error_code	= 0;
+#if defined(HTTP_SUPPORT_SSL_WININET) && HTTP_SUPPORT_SSL_WININET
 	struct http_connection	*	conn		= NULL;
+#endif
 
 	if ( NULL == request )
 	{
 		return -1;
 	}
 
-	conn = &(request->connection);
-
 #if defined(HTTP_SUPPORT_SSL_WININET) && HTTP_SUPPORT_SSL_WININET
 
+	conn = &(request->connection);
+
 	/**
 	 *	Use WinInet to connect to server.
 	 */
@@ -490,12 +904,39 @@ int http_connect(struct http_request* request)
 #else
 
 	/**
-	 *	Use raw socket + OpenSSL (optional) to connect to server.
+	 *	Reuse an idle connection to the same server if keep-alive is enabled,
+	 *	otherwise open a new one.
 	 */
-	conn->socket = ddns_socket_create_tcp(	request->server,
-											request->port,
-											conn->timeout,
-											NULL
+	if ( (0 == request->keep_alive) || (0 == http_pool_take(request)) )
+	{
+		error_code = http_open_connection(request);
+	}
+
+#endif	/* HTTP_SUPPORT_SSL_WININET */
+
+	return error_code;
+}
+
+#if (!defined(HTTP_SUPPORT_SSL_WININET)) || (0 == HTTP_SUPPORT_SSL_WININET)
+/**
+ *	Open a new connection to the HTTP server of a request.
+ *
+ *	@param[in]	request			: the http request.
+ *
+ *	@return		Return 0 on success, otherwise an error code is returned.
+ */
+static int http_open_connection(struct http_request * request)
+{
+	int							error_code	= 0;
+	struct http_connection	*	conn		= &(request->connection);
+
+	/**
+	 *	Use raw socket + OpenSSL (optional) to connect to server.
+	 */
+	conn->socket = ddns_socket_create_tcp(	request->server,
+											request->port,
+											&(conn->deadline),
+											conn->stop_wait
 											);
 	/* error detection */
 	if ( DDNS_INVALID_SOCKET == conn->socket )
@@ -508,7 +949,8 @@ int http_connect(struct http_request* request)
 	}
 	else
 	{
-		int blocking = (0 != conn->timeout) ? 1 : 0;
+		/* with a timeout, every wait goes through [http_wait] */
+		int blocking = (0 != conn->timeout) ? 0 : 1;
 		if ( -1 == ddns_socket_set_blocking(conn->socket, blocking) )
 		{
 			error_code = ENOTSOCK;
@@ -524,6 +966,10 @@ int http_connect(struct http_request* request)
 		{
 			error_code = HTTP_ERROR_SSL;
 		}
+		else
+		{
+			http_ssl_resume_session(request);
+		}
 	}
 	if ( (0 == error_code) && (NULL != conn->ssl) )
 	{
@@ -535,17 +981,12 @@ int http_connect(struct http_request* request)
 	}
 	if ( (0 == error_code) && (NULL != conn->ssl) )
 	{
-		fd_set fd;
-		struct timeval tv = { 0, 0 };
 		int connect_result = 0;
 
-		FD_ZERO(&fd);
-		FD_SET(conn->socket, &fd);
-
 		while ( (connect_result = SSL_connect(conn->ssl)) <= 0 )
 		{
-			fd_set * fd_read	= NULL;
-			fd_set * fd_write	= NULL;
+			int for_read	= 0;
+			int for_write	= 0;
 			int ssl_error = SSL_get_error(conn->ssl, connect_result);
 			if ( 0 == conn->timeout )
 			{
@@ -555,11 +996,11 @@ int http_connect(struct http_request* request)
 
 			if ( SSL_ERROR_WANT_READ == ssl_error )
 			{
-				fd_read = &fd;
+				for_read = 1;
 			}
 			else if ( SSL_ERROR_WANT_WRITE == ssl_error )
 			{
-				fd_write = &fd;
+				for_write = 1;
 			}
 			else
 			{
@@ -567,20 +1008,7 @@ int http_connect(struct http_request* request)
 				break;
 			}
 
-			do
-			{
-				tv.tv_sec = conn->timeout;
-				error_code = select(conn->socket + 1,
-									NULL,
-									fd_read,
-									fd_write,
-									&tv
-									);
-#if DDNS_SOCKET_UNIX
-			} while ( (-1 == error_code) && (EINTR == ddns_socket_get_errno()) );
-#else
-			} while (0);
-#endif
+			error_code = http_wait(conn, for_read, for_write);
 
 			if ( 0 == error_code )
 			{
@@ -601,13 +1029,81 @@ int http_connect(struct http_request* request)
 				break;
 			}
 		}
+
+		if ( 0 == error_code )
+		{
+			http_lock();
+			if ( SSL_session_reused(conn->ssl) )
+			{
+				++http_ssl_resumed;
+			}
+			else
+			{
+				++http_ssl_handshakes;
+			}
+			http_unlock();
+		}
 	}
 #endif	/* HTTP_SUPPORT_SSL_OPENSSL */
 
-#endif	/* HTTP_SUPPORT_SSL_WININET */
-
 	return error_code;
 }
+#endif	/* ! HTTP_SUPPORT_SSL_WININET */
+
+
+#if (!defined(HTTP_SUPPORT_SSL_WININET)) || (0 == HTTP_SUPPORT_SSL_WININET)
+/**
+ *	Send a request over the connection, including request headers and body,
+ *	then read the response headers.
+ *
+ *	@param[in]	request			: http request header.
+ *	@param[in]	request_body	: http request body.
+ *	@param[in]	request_size	: size of request body in bytes.
+ *
+ *	@return		Return HTTP response status on success, otherwise return 0.
+ */
+static int http_transmit(
+	struct http_request		*	request,
+	const char				*	request_body,
+	int							request_size
+	)
+{
+	int result = RESULT_SUCCESS;
+
+	/* Step 1: forget the response of previous attempt */
+	while ( NULL != request->response_hdr )
+	{
+		request->response_hdr = http_free_request_header(request->response_hdr);
+	}
+	request->status					= 0;
+	request->connection.reusable	= 0;
+	request->connection.sent		= 0;
+
+	/* Step 2: send request header to server */
+	if ( 0 == http_send_request_header(request) )
+	{
+		result = RESULT_FAILURE;
+	}
+
+	/* Step 3: send request body to server */
+	if ( (RESULT_SUCCESS == result) && (http_method_post == request->method) )
+	{
+		if ( -1 == http_send(&(request->connection), request_body, request_size) )
+		{
+			result = RESULT_FAILURE;
+		}
+	}
+
+	/* Step 4: wait the response from server */
+	if ( RESULT_SUCCESS == result )
+	{
+		request->status = http_read_headers(request);
+	}
+
+	return request->status;
+}
+#endif	/* ! HTTP_SUPPORT_SSL_WININET */
+
 
 /**
  *	Set options of the request.
@@ -615,6 +1111,7 @@ int http_connect(struct http_request* request)
  *	@param[in]	request			: the HTTP request.
  *	@param[in]	option			: type of the option, supported values are:
  *									- HTTP_OPTION_REDIRECT
+ *									- HTTP_OPTION_KEEPALIVE
  *	@param[in]	value			: value for the option.
  *
  *	@return		Return the original value of the request option.
@@ -631,6 +1128,11 @@ int http_set_option(struct http_request * request, int option, int value)
 			request->max_redirection = value;
 			break;
 
+		case HTTP_OPTION_KEEPALIVE:
+			original_value = request->keep_alive;
+			request->keep_alive = value;
+			break;
+
 		default:
 			break;
 		}
@@ -639,6 +1141,67 @@ int http_set_option(struct http_request * request, int option, int value)
 	return original_value;
 }
 
+/**
+ *	Set the stop signal of a request. Once the signal is set to non-zero, the
+ *	request stops waiting for the server soon, and fails as if it has timed
+ *	out.
+ *
+ *	@param[in]	request		: the HTTP request.
+ *	@param[in]	stop_wait	: pointer to the stop signal, it must be valid until
+ *							  the request is destroyed. NULL to remove it.
+ */
+void http_set_stop_signal(struct http_request * request, int * stop_wait)
+{
+	if (NULL != request)
+	{
+		request->connection.stop_wait = stop_wait;
+	}
+}
+
+/**
+ *	Set the deadline of a request. Connecting, sending and reading all share
+ *	it, so the request fails once the deadline expires, no matter how slowly
+ *	the server dribbles its response.
+ *
+ *	@param[in]	request		: the HTTP request.
+ *	@param[in]	deadline	: the deadline to be copied, NULL for no deadline.
+ */
+void http_set_deadline(
+	struct http_request			*	request,
+	const struct ddns_deadline	*	deadline
+	)
+{
+	if ( NULL != request )
+	{
+		if ( NULL != deadline )
+		{
+			request->connection.deadline = *deadline;
+		}
+		else
+		{
+			ddns_deadline_init(&(request->connection.deadline), DDNS_DEADLINE_NEVER);
+		}
+	}
+}
+
+/**
+ *	Stop reading the response body, the rest of it is discarded along with the
+ *	connection.
+ *
+ *	@param[in]	request		: the HTTP request.
+ *
+ *	@note		It's called by the callback of [http_get_response_ex] once the
+ *				wanted data is found, [http_get_response_ex] then returns as
+ *				soon as the callback returns.
+ */
+void http_stop_response(struct http_request * request)
+{
+	if (NULL != request)
+	{
+		request->connection.stopped = 1;
+	}
+}
+
 /**
  *	Create a HTTP request.
  *
@@ -669,6 +1232,8 @@ struct http_request * http_create_request(
 			memset(request, 0, sizeof(*request));
 
 			request->connection.timeout	= timeout;
+			ddns_deadline_init(	&(request->connection.deadline),
+								(0 != timeout) ? (timeout * 1000UL) : DDNS_DEADLINE_NEVER );
 #if (!defined(HTTP_SUPPORT_SSL_WININET)) || (0 == HTTP_SUPPORT_SSL_WININET)
 			request->connection.socket	= DDNS_INVALID_SOCKET;
 #endif
@@ -679,14 +1244,12 @@ struct http_request * http_create_request(
 		request = malloc(sizeof(*request));
 		if ( NULL != request )
 		{
-#if defined(HTTP_SUPPORT_SSL_OPENSSL) && HTTP_SUPPORT_SSL_OPENSSL
-			static int ssl_init = 0;
-#endif
-
 			uri += 8 /* "https://" */;
 			memset(request, 0, sizeof(*request));
 
 			request->connection.timeout	= timeout;
+			ddns_deadline_init(	&(request->connection.deadline),
+								(0 != timeout) ? (timeout * 1000UL) : DDNS_DEADLINE_NEVER );
 #if defined(HTTP_SUPPORT_SSL_WININET) && HTTP_SUPPORT_SSL_WININET
 			request->connection.use_ssl = 1;
 #else
@@ -694,15 +1257,12 @@ struct http_request * http_create_request(
 #endif
 
 #if defined(HTTP_SUPPORT_SSL_OPENSSL) && HTTP_SUPPORT_SSL_OPENSSL
-			if ( 0 == ssl_init )
+			request->ssl_ctx			= http_ssl_get_context();
+			if ( NULL == request->ssl_ctx )
 			{
-				ssl_init = 1;
-				SSL_load_error_strings();	/* readable error messages */
-				SSL_library_init();			/* initialize library */
-				http_RAND();				/* initialize PRNG */
+				http_destroy_request(request);
+				request = NULL;
 			}
-
-			request->ssl_ctx			= SSL_CTX_new(SSLv23_client_method());
 #endif
 		}
 	}
@@ -906,22 +1466,23 @@ void http_destroy_request(
 	}
 #endif
 
-#if defined(HTTP_SUPPORT_SSL_OPENSSL) && HTTP_SUPPORT_SSL_OPENSSL
-	/* Step 2: close SSL tunnel */
-	if ( NULL != request->connection.ssl )
-	{
-		SSL_free(request->connection.ssl);
-		request->connection.ssl = NULL;
-	}
-	if ( NULL != request->ssl_ctx )
+	/**
+	 *	Step 2: keep the connection for later requests if possible, otherwise
+	 *	close SSL tunnel and TCP connection. The SSL context is shared.
+	 */
+#if (!defined(HTTP_SUPPORT_SSL_WININET)) || (0 == HTTP_SUPPORT_SSL_WININET)
+	if ( (0 == request->keep_alive) || (0 == http_pool_put(request)) )
 	{
-		SSL_CTX_free(request->ssl_ctx);
-		request->ssl_ctx = NULL;
+		http_close_connection(request);
 	}
+#else
+	http_free_connection(&(request->connection));
+#endif
+#if defined(HTTP_SUPPORT_SSL_OPENSSL) && HTTP_SUPPORT_SSL_OPENSSL
+	request->ssl_ctx = NULL;
 #endif
 
-	/* Step 3: close TCP connection */
-	http_free_connection(&(request->connection));
+	/* Step 3: free WinInet handles */
 #if defined(HTTP_SUPPORT_SSL_WININET) && HTTP_SUPPORT_SSL_WININET
 	if ( NULL != request->handle_open )
 	{
@@ -1049,34 +1610,43 @@ int http_send_request(
 
 #else
 
-	/* Step 3: send request header to server */
 	do
 	{
+		/* Step 3: send request to server and wait for the response */
 		if ( RESULT_SUCCESS == result )
 		{
-			if ( 0 == http_send_request_header(request) )
-			{
-				result = RESULT_FAILURE;
+			status = http_transmit(request, request_body, request_size);
+			if ( (0 == status)
+				&& (0 != request->connection.reused)
+				&& (	(0 == request->connection.sent)
+					||	(0 != http_is_idempotent(request->method))	) )
+			{
+				/**
+				 *	Idle connection was closed by server, retry on a new one.
+				 *	The server may have got a POST already, so it's retried
+				 *	only if none of it was sent.
+				 */
+				http_close_connection(request);
+				if ( 0 == http_open_connection(request) )
+				{
+					status = http_transmit(request, request_body, request_size);
+				}
 			}
-		}
-	
-		/* Step 4: send request body to server */
-		if ( (RESULT_SUCCESS == result) && (http_method_post == request->method) )
-		{
-			if ( -1 == http_send(&(request->connection), request_body, request_size) )
+			if ( 0 == status )
 			{
 				result = RESULT_FAILURE;
 			}
 		}
 
-		/* Step 5: wait the response from server */
+		/* Step 4: follow redirection */
 		if (RESULT_SUCCESS == result)
 		{
-			status = http_read_headers(request);
 			if (HTTP_STATUS_PERMANENT_REDIRECT == status || HTTP_STATUS_TEMPORARY_REDIRECT == status)
 			{
 				const char * redirect_to = http_get_header(request->response_hdr, "Location");
 				struct http_request * new_request = http_create_request(request->method, redirect_to, request->connection.timeout);
+				http_set_stop_signal(new_request, request->connection.stop_wait);
+				http_set_deadline(new_request, &(request->connection.deadline));
 				if (NULL != new_request && 0 == http_connect(new_request))
 				{
 					http_replace_connection(request, new_request);
@@ -1084,13 +1654,10 @@ int http_send_request(
 					++redirection_count;
 
 					http_add_header(request, "Host", request->server, 1);
-					while(NULL != request->response_hdr)
-					{
-						request->response_hdr = http_free_request_header(request->response_hdr);
-					}
 				}
 				else
 				{
+					http_destroy_request(new_request);
 					result = RESULT_FAILURE;
 				}
 			}
@@ -1122,6 +1689,34 @@ int http_get_response(
 	struct http_request	*	request,
 	http_callback			callback,
 	void				*	param)
+{
+	struct http_char_adapter adapter;
+
+	adapter.callback	= callback;
+	adapter.param		= param;
+
+	return http_get_response_ex(request,
+								(http_data_callback)&http_char_callback,
+								&adapter
+								);
+}
+
+
+/**
+ *	Get HTTP response from server, received data is passed in blocks.
+ *
+ *	@param[in]	request		: the HTTP request
+ *	@param[in]	callback	: pointer to the callback function, it receives the
+ *							  response body block by block, as soon as the data
+ *							  arrives. The data is only valid during the call.
+ *	@param[in]	param		: extra parameter to be passed to callback function
+ *
+ *	@return		Return non-zero on success, otherwise 0 will be returned.
+ */
+int http_get_response_ex(
+	struct http_request	*	request,
+	http_data_callback		callback,
+	void				*	param)
 {
 	int result = RESULT_SUCCESS;
 
@@ -1236,8 +1831,8 @@ int http_urlencode(
 			if ( dst < out_size )
 			{
 				output[dst] = buffer[src];
-				++dst;
 			}
+			++dst;
 		}
 		else if ( buffer[src] == ' ' )
 		{
@@ -1245,22 +1840,18 @@ int http_urlencode(
 			{
 				output[dst] = '+';
 			}
+			++dst;
 		}
 		else
 		{
 			if ( dst + 3 < out_size )
 			{
-				output[dst] = '%';
-				++dst;
-				dst += c99_snprintf(output + dst,
-									out_size - dst,
-									"%02x",
-									(int)buffer[src]);
-			}
-			else
-			{
-				dst += 3;
+				c99_snprintf(	output + dst,
+								out_size - dst,
+								"%%%02x",
+								(unsigned int)(unsigned char)buffer[src]);
 			}
+			dst += 3;
 		}
 	}
 
@@ -1344,7 +1935,7 @@ static const char * http_get_method_name(
  *	default value for the following request headers if they aren't set:
  *
  *		Host			= < server name of the request >
- *		Connection		= "close"
+ *		Connection		= "close", or "keep-alive" if HTTP_OPTION_KEEPALIVE
  *		User-Agent		= "crystal-http"
  *		Accept-Charset	= "*"
  *		Accept-Encoding	= "*"
@@ -1361,7 +1952,8 @@ static int http_send_request_header(
 	int result			= RESULT_SUCCESS;
 	int header_length	= 0;
 
-	char request_header[1024];
+	/* a full [path] of the request line, and the headers */
+	char request_header[2048];
 
 	/* Step 1: parameter validity check */
 	if ( RESULT_SUCCESS == result )
@@ -1429,7 +2021,10 @@ static int http_send_request_header(
 		 *	connections MUST include the "close" connection option in every
 		 *	message.
 		 */
-		http_add_header(request, "Connection", "close", 0);
+		http_add_header(request,
+						"Connection",
+						(0 != request->keep_alive) ? "keep-alive" : "close",
+						0 );
 	}
 
 	/* Step 2: Construct HTTP request header */
@@ -1685,8 +2280,101 @@ static void http_free_connection(struct http_connection * connection)
 		ddns_socket_close(connection->socket);
 		connection->socket = DDNS_INVALID_SOCKET;
 	}
+	connection->recv_pos = 0;
+	connection->recv_len = 0;
+	connection->reused	 = 0;
+	connection->reusable = 0;
+	connection->sent	 = 0;
+#endif
+}
+
+
+#if (!defined(HTTP_SUPPORT_SSL_WININET)) || (0 == HTTP_SUPPORT_SSL_WININET)
+/**
+ *	Close the connection of a request, including its SSL layer.
+ *
+ *	@param[in]		request		: the request whose connection is closed.
+ */
+static void http_close_connection(struct http_request * request)
+{
+#if defined(HTTP_SUPPORT_SSL_OPENSSL) && HTTP_SUPPORT_SSL_OPENSSL
+	http_ssl_close(request->server, request->port, request->connection.ssl);
+	request->connection.ssl = NULL;
+#endif
+
+	http_free_connection(&(request->connection));
+}
+#endif	/* ! HTTP_SUPPORT_SSL_WININET */
+
+
+#if (!defined(HTTP_SUPPORT_SSL_WININET)) || (0 == HTTP_SUPPORT_SSL_WININET)
+/**
+ *	Wait until a connection is ready for read or write, or its deadline expires.
+ *
+ *	@param[in]	connection	: the HTTP connection.
+ *	@param[in]	for_read	: non-zero to wait until it's ready for read.
+ *	@param[in]	for_write	: non-zero to wait until it's ready for write.
+ *
+ *	@return		Return 1 if the connection is ready, 0 if it timed out or the
+ *				stop signal of the connection was set, otherwise -1.
+ *
+ *	@note		With a stop signal, it waits in slices of 100 ms, so the wait
+ *				stops soon after the signal is set.
+ */
+static int http_wait(
+	struct http_connection	*	connection,
+	int							for_read,
+	int							for_write
+	)
+{
+	int				count	= 0;
+	int				events	= 0;
+	unsigned long	remain	= 0;	/* in ms */
+
+	if ( 0 != for_read )
+	{
+		events |= DDNS_SOCKET_EVENT_READ;
+	}
+	if ( 0 != for_write )
+	{
+		events |= DDNS_SOCKET_EVENT_WRITE;
+	}
+
+	while ( 0 != (remain = ddns_deadline_remain(&(connection->deadline))) )
+	{
+		if ( (NULL != connection->stop_wait) && (0 != *(connection->stop_wait)) )
+		{
+			count = 0;
+			break;
+		}
+
+		if ( (NULL != connection->stop_wait) && (remain > 100) )
+		{
+			remain = 100;
+		}
+		else if ( remain > 1000 )
+		{
+			remain = 1000;
+		}
+		count = ddns_socket_wait(connection->socket, events, remain);
+#if DDNS_SOCKET_UNIX
+		if ( (-1 == count) && (EINTR == ddns_socket_get_errno()) )
+		{
+			continue;
+		}
 #endif
+
+		if ( 0 != count )
+		{
+			/* ready, whatever the events are */
+			count = (count > 0) ? 1 : -1;
+			break;
+		}
+	}
+
+	return count;
 }
+#endif	/* ! HTTP_SUPPORT_SSL_WININET */
 
 
 #if (!defined(HTTP_SUPPORT_SSL_WININET)) || (0 == HTTP_SUPPORT_SSL_WININET)
@@ -1721,72 +2409,67 @@ static int http_send(
 	if ( NULL == connection->ssl )
 #endif
 	{
-		if ( 0 != connection->timeout )
-		{
-			fd_set fd;
-			struct timeval tv = { 0, 0 };
-
-			FD_ZERO(&fd);
-			FD_SET(connection->socket, &fd);
-
-			do
-			{
-				tv.tv_sec = connection->timeout;
-				count = select(connection->socket + 1, NULL, &fd, NULL, &tv);
-#if DDNS_SOCKET_UNIX
-			} while ( (-1 == count) && (EINTR == ddns_socket_get_errno()) );
-#else
-			} while (0);
-#endif
-		}
-
-		if ( 0 == count )
-		{
-			/* timeout */
-			ddns_socket_set_errno(ETIMEDOUT);
-			retval = -1;
-		}
-		else if ( 1 == count )
-		{
-			/* ready to read from socket */
-			retval = send(connection->socket, buffer, size, 0);
-		}
-		else
-		{
-			/* unknown error */
-			retval = -1;
-			assert(0);
-		}
-	}
-#if defined(HTTP_SUPPORT_SSL_OPENSSL) && HTTP_SUPPORT_SSL_OPENSSL
-	else
-	{
-		fd_set fd;
-		struct timeval tv = { 0, 0 };
+		int sent = 0;
 
-		FD_ZERO(&fd);
-		FD_SET(connection->socket, &fd);
-
-		while ( (retval = SSL_write(connection->ssl, buffer, size)) <= 0 )
+		/* a non-blocking socket may take the data in several pieces */
+		while ( retval < size )
 		{
-			fd_set * fd_read	= NULL;
-			fd_set * fd_write	= NULL;
-			int ssl_error = SSL_get_error(connection->ssl, retval);
-
-			if ( 0 == connection->timeout )
+			if ( 0 != connection->timeout )
 			{
-				ddns_socket_set_errno(ssl_error);
-				retval = -1;
-				break;
+				count = http_wait(connection, 0, 1);
+			}
+
+			if ( 0 == count )
+			{
+				/* timeout */
+				ddns_socket_set_errno(ETIMEDOUT);
+				retval = -1;
+				break;
+			}
+			else if ( 1 == count )
+			{
+				/* ready to write to socket */
+				sent = send(connection->socket, buffer + retval, size - retval, 0);
+				if ( sent < 0 )
+				{
+					retval = -1;
+					break;
+				}
+				retval				+= sent;
+				connection->sent	+= sent;
+			}
+			else
+			{
+				/* unknown error */
+				retval = -1;
+				assert(0);
+				break;
+			}
+		}
+	}
+#if defined(HTTP_SUPPORT_SSL_OPENSSL) && HTTP_SUPPORT_SSL_OPENSSL
+	else
+	{
+		while ( (retval = SSL_write(connection->ssl, buffer, size)) <= 0 )
+		{
+			int for_read	= 0;
+			int for_write	= 0;
+			int ssl_error = SSL_get_error(connection->ssl, retval);
+
+			if ( 0 == connection->timeout )
+			{
+				ddns_socket_set_errno(ssl_error);
+				retval = -1;
+				break;
 			}
 
 			if ( SSL_ERROR_WANT_READ == ssl_error )
 			{
-				fd_read = &fd;
+				for_read = 1;
 			}
 			else if ( SSL_ERROR_WANT_WRITE == ssl_error )
 			{
-				fd_write = &fd;
+				for_write = 1;
 			}
 			else
 			{
@@ -1795,20 +2478,7 @@ static int http_send(
 				break;
 			}
 
-			do
-			{
-				tv.tv_sec = connection->timeout;
-				count = select(	connection->socket + 1,
-								fd_read,
-								fd_write,
-								NULL,
-								&tv
-								);
-#if DDNS_SOCKET_UNIX
-			} while ( (-1 == count) && (EINTR == ddns_socket_get_errno()) );
-#else
-			} while (0);
-#endif
+			count = http_wait(connection, for_read, for_write);
 
 			if ( 0 == count )
 			{
@@ -1830,6 +2500,11 @@ static int http_send(
 				break;
 			}
 		}
+
+		if ( retval > 0 )
+		{
+			connection->sent += retval;
+		}
 	}
 #endif
 
@@ -1872,27 +2547,13 @@ static int http_read(
 	{
 		if ( 0 != connection->timeout )
 		{
-			fd_set fd;
-			struct timeval tv = { 0, 0 };
-			
-			FD_ZERO(&fd);
-			FD_SET(connection->socket, &fd);
-			
-			do
-			{
-				tv.tv_sec = connection->timeout;
-				count = select(connection->socket + 1, &fd, NULL, NULL, &tv);
-#if DDNS_SOCKET_UNIX
-			} while ( (-1 == count) && (EINTR == ddns_socket_get_errno()) );
-#else
-			} while (0);
-#endif
+			count = http_wait(connection, 1, 0);
 		}
 
 		if ( 0 == count )
 		{
 			/* timeout */
-			ddns_socket_get_errno(ETIMEDOUT);
+			ddns_socket_set_errno(ETIMEDOUT);
 			retval = -1;
 		}
 		else if ( 1 == count )
@@ -1910,16 +2571,10 @@ static int http_read(
 #if defined(HTTP_SUPPORT_SSL_OPENSSL) && HTTP_SUPPORT_SSL_OPENSSL
 	else
 	{
-		fd_set fd;
-		struct timeval tv = { 0, 0 };
-
-		FD_ZERO(&fd);
-		FD_SET(connection->socket, &fd);
-
 		while ( (retval = SSL_read(connection->ssl, buffer, size)) <= 0 )
 		{
-			fd_set * fd_read	= NULL;
-			fd_set * fd_write	= NULL;
+			int for_read	= 0;
+			int for_write	= 0;
 			int ssl_error = SSL_get_error(connection->ssl, retval);
 			if ( 0 == connection->timeout )
 			{
@@ -1930,11 +2585,11 @@ static int http_read(
 
 			if ( SSL_ERROR_WANT_READ == ssl_error )
 			{
-				fd_read = &fd;
+				for_read = 1;
 			}
 			else if ( SSL_ERROR_WANT_WRITE == ssl_error )
 			{
-				fd_write = &fd;
+				for_write = 1;
 			}
 			else
 			{
@@ -1943,20 +2598,7 @@ static int http_read(
 				break;
 			}
 
-			do
-			{
-				tv.tv_sec = connection->timeout;
-				count = select(	connection->socket + 1,
-								fd_read,
-								fd_write,
-								NULL,
-								&tv
-								);
-#if DDNS_SOCKET_UNIX
-			} while ( (-1 == count) && (EINTR == ddns_socket_get_errno()) );
-#else
-			} while (0);
-#endif	
+			count = http_wait(connection, for_read, for_write);
 
 			if ( 0 == count )
 			{
@@ -1986,6 +2628,75 @@ static int http_read(
 #endif	/* ! HTTP_SUPPORT_SSL_WININET */
 
 
+#if (!defined(HTTP_SUPPORT_SSL_WININET)) || (0 == HTTP_SUPPORT_SSL_WININET)
+/**
+ *	Make sure there is unread data in the receive buffer of a connection. If
+ *	the buffer is drained, it will be refilled by a single [http_read].
+ *
+ *	@param[in]	connection	: the HTTP connection to read data from.
+ *
+ *	@return		Number of unread bytes in the receive buffer. If the peer has
+ *				closed the connection, 0 is returned. Otherwise, -1 is returned
+ *				and [ddns_socket_get_errno] can be used to retrieve the error.
+ */
+static int http_fill_buffer(
+	struct http_connection	*	connection
+	)
+{
+	int result = 0;
+
+	if ( connection->recv_pos >= connection->recv_len )
+	{
+		connection->recv_pos = 0;
+		connection->recv_len = 0;
+
+		result = http_read(	connection,
+							connection->recv_buf,
+							sizeof(connection->recv_buf)
+							);
+		if ( result > 0 )
+		{
+			connection->recv_len = result;
+		}
+	}
+	else
+	{
+		result = connection->recv_len - connection->recv_pos;
+	}
+
+	return result;
+}
+#endif	/* ! HTTP_SUPPORT_SSL_WININET */
+
+
+#if (!defined(HTTP_SUPPORT_SSL_WININET)) || (0 == HTTP_SUPPORT_SSL_WININET)
+/**
+ *	Read a single byte from the receive buffer of a connection.
+ *
+ *	@param[in]	connection	: the HTTP connection to read data from.
+ *	@param[out]	chr			: the byte read from the connection.
+ *
+ *	@return		Return 1 on success, 0 if the peer has closed the connection,
+ *				or -1 if any error occurred.
+ */
+static int http_read_char(
+	struct http_connection	*	connection,
+	char					*	chr
+	)
+{
+	int result = http_fill_buffer(connection);
+
+	if ( result > 0 )
+	{
+		*chr = connection->recv_buf[connection->recv_pos++];
+		result = 1;
+	}
+
+	return result;
+}
+#endif	/* ! HTTP_SUPPORT_SSL_WININET */
+
+
 #if (!defined(HTTP_SUPPORT_SSL_WININET)) || (0 == HTTP_SUPPORT_SSL_WININET)
 /**
  *	Read HTTP headers.
@@ -2026,7 +2737,7 @@ static int http_read_headers(
 	/**
 	 * Step 1: Status-Line = HTTP-Version SP Status-Code SP Reason-Phrase CRLF
 	 */
-	while (	(result = http_read(&(request->connection), &chr, 1)) > 0 )
+	while (	(result = http_read_char(&(request->connection), &chr)) > 0 )
 	{
 		/* "HTTP-Version" */
 		if ( (statusVersion == status) && (' '!= chr) )
@@ -2081,7 +2792,7 @@ static int http_read_headers(
 	/**
 	 *	Step 2: handle "general-header", "response-header" and "entity-header"
 	 */
-	while ( (result > 0) && (http_read(&(request->connection), &chr, 1) > 0) )
+	while ( (result > 0) && (http_read_char(&(request->connection), &chr) > 0) )
 	{
 		if ( (':' == chr) && (status == statusName) )
 		{
@@ -2141,19 +2852,23 @@ static int http_read_headers(
  *	Read HTTP response body.
  *
  *	@param[in]	request		: the HTTP request to be processed.
+ *	@param[in]	callback	: callback to receive blocks of the response body.
+ *	@param[in]	param		: extra parameter to be passed to callback function
  *
  *	@return		Upon successful completion, the size of HTTP response body is
  *				returned. Otherwise -1 will be returned.
  */
 static int http_read_body(
 	struct http_request		*	request,
-	http_callback				callback,
+	http_data_callback			callback,
 	void					*	param
 	)
 {
 	long			content_length	= 0;
 #if (!defined(HTTP_SUPPORT_SSL_WININET)) || (0 == HTTP_SUPPORT_SSL_WININET)
 	const char	*	encoding		= NULL;
+	const char	*	length			= NULL;
+	int				complete		= 0;
 #endif
 
 	/* Step 1: parameter validity check */
@@ -2162,27 +2877,29 @@ static int http_read_body(
 		return -1;
 	}
 
+	request->connection.stopped = 0;
+
 #if defined(HTTP_SUPPORT_SSL_WININET) && HTTP_SUPPORT_SSL_WININET
 
 	if ( NULL != request->connection.handle_resource )
 	{
-		char	chr		= 0;
+		char	data[4096];
 		DWORD	recv_bytes	= 0;
-		while ( 1 )
+		while ( 0 == request->connection.stopped )
 		{
 			BOOL result = InternetReadFile(request->connection.handle_resource,
-											&chr,
-											1,
+											data,
+											sizeof(data),
 											&recv_bytes
 											);
 			if (TRUE == result)
 			{
 				if (recv_bytes > 0)
 				{
-					++content_length;
+					content_length += recv_bytes;
 					if ( NULL != callback )
 					{
-						(*callback)(chr, param);
+						(*callback)(data, recv_bytes, param);
 					}
 				}
 				else
@@ -2221,17 +2938,54 @@ static int http_read_body(
 
 #else	/* if (!defined(HTTP_SUPPORT_SSL_OPENSSL)) || (0 == HTTP_SUPPORT_SSL_OPENSSL) */
 
-	encoding = http_get_header(request->response_hdr, "Transfer-Encoding");
-	if ( 0 != strcmp("chunked", encoding) )
+	encoding	= http_get_header(request->response_hdr, "Transfer-Encoding");
+	length		= http_get_header(request->response_hdr, "Content-Length");
+	if (	(http_method_head == request->method)
+		||	((100 <= request->status) && (request->status < 200))
+		||	(204 == request->status)
+		||	(304 == request->status) )
 	{
-		char chr = 0;
-		while ( http_read(&(request->connection), &chr, 1) > 0 )
+		/* RFC 2616: these responses never include a message-body */
+		complete = 1;
+	}
+	else if ( (0 != strcmp("chunked", encoding)) && ('\0' != length[0]) )
+	{
+		/* Content-Length: read exactly the given size */
+		struct http_connection	*	conn		= &(request->connection);
+		long						remaining	= strtol(length, NULL, 10);
+		int							size		= 0;
+		while (		(remaining > 0)
+				&&	(0 == conn->stopped)
+				&&	((size = http_fill_buffer(conn)) > 0) )
 		{
-			++content_length;
+			if ( size > remaining )
+			{
+				size = remaining;
+			}
+			content_length	+= size;
+			remaining		-= size;
 			if ( NULL != callback )
 			{
-				(*callback)(chr, param);
+				(*callback)(conn->recv_buf + conn->recv_pos, size, param);
 			}
+			conn->recv_pos += size;
+		}
+		complete = (remaining <= 0) ? 1 : 0;
+	}
+	else if ( 0 != strcmp("chunked", encoding) )
+	{
+		/* no framing: the body ends when server closes the connection */
+		struct http_connection	*	conn	= &(request->connection);
+		int							size	= 0;
+		while ( (0 == conn->stopped) && ((size = http_fill_buffer(conn)) > 0) )
+		{
+			/* deliver everything buffered, then refill with one read */
+			content_length += size;
+			if ( NULL != callback )
+			{
+				(*callback)(conn->recv_buf + conn->recv_pos, size, param);
+			}
+			conn->recv_pos = conn->recv_len;
 		}
 	}
 	else
@@ -2244,15 +2998,54 @@ static int http_read_body(
 			statusExtension,	/* chunk-extension */
 			statusSeparater,	/* separater - CRLF */
 			statusBody,			/* chunked body */
-			statusTerminator	/* end of a chunked section */
+			statusTerminator,	/* end of a chunked section */
+			statusTrailer		/* trailer after the last chunk */
 		};
 
-		char				chr			= 0;
-		long	 			chunked_size	= 0;
-		long				read_size		= 0;
-		enum read_status	status			= statusSize;
-		while ( http_read(&(request->connection), &chr, 1) > 0 )
-		{
+		struct http_connection	*	conn			= &(request->connection);
+		char						chr				= 0;
+		long	 					chunked_size	= 0;
+		long						read_size		= 0;
+		long						trailer_size	= 0;
+		enum read_status			status			= statusSize;
+		while (		(0 == complete)
+				&&	(0 == conn->stopped)
+				&&	(http_fill_buffer(conn) > 0) )
+		{
+			/* "chunk-data" is delivered straight from the receive buffer */
+			if ( (statusBody == status) && (read_size < chunked_size) )
+			{
+				long size = conn->recv_len - conn->recv_pos;
+				if ( size > chunked_size - read_size )
+				{
+					size = chunked_size - read_size;
+				}
+				if ( NULL != callback )
+				{
+					(*callback)(conn->recv_buf + conn->recv_pos, size, param);
+				}
+				conn->recv_pos	+= size;
+				read_size		+= size;
+				continue;
+			}
+
+			chr = conn->recv_buf[conn->recv_pos++];
+
+			/* "trailer" lines after "last-chunk", up to an empty line */
+			if ( statusTrailer == status )
+			{
+				if ( '\n' == chr )
+				{
+					complete		= (0 == trailer_size) ? 1 : 0;
+					trailer_size	= 0;
+				}
+				else if ( '\r' != chr )
+				{
+					++trailer_size;
+				}
+				continue;
+			}
+
 			/* Step 1: read "chunk-size" */
 			if ( (statusSize == status) && ('0' <= chr) && (chr <= '9') )
 			{
@@ -2285,7 +3078,8 @@ static int http_read_body(
 			}
 			else if ( (statusSeparater == status) && ('\n' == chr) )
 			{
-				status		= statusBody;
+				/* "last-chunk" has a size of zero */
+				status		= (0 != chunked_size) ? statusBody : statusTrailer;
 				read_size	= 0;
 				continue;
 			}
@@ -2295,18 +3089,7 @@ static int http_read_body(
 				status = statusExtension;
 			}
 
-			/* Step 4: read "chunk-data"  */
-			if ( (statusBody == status) && (read_size < chunked_size) )
-			{
-				if ( NULL != callback )
-				{
-					(*callback)(chr, param);
-				}
-				++read_size;
-				continue;
-			}
-
-			/* Step 5: read "CRLF" and the end of a chunk */
+			/* Step 4: read "CRLF" and the end of a chunk */
 			if ( statusBody == status )
 			{
 				content_length	+= read_size;
@@ -2320,12 +3103,44 @@ static int http_read_body(
 		}
 	}
 
+	/* the connection can be reused if the whole response is read */
+	if (	(0 != complete)
+		&&	(0 != ddns_strcasecmp("close", http_get_header(request->response_hdr, "Connection"))) )
+	{
+		request->connection.reusable = 1;
+	}
+
 #endif	/* HTTP_SUPPORT_SSL_WININET */
 
 	return content_length;
 }
 
 
+/**
+ *	Pass a block of response body to a per byte callback one by one.
+ *
+ *	@param[in]	data		: the received data.
+ *	@param[in]	size		: size of the received data in bytes.
+ *	@param[in]	adapter		: the per byte callback and its parameter.
+ */
+static void http_char_callback(
+	const char					*	data,
+	size_t							size,
+	struct http_char_adapter	*	adapter
+	)
+{
+	size_t idx = 0;
+
+	if ( (NULL != adapter) && (NULL != adapter->callback) )
+	{
+		for ( idx = 0; idx < size; ++idx )
+		{
+			(*adapter->callback)(data[idx], adapter->param);
+		}
+	}
+}
+
+
 #if (!defined(HTTP_SUPPORT_SSL_WININET)) || (0 == HTTP_SUPPORT_SSL_WININET)
 /**
  *	Get value of a HTTP header in a header list.
@@ -2372,32 +3187,254 @@ static void http_replace_connection(
 	struct http_request * src
 	)
 {
+	http_close_connection(dst);
+
 	c99_strncpy(dst->server, src->server, sizeof(dst->server));
 	c99_strncpy(dst->path, src->path, sizeof(dst->path));
+	dst->port = src->port;
 
 	dst->connection.timeout = src->connection.timeout;
+	dst->connection.deadline = src->connection.deadline;
 
-	http_free_connection(&(dst->connection));
 	dst->connection.socket = src->connection.socket;
 	src->connection.socket = DDNS_INVALID_SOCKET;
 
+	/* data buffered from the old connection must not leak into the new one */
+	dst->connection.recv_pos = 0;
+	dst->connection.recv_len = 0;
+
 #if defined(HTTP_SUPPORT_SSL_OPENSSL) && HTTP_SUPPORT_SSL_OPENSSL
-	if (NULL != dst->connection.ssl)
-	{
-		SSL_free(dst->connection.ssl);
-		dst->connection.ssl = NULL;
-	}
 	dst->connection.ssl = src->connection.ssl;
 	src->connection.ssl = NULL;
 
-	if (NULL != dst->ssl_ctx)
+	dst->ssl_ctx = src->ssl_ctx;
+#endif
+}
+#endif	/* ! HTTP_SUPPORT_SSL_WININET */
+
+
+#if (!defined(HTTP_SUPPORT_SSL_WININET)) || (0 == HTTP_SUPPORT_SSL_WININET)
+/**
+ *	Determine if a request method is idempotent, so that the request can be
+ *	sent again safely after the connection failed.
+ *
+ *	@param[in]	method		: the request method.
+ *
+ *	@return		Return non-zero if the method is idempotent, otherwise 0.
+ */
+static int http_is_idempotent(
+	enum http_request_type		method
+	)
+{
+	int idempotent = 1;
+
+	switch ( method )
 	{
-		SSL_CTX_free(dst->ssl_ctx);
-		dst->ssl_ctx = NULL;
+	case http_method_post:
+	case http_method_connect:
+		idempotent = 0;
+		break;
+
+	default:
+		break;
 	}
-	dst->ssl_ctx = src->ssl_ctx;
-	src->ssl_ctx = NULL;
+
+	return idempotent;
+}
+#endif	/* ! HTTP_SUPPORT_SSL_WININET */
+
+
+#if (!defined(HTTP_SUPPORT_SSL_WININET)) || (0 == HTTP_SUPPORT_SSL_WININET)
+/**
+ *	Take an idle connection to the server of a request from the connection
+ *	pool. Connections closed by server while idle are dropped.
+ *
+ *	@param[in]	request		: the HTTP request to be connected.
+ *
+ *	@return		Return non-zero if a connection is taken, otherwise 0.
+ */
+static int http_pool_take(
+	struct http_request		*	request
+	)
+{
+	struct http_pool_entry	expired[HTTP_POOL_SIZE];
+	struct http_pool_entry	found;
+	time_t					now			= time(NULL);
+	int						use_ssl		= 0;
+	int						expired_cnt	= 0;
+	int						idx			= 0;
+
+#if defined(HTTP_SUPPORT_SSL_OPENSSL) && HTTP_SUPPORT_SSL_OPENSSL
+	use_ssl = (NULL != request->ssl_ctx) ? 1 : 0;
+#endif
+	memset(&found, 0, sizeof(found));
+
+	/**
+	 *	Step 1: pick a connection to the same server, and remove connections
+	 *	which have been idle for too long. They are closed out of the lock.
+	 */
+	http_lock();
+	for ( idx = 0; idx < _countof(http_pool); ++idx )
+	{
+		struct http_pool_entry * entry = &(http_pool[idx]);
+		if ( 0 == entry->in_use )
+		{
+			continue;
+		}
+
+		if ( now - entry->idle_since > HTTP_POOL_IDLE_TIMEOUT )
+		{
+			expired[expired_cnt++] = *entry;
+			entry->in_use = 0;
+		}
+		else if (	(0 == found.in_use)
+				&&	(use_ssl == entry->use_ssl)
+				&&	(request->port == entry->port)
+				&&	(0 == ddns_strcasecmp(request->server, entry->server)) )
+		{
+			found = *entry;
+			entry->in_use = 0;
+		}
+	}
+	http_unlock();
+
+	for ( idx = 0; idx < expired_cnt; ++idx )
+	{
+		http_pool_close(&(expired[idx]));
+	}
+
+	/**
+	 *	Step 2: an idle connection should have nothing to read, otherwise it
+	 *	has been closed by server.
+	 */
+	if ( 0 != found.in_use )
+	{
+		int count = ddns_socket_wait(found.socket, DDNS_SOCKET_EVENT_READ, 0);
+#if defined(HTTP_SUPPORT_SSL_OPENSSL) && HTTP_SUPPORT_SSL_OPENSSL
+		if ( (NULL != found.ssl) && (SSL_pending(found.ssl) > 0) )
+		{
+			count = 1;
+		}
+#endif
+		if ( 0 != count )
+		{
+			http_pool_close(&found);
+		}
+	}
+
+	/* Step 3: attach the connection to the request */
+	if ( 0 != found.in_use )
+	{
+		http_free_connection(&(request->connection));
+		request->connection.socket	= found.socket;
+		request->connection.reused	= 1;
+#if defined(HTTP_SUPPORT_SSL_OPENSSL) && HTTP_SUPPORT_SSL_OPENSSL
+		request->connection.ssl		= found.ssl;
+#endif
+	}
+
+	return found.in_use;
+}
+#endif	/* ! HTTP_SUPPORT_SSL_WININET */
+
+
+#if (!defined(HTTP_SUPPORT_SSL_WININET)) || (0 == HTTP_SUPPORT_SSL_WININET)
+/**
+ *	Put the connection of a request into the connection pool, so it can be
+ *	reused by following requests to the same server.
+ *
+ *	@param[in]	request		: the HTTP request to be destroyed.
+ *
+ *	@return		Return non-zero if the connection is kept in the pool, then the
+ *				request doesn't own it any more. Otherwise, 0 is returned.
+ */
+static int http_pool_put(
+	struct http_request		*	request
+	)
+{
+	struct http_connection	*	conn	= &(request->connection);
+	struct http_pool_entry	*	entry	= NULL;
+	struct http_pool_entry		evicted;
+	int							idx		= 0;
+
+	/**
+	 *	Only a connection whose response is completely read can be reused,
+	 *	any unread byte belongs to the previous response.
+	 */
+	if (	(DDNS_INVALID_SOCKET == conn->socket)
+		||	(0 == conn->reusable)
+		||	(conn->recv_pos < conn->recv_len) )
+	{
+		return 0;
+	}
+
+	memset(&evicted, 0, sizeof(evicted));
+
+	http_lock();
+
+	/* use a free entry, or replace the one idle for the longest time */
+	for ( idx = 0; idx < _countof(http_pool); ++idx )
+	{
+		if ( 0 == http_pool[idx].in_use )
+		{
+			entry = &(http_pool[idx]);
+			break;
+		}
+		if ( (NULL == entry) || (http_pool[idx].idle_since < entry->idle_since) )
+		{
+			entry = &(http_pool[idx]);
+		}
+	}
+	if ( 0 != entry->in_use )
+	{
+		evicted = *entry;
+	}
+
+	memset(entry, 0, sizeof(*entry));
+	entry->in_use		= 1;
+	entry->port			= request->port;
+	entry->idle_since	= time(NULL);
+	entry->socket		= conn->socket;
+	c99_strncpy(entry->server, request->server, _countof(entry->server));
+#if defined(HTTP_SUPPORT_SSL_OPENSSL) && HTTP_SUPPORT_SSL_OPENSSL
+	entry->use_ssl		= (NULL != request->ssl_ctx) ? 1 : 0;
+	entry->ssl			= conn->ssl;
+	conn->ssl			= NULL;
+#endif
+	conn->socket		= DDNS_INVALID_SOCKET;
+
+	http_unlock();
+
+	if ( 0 != evicted.in_use )
+	{
+		http_pool_close(&evicted);
+	}
+
+	http_free_connection(conn);
+
+	return 1;
+}
+#endif	/* ! HTTP_SUPPORT_SSL_WININET */
+
+
+#if (!defined(HTTP_SUPPORT_SSL_WININET)) || (0 == HTTP_SUPPORT_SSL_WININET)
+/**
+ *	Close an idle connection removed from the connection pool.
+ *
+ *	@param[in]	entry		: the connection to be closed.
+ */
+static void http_pool_close(
+	struct http_pool_entry	*	entry
+	)
+{
+#if defined(HTTP_SUPPORT_SSL_OPENSSL) && HTTP_SUPPORT_SSL_OPENSSL
+	http_ssl_close(entry->server, entry->port, entry->ssl);
+	entry->ssl = NULL;
 #endif
+
+	ddns_socket_close(entry->socket);
+	entry->socket	= DDNS_INVALID_SOCKET;
+	entry->in_use	= 0;
 }
 #endif	/* ! HTTP_SUPPORT_SSL_WININET */
 
@@ -2531,3 +3568,174 @@ static int http_RAND()
 	return RAND_status();
 }
 #endif	/* HTTP_SUPPORT_SSL_OPENSSL */
+
+
+#if defined(HTTP_SUPPORT_SSL_OPENSSL) && HTTP_SUPPORT_SSL_OPENSSL
+/**
+ *	Get the SSL context shared by all HTTPS requests, it will be created on
+ *	first use.
+ *
+ *	@return	Return the shared SSL context, or NULL if it can't be created.
+ */
+static SSL_CTX * http_ssl_get_context()
+{
+	static int	ssl_init	= 0;
+	SSL_CTX	*	ssl_ctx		= NULL;
+
+	http_lock();
+
+	if ( 0 == ssl_init )
+	{
+		ssl_init = 1;
+		SSL_load_error_strings();	/* readable error messages */
+		SSL_library_init();			/* initialize library */
+		http_RAND();				/* initialize PRNG */
+	}
+
+	if ( NULL == http_ssl_ctx )
+	{
+		http_ssl_ctx = SSL_CTX_new(SSLv23_client_method());
+	}
+	ssl_ctx = http_ssl_ctx;
+
+	http_unlock();
+
+	return ssl_ctx;
+}
+#endif	/* HTTP_SUPPORT_SSL_OPENSSL */
+
+
+#if defined(HTTP_SUPPORT_SSL_OPENSSL) && HTTP_SUPPORT_SSL_OPENSSL
+/**
+ *	Attach the cached TLS session of the server to a request, if any. It must
+ *	be called before the TLS handshake.
+ *
+ *	@param[in]	request		: the HTTP request to be connected.
+ */
+static void http_ssl_resume_session(
+	struct http_request		*	request
+	)
+{
+	int idx = 0;
+
+	http_lock();
+
+	for ( idx = 0; idx < _countof(http_ssl_sessions); ++idx )
+	{
+		struct http_ssl_session * entry = &(http_ssl_sessions[idx]);
+		if (	(NULL != entry->session)
+			&&	(request->port == entry->port)
+			&&	(0 == ddns_strcasecmp(request->server, entry->server)) )
+		{
+			/* the SSL object holds its own reference to the session */
+			SSL_set_session(request->connection.ssl, entry->session);
+			entry->last_used = ++http_ssl_clock;
+			break;
+		}
+	}
+
+	http_unlock();
+}
+#endif	/* HTTP_SUPPORT_SSL_OPENSSL */
+
+
+#if defined(HTTP_SUPPORT_SSL_OPENSSL) && HTTP_SUPPORT_SSL_OPENSSL
+/**
+ *	Keep the TLS session of a connection in the session cache, and free the
+ *	SSL layer of the connection.
+ *
+ *	@param[in]	server		: name of the HTTP server.
+ *	@param[in]	port		: TCP port of the HTTP server.
+ *	@param[in]	ssl			: the SSL layer to be freed.
+ */
+static void http_ssl_close(
+	const char				*	server,
+	unsigned short				port,
+	SSL						*	ssl
+	)
+{
+	SSL_SESSION	*	session = NULL;
+
+	if ( NULL == ssl )
+	{
+		return;
+	}
+
+	/**
+	 *	TLS 1.3 servers send session tickets after the handshake, so session
+	 *	is fetched when the connection is closed rather than connected.
+	 */
+	if ( SSL_is_init_finished(ssl) )
+	{
+		session = SSL_get1_session(ssl);
+	}
+
+	if ( NULL != session )
+	{
+		struct http_ssl_session	*	entry	= NULL;
+		int							idx		= 0;
+
+		http_lock();
+
+		/* reuse the entry of the same server, or the least recently used */
+		for ( idx = 0; idx < _countof(http_ssl_sessions); ++idx )
+		{
+			struct http_ssl_session * item = &(http_ssl_sessions[idx]);
+			if (	(NULL != item->session)
+				&&	(port == item->port)
+				&&	(0 == ddns_strcasecmp(server, item->server)) )
+			{
+				entry = item;
+				break;
+			}
+			if ( (NULL == entry) || (item->last_used < entry->last_used) )
+			{
+				entry = item;
+			}
+		}
+
+		if ( NULL != entry->session )
+		{
+			SSL_SESSION_free(entry->session);
+		}
+		c99_strncpy(entry->server, server, _countof(entry->server));
+		entry->port			= port;
+		entry->session		= session;
+		entry->last_used	= ++http_ssl_clock;
+
+		http_unlock();
+	}
+
+	/**
+	 *	Mark the connection as shut down without sending "close_notify", so
+	 *	OpenSSL keeps the session resumable. Peer may have closed the socket.
+	 */
+	SSL_set_shutdown(ssl, SSL_SENT_SHUTDOWN | SSL_RECEIVED_SHUTDOWN);
+	SSL_free(ssl);
+}
+#endif	/* HTTP_SUPPORT_SSL_OPENSSL */
+
+
+/**
+ *	Lock global data of the HTTP module. It does nothing if [http_init] has
+ *	not been called.
+ */
+static void http_lock()
+{
+	if ( http_init_count > 0 )
+	{
+		ddns_sync_lock(&http_sync);
+	}
+}
+
+
+/**
+ *	Unlock global data of the HTTP module, see [http_lock].
+ */
+static void http_unlock()
+{
+	if ( http_init_count > 0 )
+	{
+		ddns_sync_unlock(&http_sync);
+	}
+}
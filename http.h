@@ -30,6 +30,8 @@
 #	include "config.h"
 #endif
 
+#include <stddef.h>
+
 #if defined(_MSC_VER) || defined(__MINGW32__)
 #	define HTTP_SUPPORT_SSL_OPENSSL		0
 #	define HTTP_SUPPORT_SSL_WININET		1
@@ -60,6 +62,7 @@ extern "C" {
  *	Constants for [http_set_option]
  */
 #define HTTP_OPTION_REDIRECT	0	/* maximum allowed redirection count */
+#define HTTP_OPTION_KEEPALIVE	1	/* non-zero: reuse pooled connections */
 
 enum http_request_type
 {
@@ -74,9 +77,36 @@ enum http_request_type
 };
 
 struct http_request;
+struct ddns_deadline;	/* see "ddns_sync.h" */
 
 typedef void (*http_callback)(char chr, void* param);
+typedef void (*http_data_callback)(const char* data, size_t size, void* param);
+
 
+/**
+ *	Initialize the HTTP module. It should be called before any HTTP request is
+ *	created, and paired with [http_uninit].
+ *
+ *	@return		Return 0 on success, otherwise an error code is returned.
+ */
+int http_init();
+
+/**
+ *	Free global resources of the HTTP module, such as the shared SSL context
+ *	and the cached TLS sessions.
+ */
+void http_uninit();
+
+/**
+ *	Get statistics of TLS handshakes made by the HTTP module.
+ *
+ *	@param[out]	handshakes	: number of full TLS handshakes.
+ *	@param[out]	resumed		: number of TLS sessions resumed from cache.
+ */
+void http_get_ssl_statistics(
+	unsigned long		*	handshakes,
+	unsigned long		*	resumed
+	);
 
 /**
  *	Connect to HTTP server
@@ -93,12 +123,52 @@ int http_connect(struct http_request* request);
  *	@param[in]	request			: the HTTP request.
  *	@param[in]	option			: type of the option, supported values are:
  *									- HTTP_OPTION_REDIRECT
+ *									- HTTP_OPTION_KEEPALIVE
  *	@param[in]	value			: value for the option.
  *
  *	@return		Return the original value of the request option.
  */
 int http_set_option(struct http_request * request, int option, int value);
 
+/**
+ *	Set the stop signal of a request. Once the signal is set to non-zero, the
+ *	request stops waiting for the server soon, and fails as if it has timed
+ *	out.
+ *
+ *	@param[in]	request		: the HTTP request.
+ *	@param[in]	stop_wait	: pointer to the stop signal, it must be valid until
+ *							  the request is destroyed. NULL to remove it.
+ */
+void http_set_stop_signal(struct http_request * request, int * stop_wait);
+
+/**
+ *	Set the deadline of a request. Connecting, sending and reading all share
+ *	it, so the request fails once the deadline expires, no matter how slowly
+ *	the server dribbles its response.
+ *
+ *	@param[in]	request		: the HTTP request.
+ *	@param[in]	deadline	: the deadline to be copied, NULL for no deadline.
+ *
+ *	@note		[http_create_request] arms a deadline of its own timeout, this
+ *				one overrides it.
+ */
+void http_set_deadline(
+	struct http_request			*	request,
+	const struct ddns_deadline	*	deadline
+	);
+
+/**
+ *	Stop reading the response body, the rest of it is discarded along with the
+ *	connection.
+ *
+ *	@param[in]	request		: the HTTP request.
+ *
+ *	@note		It's called by the callback of [http_get_response_ex] once the
+ *				wanted data is found, [http_get_response_ex] then returns as
+ *				soon as the callback returns.
+ */
+void http_stop_response(struct http_request * request);
+
 /**
  *	Send a HTTP request to server.
  *
@@ -132,6 +202,24 @@ int http_get_response(
 );
 
 
+/**
+ *	Get HTTP response from server, received data is passed in blocks.
+ *
+ *	@param[in]	request		: the HTTP request
+ *	@param[in]	callback	: pointer to the callback function, it receives the
+ *							  response body block by block, as soon as the data
+ *							  arrives. The data is only valid during the call.
+ *	@param[in]	param		: extra parameter to be passed to callback function
+ *
+ *	@return		Return non-zero on success, otherwise 0 will be returned.
+ */
+int http_get_response_ex(
+	struct http_request		*	request,
+	http_data_callback			callback,
+	void					*	param
+);
+
+
 /**
  *	Create a HTTP request.
  *
@@ -31,6 +31,16 @@
 #include <math.h>		/* pow            */
 
 
+/* size of memory blocks allocated by json arena */
+#define JSON_ARENA_BLOCK_SIZE	(16 * 1024)
+
+/* objects with more members than this are indexed by hash */
+#define JSON_OBJECT_INDEX_THRESHOLD	8
+
+/* all allocations from json arena are aligned to this */
+#define JSON_ARENA_ALIGN(size)	(((size) + 7) & ~((size_t)7))
+
+
 /****************************************************************************/
 /* json basic type definition                                               */
 /****************************************************************************/
@@ -38,7 +48,8 @@
 /* json string */
 typedef struct _json_string
 {
-	unsigned long		size;
+	unsigned long		size;				/* allocated bytes           */
+	unsigned long		length;				/* excluding null terminator */
 	char				*value;
 }									json_string;
 
@@ -54,25 +65,48 @@ typedef struct _json_pair
 	struct json_value	*name;
 	struct json_value	*value;
 	struct _json_pair	*next;
+	unsigned long		hash;				/* hash value of the name    */
 }									json_pair;
 
 /* json object */
 typedef struct _json_object
 {
-	json_pair			*pairs;
+	json_pair			*pairs;				/* in insertion order        */
+	json_pair			*last;				/* the last pair             */
+	unsigned long		count;				/* number of pairs           */
+	unsigned long		capacity;			/* slots of [index]          */
+	json_pair			**index;			/* hash index of the pairs   */
 }									json_object;
 
 /* json array */
 typedef struct _json_array
 {
 	unsigned long		size;
+	unsigned long		capacity;
 	struct json_value	**value;
 }									json_array;
 
+/* memory block of json arena */
+typedef struct _json_arena_block
+{
+	struct _json_arena_block	*next;
+	size_t						size;		/* usable bytes of the block */
+	size_t						used;		/* allocated bytes           */
+}									json_arena_block;
+
+/* json arena, values allocated from it are freed all at once */
+struct json_arena
+{
+	json_arena_block	*blocks;			/* current block is the head */
+	void				*last;				/* latest allocation         */
+	struct json_value	*owner;				/* the value owns the arena  */
+};
+
 /* json value element */
 struct json_value
 {
 	enum json_value_type	type;
+	struct json_arena	*	arena;			/* NULL if allocated in heap */
 	union
 	{
 		json_string			string;
@@ -200,6 +234,19 @@ struct json_context
 	enum	json_states				state;		/* current parsing state     */
 	enum	json_modes			*	mode_stack;	/* parsing mode stack        */
 	struct	json_parse_value	*	target;		/* the value being parsed    */
+	struct	json_arena			*	arena;		/* NULL: values are in heap  */
+
+	/*-*-*-*- the following items are used by event driven parsing only -*-*-*/
+	json_event_callback				callback;	/* event handler             */
+	void						*	param;		/* parameter of the handler  */
+	struct	json_value				string;		/* the string being parsed   */
+	struct	json_value				number;		/* the number being parsed   */
+	int								negative;	/* negative number flag      */
+	int								pow;		/* exp number                */
+	int								exp;		/* exponent of the number    */
+	int								exp_minus;	/* negative exponent flag    */
+	int								chr;		/* unicode scalar value      */
+	/*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*/
 };
 
 /*
@@ -330,6 +377,367 @@ static int json_pop(struct json_context * ctx, enum json_modes mode)
 }
 
 
+/**
+ *	Create a json arena.
+ *
+ *	@return		Return pointer to the newly created arena, or NULL if there's
+ *				no enough memory. Use [json_arena_destroy] to free it.
+ */
+static struct json_arena * json_arena_create(void)
+{
+	struct json_arena * arena = malloc(sizeof(struct json_arena));
+
+	if ( NULL != arena )
+	{
+		memset(arena, 0, sizeof(*arena));
+	}
+
+	return arena;
+}
+
+
+/**
+ *	Free all memory blocks of a json arena, and the arena itself.
+ *
+ *	@param[in]	arena	: the arena to be destroyed.
+ */
+static void json_arena_destroy(struct json_arena * arena)
+{
+	if ( NULL != arena )
+	{
+		while ( NULL != arena->blocks )
+		{
+			json_arena_block * block = arena->blocks;
+			arena->blocks = block->next;
+			free(block);
+		}
+
+		free(arena);
+	}
+}
+
+
+/**
+ *	Allocate memory for json values.
+ *
+ *	@param[in]	arena	: the arena to allocate from, if it's NULL, the memory
+ *						  is allocated from heap.
+ *	@param[in]	size	: size of the memory in bytes.
+ *
+ *	@return		Return pointer to the allocated memory, or NULL on failure.
+ */
+static void * json_alloc(struct json_arena * arena, size_t size)
+{
+	void				*	ptr		= NULL;
+	json_arena_block	*	block	= NULL;
+
+	if ( NULL == arena )
+	{
+		return malloc(size);
+	}
+
+	size	= JSON_ARENA_ALIGN(size);
+	block	= arena->blocks;
+	if ( (NULL == block) || (block->size - block->used < size) )
+	{
+		size_t block_size = JSON_ARENA_BLOCK_SIZE;
+		if ( block_size < size )
+		{
+			block_size = size;
+		}
+
+		block = malloc(JSON_ARENA_ALIGN(sizeof(json_arena_block)) + block_size);
+		if ( NULL == block )
+		{
+			return NULL;
+		}
+
+		block->size		= block_size;
+		block->used		= 0;
+		block->next		= arena->blocks;
+		arena->blocks	= block;
+	}
+
+	ptr = (char*)block + JSON_ARENA_ALIGN(sizeof(json_arena_block)) + block->used;
+	block->used += size;
+	arena->last = ptr;
+
+	return ptr;
+}
+
+
+/**
+ *	Resize memory allocated by [json_alloc].
+ *
+ *	@param[in]	arena		: the arena which [ptr] is allocated from.
+ *	@param[in]	ptr			: the memory to be resized, it can be NULL.
+ *	@param[in]	old_size	: current size of [ptr] in bytes.
+ *	@param[in]	new_size	: new size in bytes.
+ *
+ *	@note		If [ptr] is the latest allocation of the arena, it's resized in
+ *				place when possible, otherwise the content is moved.
+ *
+ *	@return		Return pointer to the resized memory, or NULL on failure, in
+ *				such case, [ptr] is not changed.
+ */
+static void * json_realloc(
+	struct json_arena	*	arena,
+	void				*	ptr,
+	size_t					old_size,
+	size_t					new_size
+	)
+{
+	void * new_ptr = NULL;
+
+	if ( NULL == arena )
+	{
+		return realloc(ptr, new_size);
+	}
+
+	if ( (NULL != ptr) && (ptr == arena->last) )
+	{
+		json_arena_block	*	block	= arena->blocks;
+		size_t					offset	= (char*)ptr - (char*)block
+										- JSON_ARENA_ALIGN(sizeof(json_arena_block));
+
+		if ( JSON_ARENA_ALIGN(new_size) <= block->size - offset )
+		{
+			block->used = offset + JSON_ARENA_ALIGN(new_size);
+			return ptr;
+		}
+	}
+
+	new_ptr = json_alloc(arena, new_size);
+	if ( (NULL != new_ptr) && (NULL != ptr) )
+	{
+		memcpy(new_ptr, ptr, old_size < new_size ? old_size : new_size);
+	}
+
+	return new_ptr;
+}
+
+
+/**
+ *	Free memory allocated by [json_alloc]. Memory allocated from arena will be
+ *	freed when the arena is destroyed.
+ *
+ *	@param[in]	arena	: the arena which [ptr] is allocated from.
+ *	@param[in]	ptr		: the memory to be freed.
+ */
+static void json_free(struct json_arena * arena, void * ptr)
+{
+	if ( NULL == arena )
+	{
+		free(ptr);
+	}
+}
+
+
+/**
+ *	Calculate hash value of a member name, using 32-bit FNV-1a.
+ *
+ *	@param[in]	key		: the member name.
+ *
+ *	@return		Return the hash value.
+ */
+static unsigned long json_hash(const char * key)
+{
+	unsigned long hash = 2166136261UL;
+
+	for ( ; '\0' != *key; ++key )
+	{
+		hash ^= (unsigned char)(*key);
+		hash = (hash * 16777619UL) & 0xFFFFFFFFUL;
+	}
+
+	return hash;
+}
+
+
+/**
+ *	Find a member of a json object.
+ *
+ *	@param[in]	var		: the [json_value] object of type [json_type_object].
+ *	@param[in]	key		: name of the member.
+ *
+ *	@return		Return the name-value pair if found, otherwise NULL.
+ */
+static json_pair * json_object_find(
+	struct json_value	*	var,
+	const char			*	key
+	)
+{
+	json_object * object = &(var->value.object);
+	json_pair	* pairs	 = NULL;
+
+	if ( NULL != object->index )
+	{
+		unsigned long hash	= json_hash(key);
+		unsigned long mask	= object->capacity - 1;
+		unsigned long slot	= hash & mask;
+
+		/* linear probing, the index is never full */
+		for (	pairs = object->index[slot];
+				NULL != pairs;
+				slot = (slot + 1) & mask, pairs = object->index[slot] )
+		{
+			if (	(hash == pairs->hash)
+				&&	(0 == strcmp(pairs->name->value.string.value, key)) )
+			{
+				break;
+			}
+		}
+	}
+	else
+	{
+		for ( pairs = object->pairs; NULL != pairs; pairs = pairs->next )
+		{
+			if ( 0 == strcmp(pairs->name->value.string.value, key) )
+			{
+				break;
+			}
+		}
+	}
+
+	return pairs;
+}
+
+
+/**
+ *	Rebuild the hash index of a json object.
+ *
+ *	@param[in]	var			: the [json_value] object of type [json_type_object].
+ *	@param[in]	capacity	: number of index slots, it must be power of 2 and
+ *							  larger than number of the members.
+ *
+ *	@note		If there's no enough memory, the object is left without index,
+ *				and members are searched one by one.
+ */
+static void json_object_reindex(struct json_value * var, unsigned long capacity)
+{
+	json_object	*	object	= &(var->value.object);
+	json_pair	**	index	= NULL;
+	json_pair	*	pairs	= NULL;
+
+	index = json_alloc(var->arena, capacity * sizeof(json_pair*));
+	if ( NULL != index )
+	{
+		memset(index, 0, capacity * sizeof(json_pair*));
+		for ( pairs = object->pairs; NULL != pairs; pairs = pairs->next )
+		{
+			unsigned long slot = pairs->hash & (capacity - 1);
+			while ( NULL != index[slot] )
+			{
+				slot = (slot + 1) & (capacity - 1);
+			}
+			index[slot] = pairs;
+		}
+	}
+
+	json_free(var->arena, object->index);
+	object->index		= index;
+	object->capacity	= (NULL != index) ? capacity : 0;
+}
+
+
+/**
+ *	Append a new member to a json object, the object takes the ownership of
+ *	the name and the value.
+ *
+ *	@param[in]	var		: the [json_value] object of type [json_type_object].
+ *	@param[in]	name	: name of the member, it must not exist in [var].
+ *	@param[in]	value	: value of the member.
+ *
+ *	@note		[name] and [value] are destroyed if the function fails.
+ *
+ *	@return		Return 0 if the operation succeeded. Otherwise -1 is returned.
+ */
+static int json_object_add(
+	struct json_value	*	var,
+	struct json_value	*	name,
+	struct json_value	*	value
+	)
+{
+	json_object	*	object	= &(var->value.object);
+	json_pair	*	pairs	= json_alloc(var->arena, sizeof(json_pair));
+
+	if ( NULL == pairs )
+	{
+		json_destroy(name);
+		json_destroy(value);
+		return -1;
+	}
+
+	pairs->name		= name;
+	pairs->value	= value;
+	pairs->next		= NULL;
+	pairs->hash		= json_hash(name->value.string.value);
+
+	/* keep the insertion order */
+	if ( NULL == object->last )
+	{
+		object->pairs = pairs;
+	}
+	else
+	{
+		object->last->next = pairs;
+	}
+	object->last = pairs;
+	++(object->count);
+
+	if ( object->count > JSON_OBJECT_INDEX_THRESHOLD )
+	{
+		/* keep at least half of the slots free */
+		if ( object->count * 2 > object->capacity )
+		{
+			json_object_reindex(var, (0 == object->capacity)
+										? JSON_OBJECT_INDEX_THRESHOLD * 4
+										: object->capacity * 2);
+		}
+		else
+		{
+			unsigned long slot = pairs->hash & (object->capacity - 1);
+			while ( NULL != object->index[slot] )
+			{
+				slot = (slot + 1) & (object->capacity - 1);
+			}
+			object->index[slot] = pairs;
+		}
+	}
+
+	return 0;
+}
+
+
+/**
+ *	Create a [json_value] object in the given arena.
+ *
+ *	@param[in]	arena	: the arena, if it's NULL, the object is allocated
+ *						  from heap, just as [json_create] does.
+ *	@param[in]	type	: type of the object.
+ *
+ *	@return		Return pointer to the newly created json_value object, or NULL
+ *				if there's no enough memory.
+ */
+static struct json_value * json_create_in(
+	struct json_arena		*	arena,
+	enum json_value_type		type
+	)
+{
+	struct json_value * value =
+		(struct json_value *)json_alloc(arena, sizeof(struct json_value));
+
+	if ( NULL != value )
+	{
+		memset(value, 0, sizeof(*value));
+		value->type		= type;
+		value->arena	= arena;
+	}
+
+	return value;
+}
+
+
 /****************************************************************************/
 /* implementation of functions                                              */
 /****************************************************************************/
@@ -350,13 +758,7 @@ static int json_pop(struct json_context * ctx, enum json_modes mode)
  */
 struct json_value * json_create(enum json_value_type type)
 {
-	struct json_value * value =
-		(struct json_value *)malloc(sizeof(struct json_value));
-
-	memset(value, 0, sizeof(*value));
-	value->type = type;
-
-	return value;
+	return json_create_in(NULL, type);
 }
 
 
@@ -368,7 +770,15 @@ struct json_value * json_create(enum json_value_type type)
  */
 void json_destroy(struct json_value * var)
 {
-	if ( NULL != var )
+	if ( (NULL != var) && (NULL != var->arena) )
+	{
+		/* values in arena are freed together with the arena */
+		if ( var == var->arena->owner )
+		{
+			json_arena_destroy(var->arena);
+		}
+	}
+	else if ( NULL != var )
 	{
 		unsigned long i = 0;
 		switch ( var->type )
@@ -398,6 +808,7 @@ void json_destroy(struct json_value * var)
 				var->value.object.pairs = pair->next;
 				free(pair);
 			}
+			free(var->value.object.index);
 			break;
 
 		case json_type_array:
@@ -419,15 +830,19 @@ void json_destroy(struct json_value * var)
 
 
 /**
- *	Create a copy of a [json_value] object.
+ *	Create a copy of a [json_value] object in the given arena.
  *
+ *	@param[in]	arena	: the arena, if it's NULL, the copy is allocated
+ *						  from heap, just as [json_duplicate] does.
  *	@param[in]	var		: the object to be copied.
  *
  *	@return		Return pointer to the newly created [json_value] object. If the
- *				copy failed, NULL will be returned. When it's no longer needed,
- *				use [json_destroy] to free it.
+ *				copy failed, NULL will be returned.
  */
-struct json_value * json_duplicate(struct json_value * var)
+static struct json_value * json_duplicate_in(
+	struct json_arena		*	arena,
+	struct json_value		*	var
+	)
 {
 	json_pair * pairs = NULL;
 	struct json_value * new_var = NULL;
@@ -435,7 +850,7 @@ struct json_value * json_duplicate(struct json_value * var)
 
 	if ( json_type_invalid != type )
 	{
-		new_var = json_create(type);
+		new_var = json_create_in(arena, type);
 	}
 
 	if ( NULL != new_var )
@@ -470,14 +885,16 @@ struct json_value * json_duplicate(struct json_value * var)
 
 		case json_type_array:
 			new_var->value.array.value =
-				malloc(var->value.array.size * sizeof(var->value.array.value));
+				json_alloc(arena, var->value.array.size * sizeof(struct json_value*));
 			if ( NULL != new_var->value.array.value )
 			{
 				unsigned long i = 0;
+
+				new_var->value.array.capacity = var->value.array.size;
 				for ( i = 0; i < var->value.array.size; ++i )
 				{
 					new_var->value.array.value[i] =
-						json_duplicate(var->value.array.value[i]);
+						json_duplicate_in(arena, var->value.array.value[i]);
 					if ( NULL == new_var->value.array.value[i] )
 					{
 						json_destroy(new_var);
@@ -508,6 +925,21 @@ struct json_value * json_duplicate(struct json_value * var)
 }
 
 
+/**
+ *	Create a copy of a [json_value] object.
+ *
+ *	@param[in]	var		: the object to be copied.
+ *
+ *	@return		Return pointer to the newly created [json_value] object. If the
+ *				copy failed, NULL will be returned. When it's no longer needed,
+ *				use [json_destroy] to free it.
+ */
+struct json_value * json_duplicate(struct json_value * var)
+{
+	return json_duplicate_in(NULL, var);
+}
+
+
 /**
  *	Get type of a [json_value] object.
  *
@@ -572,7 +1004,10 @@ int json_string_set(struct json_value * var, char * string)
 		{
 			/* at least 16 bytes is allocated */
 			unsigned long size = ((length + 16) & 0xFFFFFFF0);
-			char * new_buf = realloc(var->value.string.value, size);
+			char * new_buf = json_realloc(	var->arena,
+											var->value.string.value,
+											var->value.string.size,
+											size );
 			if ( NULL != new_buf )
 			{
 				result = 0;
@@ -585,6 +1020,7 @@ int json_string_set(struct json_value * var, char * string)
 		if ( 0 == result )
 		{
 			var->value.string.value[length] = '\0';
+			var->value.string.length = length;
 			memcpy(var->value.string.value, string, length);
 		}
 	}
@@ -647,27 +1083,35 @@ int json_number_set(struct json_value * var, int number)
  *				to free the returned object when it's no longer needed.
  */
 struct json_value * json_object_get(struct json_value * var, char * key)
+{
+	return json_duplicate(json_object_peek(var, key));
+}
+
+
+/**
+ *	Get member value of a json object object, without copying it.
+ *
+ *	@param[in]	var		: the [json_value] object of type [json_type_object].
+ *	@param[in]	key		: name of the object member.
+ *
+ *	@return		Return value of the json object's member, if the key is not
+ *				found in the object, NULL will be returned. The returned object
+ *				is owned by [var], don't free it, and don't use it after [var]
+ *				is destroyed.
+ */
+struct json_value * json_object_peek(struct json_value * var, const char * key)
 {
 	struct json_value * value = NULL;
 
-	if ( (NULL != key) || (json_type_object == json_get_type(var)) )
+	if ( (NULL != key) && (json_type_object == json_get_type(var)) )
 	{
-		json_pair * pairs = var->value.object.pairs;
-		for ( ; NULL != pairs; pairs = pairs->next )
+		json_pair * pairs = json_object_find(var, key);
+		if ( NULL != pairs )
 		{
-			if ( 0 == strcmp(pairs->name->value.string.value, key) )
-			{
-				value = pairs->value;
-				break;
-			}
+			value = pairs->value;
 		}
 	}
 
-	if ( NULL != value )
-	{
-		value = json_duplicate(value);
-	}
-
 	return value;
 }
 
@@ -686,83 +1130,155 @@ int json_object_set(
 	struct json_value	*	value
 	)
 {
-	int result = -1;
-	enum json_value_type type = json_get_type(var);
+	int						result	= -1;
+	json_pair			*	pairs	= NULL;
+	struct json_value	*	name	= NULL;
+	struct json_value	*	new_var	= NULL;
 
-	if ( json_type_object == type )
+	if ( json_type_object == json_get_type(var) )
 	{
-		json_pair * pairs = var->value.object.pairs;
+		new_var = json_duplicate_in(var->arena, value);
+	}
 
-		for ( ; NULL != pairs; pairs = pairs->next )
+	if ( NULL != new_var )
+	{
+		if ( NULL == key )
 		{
-			if ( (NULL == key) && (NULL == pairs->name->value.string.value) )
-			{
-				break;
-			}
-			else if ( NULL == key )
+			key = "";
+		}
+
+		pairs = json_object_find(var, key);
+		if ( NULL != pairs )
+		{
+			result = 0;
+
+			json_destroy(pairs->value);
+			pairs->value = new_var;
+		}
+		else
+		{
+			name = json_create_in(var->arena, json_type_string);
+			if ( (NULL != name) && (0 == json_string_set(name, key)) )
 			{
-				/* do nothing */
+				result = json_object_add(var, name, new_var);
 			}
-			else if ( 0 == strcmp(pairs->name->value.string.value, key) )
+			else
 			{
-				break;
+				json_destroy(name);
+				json_destroy(new_var);
 			}
 		}
-		if ( NULL == pairs )
+	}
+
+	return result;
+}
+
+
+/**
+ *	Append a value into an array, the array takes the ownership of the value.
+ *
+ *	@param[in]	var		: the [json_value] object of type [json_type_array].
+ *	@param[in]	value	: the value to be appended, it must be allocated in the
+ *						  same way as [var]. It's destroyed if the function
+ *						  fails.
+ *
+ *	@return		Return 0 if the operation succeeded. Otherwise -1 is returned.
+ */
+static int json_array_attach(
+	struct json_value	*	var,
+	struct json_value	*	value
+	)
+{
+	json_array * array = NULL;
+
+	if ( (json_type_array != json_get_type(var)) || (NULL == value) )
+	{
+		json_destroy(value);
+		return -1;
+	}
+
+	array = &(var->value.array);
+	if ( array->size >= array->capacity )
+	{
+		/* grow geometrically, the arena can't reuse freed slots */
+		unsigned long			capacity	= (0 == array->capacity)
+												? 4 : array->capacity * 2;
+		struct json_value	**	slots		= json_realloc(
+												var->arena,
+												array->value,
+												array->capacity * sizeof(struct json_value*),
+												capacity * sizeof(struct json_value*) );
+		if ( NULL == slots )
 		{
-			pairs = malloc(sizeof(*pairs));
-			if ( NULL != pairs )
-			{
-				pairs->name = json_create(json_type_string);
-				if ( NULL != pairs->name )
-				{
-					if ( -1 == json_string_set(pairs->name, key) )
-					{
-						json_destroy(pairs->name);
-						pairs->name = NULL;
+			json_destroy(value);
+			return -1;
+		}
 
-						free(pairs);
-						pairs = NULL;
-					}
-				}
-				else
-				{
-					free(pairs);
-					pairs = NULL;
-				}
-			}
-			if ( NULL != pairs )
-			{
-				pairs->value = json_duplicate(value);
-				if ( NULL != pairs->value )
-				{
-					result = 0;
+		array->value	= slots;
+		array->capacity	= capacity;
+	}
 
-					pairs->next = var->value.object.pairs;
-					var->value.object.pairs = pairs;
-				}
-				else
-				{
-					json_destroy(pairs->name);
-					pairs->name = NULL;
+	array->value[array->size++] = value;
 
-					free(pairs);
-					pairs = NULL;
-				}
-			}
+	return 0;
+}
+
+
+/**
+ *	Add a member to an object, the object takes the ownership of the name and
+ *	the value. If the name already exists, the latter value wins.
+ *
+ *	@param[in]	var		: the [json_value] object of type [json_type_object].
+ *	@param[in]	name	: name of the member, of type [json_type_string].
+ *	@param[in]	value	: value of the member.
+ *
+ *	@note		[name] and [value] must be allocated in the same way as [var],
+ *				they're destroyed if the function fails.
+ *
+ *	@return		Return 0 if the operation succeeded. Otherwise -1 is returned.
+ */
+static int json_object_attach(
+	struct json_value	*	var,
+	struct json_value	*	name,
+	struct json_value	*	value
+	)
+{
+	int				result	= -1;
+	json_pair	*	pairs	= NULL;
+
+	if (	(json_type_object == json_get_type(var))
+		&&	(json_type_string == json_get_type(name))
+		&&	(NULL != value) )
+	{
+		result = 0;
+		if ( NULL == name->value.string.value )
+		{
+			/* empty name */
+			result = json_string_set(name, "");
 		}
-		else
+	}
+
+	if ( 0 == result )
+	{
+		pairs = json_object_find(var, name->value.string.value);
+		if ( NULL != pairs )
 		{
-			struct json_value * new_var = json_duplicate(pairs->value);
-			if ( NULL != new_var )
-			{
-				result = 0;
+			json_destroy(pairs->value);
+			pairs->value = value;
 
-				json_destroy(pairs->value);
-				pairs->value = new_var;
-			}
+			json_destroy(name);
+		}
+		else
+		{
+			/* it destroys [name] and [value] on failure */
+			return json_object_add(var, name, value);
 		}
 	}
+	else
+	{
+		json_destroy(name);
+		json_destroy(value);
+	}
 
 	return result;
 }
@@ -797,27 +1313,14 @@ int json_array_append(
 
 	if ( RESULT_SUCCESS == result )
 	{
-		unsigned long			new_size	= var->value.array.size + 1;
-		struct json_value	**	array		= NULL;
-		struct json_value	*	element		= json_duplicate(value);
+		struct json_value * element = json_duplicate_in(var->arena, value);
 		if ( NULL == element )
 		{
 			result = RESULT_FAILURE;
 		}
-		else
+		else if ( 0 != json_array_attach(var, element) )
 		{
-			array = realloc(var->value.array.value,
-							new_size * sizeof(struct json_value*) );
-			if ( NULL != array )
-			{
-				array[new_size - 1]		= element;
-				var->value.array.value	= array;
-				var->value.array.size	= new_size;
-			}
-			else
-			{
-				result = RESULT_FAILURE;
-			}
+			result = RESULT_FAILURE;
 		}
 	}
 
@@ -826,18 +1329,23 @@ int json_array_append(
 
 
 /**
- *	Modify value of a json string object.
+ *	Append characters to a json string object.
  *
- *	@param[out]	var		: the [json_string] object.
- *	@param[in]	string	: the value to be set to [var].
+ *	@param[out]	var		: the [json_value] object of type [json_type_string].
+ *	@param[in]	data	: the characters to be appended.
+ *	@param[in]	size	: number of characters in [data].
  *
- *	@note		If [var] is not of type [json_type_string], the function fails.
+ *	@note		The buffer grows geometrically, so appending a string char by
+ *				char takes linear time.
  *
  *	@return		Return 0 if the operation succeeded. Otherwise -1 is returned.
  */
-static int json_string_append(struct json_value * var, char chr)
+static int json_string_append_n(
+	struct json_value	*	var,
+	const char			*	data,
+	unsigned long			size
+	)
 {
-	unsigned long length = 0;
 	json_string *s = NULL;
 
 	if ( (NULL == var) || (json_type_string != json_get_type(var)) )
@@ -846,12 +1354,18 @@ static int json_string_append(struct json_value * var, char chr)
 	}
 
 	s = &(var->value.string);
-
-	length = (NULL != s->value) ? strlen(s->value) : 0;
-	if ( length + 1 >= var->value.string.size )
+	if ( s->length + size + 1 > s->size )
 	{
-		int newlen = (s->size + 1 + 15) & 0xFFFFFFF0;
-		char * newval = realloc(s->value, newlen);
+		/* at least 16 bytes is allocated */
+		unsigned long	newlen	= (s->size < 16) ? 16 : s->size;
+		char		*	newval	= NULL;
+
+		while ( newlen < s->length + size + 1 )
+		{
+			newlen *= 2;
+		}
+
+		newval = json_realloc(var->arena, s->value, s->size, newlen);
 		if ( NULL == newval )
 		{
 			return -1;
@@ -861,77 +1375,523 @@ static int json_string_append(struct json_value * var, char chr)
 		s->value = newval;
 	}
 
-	s->value[length] = chr;
-	s->value[length + 1] = '\0';
+	memcpy(s->value + s->length, data, size);
+	s->length += size;
+	s->value[s->length] = '\0';
+
+	return 0;
+}
+
+
+/**
+ *	Append a character to a json string object.
+ *
+ *	@param[out]	var		: the [json_value] object of type [json_type_string].
+ *	@param[in]	chr		: the character to be appended.
+ *
+ *	@return		Return 0 if the operation succeeded. Otherwise -1 is returned.
+ */
+static int json_string_append(struct json_value * var, char chr)
+{
+	return json_string_append_n(var, &chr, 1);
+}
+
+
+/**
+ *	Append an unicode character into a json string object, UTF-8 encoded.
+ *
+ *	@param[out]	var		: the [json_value] object of type [json_type_string].
+ *	@param[in]	chr		: unicode scalar value of the character.
+ *
+ *	@return		Return 0 if the operation succeeded. Otherwise -1 is returned.
+ */
+static int json_string_append_unicode(struct json_value * var, int chr)
+{
+	int result = 0;
+
+	if ( chr > 0x07ff )
+	{
+		/* 3-byte character */
+		result |= json_string_append(var, (char)(0xe0 | (chr >> 12)));
+		result |= json_string_append(var, (char)(0x80 | ((chr >> 6) & 0x3f)));
+		result |= json_string_append(var, (char)(0x80 | (chr & 0x3f)));
+	}
+	else if ( chr > 0x007f )
+	{
+		/* 2-byte character */
+		result |= json_string_append(var, (char)(0xc0 | (chr >> 6)));
+		result |= json_string_append(var, (char)(0x80 | (chr & 0x3f)));
+	}
+	else
+	{
+		/* 1-byte character */
+		result |= json_string_append(var, (char)chr);
+	}
+
+	return result;
+}
+
+
+/**
+ *	Translate the character following a backslash into the character it
+ *	stands for.
+ *
+ *	@param[in/out]	chr		: the escaped character.
+ *
+ *	@return		Return 0 if successful, otherwise return -1.
+ */
+static int json_unescape(char * chr)
+{
+	int result = 0;
+
+	switch ( *chr )
+	{
+	case '"':
+		*chr = '"';
+		break;
+	case '\\':
+		*chr = '\\';
+		break;
+	case '/':
+		*chr = '/';
+		break;
+	case 'b':
+		*chr = '\b';
+		break;
+	case 'f':
+		*chr = '\f';
+		break;
+	case 'n':
+		*chr = '\n';
+		break;
+	case 'r':
+		*chr = '\r';
+		break;
+	case 't':
+		*chr = '\t';
+		break;
+	default:
+		assert(0);
+		result = -1;
+		break;
+	}
+
+	return result;
+}
+
+
+/**
+ *	Push a json value into json context.
+ *
+ *	@param[out]		ctx		- the json parse context.
+ *	@param[in]		type	- type of the new value to be pushed.
+ *
+ *	@return		Return 0 if successful, otherwise return -1.
+ */
+static int json_push_value(
+	struct	json_context		*	ctx,
+	enum	json_value_type			type
+	)
+{
+	static const int RESULT_SUCCESS = 0;
+	static const int RESULT_FAILURE = -1;
+
+	int								result	= RESULT_SUCCESS;
+	struct	json_parse_value	*	value	= NULL;
+
+	if ( NULL == ctx )
+	{
+		result = RESULT_FAILURE;
+	}
+
+	if ( RESULT_SUCCESS == result )
+	{
+		value = malloc(sizeof(struct json_parse_value));
+		if ( NULL != value )
+		{
+			memset(value, 0, sizeof(*value));
+		}
+		else
+		{
+			result = RESULT_FAILURE;
+		}
+	}
+
+	if ( RESULT_SUCCESS == result )
+	{
+		value->object = json_create_in(ctx->arena, type);
+		if ( NULL == value->object )
+		{
+			result = RESULT_FAILURE;
+		}
+	}
+
+	if ( RESULT_SUCCESS == result )
+	{
+		value->parent = ctx->target;
+		ctx->target = value;
+	}
+	else
+	{
+		if ( NULL != value )
+		{
+			if ( NULL != value->object )
+			{
+				json_destroy(value->object);
+				value->object = NULL;
+			}
+
+			free(value);
+			value = NULL;
+		}
+	}
+
+	return result;
+}
+
+
+/**
+ *	Report an event to the handler of an event driven json context.
+ *
+ *	@param[in]		ctx		- the json parse context.
+ *	@param[in]		event	- the event to be reported.
+ *	@param[in]		value	- value of the event, NULL if it has no value.
+ *
+ *	@return		Return 0 if the handler wants to continue, otherwise return -1.
+ */
+static int json_emit(
+	struct	json_context		*	ctx,
+	enum	json_event_type			event,
+	struct	json_value			*	value
+	)
+{
+	return ( 0 == ctx->callback(event, value, ctx->param) ) ? 0 : -1;
+}
+
+
+/**
+ *	Read a char into an event driven json parse context. It runs the same state
+ *	machine as [json_readchr], but reports each complete token to the event
+ *	handler instead of building [json_value] objects, only the string or
+ *	number being parsed is kept.
+ *
+ *	@param[out]		ctx		- the json parse context.
+ *	@param[in]		chr		- the char to be parsed.
+ *
+ *	@return		Return 0 if successful, otherwise return -1.
+ */
+static int json_readchr_event(struct json_context * ctx, char chr)
+{
+	int						result		= 0;
+
+	enum	json_states		state		= ctx->state;
+	enum	json_modes		mode		= ctx->mode_stack[ctx->stack_top];
+
+	enum	json_classes	chr_class	= _____;
+	enum	json_states		next_state	= __;
+
+	if ( __ == state )
+	{
+		/* parsing has been stopped by error or by the event handler */
+		return -1;
+	}
+
+	chr_class = ((unsigned char)chr) >= 128 ? C_ETC : json_ascii_class[(int)chr];
+	if ( _____ != chr_class )
+	{
+		next_state = json_state_table[state][chr_class];
+	}
+
+	/* pre-process: the number ends when leaving number states */
+	if (	((ZE == state) || (IN == state) || (FR == state) || (E3 == state))
+		&&	((OK == next_state) || (_V == next_state)
+			|| (_T == next_state) || (_Y == next_state)) )
+	{
+		if ( E3 == state )
+		{
+			ctx->number.value.number.value *= pow(	10.0,
+													(0 != ctx->exp_minus)
+														? -ctx->exp
+														: ctx->exp
+													);
+		}
+		if ( 0 != ctx->negative )
+		{
+			ctx->number.value.number.value *= -1;
+		}
+		result = json_emit(ctx, json_event_number, &(ctx->number));
+	}
+
+	if ( 0 != result )
+	{
+		next_state = __;
+	}
+
+	switch ( next_state )
+	{
+	case _O:	/* start of object */
+		if ( 0 == json_push(ctx, MODE_KEY) )
+		{
+			result = -1;
+		}
+		else
+		{
+			result = json_emit(ctx, json_event_start_object, NULL);
+		}
+		ctx->state = OB;
+		break;
+
+	case _A:	/* start of array */
+		if ( 0 == json_push(ctx, MODE_ARRAY) )
+		{
+			result = -1;
+		}
+		else
+		{
+			result = json_emit(ctx, json_event_start_array, NULL);
+		}
+		ctx->state = AR;
+		break;
+
+	case _S:	/* end of string */
+		switch ( mode )
+		{
+		case MODE_KEY:
+			result = json_emit(ctx, json_event_key, &(ctx->string));
+			ctx->state = CO;
+			break;
+		case MODE_ARRAY:
+		case MODE_OBJECT:
+			result = json_emit(ctx, json_event_string, &(ctx->string));
+			ctx->state = OK;
+			break;
+		default:
+			result = -1;
+			break;
+		}
+		break;
+
+	case _C:	/* colon = end of key */
+		if ( 0 == json_pop(ctx, MODE_KEY) || 0 == json_push(ctx, MODE_OBJECT) )
+		{
+			result = -1;
+		}
+		ctx->state = VA;
+		break;
+
+	case _V:	/* comma = end of key-value pair, array element */
+		switch ( mode )
+		{
+		case MODE_OBJECT:
+			if ( 0 == json_pop(ctx, MODE_OBJECT) || 0 == json_push(ctx, MODE_KEY) )
+			{
+				result = -1;
+			}
+			ctx->state = KE;
+			break;
+		case MODE_ARRAY:
+			ctx->state = VA;
+			break;
+		default:
+			result = -1;
+			break;
+		}
+		break;
+
+	case _T:	/* end of object */
+		if ( (MODE_KEY != mode) && (MODE_OBJECT != mode) )
+		{
+			result = -1;
+		}
+		else if ( 0 == json_pop(ctx, mode) )
+		{
+			result = -1;
+		}
+		else
+		{
+			result = json_emit(ctx, json_event_end_object, NULL);
+		}
+		ctx->state = OK;
+		break;
+
+	case _Y:	/* end of array */
+		if ( 0 == json_pop(ctx, MODE_ARRAY) )
+		{
+			result = -1;
+		}
+		else
+		{
+			result = json_emit(ctx, json_event_end_array, NULL);
+		}
+		ctx->state = OK;
+		break;
+
+	case OK:	/* ok       */
+		switch ( state )
+		{
+		case T3:
+			result = json_emit(ctx, json_event_true, NULL);
+			break;
+		case F4:
+			result = json_emit(ctx, json_event_false, NULL);
+			break;
+		case N3:
+			result = json_emit(ctx, json_event_null, NULL);
+			break;
+		default:
+			break;
+		}
+		ctx->state = next_state;
+		break;
+
+	case ST:	/* string   */
+		switch ( state )
+		{
+		case ES:	/* escape character */
+			result = json_unescape(&chr);
+			if ( 0 == result )
+			{
+				result = json_string_append(&(ctx->string), chr);
+			}
+			break;
 
-	return 0;
-}
+		case ST:
+			result = json_string_append(&(ctx->string), chr);
+			break;
 
+		case U4:
+			ctx->chr *= 16;
+			if ( (chr >= '0') && (chr <= '9') )
+			{
+				ctx->chr += (chr - '0');
+			}
+			else if ( (chr >= 'a') && (chr <= 'f') )
+			{
+				ctx->chr += (chr - 'a' + 10);
+			}
+			else /* if ( (chr >= 'A') && (chr <= 'F') ) */
+			{
+				ctx->chr += (chr - 'A' + 10);
+			}
+			result = json_string_append_unicode(&(ctx->string), ctx->chr);
+			break;
 
-/**
- *	Push a json value into json context.
- *
- *	@param[out]		ctx		- the json parse context.
- *	@param[in]		type	- type of the new value to be pushed.
- *
- *	@return		Return 0 if successful, otherwise return -1.
- */
-static int json_push_value(
-	struct	json_context		*	ctx,
-	enum	json_value_type			type
-	)
-{
-	static const int RESULT_SUCCESS = 0;
-	static const int RESULT_FAILURE = -1;
+		default:
+			/* start of string, reuse the buffer */
+			if ( NULL != ctx->string.value.string.value )
+			{
+				ctx->string.value.string.value[0] = '\0';
+				ctx->string.value.string.length = 0;
+			}
+			else
+			{
+				result = json_string_set(&(ctx->string), "");
+			}
+			break;
+		}
+		ctx->state = next_state;
+		break;
 
-	int								result	= RESULT_SUCCESS;
-	struct	json_parse_value	*	value	= NULL;
+	case U1:	/* u1       */
+		ctx->chr = 0;
+		ctx->state = next_state;
+		break;
 
-	if ( NULL == ctx )
-	{
-		result = RESULT_FAILURE;
-	}
+	case U2:	/* u2       */
+	case U3:	/* u3       */
+	case U4:	/* u4       */
+		ctx->chr *= 16;
+		if ( (chr >= '0') && (chr <= '9') )
+		{
+			ctx->chr += (chr - '0');
+		}
+		else if ( (chr >= 'a') && (chr <= 'f') )
+		{
+			ctx->chr += (chr - 'a' + 10);
+		}
+		else /* if ( (chr >= 'A') && (chr <= 'F') ) */
+		{
+			ctx->chr += (chr - 'A' + 10);
+		}
+		ctx->state = next_state;
+		break;
 
-	if ( RESULT_SUCCESS == result )
-	{
-		value = malloc(sizeof(struct json_parse_value));
-		if ( NULL != value )
+	case ZE:	/* zero     */
+	case IN:	/* integer  */
+		if ( IN != state )
 		{
-			memset(value, 0, sizeof(*value));
+			ctx->pow		= 0;
+			ctx->negative	= (MI == state) ? 1 : 0;
+			ctx->number.value.number.value = (IN == next_state) ? (chr - '0') : 0;
 		}
 		else
 		{
-			result = RESULT_FAILURE;
+			ctx->number.value.number.value *= 10;
+			ctx->number.value.number.value += chr - '0';
 		}
-	}
+		ctx->state = next_state;
+		break;
 
-	if ( RESULT_SUCCESS == result )
-	{
-		value->object = json_create(type);
-		if ( NULL == value->object )
+	case FR:	/* fraction */
+		if ( FR == state )
 		{
-			result = RESULT_FAILURE;
+			double exp = (chr - '0') * pow(10.0, ctx->pow);
+			ctx->number.value.number.value += exp;
 		}
-	}
+		--(ctx->pow);
+		ctx->state = next_state;
+		break;
 
-	if ( RESULT_SUCCESS == result )
-	{
-		value->parent = ctx->target;
-		ctx->target = value;
-	}
-	else
-	{
-		if ( NULL != value )
-		{
-			if ( NULL != value->object )
-			{
-				json_destroy(value->object);
-				value->object = NULL;
-			}
+	case GO:	/* start    */
+	case OB:	/* object   */
+	case KE:	/* key      */
+	case CO:	/* colon    */
+	case VA:	/* value    */
+	case AR:	/* array    */
+	case ES:	/* escape   */
+	case MI:	/* minus    */
+	case T1:	/* tr       */
+	case T2:	/* tru      */
+	case T3:	/* true     */
+	case F1:	/* fa       */
+	case F2:	/* fal      */
+	case F3:	/* fals     */
+	case F4:	/* false    */
+	case N1:	/* nu       */
+	case N2:	/* nul      */
+	case N3:	/* null     */
+		ctx->state = next_state;
+		break;
 
-			free(value);
-			value = NULL;
+	case E1:	/* e        */
+		ctx->exp			= 0;
+		ctx->exp_minus		= 0;
+		ctx->state			= next_state;
+		break;
+
+	case E2:	/* ex       */
+		ctx->exp_minus		= ('-' == chr) ? 1 : 0;
+		ctx->state			= next_state;
+		break;
+
+	case E3:	/* exp      */
+		/* larger exponents overflow a double anyway */
+		if ( ctx->exp < 10000 )
+		{
+			ctx->exp = ctx->exp * 10 + (chr - '0');
 		}
+		ctx->state = next_state;
+		break;
+
+	case __:	/* invalid state */
+	default:
+		result = -1;
+		break;
+	}
+
+	if ( 0 != result )
+	{
+		ctx->state = __;
 	}
 
 	return result;
@@ -957,6 +1917,11 @@ int json_readchr(struct json_context * ctx, char chr)
 	enum	json_classes	chr_class	= __;
 	enum	json_states		next_state	= __;
 
+	if ( NULL != ctx->callback )
+	{
+		return json_readchr_event(ctx, chr);
+	}
+
 	chr_class = ((unsigned char)chr) >= 128 ? C_ETC : json_ascii_class[(int)chr];
 	next_state = json_state_table[state][chr_class];
 
@@ -1035,7 +2000,7 @@ int json_readchr(struct json_context * ctx, char chr)
 				if ( NULL != ctx->target )
 				{
 					memset(ctx->target, 0, sizeof(*ctx->target));
-					ctx->target->object = json_create(json_type_array);
+					ctx->target->object = json_create_in(ctx->arena, json_type_array);
 					if ( NULL == ctx->target->object )
 					{
 						assert(0);
@@ -1117,11 +2082,9 @@ int json_readchr(struct json_context * ctx, char chr)
 				assert(json_type_object == json_get_type(ctx->target->object));
 				assert(json_type_string == json_get_type(ctx->target->key));
 				assert(NULL != ctx->target->value);
-				json_object_set(ctx->target->object,
-								ctx->target->key->value.string.value,
-								ctx->target->value);
-				json_destroy(ctx->target->key);
-				json_destroy(ctx->target->value);
+				result = json_object_attach(ctx->target->object,
+											ctx->target->key,
+											ctx->target->value);
 				ctx->target->key = NULL;
 				ctx->target->value = NULL;
 			}
@@ -1137,8 +2100,7 @@ int json_readchr(struct json_context * ctx, char chr)
 			assert(NULL == ctx->target->key);
 			assert(NULL != ctx->target->value);
 
-			json_array_append(ctx->target->object, ctx->target->value);
-			json_destroy(ctx->target->value);
+			result = json_array_attach(ctx->target->object, ctx->target->value);
 			ctx->target->value = NULL;
 			ctx->state = VA;
 			break;
@@ -1179,11 +2141,9 @@ int json_readchr(struct json_context * ctx, char chr)
 				assert(json_type_string == json_get_type(ctx->target->key));
 				assert(NULL != ctx->target->value);
 
-				json_object_set(ctx->target->object,
-								ctx->target->key->value.string.value,
-								ctx->target->value);
-				json_destroy(ctx->target->key);
-				json_destroy(ctx->target->value);
+				result = json_object_attach(ctx->target->object,
+											ctx->target->key,
+											ctx->target->value);
 				ctx->target->key = NULL;
 				ctx->target->value = NULL;
 				if ( NULL != ctx->target->parent )
@@ -1212,8 +2172,7 @@ int json_readchr(struct json_context * ctx, char chr)
 			if ( NULL != ctx->target->value )
 			{
 				/* non-empty array */
-				json_array_append(ctx->target->object, ctx->target->value);
-				json_destroy(ctx->target->value);
+				result = json_array_attach(ctx->target->object, ctx->target->value);
 				ctx->target->value = NULL;
 			}
 			if ( NULL != ctx->target->parent )
@@ -1248,7 +2207,7 @@ int json_readchr(struct json_context * ctx, char chr)
 		{
 		case T3:
 			assert( NULL != ctx->target );
-			ctx->target->value = json_create(json_type_true);
+			ctx->target->value = json_create_in(ctx->arena, json_type_true);
 			if ( NULL == ctx->target->value )
 			{
 				assert(0);
@@ -1258,7 +2217,7 @@ int json_readchr(struct json_context * ctx, char chr)
 
 		case F4:
 			assert( NULL != ctx->target );
-			ctx->target->value = json_create(json_type_false);
+			ctx->target->value = json_create_in(ctx->arena, json_type_false);
 			if ( NULL == ctx->target->value )
 			{
 				assert(0);
@@ -1268,7 +2227,7 @@ int json_readchr(struct json_context * ctx, char chr)
 
 		case N3:
 			assert( NULL != ctx->target );
-			ctx->target->value = json_create(json_type_null);
+			ctx->target->value = json_create_in(ctx->arena, json_type_null);
 			if ( NULL == ctx->target->value )
 			{
 				assert(0);
@@ -1286,37 +2245,7 @@ int json_readchr(struct json_context * ctx, char chr)
 		if ( ES == ctx->state )
 		{
 			/* escape character support */
-			switch ( chr )
-			{
-			case '"':
-				chr = '"';
-				break;
-			case '\\':
-				chr = '\\';
-				break;
-			case '/':
-				chr = '/';
-				break;
-			case 'b':
-				chr = '\b';
-				break;
-			case 'f':
-				chr = '\f';
-				break;
-			case 'n':
-				chr = '\n';
-				break;
-			case 'r':
-				chr = '\r';
-				break;
-			case 't':
-				chr = '\t';
-				break;
-			default:
-				assert(0);
-				result = -1;
-				break;
-			}
+			result = json_unescape(&chr);
 		}
 		if ( -1 != result )
 		{
@@ -1369,28 +2298,11 @@ int json_readchr(struct json_context * ctx, char chr)
 				{
 					ctx->target->chr += (chr - 'A' + 10);
 				}
-				if ( ctx->target->chr > 0x07ff )
-				{
-					/* 3-byte character */
-					json_string_append(*target, (char)(0xe0 | (ctx->target->chr >> 12)));
-					json_string_append(*target, (char)(0x80 | ((ctx->target->chr >> 6) & 0x3f)));
-					json_string_append(*target, (char)(0x80 | (ctx->target->chr & 0x3f)));
-				}
-				else if ( ctx->target->chr > 0x007f )
-				{
-					/* 2-byte character */
-					json_string_append(*target, (char)(0xc0 | (ctx->target->chr >> 6)));
-					json_string_append(*target, (char)(0x80 | (ctx->target->chr & 0x3f)));
-				}
-				else
-				{
-					/* 1-byte character */
-					json_string_append(*target, (char)ctx->target->chr);
-				}
+				json_string_append_unicode(*target, ctx->target->chr);
 				break;
 
 			default:
-				*target = json_create(json_type_string);
+				*target = json_create_in(ctx->arena, json_type_string);
 				if ( NULL == (*target) )
 				{
 					assert(0);
@@ -1444,7 +2356,7 @@ int json_readchr(struct json_context * ctx, char chr)
 				assert( (MODE_OBJECT == mode) || (NULL == ctx->target->key));
 				ctx->target->pow		= 0;
 				ctx->target->negative	= MI == ctx->state ? 1 : 0;
-				ctx->target->value		= json_create(json_type_number);
+				ctx->target->value		= json_create_in(ctx->arena, json_type_number);
 				if ( NULL == ctx->target->value )
 				{
 					assert(0);
@@ -1513,6 +2425,81 @@ int json_readchr(struct json_context * ctx, char chr)
 }
 
 
+/**
+ *	Read a block of chars into the json parse context.
+ *
+ *	@param[out]		ctx		- the json parse context.
+ *	@param[in]		data	- the chars to be parsed.
+ *	@param[in]		size	- number of chars in [data].
+ *
+ *	@note		It's the same as calling [json_readchr] for each char, except
+ *				that a run of plain characters inside a string is appended to
+ *				the string at once.
+ *
+ *	@return		Return 0 if successful, otherwise return -1.
+ */
+int json_read(struct json_context * ctx, const char * data, size_t size)
+{
+	size_t idx = 0;
+
+	if ( (NULL == ctx) || ((NULL == data) && (0 != size)) )
+	{
+		return -1;
+	}
+
+	while ( idx < size )
+	{
+		if ( ST == ctx->state )
+		{
+			struct json_value	*	target	= NULL;
+			size_t					end		= idx;
+
+			/* find characters which don't end the string or start escape */
+			while ( end < size )
+			{
+				unsigned char chr = (unsigned char)data[end];
+				if (	(chr < 128)
+					&&	(	(_____ == json_ascii_class[chr])
+						||	(ST != json_state_table[ST][json_ascii_class[chr]]) ) )
+				{
+					break;
+				}
+				++end;
+			}
+
+			if ( end > idx )
+			{
+				if ( NULL != ctx->callback )
+				{
+					target = &(ctx->string);
+				}
+				else if ( NULL != ctx->target )
+				{
+					target = (MODE_KEY == ctx->mode_stack[ctx->stack_top])
+								? ctx->target->key
+								: ctx->target->value;
+				}
+				if ( 0 != json_string_append_n(target, data + idx, end - idx) )
+				{
+					return -1;
+				}
+
+				idx = end;
+				continue;
+			}
+		}
+
+		if ( 0 != json_readchr(ctx, data[idx]) )
+		{
+			return -1;
+		}
+		++idx;
+	}
+
+	return 0;
+}
+
+
 /**
  *	Create a json_context object.
  *
@@ -1526,11 +2513,17 @@ struct json_context * json_create_context(int depth)
 {
 	struct json_context * ctx = malloc(sizeof(struct json_context));
 
+	if ( NULL == ctx )
+	{
+		return NULL;
+	}
+
 	memset(ctx, 0, sizeof(*ctx));
 
 	ctx->mode_stack  = malloc(sizeof(ctx->mode_stack[0]) * depth);
 	if ( NULL == ctx->mode_stack )
 	{
+		free(ctx);
 		return NULL;
 	}
 
@@ -1541,6 +2534,68 @@ struct json_context * json_create_context(int depth)
 }
 
 
+/**
+ *	Create a json_context object which allocates the parsed values from an
+ *	arena. The values are allocated in large blocks, and freed all at once.
+ *
+ *	@param[in]	depth	: maximum json depth.
+ *
+ *	@return		Return pointer to the newly created json_context object if
+ *				successful. Otherwise it will return NULL.
+ */
+struct json_context * json_create_arena_context(int depth)
+{
+	struct json_context * ctx = json_create_context(depth);
+
+	if ( NULL != ctx )
+	{
+		ctx->arena = json_arena_create();
+		if ( NULL == ctx->arena )
+		{
+			json_destroy_context(ctx);
+			ctx = NULL;
+		}
+	}
+
+	return ctx;
+}
+
+
+/**
+ *	Create an event driven json_context object.
+ *
+ *	@param[in]	depth		: maximum json depth.
+ *	@param[in]	callback	: the event handler.
+ *	@param[in]	param		: extra parameter to be passed to [callback].
+ *
+ *	@return		Return pointer to the newly created json_context object if
+ *				successful. Otherwise it will return NULL.
+ */
+struct json_context * json_create_event_context(
+	int							depth,
+	json_event_callback			callback,
+	void					*	param
+	)
+{
+	struct json_context * ctx = NULL;
+
+	if ( NULL != callback )
+	{
+		ctx = json_create_context(depth);
+	}
+
+	if ( NULL != ctx )
+	{
+		ctx->callback		= callback;
+		ctx->param			= param;
+		ctx->string.type	= json_type_string;
+		ctx->number.type	= json_type_number;
+	}
+
+	return ctx;
+}
+
+
 /**
  *	Stop parsing json object and determine if the parsed string is a valid and
  *	complete json expression.
@@ -1580,15 +2635,23 @@ void json_destroy_context(struct json_context * context)
 		free(context->mode_stack);
 		context->mode_stack = NULL;
 	}
+	if ( NULL != context->string.value.string.value )
+	{
+		free(context->string.value.string.value);
+		context->string.value.string.value = NULL;
+	}
 
 	value = context->target;
 	while ( value != NULL )
 	{
 		struct json_parse_value * parent = NULL;
 
-		json_destroy(value->object);
-		json_destroy(value->key);
-		json_destroy(value->value);
+		if ( NULL == context->arena )
+		{
+			json_destroy(value->object);
+			json_destroy(value->key);
+			json_destroy(value->value);
+		}
 		value->object = NULL;
 		value->key = NULL;
 		value->value = NULL;
@@ -1598,6 +2661,12 @@ void json_destroy_context(struct json_context * context)
 		value = parent;
 	}
 
+	if ( (NULL != context->arena) && (NULL == context->arena->owner) )
+	{
+		json_arena_destroy(context->arena);
+	}
+	context->arena = NULL;
+
 	free(context);
 	context = NULL;
 }
@@ -1620,6 +2689,13 @@ struct json_value * json_get_value(struct json_context * ctx)
 		return NULL;
 	}
 
+	if ( (NULL != ctx->arena) && (NULL == ctx->arena->owner) )
+	{
+		/* no copy, the returned value takes over the arena */
+		ctx->arena->owner = ctx->target->object;
+		return ctx->target->object;
+	}
+
 	return json_duplicate(ctx->target->object);
 }
 
@@ -1655,11 +2731,27 @@ unsigned long json_array_size(struct json_value * var)
  *				NULL will be returned.
  */
 struct json_value * json_array_get(struct json_value * var, unsigned long idx)
+{
+	return json_duplicate(json_array_peek(var, idx));
+}
+
+
+/**
+ *	Get array element from an array, without copying it.
+ *
+ *	@param[in]		var		: the array
+ *	@param[in]		idx		: 0-based array element index
+ *
+ *	@return		The array element will be returned on success, it's owned by
+ *				[var], don't free it, and don't use it after [var] is destroyed.
+ *				Otherwise NULL will be returned.
+ */
+struct json_value * json_array_peek(struct json_value * var, unsigned long idx)
 {
 	struct json_value * value = NULL;
 	if ( json_type_array == json_get_type(var) && idx < json_array_size(var) )
 	{
-		value = json_duplicate(var->value.array.value[idx]);
+		value = var->value.array.value[idx];
 	}
 
 	return value;
@@ -1695,7 +2787,7 @@ int json_to_number(struct json_value * var)
 
 			if ( (NULL != end) && ('\0' == *end ) )
 			{
-				free(var->value.string.value);
+				json_free(var->arena, var->value.string.value);
 
 				var->value.string.value	= NULL;
 				var->type				= json_type_number;
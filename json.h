@@ -26,6 +26,8 @@
 #ifndef _INC_JSON
 #define _INC_JSON
 
+#include <stddef.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -47,6 +49,39 @@ enum json_value_type
 	json_type_false
 };
 
+/* events reported by an event driven json_context */
+enum json_event_type
+{
+	json_event_start_object,	/* {                                  */
+	json_event_end_object,		/* }                                  */
+	json_event_start_array,		/* [                                  */
+	json_event_end_array,		/* ]                                  */
+	json_event_key,				/* name of an object member, a string */
+	json_event_string,			/* string value                       */
+	json_event_number,			/* number value                       */
+	json_event_true,			/* true                               */
+	json_event_false,			/* false                              */
+	json_event_null				/* null                               */
+};
+
+/**
+ *	Prototype of the event handler of an event driven json_context.
+ *
+ *	@param[in]	event	: type of the event.
+ *	@param[in]	value	: for [json_event_key], [json_event_string] and
+ *						  [json_event_number], it's the parsed value. It's
+ *						  owned by the parser and only valid during the call.
+ *						  For other events, it's NULL.
+ *	@param[in]	param	: the parameter passed to [json_create_event_context].
+ *
+ *	@return		Return 0 to continue parsing, any other value stops it.
+ */
+typedef int (*json_event_callback)(
+	enum json_event_type		event,
+	struct json_value		*	value,
+	void					*	param
+	);
+
 
 /**
  *	Create a json_context object.
@@ -61,6 +96,49 @@ enum json_value_type
 struct json_context * json_create_context(int depth);
 
 
+/**
+ *	Create a json_context object which allocates the parsed values from an
+ *	arena: they're allocated in a few large blocks instead of one by one.
+ *
+ *	@param[in]	depth	: maximum json depth.
+ *
+ *	@note		The first [json_get_value] call returns the parsed value without
+ *				copying it, and the value takes over the arena. Destroying it by
+ *				[json_destroy] frees the whole tree at once, and its members can
+ *				not be destroyed separately. Only [json_destroy_context] can be
+ *				used on the context after that.
+ *
+ *	@return		Return pointer to the newly created json_context object if
+ *				successful. Otherwise it will return NULL.
+ *				Use [json_destroy_context] to free the returned object when it's
+ *				no longer needed.
+ */
+struct json_context * json_create_arena_context(int depth);
+
+
+/**
+ *	Create an event driven json_context object. Instead of building json_value
+ *	objects, the parser reports what it read to [callback] as soon as a token
+ *	is complete, so memory usage doesn't grow with the size of the input.
+ *
+ *	@param[in]	depth		: maximum json depth.
+ *	@param[in]	callback	: the event handler.
+ *	@param[in]	param		: extra parameter to be passed to [callback].
+ *
+ *	@note		[json_get_value] always returns NULL for such a context.
+ *
+ *	@return		Return pointer to the newly created json_context object if
+ *				successful. Otherwise it will return NULL.
+ *				Use [json_destroy_context] to free the returned object when it's
+ *				no longer needed.
+ */
+struct json_context * json_create_event_context(
+	int							depth,
+	json_event_callback			callback,
+	void					*	param
+	);
+
+
 /**
  *	Destroy the [json_context] object and free resources allocated for the
  *	[json_context] object.
@@ -93,6 +171,22 @@ int json_finalize_context(struct json_context * ctx);
 int json_readchr(struct json_context * ctx, char chr);
 
 
+/**
+ *	Read a block of chars into the json parse context.
+ *
+ *	@param[out]		ctx		: the json parse context.
+ *	@param[in]		data	: the chars to be parsed.
+ *	@param[in]		size	: number of chars in [data].
+ *
+ *	@note		It's the same as calling [json_readchr] for each char, except
+ *				that a run of plain characters inside a string is appended to
+ *				the string at once.
+ *
+ *	@return		Return 0 if successful, otherwise return -1.
+ */
+int json_read(struct json_context * ctx, const char * data, size_t size);
+
+
 /**
  *	Get the [json_value] object from [json_context].
  *
@@ -214,6 +308,18 @@ int json_number_set(struct json_value * var, int number);
  *				to free the returned object when it's no longer needed.
  */
 struct json_value * json_object_get(struct json_value * var, char * key);
+/**
+ *	Get member value of a json object object, without copying it.
+ *
+ *	@param[in]	var		: the [json_value] object of type [json_type_object].
+ *	@param[in]	key		: name of the object member.
+ *
+ *	@return		Return value of the json object's member, if the key is not
+ *				found in the object, NULL will be returned. The returned object
+ *				is owned by [var], don't free it, and don't use it after [var]
+ *				is destroyed.
+ */
+struct json_value * json_object_peek(struct json_value * var, const char * key);
 
 
 /**
@@ -272,6 +378,20 @@ struct json_value * json_array_get(
 	struct json_value	*	var,
 	unsigned long			idx
 	);
+/**
+ *	Get array element from an array, without copying it.
+ *
+ *	@param[in]		var		: the array
+ *	@param[in]		idx		: 0-based array element index
+ *
+ *	@return		The array element will be returned on success, it's owned by
+ *				[var], don't free it, and don't use it after [var] is destroyed.
+ *				Otherwise NULL will be returned.
+ */
+struct json_value * json_array_peek(
+	struct json_value	*	var,
+	unsigned long			idx
+	);
 	
 
 /**
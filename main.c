@@ -78,6 +78,12 @@ static int handle_config_parseline(char * buffer, char ** name, char ** value);
  */
 static struct ddns_context ddns_ctx;
 
+/**
+ *	The first account to be run, it's [ddns_ctx] unless [ddns_ctx] only holds
+ *	options shared by the "[account]" sections of configuration file.
+ */
+static struct ddns_context * ddns_head = &ddns_ctx;
+
 #if (defined(HAVE_CONFIG_H) && (!defined(HAVE_GETCH) || 0 == HAVE_GETCH) ) || \
 	(!defined(HAVE_CONFIG_H) && !defined(WIN32))
 static int getch(void)
@@ -95,6 +101,23 @@ static int getch(void)
 }
 #endif
 
+/**
+ *	Ask all accounts to quit.
+ */
+static void handle_exit(void)
+{
+	struct ddns_context * context = NULL;
+
+	for ( context = &ddns_ctx; NULL != context; context = context->next_account )
+	{
+		ddns_sync_lock(&(context->sync_object));
+		context->exit_signal = 1;
+		ddns_sync_unlock(&(context->sync_object));
+	}
+
+	ddns_sync_event_set(&(ddns_head->wakeup_event));
+}
+
 #ifndef WIN32
 
 /**
@@ -118,9 +141,7 @@ void handle_signals(int code)
 	case SIGABRT:
 	case SIGKILL:
 	case SIGTERM:
-		ddns_sync_lock(&(ddns_ctx.sync_object));
-		ddns_ctx.exit_signal = 1;
-		ddns_sync_unlock(&(ddns_ctx.sync_object));
+		handle_exit();
 		return;
 
 	case SIGPIPE:
@@ -160,9 +181,7 @@ BOOL WINAPI handle_signals(DWORD dwCtrlType)
 	case CTRL_CLOSE_EVENT:
 	case CTRL_LOGOFF_EVENT:
 	case CTRL_SHUTDOWN_EVENT:
-		ddns_sync_lock(&(ddns_ctx.sync_object));
-		ddns_ctx.exit_signal = 1;
-		ddns_sync_unlock(&(ddns_ctx.sync_object));
+		handle_exit();
 		return TRUE;
 		break;
 
@@ -187,6 +206,7 @@ int main(int argc, const char * argv[])
 {
 	int i = 0;
 	int set_verbose_mode = 0;
+	struct ddns_context * account = NULL;
 
 #ifdef WIN32
 	int nt_service_mode = 0;
@@ -196,9 +216,6 @@ int main(int argc, const char * argv[])
 #endif
 
 	ddns_initcontext(&ddns_ctx);
-	ddns_ctx.interval		= -1;
-	ddns_ctx.timeout		= -1;
-	ddns_ctx.auto_restart	= -1;
 
 #ifdef WIN32
 	SetConsoleCtrlHandler(&handle_signals, TRUE);
@@ -316,6 +333,27 @@ int main(int argc, const char * argv[])
 				goto _DONE;
 			i += (result - 1);
 		}
+		else if ( 0 == strcmp("--parallel", argv[i]) )
+		{
+			int result = handle_parallel(&ddns_ctx, argc - i, argv + i);
+			if ( result < 0 )
+				goto _DONE;
+			i += (result - 1);
+		}
+		else if ( 0 == strcmp("--interface", argv[i]) )
+		{
+			int result = handle_interface(&ddns_ctx, argc - i, argv + i);
+			if ( result < 0 )
+				goto _DONE;
+			i += (result - 1);
+		}
+		else if ( 0 == strcmp("--state", argv[i]) )
+		{
+			int result = handle_state(&ddns_ctx, argc - i, argv + i);
+			if ( result < 0 )
+				goto _DONE;
+			i += (result - 1);
+		}
 #ifdef ENABLE_DAEMON_MODE
 		else if ( 0 == strcmp("-m", argv[i]) ||
 				  0 == strcmp("--daemon", argv[i]) )
@@ -364,16 +402,75 @@ int main(int argc, const char * argv[])
 		}
 	}
 
+	/**
+	 *	Without an account of its own, [ddns_ctx] only provides the options
+	 *	shared by the accounts declared in configuration file.
+	 */
+	if ( ('\0' == ddns_ctx.username[0]) && (NULL != ddns_ctx.next_account) )
+	{
+		ddns_head = ddns_ctx.next_account;
+	}
+
 	/* provide defaults for optional options */
 	fill_default_options(&ddns_ctx);
 
 	/* check critical options, exit on any error. */
-	if ( !check_critical_options(&ddns_ctx) )
+	if ( (&ddns_ctx == ddns_head) && !check_critical_options(&ddns_ctx) )
 	{
 		print_usage();
 		goto _DONE;
 	}
 
+	/**
+	 *	The same for accounts declared in configuration file, options not
+	 *	specified by the account are taken from command line.
+	 */
+	for ( account = ddns_ctx.next_account; NULL != account; account = account->next_account )
+	{
+		if ( NULL == account->stream_out )
+		{
+			account->stream_out = ddns_ctx.stream_out;
+		}
+		if ( set_verbose_mode )
+		{
+			account->verbose_mode = ddns_ctx.verbose_mode;
+		}
+		if ( proto_unknown == account->protocol )
+		{
+			account->protocol = ddns_ctx.protocol;
+		}
+		if ( account->timeout <= 0 )
+		{
+			account->timeout = ddns_ctx.timeout;
+		}
+		if ( account->interval <= 0 )
+		{
+			account->interval = ddns_ctx.interval;
+		}
+		if ( account->auto_restart < 0 )
+		{
+			account->auto_restart = ddns_ctx.auto_restart;
+		}
+		if ( account->parallel <= 0 )
+		{
+			account->parallel = ddns_ctx.parallel;
+		}
+		if ( '\0' == account->netif[0] )
+		{
+			c99_strncpy(account->netif,
+						ddns_ctx.netif,
+						_countof(account->netif)
+						);
+		}
+
+		fill_default_options(account);
+		if ( !check_critical_options(account) )
+		{
+			print_usage();
+			goto _DONE;
+		}
+	}
+
 #if defined(ENABLE_DAEMON_MODE) && !defined(WIN32)
 	if ( 0 != daemon_mode )
 	{
@@ -382,18 +479,18 @@ int main(int argc, const char * argv[])
 #endif
 
 #ifndef WIN32
-	ddns_execute(&ddns_ctx);
+	ddns_execute(ddns_head);
 #else
 	if ( 0 != nt_service_mode )
 	{
-		if ( 0 != ddns_nt_service(&ddns_ctx) )
+		if ( 0 != ddns_nt_service(ddns_head) )
 		{
 			ddns_msg(&ddns_ctx, msg_type_error, "Incorrect usage of option \"--service\".\n");
 		}
 	}
 	else
 	{
-		ddns_execute(&ddns_ctx);
+		ddns_execute(ddns_head);
 	}
 #endif
 
@@ -441,7 +538,8 @@ void print_usage(void)
 			"    protocols       List all available DDNS protocols.\n"
 			"\n"
 			"Options:\n"
-			"    -c, --config    Path of configuration file.\n"
+			"    -c, --config    Path of configuration file, each \"[account]\" section\n"
+			"                    in it declares an account to be run in parallel.\n"
 			"    -l, --log       Path of log file.\n"
 			"    -p, --protocol  DDNS protocol type, default is peanuthull.\n"
 			"    -s, --server    DDNS server address in \"domain:port\" favor.\n"
@@ -459,6 +557,13 @@ void print_usage(void)
 			"\n"
 			"    -t, --timeout   DDNS server timeout in seconds, default = 15s.\n"
 			"    -i, --interval  DDNS keep-alive interval, default = 60s.\n"
+			"    --parallel      Maximum number of domain names updated at the\n"
+			"                    same time, default = 4.\n"
+			"    --interface     Read the IP address from a local network interface,\n"
+			"                    the server is asked if it has no internet address.\n"
+			"                    On Linux, a new address of it is applied at once.\n"
+			"    --state         File to keep domains & records of the account, so\n"
+			"                    a restart needn't list them again (DNSPod only).\n"
 #ifdef ENABLE_DAEMON_MODE
 			"    -m, --daemon    Launch the tool in daemon mode.\n"
 #endif
@@ -528,9 +633,11 @@ int handle_help(int argc, const char * argv[])
  */
 int handle_config(struct ddns_context * context, int argc, const char* argv[])
 {
-	int			result	= 2;
-	FILE	*	fconfig = NULL;
-	char		buffer[1024];
+	int						result	= 2;
+	FILE				*	fconfig = NULL;
+	struct ddns_context	*	account	= context;
+	char					buffer[1024];
+	size_t					length	= 0;
 
 	if ( argc < 2 || '-' == argv[1][0] )
 	{
@@ -551,6 +658,7 @@ int handle_config(struct ddns_context * context, int argc, const char* argv[])
 	{
 		char * name = NULL;
 		char * value = NULL;
+		char * line = buffer;
 
 		memset(buffer, 0, sizeof(buffer));
 
@@ -560,6 +668,39 @@ int handle_config(struct ddns_context * context, int argc, const char* argv[])
 			break;
 		}
 
+		/**
+		 *	"[account]" starts a new account, which inherits options above
+		 *	the first section from [context]. Options in a section only
+		 *	apply to its own account.
+		 */
+		while ( 0 != isspace(*line) )
+		{
+			++line;
+		}
+		if ( '[' == *line )
+		{
+			length = strlen(line);
+			while ( (length > 0) && (0 != isspace(line[length - 1])) )
+			{
+				line[--length] = '\0';
+			}
+			if ( 0 != ddns_strcasecmp("[account]", line) )
+			{
+				ddns_msg(context, msg_type_warning, "unknown section \"%s\".\n", line);
+			}
+			else
+			{
+				account = ddns_addaccount(context);
+				if ( NULL == account )
+				{
+					ddns_msg(context, msg_type_error, "insufficient memory.\n");
+					result = -1;
+					break;
+				}
+			}
+			continue;
+		}
+
 		if ( 0 == handle_config_parseline(buffer, &name, &value) )
 		{
 			/* error or comment line */
@@ -568,31 +709,31 @@ int handle_config(struct ddns_context * context, int argc, const char* argv[])
 
 		if ( 0 == ddns_strcasecmp("username", name) )
 		{
-			if ( '\0' == context->username[0] )
+			if ( '\0' == account->username[0] )
 			{
-				c99_strncpy(context->username, value, _countof(context->username));
+				c99_strncpy(account->username, value, _countof(account->username));
 			}
 		}
 		else if ( 0 == ddns_strcasecmp("password", name) )
 		{
-			if ( '\0' == context->password[0] )
+			if ( '\0' == account->password[0] )
 			{
-				c99_strncpy(context->password, value, _countof(context->password));
+				c99_strncpy(account->password, value, _countof(account->password));
 			}
 		}
 		else if ( 0 == ddns_strcasecmp("protocol", name) )
 		{
 			if ( 0 == ddns_strcasecmp("peanuthull", value) )
 			{
-				context->protocol = proto_peanuthull;
+				account->protocol = proto_peanuthull;
 			}
 			else if ( 0 == ddns_strcasecmp("dnspod", value) )
 			{
-				context->protocol = proto_dnspod;
+				account->protocol = proto_dnspod;
 			}
 			else if ( 0 == ddns_strcasecmp("dyndns", value) )
 			{
-				context->protocol = proto_dyndns;
+				account->protocol = proto_dyndns;
 			}
 			else
 			{
@@ -608,17 +749,29 @@ int handle_config(struct ddns_context * context, int argc, const char* argv[])
 			memset(&domain, 0, sizeof(domain));
 
 			c99_strncpy(domain.domain, value, _countof(domain.domain));
-			if ( 0 == ddns_adddomain(context, &domain) )
+			if ( 0 == ddns_adddomain(account, &domain) )
 			{
 				ddns_msg(context, msg_type_error, "insufficient memory.\n");
 				result = -1;
 				break;
 			}
 		}
+		else if ( 0 == ddns_strcasecmp("parallel", name) )
+		{
+			account->parallel = atoi(value);
+		}
+		else if ( 0 == ddns_strcasecmp("interface", name) )
+		{
+			c99_strncpy(account->netif, value, _countof(account->netif));
+		}
+		else if ( 0 == ddns_strcasecmp("StateFile", name) )
+		{
+			c99_strncpy(account->state_file, value, _countof(account->state_file));
+		}
 		else if (0 == ddns_strcasecmp("LogFile", name))
 		{
 			const char * args[] = { "--log", value };
-			if (2 != handle_log(context, 2, args))
+			if (2 != handle_log(account, 2, args))
 			{
 				return -1;
 			}
@@ -846,6 +999,90 @@ int handle_interval(struct ddns_context * context, int argc, const char* argv[])
 }
 
 
+/**
+ *	Handles concurrent update limit argument (--parallel).
+ *
+ *	@param[in]	context		: the DDNS context.
+ *	@param[in]	argc		: count of arguments in argv.
+ *	@param[in]	argv		: arguments to be parsed, the first one is "--parallel".
+ *
+ *	@return	count of arguments have been eaten by this routine when every thing
+ *			is going fine, otherwise -1 will be returned.
+ */
+int handle_parallel(struct ddns_context * context, int argc, const char* argv[])
+{
+	if ( argc < 2 || '-' == argv[1][0] || atoi(argv[1]) <= 0 )
+	{
+		ddns_msg(context, msg_type_error, "No parallel update limit is specified.\n");
+		print_usage();
+		return -1;
+	}
+	else
+	{
+		context->parallel = atoi(argv[1]);
+	}
+
+	return 2;
+}
+
+
+/**
+ *	Handles network interface argument (--interface).
+ *
+ *	@param[in]	context		: the DDNS context.
+ *	@param[in]	argc		: count of arguments in argv.
+ *	@param[in]	argv		: arguments to be parsed, the first one is "--interface".
+ *
+ *	@return	count of arguments have been eaten by this routine when every thing
+ *			is going fine, otherwise -1 will be returned.
+ */
+int handle_interface(struct ddns_context * context, int argc, const char* argv[])
+{
+	if ( argc < 2 || '-' == argv[1][0] )
+	{
+		ddns_msg(context, msg_type_error, "No network interface is specified.\n");
+		print_usage();
+		return -1;
+	}
+	else
+	{
+		c99_strncpy(context->netif, argv[1], _countof(context->netif));
+	}
+
+	return 2;
+}
+
+
+/**
+ *	Handles state file argument (--state).
+ *
+ *	@param[in]	context		: the DDNS context.
+ *	@param[in]	argc		: count of arguments in argv.
+ *	@param[in]	argv		: arguments to be parsed, the first one is "--state".
+ *
+ *	@note	The file belongs to [context] only, other accounts don't inherit
+ *			it, each of them needs its own "StateFile".
+ *
+ *	@return	count of arguments have been eaten by this routine when every thing
+ *			is going fine, otherwise -1 will be returned.
+ */
+int handle_state(struct ddns_context * context, int argc, const char* argv[])
+{
+	if ( argc < 2 || '-' == argv[1][0] )
+	{
+		ddns_msg(context, msg_type_error, "No state file is specified.\n");
+		print_usage();
+		return -1;
+	}
+	else
+	{
+		c99_strncpy(context->state_file, argv[1], _countof(context->state_file));
+	}
+
+	return 2;
+}
+
+
 /**
  *	Handles restart interval argument (-a, --auto-restart).
  *
@@ -893,8 +1130,8 @@ int handle_log(struct ddns_context * context, int argc, const char * argv[])
 	}
 	else
 	{
-		ddns_ctx.stream_out = fopen(argv[1], "a");
-		if (NULL == ddns_ctx.stream_out)
+		context->stream_out = fopen(argv[1], "a");
+		if (NULL == context->stream_out)
 		{
 			ddns_msg(context, msg_type_error, "couldn't open log file for writing.\n");
 			print_usage();
@@ -1021,6 +1258,14 @@ void fill_default_options(struct ddns_context * context)
 								"INFO: Interval default to 60s.\n" );
 	}
 
+	/* default concurrent update limit is 4 */
+	if ( context->parallel <= 0 )
+	{
+		context->parallel = 4;
+		ddns_printf_v(context,	msg_type_info,
+								"INFO: Parallel updates default to 4.\n" );
+	}
+
 	/* default auto restart interval is 60s */
 	if ( context->auto_restart < 0 )
 	{
@@ -157,6 +157,48 @@ int handle_interval(struct ddns_context * context, int argc, const char* argv[])
 int handle_restart(struct ddns_context *context, int argc, const char* argv[]);
 
 
+/**
+ *	Handles concurrent update limit argument (--parallel).
+ *
+ *	@param[in]	context		: the DDNS context.
+ *	@param[in]	argc		: count of arguments in argv.
+ *	@param[in]	argv		: arguments to be parsed, the first one is "--parallel".
+ *
+ *	@return	count of arguments have been eaten by this routine when every thing
+ *			is going fine, otherwise -1 will be returned.
+ */
+int handle_parallel(struct ddns_context * context, int argc, const char* argv[]);
+
+
+/**
+ *	Handles network interface argument (--interface).
+ *
+ *	@param[in]	context		: the DDNS context.
+ *	@param[in]	argc		: count of arguments in argv.
+ *	@param[in]	argv		: arguments to be parsed, the first one is "--interface".
+ *
+ *	@return	count of arguments have been eaten by this routine when every thing
+ *			is going fine, otherwise -1 will be returned.
+ */
+int handle_interface(struct ddns_context * context, int argc, const char* argv[]);
+
+
+/**
+ *	Handles state file argument (--state).
+ *
+ *	@param[in]	context		: the DDNS context.
+ *	@param[in]	argc		: count of arguments in argv.
+ *	@param[in]	argv		: arguments to be parsed, the first one is "--state".
+ *
+ *	@note	The file belongs to [context] only, other accounts don't inherit
+ *			it, each of them needs its own "StateFile".
+ *
+ *	@return	count of arguments have been eaten by this routine when every thing
+ *			is going fine, otherwise -1 will be returned.
+ */
+int handle_state(struct ddns_context * context, int argc, const char* argv[]);
+
+
 /**
  *	Handles log file argument (-l, --log).
  *
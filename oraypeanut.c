@@ -184,6 +184,24 @@ static ddns_error peanuthull_interface_is_ip_changed(
 	);
 
 
+/**
+ *	Non-blocking form of [peanuthull_interface_is_ip_changed], it sends the
+ *	keep-alive request and yields until the response arrives.
+ *
+ *	@param[in]		context		: the DDNS context to operate.
+ *	@param[out]		socket		: the socket to wait for.
+ *	@param[in/out]	events		: see [step_ip_changed] of [ddns_interface].
+ *
+ *	@return		Return DDNS_ERROR_PENDING if the response is to be waited,
+ *				otherwise the same as [peanuthull_interface_is_ip_changed].
+ */
+static ddns_error peanuthull_interface_step_ip_changed(
+	struct ddns_context *	context,
+	ddns_socket			*	socket,
+	int					*	events
+	);
+
+
 /**
  *	Get current IP address.
  *
@@ -371,6 +389,37 @@ static ddns_error peanuthull_do_keepalive(
 	);
 
 
+/**
+ *	Send keep-alive request to active DDNS server via UDP.
+ *
+ *	@param[in/out]	context			: DDNS context.
+ *	@param[in]		request_type	: keep-alive request request_type
+ *
+ *	@return		Return DDNS_ERROR_SUCCESS if successful, otherwise an error
+ *				code will be returned.
+ */
+static ddns_error peanuthull_keepalive_send(
+	struct ddns_context	*	context,
+	unsigned long			request_type
+	);
+
+
+/**
+ *	Receive keep-alive response from active DDNS server and update sequence
+ *	number according to it.
+ *
+ *	@param[in/out]	context			: DDNS context.
+ *	@param[in]		request_type	: type of the keep-alive request sent.
+ *
+ *	@return		Return DDNS_ERROR_SUCCESS if successful, otherwise an error
+ *				code will be returned.
+ */
+static ddns_error peanuthull_keepalive_recv(
+	struct ddns_context	*	context,
+	unsigned long			request_type
+	);
+
+
 /*============================================================================*
  *	Implementation of Functions
  *============================================================================*/
@@ -392,6 +441,7 @@ ddns_interface * peanuthull_interface_create(void)
 
 		ddns->initialize		= &peanuthull_interface_initialize;
 		ddns->is_ip_changed		= &peanuthull_interface_is_ip_changed;
+		ddns->step_ip_changed	= &peanuthull_interface_step_ip_changed;
 		ddns->get_ip_address	= &peanuthull_interface_get_ip_address;
 		ddns->do_update			= &peanuthull_interface_do_update;
 		ddns->finalize			= &peanuthull_interface_finalize;
@@ -537,11 +587,48 @@ static ddns_error peanuthull_interface_initialize(
 static ddns_error peanuthull_interface_is_ip_changed(
 	struct ddns_context * context
 	)
+{
+	ddns_error	error_code	= DDNS_ERROR_SUCCESS;
+	ddns_socket	socket		= DDNS_INVALID_SOCKET;
+	int			events		= 0;
+
+	error_code = peanuthull_interface_step_ip_changed(context, &socket, &events);
+	if ( DDNS_ERROR_PENDING == error_code )
+	{
+		/* [peanuthull_recv] waits for the response until timeout */
+		events		= DDNS_EVENT_READ;
+		error_code	= peanuthull_interface_step_ip_changed(	context,
+															&socket,
+															&events
+															);
+	}
+
+	return error_code;
+}
+
+
+/**
+ *	Non-blocking form of [peanuthull_interface_is_ip_changed], it sends the
+ *	keep-alive request and yields until the response arrives.
+ *
+ *	@param[in]		context		: the DDNS context to operate.
+ *	@param[out]		socket		: the socket to wait for.
+ *	@param[in/out]	events		: see [step_ip_changed] of [ddns_interface].
+ *
+ *	@return		Return DDNS_ERROR_PENDING if the response is to be waited,
+ *				otherwise the same as [peanuthull_interface_is_ip_changed].
+ */
+static ddns_error peanuthull_interface_step_ip_changed(
+	struct ddns_context *	context,
+	ddns_socket			*	socket,
+	int					*	events
+	)
 {
 	ddns_error						error_code	= DDNS_ERROR_SUCCESS;
 	struct peanuthull_context	*	peanuthull	= NULL;
 
-	if ( (NULL == context) || (proto_peanuthull != context->protocol) )
+	if (	(NULL == context) || (proto_peanuthull != context->protocol)
+		||	(NULL == socket) || (NULL == events) )
 	{
 		error_code = DDNS_ERROR_BADARG;
 	}
@@ -554,14 +641,17 @@ static ddns_error peanuthull_interface_is_ip_changed(
 		}
 	}
 
-	ddns_printf_v(	context,
-					msg_type_info,
-					"Doing keep-alive [%d]... ",
-					peanuthull->keep_alive.request.sequence
-					);
-
-	if ( DDNS_ERROR_SUCCESS == error_code )
+	/**
+	 *	Step 1: send keep-alive request, and yield for the response.
+	 */
+	if ( (DDNS_ERROR_SUCCESS == error_code) && (0 == (*events)) )
 	{
+		ddns_printf_v(	context,
+						msg_type_info,
+						"Doing keep-alive [%d]... ",
+						peanuthull->keep_alive.request.sequence
+						);
+
 		if ( DDNS_INVALID_SOCKET == peanuthull->sock )
 		{
 			peanuthull->sock = ddns_socket_create(	AF_INET,
@@ -573,15 +663,37 @@ static ddns_error peanuthull_interface_is_ip_changed(
 				error_code = DDNS_ERROR_UNKNOWN;
 			}
 		}
+
+		if ( DDNS_ERROR_SUCCESS == error_code )
+		{
+			error_code = peanuthull_keepalive_send(context, PEANUTHULL_KEEPALIVE_REQ);
+		}
+		if ( DDNS_ERROR_SUCCESS == error_code )
+		{
+			(*socket)	= peanuthull->sock;
+			(*events)	= DDNS_EVENT_READ;
+			error_code	= DDNS_ERROR_PENDING;
+		}
 	}
 
-	if ( DDNS_ERROR_SUCCESS == error_code )
+	/**
+	 *	Step 2: receive the response, check if IP address is changed.
+	 */
+	else if ( DDNS_ERROR_SUCCESS == error_code )
 	{
 		ddns_ulong32 old_address = peanuthull->address;
 
-		error_code = peanuthull_do_keepalive(	context,
-												PEANUTHULL_KEEPALIVE_REQ
-												);
+		if ( 0 != ((*events) & DDNS_EVENT_READ) )
+		{
+			error_code = peanuthull_keepalive_recv(	context,
+													PEANUTHULL_KEEPALIVE_REQ
+													);
+		}
+		else
+		{
+			error_code = DDNS_ERROR_TIMEOUT;
+		}
+
 		if ( DDNS_ERROR_SUCCESS == error_code )
 		{
 			if ( (0 == old_address) || (old_address == peanuthull->address) )
@@ -589,7 +701,13 @@ static ddns_error peanuthull_interface_is_ip_changed(
 				error_code = DDNS_ERROR_NOCHG;
 			}
 		}
+	}
 
+	/**
+	 *	Step 3: report the result, unless it's waiting for the response.
+	 */
+	if ( (NULL != peanuthull) && (DDNS_ERROR_PENDING != error_code) )
+	{
 		switch ( error_code )
 		{
 		case DDNS_ERROR_SUCCESS:
@@ -1266,28 +1384,23 @@ static int peanuthull_recv(
 _RETRY:
 	if ( DDNS_ERROR_SUCCESS == status_code )
 	{
-		fd_set			fd;
-		struct timeval	tv = { 0, 0 };
-
-		FD_ZERO(&fd);
-		FD_SET(peanuthull->sock, &fd);
-		tv.tv_sec = context->timeout;
-
 		/* wait until the socket is read for read */
-		switch ( select(peanuthull->sock + 1, &fd, 0, 0, &tv) )
+		switch ( ddns_socket_wait(	peanuthull->sock,
+									DDNS_SOCKET_EVENT_READ,
+									context->timeout * 1000UL ) )
 		{
 		case 0:
 			/* timeout */
 			status_code = DDNS_ERROR_TIMEOUT;
 			break;
 
-		case 1:
-			/* socket is read for read */
+		case -1:
+			/* unknown error */
+			status_code = DDNS_ERROR_UNKNOWN;
 			break;
 
 		default:
-			/* unknown error */
-			status_code = DDNS_ERROR_UNKNOWN;
+			/* socket is read for read */
 			break;
 		}
 	}
@@ -1445,27 +1558,22 @@ static ddns_error peanuthull_sendcmd(
 
 	if ( DDNS_ERROR_SUCCESS == error_code )
 	{
-		fd_set			fd;
-		struct timeval	tv =  { 0, 0 };
-
-		FD_ZERO(&fd);
-		FD_SET(peanuthull->sock, &fd);
-		tv.tv_sec = context->timeout;
-
 		/* wait until the socket is read for write */
-		switch ( select(peanuthull->sock + 1, 0, &fd, 0, &tv) )
+		switch ( ddns_socket_wait(	peanuthull->sock,
+									DDNS_SOCKET_EVENT_WRITE,
+									context->timeout * 1000UL ) )
 		{
 		case 0:
 			/* timeout */
 			error_code = DDNS_ERROR_TIMEOUT;
 			break;
-		case 1:
-			/* socket is ready for write */
-			break;
-		default:
+		case -1:
 			/* unknown error */
 			error_code = DDNS_ERROR_UNKNOWN;
 			break;
+		default:
+			/* socket is ready for write */
+			break;
 		}
 	}
 
@@ -1581,6 +1689,8 @@ static ddns_error peanuthull_connect(struct ddns_context * context)
 	if ( DDNS_ERROR_SUCCESS == error_code )
 	{
 		struct ddns_server * server = NULL;
+		struct ddns_deadline deadline;
+
 		if ( NULL == peanuthull->redirect_to )
 		{
 			server = context->server;
@@ -1590,9 +1700,10 @@ static ddns_error peanuthull_connect(struct ddns_context * context)
 			server = peanuthull->redirect_to;
 		}
 
+		ddns_deadline_init(&deadline, context->timeout * 1000UL);
 		peanuthull->sock = ddns_socket_create_tcp(	server->domain,
 													server->port,
-													context->timeout,
+													&deadline,
 													&(context->exit_signal)
 													);
 		if ( DDNS_INVALID_SOCKET != peanuthull->sock )
@@ -2169,6 +2280,31 @@ static ddns_error peanuthull_do_keepalive(
 	struct ddns_context	*	context,
 	unsigned long			request_type
 	)
+{
+	ddns_error error_code = peanuthull_keepalive_send(context, request_type);
+
+	if ( DDNS_ERROR_SUCCESS == error_code )
+	{
+		error_code = peanuthull_keepalive_recv(context, request_type);
+	}
+
+	return error_code;
+}
+
+
+/**
+ *	Send keep-alive request to active DDNS server via UDP.
+ *
+ *	@param[in/out]	context			: DDNS context.
+ *	@param[in]		request_type	: keep-alive request request_type
+ *
+ *	@return		Return DDNS_ERROR_SUCCESS if successful, otherwise an error
+ *				code will be returned.
+ */
+static ddns_error peanuthull_keepalive_send(
+	struct ddns_context	*	context,
+	unsigned long			request_type
+	)
 {
 	ddns_error							error_code	= DDNS_ERROR_SUCCESS;
 	struct peanuthull_context		*	peanuthull	= NULL;
@@ -2243,7 +2379,56 @@ static ddns_error peanuthull_do_keepalive(
 		}
 	}
 
-	/* step 5: wait for response from DDNS server */
+	return error_code;
+}
+
+
+/**
+ *	Receive keep-alive response from active DDNS server and update sequence
+ *	number according to it.
+ *
+ *	@param[in/out]	context			: DDNS context.
+ *	@param[in]		request_type	: type of the keep-alive request sent.
+ *
+ *	@return		Return DDNS_ERROR_SUCCESS if successful, otherwise an error
+ *				code will be returned.
+ */
+static ddns_error peanuthull_keepalive_recv(
+	struct ddns_context	*	context,
+	unsigned long			request_type
+	)
+{
+	ddns_error							error_code	= DDNS_ERROR_SUCCESS;
+	struct peanuthull_context		*	peanuthull	= NULL;
+	struct peanuthull_keepalive_ctx	*	keep_alive	= NULL;
+
+	/**
+	 *	Step 1: arguments validity check.
+	 */
+	if ( (NULL == context) || (proto_peanuthull != context->protocol) )
+	{
+		error_code = DDNS_ERROR_BADARG;
+	}
+	else
+	{
+		peanuthull = (struct peanuthull_context*)context->extra_data;
+		if ( NULL != peanuthull )
+		{
+			keep_alive = &(peanuthull->keep_alive);
+		}
+		else
+		{
+			error_code = DDNS_ERROR_BADARG;
+		}
+	}
+
+	if (	PEANUTHULL_KEEPALIVE_REQ != request_type
+		&&	PEANUTHULL_LOGOUT_REQ != request_type )
+	{
+		error_code = DDNS_ERROR_BADARG;
+	}
+
+	/* wait for response from DDNS server */
 	if ( DDNS_ERROR_SUCCESS == error_code )
 	{
 		struct peanuthull_keepalive_reponse svrpkg;
@@ -363,6 +363,7 @@ static VOID WINAPI service_handler(DWORD dwControl)
 
 				ddns_sync_unlock(&(g_ctx->sync_object));
 			}
+			ddns_sync_event_set(&(g_ctx->wakeup_event));
 		}
 		break;
 
@@ -406,8 +407,8 @@ static VOID WINAPI service_main(DWORD dwArgc, LPTSTR *pArgv)
 		ddns_sync_unlock(&(g_ctx->sync_object));
 		if ( 0 == signal )
 		{
-			/* retry after several seconds */
-			Sleep(RESTART_INTERVAL * 1000);
+			/* retry after several seconds, or quit as soon as stopped */
+			ddns_sync_event_wait(&(g_ctx->wakeup_event), RESTART_INTERVAL * 1000);
 		}
 		else
 		{
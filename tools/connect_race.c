@@ -0,0 +1,155 @@
+/*
+ *	This file is part of 'ddns'.
+ *
+ *	'ddns' is free software; you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published
+ *	by the Free Software Foundation; either version 3 of the License,
+ *	or (at your option) any later version.
+ *
+ *	'ddns' is distributed in the hope that it will be useful, but
+ *	WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with 'ddns'; if not, write to the Free Software Foundation, Inc.,
+ *	51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*
+ *	Check the connect race of [ddns_socket_create_tcp] against a listener at
+ *	10.9.0.5:8080 and blackholed addresses:
+ *
+ *		sudo ./connect_race.sh
+ *
+ *	connect_race.sh runs it in a network namespace, where dns_stub.py gives
+ *	the addresses of the names and 10.9.0.2 and 10.9.0.3 never answer. The
+ *	names are resolved first, so that the steps time the connections only.
+ *	Every step prints the connected address and the time it took, and fails
+ *	unless
+ *
+ *		dead.test		connects to 10.9.0.5 once the blackholed 10.9.0.2 had
+ *						a head start of 250ms, then at once as 10.9.0.5 is
+ *						tried first since;
+ *		refused.test	connects to 10.9.0.5 at once, as 10.9.0.6 refuses;
+ *		void.test		gives up by a deadline of 1s, then by the exit
+ *						signal 0.2s later.
+ */
+
+#include <arpa/inet.h>		/* inet_ntoa */
+#include <stdio.h>
+#include <string.h>
+#include "ddns_socket.h"
+#include "ddns_string.h"	/* _countof */
+#include "ddns_sync.h"
+
+#define CONNECT_RACE_PORT		8080
+#define CONNECT_RACE_SERVER		"10.9.0.5"
+#define CONNECT_RACE_AT_ONCE	50		/* ms of a connection with no race */
+
+static struct ddns_sync_event	connect_race_timer;			/* never set */
+static int						connect_race_stop	= 0;	/* exit signal of a step */
+
+/**
+ *	Connect to a host once, print the result.
+ *
+ *	@param[in]	addr		: the host name.
+ *	@param[in]	budget		: ms to wait at most.
+ *	@param[in]	expected	: address to be connected, NULL if none.
+ *	@param[in]	min_time	: ms the step must take at least.
+ *	@param[in]	max_time	: ms the step must take at most.
+ *
+ *	@return	Return 0 if the step went as expected, otherwise 1.
+ */
+static int connect_race_step(
+	const char	*	addr,
+	unsigned long	budget,
+	const char	*	expected,
+	unsigned long	min_time,
+	unsigned long	max_time
+	)
+{
+	struct ddns_deadline	deadline;
+	struct sockaddr_in		peer;
+	socklen_t				peer_len	= sizeof(peer);
+	char					connected[16];
+	unsigned long			start		= ddns_sync_clock();
+	unsigned long			elapsed		= 0;
+	ddns_socket				sock		= DDNS_INVALID_SOCKET;
+	int						failed		= 0;
+
+	ddns_deadline_init(&deadline, budget);
+	sock	= ddns_socket_create_tcp(	addr, CONNECT_RACE_PORT,
+										&deadline, &connect_race_stop );
+	elapsed	= ddns_sync_clock() - start;
+
+	connected[0] = '\0';
+	if ( DDNS_INVALID_SOCKET != sock )
+	{
+		if ( 0 == getpeername(sock, (struct sockaddr*)&peer, &peer_len) )
+		{
+			c99_strncpy(connected, inet_ntoa(peer.sin_addr), _countof(connected));
+		}
+		ddns_socket_close(sock);
+	}
+
+	failed	=	(elapsed < min_time)
+			||	(elapsed > max_time)
+			||	((NULL == expected) && (DDNS_INVALID_SOCKET != sock))
+			||	((NULL != expected) && (0 != strcmp(expected, connected)));
+
+	printf(	"%-12s: %-10s %5lu ms%s\n",
+			addr, (DDNS_INVALID_SOCKET != sock) ? connected : "failed",
+			elapsed, (0 != failed) ? "  FAIL" : "" );
+
+	return failed;
+}
+
+/**
+ *	Set the exit signal a while later.
+ *
+ *	@param[in]	param	: not used.
+ */
+static void connect_race_signal(void * param)
+{
+	(void)param;
+
+	ddns_sync_event_wait(&connect_race_timer, 200);
+	connect_race_stop = 1;
+}
+
+int main(void)
+{
+	static const char * NAMES[] = { "dead.test", "refused.test", "void.test" };
+
+	struct ddns_sync_thread	thread;
+	struct in_addr			addr_list[4];
+	int						failed	= 0;
+	int						i		= 0;
+
+	ddns_socket_init();
+	ddns_sync_event_init(&connect_race_timer);
+
+	for ( i = 0; i < (int)_countof(NAMES); ++i )
+	{
+		if ( 2 != ddns_socket_resolve(NAMES[i], addr_list, _countof(addr_list), NULL, NULL) )
+		{
+			printf("%-12s: not resolved  FAIL\n", NAMES[i]);
+			++failed;
+		}
+	}
+
+	failed += connect_race_step("dead.test", 5000, CONNECT_RACE_SERVER, 250, 450);
+	failed += connect_race_step("dead.test", 5000, CONNECT_RACE_SERVER, 0, CONNECT_RACE_AT_ONCE);
+	failed += connect_race_step("refused.test", 5000, CONNECT_RACE_SERVER, 0, CONNECT_RACE_AT_ONCE);
+	failed += connect_race_step("void.test", 1000, NULL, 950, 1200);
+
+	connect_race_stop = 0;
+	ddns_sync_thread_create(&thread, &connect_race_signal, NULL);
+	failed += connect_race_step("void.test", 5000, NULL, 150, 400);
+	ddns_sync_thread_join(&thread);
+
+	ddns_sync_event_destroy(&connect_race_timer);
+	ddns_socket_uninit();
+
+	return (0 == failed) ? 0 : 1;
+}
@@ -0,0 +1,79 @@
+#!/bin/sh
+#
+#  This file is part of 'ddns'.
+#
+#  'ddns' is free software; you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published
+#  by the Free Software Foundation; either version 3 of the License,
+#  or (at your option) any later version.
+#
+#  'ddns' is distributed in the hope that it will be useful, but
+#  WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with 'ddns'; if not, write to the Free Software Foundation, Inc.,
+#  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+#
+
+#
+#  Check the connect race against a listener and blackholed addresses, as
+#  root:
+#
+#      make -C tools connect_race
+#      sudo tools/connect_race.sh
+#
+#  connect_race and dns_stub.py run in a network namespace, linked by a
+#  veth pair to another one:
+#
+#      10.9.0.1    ddns0, connect_race
+#      10.9.0.5    ddns1, a listener at port 8080
+#      10.9.0.6    ddns1, nothing listens
+#
+#  Nobody owns 10.9.0.2 and 10.9.0.3, so that connections to them hang
+#  until ARP gives up. The listener is out of the namespace of connect_race,
+#  or getaddrinfo would sort it before the other addresses as a local one.
+#  resolv.conf of the namespace names the stub only, see resolve_cache.sh.
+#
+
+NETNS=ddns_race
+SERVER_NETNS=ddns_race_server
+TOOLS="$(dirname "$0")"
+QUERIES=$(mktemp)
+
+run() {
+	ip netns exec $NETNS "$@"
+}
+
+ip netns add $NETNS || exit 1
+ip netns add $SERVER_NETNS || { ip netns del $NETNS; exit 1; }
+mkdir -p /etc/netns/$NETNS
+echo "nameserver 127.0.0.1" > /etc/netns/$NETNS/resolv.conf
+trap 'kill $STUB $LISTENER 2>/dev/null; ip netns del $NETNS; ip netns del $SERVER_NETNS; rm -rf /etc/netns/$NETNS "$QUERIES"' EXIT
+
+run ip link set lo up
+run ip link add ddns0 type veth peer name ddns1 netns $SERVER_NETNS
+run ip addr add 10.9.0.1/24 dev ddns0
+run ip link set ddns0 up
+ip netns exec $SERVER_NETNS ip addr add 10.9.0.5/24 dev ddns1
+ip netns exec $SERVER_NETNS ip addr add 10.9.0.6/24 dev ddns1
+ip netns exec $SERVER_NETNS ip link set ddns1 up
+
+# the kernel completes the connections in the backlog, nothing is accepted
+ip netns exec $SERVER_NETNS python3 -c '
+import socket, time
+sock = socket.socket()
+sock.bind(("10.9.0.5", 8080))
+sock.listen(64)
+time.sleep(3600)' &
+LISTENER=$!
+ip netns exec $NETNS "$TOOLS/dns_stub.py" 127.0.0.1 "$QUERIES" &
+STUB=$!
+sleep 1
+
+run "$TOOLS/connect_race"
+FAILED=$?
+
+[ 0 -eq $FAILED ] && echo OK || echo FAIL
+exit $FAILED
@@ -0,0 +1,198 @@
+/*
+ *	This file is part of 'ddns'.
+ *
+ *	'ddns' is free software; you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published
+ *	by the Free Software Foundation; either version 3 of the License,
+ *	or (at your option) any later version.
+ *
+ *	'ddns' is distributed in the hope that it will be useful, but
+ *	WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with 'ddns'; if not, write to the Free Software Foundation, Inc.,
+ *	51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*
+ *	Check that a request ends by its deadline against a server that answers
+ *	one byte per second:
+ *
+ *		./dribble_server.py 8090 &
+ *		./dribble_server.py 8453 cert.pem key.pem &
+ *		./deadline 8090 8453
+ *
+ *	Every step prints its result and the time it took, and fails unless it
+ *	failed within 0.3s after its budget:
+ *
+ *		http		a GET with the timeout of 3s of the request;
+ *		deadline	a GET with a deadline of 1.5s set by [http_set_deadline];
+ *		silent		a GET of /silent, which is never answered, in 2s;
+ *		dnspod		[dnspod_send_command] of an account with a timeout of 2s,
+ *					over TLS if the build supports it.
+ *
+ *	Waiting a fresh timeout for every byte, the page would take more than a
+ *	minute.
+ *
+ *	It includes "dnspod.c" to reach [dnspod_send_command].
+ */
+
+#include "dnspod.c"
+
+#define DEADLINE_LATE	300		/* ms a step may take after its budget */
+
+/**
+ *	Count the bytes of the response body.
+ *
+ *	@param[in]		data	: a block of the response body.
+ *	@param[in]		size	: size of [data] in bytes.
+ *	@param[in/out]	param	: the byte counter.
+ */
+static void deadline_count(const char * data, size_t size, void * param)
+{
+	(void)data;
+	*(size_t*)param += size;
+}
+
+/**
+ *	Print the result of a step.
+ *
+ *	@param[in]	name	: name of the step.
+ *	@param[in]	result	: what the step got.
+ *	@param[in]	success	: non-zero if the request succeeded.
+ *	@param[in]	elapsed	: ms the step took.
+ *	@param[in]	budget	: ms the step was given.
+ *
+ *	@return	Return 0 if the step failed in time, otherwise 1.
+ */
+static int deadline_report(
+	const char	*	name,
+	const char	*	result,
+	int				success,
+	unsigned long	elapsed,
+	unsigned long	budget
+	)
+{
+	int failed =	(0 != success)
+				||	(elapsed + DEADLINE_LATE < budget)
+				||	(elapsed > budget + DEADLINE_LATE);
+
+	printf(	"%-9s: %-28s %5lu ms of %5lu ms%s\n",
+			name, result, elapsed, budget, (0 != failed) ? "  FAIL" : "" );
+
+	return failed;
+}
+
+/**
+ *	GET a page of the server once.
+ *
+ *	@param[in]	name		: name of the step.
+ *	@param[in]	url			: the page.
+ *	@param[in]	timeout		: timeout of the request in seconds.
+ *	@param[in]	budget		: ms of a deadline set on the request, 0 for
+ *							  none.
+ *
+ *	@return	Return 0 if the step failed in time, otherwise 1.
+ */
+static int deadline_get(
+	const char	*	name,
+	const char	*	url,
+	int				timeout,
+	unsigned long	budget
+	)
+{
+	struct http_request	*	request		= NULL;
+	struct ddns_deadline	deadline;
+	unsigned long			start		= ddns_sync_clock();
+	size_t					received	= 0;
+	int						status		= 0;
+	char					result[64];
+
+	request = http_create_request(http_method_get, url, timeout);
+	if ( NULL == request )
+	{
+		return 1;
+	}
+	if ( 0 != budget )
+	{
+		ddns_deadline_init(&deadline, budget);
+		http_set_deadline(request, &deadline);
+	}
+	else
+	{
+		budget = (unsigned long)timeout * 1000;
+	}
+
+	if ( 0 == http_connect(request) )
+	{
+		status = http_send_request(request, NULL, 0);
+	}
+	if (	(0 != status)
+		&&	(0 != http_get_response_ex(request, &deadline_count, &received)) )
+	{
+		status = 0;
+	}
+	http_destroy_request(request);
+
+	c99_snprintf(result, _countof(result), "status %d, %lu body bytes",
+				 status, (unsigned long)received);
+
+	return deadline_report(name, result, 0 != status,
+						   ddns_sync_clock() - start, budget);
+}
+
+int main(int argc, char * argv[])
+{
+	struct ddns_context		context;
+	struct ddns_server		server;
+	struct json_value	*	json		= NULL;
+	ddns_error				error_code	= DDNS_ERROR_SUCCESS;
+	unsigned long			start		= 0;
+	unsigned short			port		= 0;
+	int						failed		= 0;
+	char					url[64];
+
+	if ( argc < 3 )
+	{
+		fprintf(stderr, "usage: %s <port> <tls port>\n", argv[0]);
+		return 1;
+	}
+	port = (unsigned short)atoi(argv[1]);
+
+	ddns_socket_init();
+	http_init();
+
+	c99_snprintf(url, _countof(url), "http://127.0.0.1:%u/", (unsigned int)port);
+	failed += deadline_get("http", url, 3, 0);
+	failed += deadline_get("deadline", url, 60, 1500);
+	c99_snprintf(url, _countof(url), "http://127.0.0.1:%u/silent", (unsigned int)port);
+	failed += deadline_get("silent", url, 2, 0);
+
+	/* the path of a command goes from here down to the SSL loops */
+	ddns_initcontext(&context);
+	context.protocol	= proto_dnspod;
+	context.timeout		= 2;
+	memset(&server, 0, sizeof(server));
+	c99_strncpy(server.domain, "127.0.0.1", _countof(server.domain));
+#if defined(HTTP_SUPPORT_SSL) && HTTP_SUPPORT_SSL
+	server.port			= (unsigned short)atoi(argv[2]);
+#else
+	server.port			= port;
+#endif
+	ddns_addserver(&context, &server);
+
+	start		= ddns_sync_clock();
+	error_code	= dnspod_send_command(&context, DNSPOD_DOMAIN_LIST, "format=json", &json);
+	failed += deadline_report(	"dnspod", ddns_err2str(error_code),
+								DDNS_ERROR_SUCCESS == error_code,
+								ddns_sync_clock() - start,
+								(unsigned long)context.timeout * 1000 );
+	json_destroy(json);
+
+	ddns_clearcontext(&context);
+	http_uninit();
+	ddns_socket_uninit();
+
+	return (0 == failed) ? 0 : 1;
+}
@@ -0,0 +1,88 @@
+#!/usr/bin/env python3
+#
+#  This file is part of 'ddns'.
+#
+#  'ddns' is free software; you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published
+#  by the Free Software Foundation; either version 3 of the License,
+#  or (at your option) any later version.
+#
+#  'ddns' is distributed in the hope that it will be useful, but
+#  WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with 'ddns'; if not, write to the Free Software Foundation, Inc.,
+#  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+#
+
+"""Stub DNS server of the .test names, for tools/resolve_cache and
+tools/connect_race.
+
+Usage: dns_stub.py <address> <log>
+
+It answers on UDP port 53 of <address>, and appends "<name> <qtype>" of
+every query to <log>. Names:
+
+    nx.*        NXDOMAIN after 0.3s
+    slow.*      10.0.0.7 after 3s
+    dead.*      10.9.0.2 and 10.9.0.5 after 0.3s
+    refused.*   10.9.0.6 and 10.9.0.5 after 0.3s
+    void.*      10.9.0.2 and 10.9.0.3 after 0.3s
+    *           10.0.0.7 after 0.3s
+
+Queries of other types than A are answered with no record.
+"""
+
+import socket
+import struct
+import sys
+import threading
+import time
+
+ADDRESSES = {
+    'dead': ['10.9.0.2', '10.9.0.5'],
+    'refused': ['10.9.0.6', '10.9.0.5'],
+    'void': ['10.9.0.2', '10.9.0.3'],
+}
+
+
+def answer(sock, data, peer, log):
+    labels = []
+    i = 12
+    while data[i]:
+        labels.append(data[i + 1:i + 1 + data[i]].decode('latin-1'))
+        i += 1 + data[i]
+    name = '.'.join(labels)
+    qtype = struct.unpack('>H', data[i + 1:i + 3])[0]
+    question = data[12:i + 5]
+    log.write('%s %d\n' % (name, qtype))
+
+    time.sleep(3 if name.startswith('slow.') else 0.3)
+
+    if name.startswith('nx.'):
+        reply = data[:2] + struct.pack('>HHHHH', 0x8183, 1, 0, 0, 0) + question
+    elif qtype != 1:
+        reply = data[:2] + struct.pack('>HHHHH', 0x8180, 1, 0, 0, 0) + question
+    else:
+        addresses = ADDRESSES.get(labels[0], ['10.0.0.7'])
+        reply = (data[:2]
+                 + struct.pack('>HHHHH', 0x8180, 1, len(addresses), 0, 0)
+                 + question)
+        for address in addresses:
+            reply += (b'\xc0\x0c' + struct.pack('>HHIH', 1, 1, 60, 4)
+                      + socket.inet_aton(address))
+    sock.sendto(reply, peer)
+
+
+if __name__ == '__main__':
+    if len(sys.argv) < 3:
+        sys.exit(__doc__)
+    log = open(sys.argv[2], 'a', buffering=1)
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.bind((sys.argv[1], 53))
+    while True:
+        data, peer = sock.recvfrom(512)
+        threading.Thread(target=answer, args=(sock, data, peer, log),
+                         daemon=True).start()
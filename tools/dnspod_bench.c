@@ -0,0 +1,144 @@
+/*
+ *	This file is part of 'ddns'.
+ *
+ *	'ddns' is free software; you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published
+ *	by the Free Software Foundation; either version 3 of the License,
+ *	or (at your option) any later version.
+ *
+ *	'ddns' is distributed in the hope that it will be useful, but
+ *	WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with 'ddns'; if not, write to the Free Software Foundation, Inc.,
+ *	51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*
+ *	Time a batch update of DNSPod records with a given parallel limit. The
+ *	records are loaded in advance, so only the updates reach the server:
+ *
+ *		./dnspod_server.py 8443 cert.pem key.pem 0.2 &
+ *		./dnspod_bench 8443 1
+ *		./dnspod_bench 8443 4
+ *		./dnspod_bench 8443 8
+ *
+ *	The record "bad" of the 8 default ones fails on the mock server, so every
+ *	run should report 7 updated records and its error.
+ *
+ *	It includes "dnspod.c" to reach [dnspod_interface_update_all].
+ */
+
+#include "dnspod.c"
+
+int main(int argc, char * argv[])
+{
+	struct ddns_context			context;
+	struct ddns_server			server;
+	struct ddns_server			host;
+	struct dnspod_context	*	dnspod		= NULL;
+	struct dnspod_domain	*	domain		= NULL;
+	struct dnspod_record	*	record		= NULL;
+	unsigned long				start		= 0;
+	unsigned int				update_cnt	= 0;
+	int							host_cnt	= 8;
+	int							i			= 0;
+	ddns_error					error_code	= DDNS_ERROR_SUCCESS;
+
+	if ( argc < 3 )
+	{
+		fprintf(stderr, "usage: %s <port> <parallel> [hosts]\n", argv[0]);
+		return 1;
+	}
+	if ( argc > 3 )
+	{
+		host_cnt = atoi(argv[3]);
+	}
+
+	ddns_initcontext(&context);
+	context.protocol		= proto_dnspod;
+	context.parallel		= atoi(argv[2]);
+	context.timeout			= 10;
+	context.interval		= 60;
+	c99_strncpy(context.username, "user", _countof(context.username));
+	c99_strncpy(context.password, "pass", _countof(context.password));
+
+	memset(&server, 0, sizeof(server));
+	c99_strncpy(server.domain, "127.0.0.1", _countof(server.domain));
+	server.port		= (unsigned short)atoi(argv[1]);
+	ddns_addserver(&context, &server);
+
+	/**
+	 *	Step 1: one domain of [host_cnt] A records, as if they were loaded.
+	 */
+	dnspod	= (struct dnspod_context*)calloc(1, sizeof(*dnspod));
+	domain	= (struct dnspod_domain*)calloc(1, sizeof(*domain));
+	if ( (NULL == dnspod) || (NULL == domain) )
+	{
+		return 1;
+	}
+	dnspod->api_version	= DNSPOD_API_VERSION_2_9;
+	dnspod->domain_list	= domain;
+	context.extra_data	= dnspod;
+	c99_strncpy(domain->domain, "example.com", _countof(domain->domain));
+	domain->domain_id	= 1;
+	domain->min_ttl		= 600;
+
+	for ( i = host_cnt - 1; i >= 0; --i )
+	{
+		record = (struct dnspod_record*)calloc(1, sizeof(*record));
+		if ( NULL == record )
+		{
+			return 1;
+		}
+		if ( 3 == i )
+		{
+			c99_strncpy(record->name, "bad", _countof(record->name));
+		}
+		else
+		{
+			c99_snprintf(record->name, _countof(record->name), "host%d", i);
+		}
+		record->host_id	= (unsigned long)i + 1;
+		record->type	= DNSPOD_RECORD_TYPE_A;
+		record->ttl		= 600;
+		record->enabled	= 1;
+		c99_strncpy(record->value, "192.0.2.1", _countof(record->value));
+		record->next	= domain->records;
+		domain->records	= record;
+	}
+	for ( record = domain->records; NULL != record; record = record->next )
+	{
+		memset(&host, 0, sizeof(host));
+		c99_snprintf(host.domain, _countof(host.domain),
+					 "%s.example.com", record->name);
+		ddns_adddomain(&context, &host);
+	}
+	dnspod_index_records(&domain->record_index, domain->records);
+	dnspod_index_domains(&dnspod->domain_index, dnspod->domain_list);
+
+	/**
+	 *	Step 2: update all of them to a new address.
+	 */
+	ddns_socket_init();
+	http_init();
+
+	start		= ddns_sync_clock();
+	error_code	= dnspod_interface_update_all(	&context,
+												dnspod->domain_list,
+												"192.0.2.2",
+												&update_cnt
+												);
+	printf("parallel=%d hosts=%d time=%.2fs updated=%u error=%s\n",
+			context.parallel, host_cnt,
+			(ddns_sync_clock() - start) / 1000.0,
+			update_cnt, ddns_err2str(error_code));
+
+	dnspod_interface_finalize(&context);
+	ddns_clearcontext(&context);
+	http_uninit();
+	ddns_socket_uninit();
+
+	return 0;
+}
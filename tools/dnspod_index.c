@@ -0,0 +1,203 @@
+/*
+ *	This file is part of 'ddns'.
+ *
+ *	'ddns' is free software; you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published
+ *	by the Free Software Foundation; either version 3 of the License,
+ *	or (at your option) any later version.
+ *
+ *	'ddns' is distributed in the hope that it will be useful, but
+ *	WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with 'ddns'; if not, write to the Free Software Foundation, Inc.,
+ *	51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*
+ *	Time the lookup of host names in an account of many domains and records,
+ *	with and without the domain and record indexes:
+ *
+ *		./dnspod_index
+ *		./dnspod_index 200 5000
+ *
+ *	The arguments are the count of domains (50 by default) and of records in
+ *	every domain (2000 by default). Half of the records are A records, the
+ *	others are CNAME or "any" records of the same names in another case.
+ *	Every host name is looked up once by [dnspod_find_domain] and
+ *	[dnspod_find_record], and both searches must find the same records.
+ *
+ *	It includes "dnspod.c" to reach [dnspod_index_domains] and
+ *	[dnspod_index_records].
+ */
+
+#include "dnspod.c"
+
+#define DNSPOD_INDEX_NAME_LEN	128		/* as [domain] of [ddns_server] */
+
+int main(int argc, char * argv[])
+{
+	struct ddns_context					context;
+	struct dnspod_context			*	dnspod		= NULL;
+	struct dnspod_domain			*	domain		= NULL;
+	struct dnspod_record			*	record		= NULL;
+	const struct dnspod_domain		*	found		= NULL;
+	const struct dnspod_record		*	host		= NULL;
+	const struct dnspod_record		**	results		= NULL;
+	char							(*	names)[DNSPOD_INDEX_NAME_LEN];
+	unsigned long						start		= 0;
+	unsigned long						index_time	= 0;
+	unsigned long						search_time	= 0;
+	int									domain_cnt	= 50;
+	int									record_cnt	= 2000;
+	int									host_cnt	= 0;
+	int									mismatch	= 0;
+	int									missing		= 0;
+	int									d			= 0;
+	int									r			= 0;
+	int									i			= 0;
+	int									indexed		= 0;
+
+	if ( argc > 1 )
+	{
+		domain_cnt = atoi(argv[1]);
+	}
+	if ( argc > 2 )
+	{
+		record_cnt = atoi(argv[2]);
+	}
+	if ( (domain_cnt <= 0) || (record_cnt < 2) )
+	{
+		fprintf(stderr, "usage: %s [domains] [records]\n", argv[0]);
+		return 1;
+	}
+
+	ddns_initcontext(&context);
+	context.protocol = proto_dnspod;
+
+	/**
+	 *	Step 1: [domain_cnt] domains of [record_cnt] records, as if they were
+	 *			loaded.
+	 */
+	dnspod		= (struct dnspod_context*)calloc(1, sizeof(*dnspod));
+	host_cnt	= domain_cnt * record_cnt / 2;
+	names		= (char(*)[DNSPOD_INDEX_NAME_LEN])malloc(host_cnt * sizeof(names[0]));
+	results		= (const struct dnspod_record**)malloc(host_cnt * sizeof(results[0]));
+	if ( (NULL == dnspod) || (NULL == names) || (NULL == results) )
+	{
+		return 1;
+	}
+	context.extra_data	= dnspod;
+	dnspod->api_version	= DNSPOD_API_VERSION_2_9;
+
+	for ( d = domain_cnt - 1; d >= 0; --d )
+	{
+		domain = (struct dnspod_domain*)calloc(1, sizeof(*domain));
+		if ( NULL == domain )
+		{
+			return 1;
+		}
+		c99_snprintf(domain->domain, _countof(domain->domain), "Example%d.com", d);
+		domain->domain_id	= (unsigned long)d + 1;
+		domain->min_ttl		= 600;
+		domain->next		= dnspod->domain_list;
+		dnspod->domain_list	= domain;
+
+		for ( r = record_cnt - 1; r >= 0; --r )
+		{
+			record = (struct dnspod_record*)calloc(1, sizeof(*record));
+			if ( NULL == record )
+			{
+				return 1;
+			}
+			c99_snprintf(	record->name, _countof(record->name),
+							(0 != r % 2) ? "HOST%d" : "host%d", r / 2 );
+			if ( 0 != r % 2 )
+			{
+				record->type = DNSPOD_RECORD_TYPE_A;
+			}
+			else
+			{
+				record->type = (0 != r % 7) ? DNSPOD_RECORD_TYPE_CNAME
+											: DNSPOD_RECORD_TYPE_ALL;
+			}
+			record->host_id	= (unsigned long)r + 1;
+			record->ttl		= 600;
+			record->enabled	= 1;
+			c99_strncpy(record->value, "192.0.2.1", _countof(record->value));
+			record->next	= domain->records;
+			domain->records	= record;
+		}
+	}
+
+	/* every host once, in a scattered order */
+	for ( i = 0; i < host_cnt; ++i )
+	{
+		c99_snprintf(	names[i], _countof(names[i]), "host%d.example%d.COM",
+						(int)(((unsigned long)i * 7919) % (record_cnt / 2)),
+						i % domain_cnt );
+	}
+
+	/**
+	 *	Step 2: look up every host by the lists, then by the indexes.
+	 */
+	for ( indexed = 0; indexed < 2; ++indexed )
+	{
+		if ( 0 != indexed )
+		{
+			start = ddns_sync_clock();
+			for ( domain = dnspod->domain_list; NULL != domain; domain = domain->next )
+			{
+				dnspod_index_records(&domain->record_index, domain->records);
+			}
+			dnspod_index_domains(&dnspod->domain_index, dnspod->domain_list);
+			index_time = ddns_sync_clock() - start;
+		}
+
+		start = ddns_sync_clock();
+		for ( i = 0; i < host_cnt; ++i )
+		{
+			host	= NULL;
+			found	= dnspod_find_domain(	dnspod->domain_list,
+											(0 != indexed) ? &dnspod->domain_index : NULL,
+											names[i] );
+			if ( NULL != found )
+			{
+				host = dnspod_find_record(	found->records,
+											(0 != indexed) ? &found->record_index : NULL,
+											DNSPOD_RECORD_TYPE_A,
+											names[i] );
+			}
+
+			if ( 0 == indexed )
+			{
+				results[i] = host;
+				missing += (NULL == host) ? 1 : 0;
+			}
+			else if ( results[i] != host )
+			{
+				++mismatch;
+			}
+		}
+		search_time = ddns_sync_clock() - start;
+
+		printf("%-8s: %7lu ms for %d hosts",
+				(0 != indexed) ? "indexed" : "linear", search_time, host_cnt);
+		if ( 0 != indexed )
+		{
+			printf(", %lu ms to build the indexes", index_time);
+		}
+		printf("\n");
+	}
+
+	printf("domains=%d records=%d missing=%d mismatch=%d\n",
+			domain_cnt, record_cnt, missing, mismatch);
+
+	free(names);
+	free((void*)results);
+	dnspod_interface_finalize(&context);
+	ddns_clearcontext(&context);
+
+	return ((0 == mismatch) && (0 == missing)) ? 0 : 1;
+}
@@ -0,0 +1,87 @@
+#!/usr/bin/env python3
+#
+#  This file is part of 'ddns'.
+#
+#  'ddns' is free software; you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published
+#  by the Free Software Foundation; either version 3 of the License,
+#  or (at your option) any later version.
+#
+#  'ddns' is distributed in the hope that it will be useful, but
+#  WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with 'ddns'; if not, write to the Free Software Foundation, Inc.,
+#  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+#
+
+"""Mock DNSPod API server over TLS, for tools/dnspod_bench.
+
+Usage: dnspod_server.py <port> <cert.pem> <key.pem> [delay]
+
+Every POST is answered as a successful record update after [delay] seconds
+(0.2 by default), except records whose sub_domain starts with "bad", which
+fail with status code -1. The highest number of requests served at the
+same time is logged to stderr.
+"""
+
+import http.server
+import socketserver
+import ssl
+import sys
+import threading
+import time
+import urllib.parse
+
+lock = threading.Lock()
+active = 0
+peak = 0
+
+
+class Handler(http.server.BaseHTTPRequestHandler):
+    protocol_version = 'HTTP/1.1'
+
+    def log_message(self, *args):
+        pass
+
+    def do_POST(self):
+        global active, peak
+        length = int(self.headers.get('Content-Length', '0'))
+        form = urllib.parse.parse_qs(self.rfile.read(length).decode())
+        with lock:
+            active += 1
+            peak = max(peak, active)
+        time.sleep(DELAY)
+        with lock:
+            active -= 1
+        name = form.get('sub_domain', [''])[0]
+        code = '-1' if name.startswith('bad') else '1'
+        body = ('{"status":{"code":"%s","message":"mock"},'
+                '"record":{"id":"1","name":"%s"}}' % (code, name)).encode()
+        self.send_response(200)
+        self.send_header('Content-Type', 'application/json')
+        self.send_header('Content-Length', str(len(body)))
+        self.end_headers()
+        self.wfile.write(body)
+        sys.stderr.write('%s %s: code %s, peak %d\n'
+                         % (self.path, name, code, peak))
+        sys.stderr.flush()
+
+
+class Server(socketserver.ThreadingMixIn, http.server.HTTPServer):
+    allow_reuse_address = True
+    daemon_threads = True
+    request_queue_size = 64
+
+
+if __name__ == '__main__':
+    if len(sys.argv) < 4:
+        sys.exit(__doc__)
+    DELAY = float(sys.argv[4]) if len(sys.argv) > 4 else 0.2
+    server = Server(('127.0.0.1', int(sys.argv[1])), Handler)
+    tls = ssl.SSLContext(ssl.PROTOCOL_TLS_SERVER)
+    tls.load_cert_chain(sys.argv[2], sys.argv[3])
+    server.socket = tls.wrap_socket(server.socket, server_side=True)
+    server.serve_forever()
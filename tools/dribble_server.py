@@ -0,0 +1,75 @@
+#!/usr/bin/env python3
+#
+#  This file is part of 'ddns'.
+#
+#  'ddns' is free software; you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published
+#  by the Free Software Foundation; either version 3 of the License,
+#  or (at your option) any later version.
+#
+#  'ddns' is distributed in the hope that it will be useful, but
+#  WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with 'ddns'; if not, write to the Free Software Foundation, Inc.,
+#  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+#
+
+"""Slow-loris HTTP server, for tools/deadline.
+
+Usage: dribble_server.py <port> [cert.pem key.pem]
+
+It answers every request with a JSON page of DNSPod, one byte per second,
+so that a client waiting for a byte at a time never times out. With a
+certificate and a key it's served over TLS, one record per byte. The
+resource /silent is never answered at all.
+"""
+
+import socketserver
+import ssl
+import sys
+import time
+
+BODY = b'{"status":{"code":"1","message":"Action completed successful"}}'
+
+
+class Handler(socketserver.StreamRequestHandler):
+
+    def handle(self):
+        line = self.rfile.readline()
+        if not line.strip():
+            return
+        path = line.decode('latin-1').split()[1]
+        while self.rfile.readline() not in (b'\r\n', b'\n', b''):
+            pass
+
+        if path == '/silent':
+            time.sleep(60)
+            return
+        answer = (b'HTTP/1.1 200 OK\r\nContent-Type: text/html\r\n'
+                  b'Content-Length: %d\r\n\r\n' % len(BODY)) + BODY
+        try:
+            for i in range(len(answer)):
+                self.wfile.write(answer[i:i + 1])
+                self.wfile.flush()
+                time.sleep(1)
+        except OSError:
+            pass
+
+
+class Server(socketserver.ThreadingTCPServer):
+    allow_reuse_address = True
+    daemon_threads = True
+
+
+if __name__ == '__main__':
+    if len(sys.argv) < 2:
+        sys.exit(__doc__)
+    server = Server(('127.0.0.1', int(sys.argv[1])), Handler)
+    if len(sys.argv) > 3:
+        tls = ssl.SSLContext(ssl.PROTOCOL_TLS_SERVER)
+        tls.load_cert_chain(sys.argv[2], sys.argv[3])
+        server.socket = tls.wrap_socket(server.socket, server_side=True)
+    server.serve_forever()
@@ -0,0 +1,138 @@
+/*
+ *	This file is part of 'ddns'.
+ *
+ *	'ddns' is free software; you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published
+ *	by the Free Software Foundation; either version 3 of the License,
+ *	or (at your option) any later version.
+ *
+ *	'ddns' is distributed in the hope that it will be useful, but
+ *	WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with 'ddns'; if not, write to the Free Software Foundation, Inc.,
+ *	51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*
+ *	Time a DynDNS update of many host names with a given parallel limit:
+ *
+ *		./dyndns_server.py 8443 cert.pem key.pem good 0.05 &
+ *		./dyndns_bench 8443 1 500
+ *		./dyndns_bench 8443 4 500
+ *
+ *	The server log shows how the host names were split into requests, and
+ *	how many connections carried them. Options after the host count:
+ *
+ *		verbose		print the result of every host name
+ *		long		use host names of about 125 characters, which must be
+ *					split by url length before the host limit of a chunk
+ *		utf8		give the 2nd host name non-ASCII characters, a space and
+ *					an '&', to check they're escaped in the url
+ *
+ *	Run the server in "badauth" mode to check that the chunks not sent yet
+ *	are stopped, or in "short" mode to check that a host name without a
+ *	return code fails.
+ *
+ *	It includes "dyndns.c" to reach [dyndns_interface_do_update], the address
+ *	detection of [dyndns_interface_initialize] needs the real service.
+ */
+
+#include "dyndns.c"
+
+int main(int argc, char * argv[])
+{
+	struct ddns_context			context;
+	struct ddns_server			server;
+	struct ddns_server			host;
+	struct dyndns_context	*	dyndns		= NULL;
+	unsigned long				start		= 0;
+	int							host_cnt	= 0;
+	int							long_names	= 0;
+	int							utf8_name	= 0;
+	int							i			= 0;
+	ddns_error					error_code	= DDNS_ERROR_SUCCESS;
+
+	if ( argc < 4 )
+	{
+		fprintf(stderr,	"usage: %s <port> <parallel> <hosts> "
+						"[verbose] [long] [utf8]\n", argv[0]);
+		return 1;
+	}
+	host_cnt = atoi(argv[3]);
+
+	ddns_initcontext(&context);
+	context.protocol		= proto_dyndns;
+	context.parallel		= atoi(argv[2]);
+	context.timeout			= 10;
+	context.interval		= 60;
+	c99_strncpy(context.username, "user", _countof(context.username));
+	c99_strncpy(context.password, "pass", _countof(context.password));
+	for ( i = 4; i < argc; ++i )
+	{
+		if ( 0 == strcmp("verbose", argv[i]) )
+		{
+			context.verbose_mode = verbose_verbose;
+		}
+		else if ( 0 == strcmp("long", argv[i]) )
+		{
+			long_names = 1;
+		}
+		else if ( 0 == strcmp("utf8", argv[i]) )
+		{
+			utf8_name = 1;
+		}
+	}
+
+	memset(&server, 0, sizeof(server));
+	c99_strncpy(server.domain, "127.0.0.1", _countof(server.domain));
+	server.port = (unsigned short)atoi(argv[1]);
+	ddns_addserver(&context, &server);
+
+	if ( 0 == ddns_create_extra_param(&context, sizeof(*dyndns)) )
+	{
+		return 1;
+	}
+	dyndns = (struct dyndns_context*)context.extra_data;
+	c99_strncpy(dyndns->ip_address, "192.0.2.1", _countof(dyndns->ip_address));
+
+	for ( i = 0; i < host_cnt; ++i )
+	{
+		memset(&host, 0, sizeof(host));
+		if ( (0 != utf8_name) && (1 == i) )
+		{
+			c99_strncpy(host.domain, "h\xc3\xa9 a&b.example.com",
+						_countof(host.domain));
+		}
+		else if ( 0 != long_names )
+		{
+			memset(host.domain, 'a', 110);
+			c99_snprintf(&(host.domain[110]), _countof(host.domain) - 110,
+						 "%d.example.com", i);
+		}
+		else
+		{
+			c99_snprintf(host.domain, _countof(host.domain),
+						 "host%d.example.com", i);
+		}
+		ddns_adddomain(&context, &host);
+	}
+
+	ddns_socket_init();
+	http_init();
+
+	start		= ddns_sync_clock();
+	error_code	= dyndns_interface_do_update(&context);
+	printf("parallel=%d hosts=%d time=%.2fs error=%s\n",
+			context.parallel, host_cnt,
+			(ddns_sync_clock() - start) / 1000.0,
+			ddns_err2str(error_code));
+
+	dyndns_interface_finalize(&context);
+	ddns_clearcontext(&context);
+	http_uninit();
+	ddns_socket_uninit();
+
+	return 0;
+}
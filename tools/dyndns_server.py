@@ -0,0 +1,112 @@
+#!/usr/bin/env python3
+#
+#  This file is part of 'ddns'.
+#
+#  'ddns' is free software; you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published
+#  by the Free Software Foundation; either version 3 of the License,
+#  or (at your option) any later version.
+#
+#  'ddns' is distributed in the hope that it will be useful, but
+#  WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with 'ddns'; if not, write to the Free Software Foundation, Inc.,
+#  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+#
+
+"""Mock DynDNS /nic/update server over TLS, for tools/dyndns_bench.
+
+Usage: dyndns_server.py <port> <cert.pem> <key.pem> [mode] [delay]
+
+Every request is answered after [delay] seconds (0.05 by default), with
+one return code per host name of the "hostname" parameter:
+
+    good        "good 192.0.2.2" for every host name (default)
+    badauth     "badauth" from the 3rd request on
+    short       like good, but the line of the last host name is missing
+
+Every request is logged to stderr with its connection, the length of its
+path and the decoded host names, followed by the number of requests and
+connections so far and the highest number of requests served at once.
+"""
+
+import http.server
+import socketserver
+import ssl
+import sys
+import threading
+import time
+import urllib.parse
+
+lock = threading.Lock()
+requests = 0
+connections = 0
+active = 0
+peak = 0
+
+
+class Handler(http.server.BaseHTTPRequestHandler):
+    protocol_version = 'HTTP/1.1'
+
+    def log_message(self, *args):
+        pass
+
+    def setup(self):
+        global connections
+        super().setup()
+        with lock:
+            connections += 1
+            self.connection_id = connections
+
+    def do_GET(self):
+        global requests, active, peak
+        query = urllib.parse.urlparse(self.path).query
+        hosts = urllib.parse.parse_qs(query).get('hostname', [''])[0]
+        hosts = hosts.split(',')
+        with lock:
+            requests += 1
+            served = requests
+            active += 1
+            peak = max(peak, active)
+        time.sleep(DELAY)
+        with lock:
+            active -= 1
+
+        if MODE == 'badauth' and served >= 3:
+            body = b'badauth\n'
+        else:
+            answered = hosts[:-1] if MODE == 'short' else hosts
+            body = b''.join(b'good 192.0.2.2\n' for host in answered)
+        self.send_response(200)
+        self.send_header('Content-Type', 'text/plain')
+        self.send_header('Content-Length', str(len(body)))
+        self.end_headers()
+        self.wfile.write(body)
+
+        sys.stderr.write('connection %d: path %d chars, %d host(s) %s\n'
+                         % (self.connection_id, len(self.path),
+                            len(hosts), ','.join(hosts)))
+        sys.stderr.write('requests=%d connections=%d peak=%d\n'
+                         % (requests, connections, peak))
+        sys.stderr.flush()
+
+
+class Server(socketserver.ThreadingMixIn, http.server.HTTPServer):
+    allow_reuse_address = True
+    daemon_threads = True
+    request_queue_size = 64
+
+
+if __name__ == '__main__':
+    if len(sys.argv) < 4:
+        sys.exit(__doc__)
+    MODE = sys.argv[4] if len(sys.argv) > 4 else 'good'
+    DELAY = float(sys.argv[5]) if len(sys.argv) > 5 else 0.05
+    server = Server(('127.0.0.1', int(sys.argv[1])), Handler)
+    tls = ssl.SSLContext(ssl.PROTOCOL_TLS_SERVER)
+    tls.load_cert_chain(sys.argv[2], sys.argv[3])
+    server.socket = tls.wrap_socket(server.socket, server_side=True)
+    server.serve_forever()
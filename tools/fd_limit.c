@@ -0,0 +1,186 @@
+/*
+ *	This file is part of 'ddns'.
+ *
+ *	'ddns' is free software; you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published
+ *	by the Free Software Foundation; either version 3 of the License,
+ *	or (at your option) any later version.
+ *
+ *	'ddns' is distributed in the hope that it will be useful, but
+ *	WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with 'ddns'; if not, write to the Free Software Foundation, Inc.,
+ *	51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*
+ *	Wait on descriptors beyond FD_SETSIZE. It opens 2000 descriptors first,
+ *	so the event pipe and the sockets created afterwards are numbered above
+ *	1024, then waits on an event and sends a few requests:
+ *
+ *		./keepalive_server.py 8080 &
+ *		./fd_limit http://127.0.0.1:8080/length http://127.0.0.1:8080/chunked
+ *
+ *	Every line should pass. Built without <poll.h> (HAVE_POLL_H undefined in
+ *	config.h), the event is still set in time, but the requests fail since a
+ *	socket out of the range of [fd_set] can't be selected.
+ */
+
+#include <stdio.h>			/* printf	*/
+#include <fcntl.h>			/* open		*/
+#include <sys/resource.h>	/* setrlimit	*/
+#include "ddns_sync.h"		/* ddns_sync_event_init, ... */
+#include "ddns_socket.h"	/* ddns_socket_init, ... */
+#include "http.h"			/* http_init, ... */
+
+#define FD_LIMIT_OPEN	2000	/* descriptors opened in advance */
+
+/**
+ *	Count the bytes of the response body.
+ *
+ *	@param[in]		data	: a block of the response body.
+ *	@param[in]		size	: size of [data] in bytes.
+ *	@param[in/out]	param	: the byte counter.
+ */
+static void fd_limit_count(const char * data, size_t size, void * param)
+{
+	(void)data;
+	*(size_t*)param += size;
+}
+
+/**
+ *	Print the result of a check.
+ *
+ *	@param[in]	name	: what was checked.
+ *	@param[in]	passed	: non-zero if it passed.
+ *	@param[in]	start	: [ddns_sync_clock] when the check started.
+ *
+ *	@return	1 if the check failed, otherwise 0.
+ */
+static int fd_limit_report(const char * name, int passed, unsigned long start)
+{
+	printf("%-40s: %s (%lums)\n",
+			name, (0 != passed) ? "pass" : "FAIL", ddns_sync_clock() - start);
+	return (0 != passed) ? 0 : 1;
+}
+
+int main(int argc, char * argv[])
+{
+	struct rlimit				limit;
+	struct ddns_sync_event		event;
+	struct ddns_deadline		deadline;
+	struct http_request		*	request		= NULL;
+	ddns_socket					socket		= DDNS_INVALID_SOCKET;
+	unsigned long				start		= 0;
+	size_t						received	= 0;
+	int							status		= 0;
+	int							failed		= 0;
+	int							fd			= -1;
+	int							i			= 0;
+
+	if ( argc < 2 )
+	{
+		fprintf(stderr, "usage: %s <url>...\n", argv[0]);
+		return 1;
+	}
+
+	/**
+	 *	Step 1: push the descriptors created later beyond FD_SETSIZE.
+	 */
+	limit.rlim_cur = FD_LIMIT_OPEN * 2;
+	limit.rlim_max = FD_LIMIT_OPEN * 2;
+	if ( 0 != setrlimit(RLIMIT_NOFILE, &limit) )
+	{
+		fprintf(stderr, "can't raise the limit of open files.\n");
+		return 1;
+	}
+	for ( i = 0; i < FD_LIMIT_OPEN; ++i )
+	{
+		fd = open("/dev/null", O_RDONLY);
+		if ( fd < 0 )
+		{
+			fprintf(stderr, "can't open descriptor %d.\n", i);
+			return 1;
+		}
+	}
+	printf("last descriptor %d, FD_SETSIZE %d\n", fd, FD_SETSIZE);
+
+	ddns_socket_init();
+	http_init();
+
+	/**
+	 *	Step 2: an event times out when it's not set, and wakes up at once
+	 *			when it is.
+	 */
+	if ( 0 != ddns_sync_event_init(&event) )
+	{
+		fprintf(stderr, "can't create the event.\n");
+		return 1;
+	}
+	printf("event descriptor %d\n", ddns_sync_event_fd(&event));
+
+	start = ddns_sync_clock();
+	failed += fd_limit_report("event not set",
+							  (0 == ddns_sync_event_wait(&event, 300))
+							  && (ddns_sync_clock() - start >= 300),
+							  start);
+
+	start = ddns_sync_clock();
+	ddns_sync_event_set(&event);
+	failed += fd_limit_report("event set",
+							  (0 != ddns_sync_event_wait(&event, 3000))
+							  && (ddns_sync_clock() - start < 100),
+							  start);
+	ddns_sync_event_destroy(&event);
+
+	/**
+	 *	Step 3: a refused connection fails at once, not at the deadline.
+	 */
+	start = ddns_sync_clock();
+	ddns_deadline_init(&deadline, 3000);
+	socket = ddns_socket_create_tcp("127.0.0.1", 1, &deadline, NULL);
+	failed += fd_limit_report("connection refused",
+							  (DDNS_INVALID_SOCKET == socket)
+							  && (ddns_sync_clock() - start < 1000),
+							  start);
+	if ( DDNS_INVALID_SOCKET != socket )
+	{
+		ddns_socket_close(socket);
+	}
+
+	/**
+	 *	Step 4: every request is sent and answered twice, the second time on
+	 *			the pooled connection.
+	 */
+	for ( i = 1; i < argc * 2 - 1; ++i )
+	{
+		start		= ddns_sync_clock();
+		status		= 0;
+		received	= 0;
+		request		= http_create_request(http_method_get, argv[(i + 1) / 2], 5);
+		if ( NULL != request )
+		{
+			http_set_option(request, HTTP_OPTION_KEEPALIVE, 1);
+			if ( 0 == http_connect(request) )
+			{
+				status = http_send_request(request, NULL, 0);
+			}
+			if (	(0 != status)
+				&&	(0 == http_get_response_ex(request, &fd_limit_count, &received)) )
+			{
+				status = 0;
+			}
+			http_destroy_request(request);
+		}
+		failed += fd_limit_report(argv[(i + 1) / 2],
+								  (200 == status) && (received > 0),
+								  start);
+	}
+
+	http_uninit();
+	ddns_socket_uninit();
+
+	return (0 == failed) ? 0 : 1;
+}
@@ -0,0 +1,474 @@
+/*
+ *	This file is part of 'ddns'.
+ *
+ *	'ddns' is free software; you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published
+ *	by the Free Software Foundation; either version 3 of the License,
+ *	or (at your option) any later version.
+ *
+ *	'ddns' is distributed in the hope that it will be useful, but
+ *	WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with 'ddns'; if not, write to the Free Software Foundation, Inc.,
+ *	51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*
+ *	Scan pages for the signatures of the IP address servers, and check
+ *	[ddns_matcher_scan] against a brute-force search:
+ *
+ *		./getip_scan
+ *		./getip_scan baidu.html ip138.html
+ *		curl -s 'http://www.baidu.com/s?wd=ip' > baidu.html
+ *
+ *	Every page, recorded ones given as arguments or 100 KB pages built with
+ *	the answer near the end, is scanned 100 times in blocks of 4 KB by the
+ *	matcher of [dnspod_getip_table], by one [strstr] pass per signature, and
+ *	scraped by the rules of its server. Then random patterns are searched in
+ *	random text, split into random blocks, and every match (pattern and
+ *	offset, the longest first) must be the one found by brute force. The
+ *	optional "-n <rounds>" before the pages sets the rounds of this check
+ *	(10000 by default).
+ *
+ *	It includes "dnspod.c" to reach [dnspod_getip_table] and the scraping
+ *	functions.
+ */
+
+#include "dnspod.c"
+
+#define GETIP_SCAN_PAGE_SIZE	(100 * 1024)
+#define GETIP_SCAN_BLOCK		4096	/* size of a block of the page */
+#define GETIP_SCAN_ROUNDS		100		/* scans of every page */
+#define GETIP_SCAN_MAX_MATCH	4096	/* matches kept by the random check */
+
+/* matches found in a block, or in the whole text */
+struct getip_scan_matches
+{
+	size_t			count;
+	size_t			base;		/* offset of the block in the text */
+	unsigned int	pattern[GETIP_SCAN_MAX_MATCH];
+	size_t			offset[GETIP_SCAN_MAX_MATCH];
+};
+
+/**
+ *	Callback of [ddns_matcher_scan], counts the matches.
+ *
+ *	@param[in]		pattern	: index of the pattern found.
+ *	@param[in]		offset	: offset following the pattern in the block.
+ *	@param[in/out]	param	: the counter.
+ *
+ *	@return	always 0 to continue.
+ */
+static int getip_scan_count(unsigned int pattern, size_t offset, void * param)
+{
+	(void)pattern;
+	(void)offset;
+	++*(unsigned long*)param;
+	return 0;
+}
+
+/**
+ *	Callback of [ddns_matcher_scan], keeps the matches.
+ *
+ *	@param[in]		pattern	: index of the pattern found.
+ *	@param[in]		offset	: offset following the pattern in the block.
+ *	@param[in/out]	param	: the [getip_scan_matches].
+ *
+ *	@return	always 0 to continue.
+ */
+static int getip_scan_keep(unsigned int pattern, size_t offset, void * param)
+{
+	struct getip_scan_matches * matches = (struct getip_scan_matches*)param;
+
+	if ( matches->count < GETIP_SCAN_MAX_MATCH )
+	{
+		matches->pattern[matches->count]	= pattern;
+		matches->offset[matches->count]		= matches->base + offset;
+	}
+	++matches->count;
+
+	return 0;
+}
+
+/**
+ *	Build a page of about 100 KB, the answer of [server] near the end.
+ *
+ *	@param[in]	server	: "baidu" or "ip138".
+ *	@param[out]	size	: length of the page.
+ *
+ *	@return	the page, free it by [free].
+ */
+static char * getip_scan_build(const char * server, size_t * size)
+{
+	static const char FILLER[] =
+		"<div class=\"result c-container\" id=\"%d\"><h3 class=\"t\"><a href=\""
+		"http://www.example.com/link?url=%d&amp;wd=ip\" target=\"_blank\">"
+		"IP [lookup] result %d</a></h3><div class=\"c-abstract\">query: ip, "
+		"key: %d, location.href may be &quot;/%d&quot;</div></div>\n";
+
+	char	*	page	= (char*)malloc(GETIP_SCAN_PAGE_SIZE + 1024);
+	size_t		length	= 0;
+	int			i		= 0;
+
+	if ( NULL == page )
+	{
+		return NULL;
+	}
+
+	length = c99_snprintf(page, 1024, "<!DOCTYPE html><html><head><title>ip</title></head><body>\n");
+	for ( i = 0; length < GETIP_SCAN_PAGE_SIZE - 4096; ++i )
+	{
+		length += c99_snprintf(&(page[length]), 1024, FILLER, i, i, i, i, i);
+	}
+
+	if ( 0 == strcmp("baidu", server) )
+	{
+		length += c99_snprintf(	&(page[length]), 1024,
+								"<script>bds.comm={sid:'1',query:'ip',key:'198.51.100.7',"
+								"qid:'0'};</script>\n" );
+	}
+	else
+	{
+		length += c99_snprintf(	&(page[length]), 1024,
+								"<center>Your IP: [198.51.100.7] from: Example</center>\n" );
+	}
+	while ( length < GETIP_SCAN_PAGE_SIZE )
+	{
+		length += c99_snprintf(&(page[length]), 1024, "<!-- padding -->\n");
+	}
+	length += c99_snprintf(&(page[length]), 1024, "</body></html>\n");
+
+	*size = length;
+	return page;
+}
+
+/**
+ *	Read a recorded page.
+ *
+ *	@param[in]	path	: path of the page.
+ *	@param[out]	size	: length of the page.
+ *
+ *	@return	the page ended by '\0', free it by [free]. NULL if it can't be
+ *			read.
+ */
+static char * getip_scan_load(const char * path, size_t * size)
+{
+	FILE	*	file	= fopen(path, "rb");
+	char	*	page	= NULL;
+	long		length	= 0;
+
+	if ( NULL == file )
+	{
+		return NULL;
+	}
+
+	if (	(0 == fseek(file, 0, SEEK_END))
+		&&	((length = ftell(file)) >= 0)
+		&&	(0 == fseek(file, 0, SEEK_SET))
+		&&	(NULL != (page = (char*)malloc(length + 1))) )
+	{
+		*size = fread(page, 1, length, file);
+		page[*size] = '\0';
+	}
+	fclose(file);
+
+	return page;
+}
+
+/**
+ *	Time the scans of a page, and scrape it.
+ *
+ *	@param[in]	matcher	: signatures of all servers.
+ *	@param[in]	name	: name of the page.
+ *	@param[in]	page	: the page ended by '\0'.
+ *	@param[in]	size	: length of the page.
+ *
+ *	@return	1 if the matcher and [strstr] disagree, otherwise 0.
+ */
+static int getip_scan_page(
+	const struct dnspod_getip_matcher	*	matcher,
+	const char							*	name,
+	const char							*	page,
+	size_t									size
+	)
+{
+	static const struct
+	{
+		const char						*	name;
+		const struct dnspod_getip_rule	*	rules;
+	} SERVERS[] =
+	{
+		{ "Baidu",	dnspod_getip_rules_baidu	},
+		{ "IP138",	dnspod_getip_rules_ip138	},
+	};
+
+	struct dnspod_getip_stream	stream;
+	const char				*	found		= NULL;
+	unsigned long				matches		= 0;
+	unsigned long				occurrences	= 0;
+	unsigned long				start		= 0;
+	unsigned long				scan_time	= 0;
+	unsigned long				find_time	= 0;
+	unsigned int				state		= 0;
+	unsigned int				p			= 0;
+	size_t						offset		= 0;
+	size_t						block		= 0;
+	int							round		= 0;
+	int							s			= 0;
+
+	/**
+	 *	Step 1: all signatures in one pass, then one pass per signature.
+	 */
+	start = ddns_sync_clock();
+	for ( round = 0; round < GETIP_SCAN_ROUNDS; ++round )
+	{
+		matches	= 0;
+		state	= 0;
+		for ( offset = 0; offset < size; offset += block )
+		{
+			block = (size - offset < GETIP_SCAN_BLOCK) ? size - offset : GETIP_SCAN_BLOCK;
+			ddns_matcher_scan(	&(matcher->matcher), &state, &(page[offset]),
+								block, &getip_scan_count, &matches );
+		}
+	}
+	scan_time = ddns_sync_clock() - start;
+
+	start = ddns_sync_clock();
+	for ( round = 0; round < GETIP_SCAN_ROUNDS; ++round )
+	{
+		occurrences = 0;
+		for ( p = 0; p < DDNS_MATCHER_MAX_PATTERN; ++p )
+		{
+			if ( (NULL == matcher->rules[p]) || ('\0' == matcher->rules[p]->signature[0]) )
+			{
+				continue;
+			}
+			for (	found = strstr(page, matcher->rules[p]->signature);
+					NULL != found;
+					found = strstr(found + 1, matcher->rules[p]->signature) )
+			{
+				++occurrences;
+			}
+		}
+	}
+	find_time = ddns_sync_clock() - start;
+
+	printf(	"%-16s: %7lu bytes, %5lu matches, matcher %6.1f MB/s, strstr %6.1f MB/s\n",
+			name, (unsigned long)size, matches,
+			size * (double)GETIP_SCAN_ROUNDS / 1048576.0 / ((0 != scan_time) ? scan_time / 1000.0 : 0.001),
+			size * (double)GETIP_SCAN_ROUNDS / 1048576.0 / ((0 != find_time) ? find_time / 1000.0 : 0.001) );
+
+	/**
+	 *	Step 2: scrape it as the page of every server.
+	 */
+	for ( s = 0; s < (int)_countof(SERVERS); ++s )
+	{
+		dnspod_getip_stream_init(&stream, matcher, SERVERS[s].rules, NULL);
+		for ( offset = 0; (offset < size) && (DDNS_ERROR_PENDING == stream.error_code); offset += block )
+		{
+			block = (size - offset < GETIP_SCAN_BLOCK) ? size - offset : GETIP_SCAN_BLOCK;
+			dnspod_getip_stream_read(&(page[offset]), block, &stream);
+		}
+		dnspod_getip_stream_end(&stream);
+		printf("    as %s: %s%s%s\n", SERVERS[s].name, ddns_err2str(stream.error_code),
+				(DDNS_ERROR_BADSVR != stream.error_code) ? ", " : "",
+				(DDNS_ERROR_BADSVR != stream.error_code) ? stream.token : "");
+	}
+
+	if ( matches != occurrences )
+	{
+		printf("    FAIL: %lu matches by strstr\n", occurrences);
+		return 1;
+	}
+	return 0;
+}
+
+/**
+ *	Search random patterns in random text, by the matcher and by brute force.
+ *
+ *	@param[in]	rounds	: count of random cases.
+ *
+ *	@return	count of the cases which disagree.
+ */
+static int getip_scan_random(unsigned long rounds)
+{
+	static struct ddns_matcher			matcher;
+	static struct getip_scan_matches	scanned;
+	static struct getip_scan_matches	expected;
+
+	char			patterns[DDNS_MATCHER_MAX_PATTERN][8];
+	const char	*	pointers[DDNS_MATCHER_MAX_PATTERN];
+	char			text[512];
+	unsigned int	count		= 0;
+	unsigned int	state		= 0;
+	unsigned int	total		= 0;
+	unsigned int	p			= 0;
+	unsigned int	q			= 0;
+	size_t			length		= 0;
+	size_t			size		= 0;
+	size_t			end			= 0;
+	size_t			block		= 0;
+	size_t			i			= 0;
+	unsigned long	n			= 0;
+	int				failed		= 0;
+	int				alphabet	= 0;
+
+	srand(1);
+	for ( n = 0; n < rounds; ++n )
+	{
+		/**
+		 *	Step 1: distinct patterns, most of them over a small alphabet so
+		 *			they overlap, a few with high bytes.
+		 */
+		alphabet	= 2 + rand() % 3;
+		count		= 1 + rand() % DDNS_MATCHER_MAX_PATTERN;
+		total		= 0;
+		for ( p = 0; p < count; ++p )
+		{
+			do
+			{
+				length = 1 + rand() % 6;
+				for ( i = 0; i < length; ++i )
+				{
+					patterns[p][i] = (0 == rand() % 50) ? (char)0xE5 : (char)('a' + rand() % alphabet);
+				}
+				patterns[p][length] = '\0';
+				for ( q = 0; (q < p) && (0 != strcmp(patterns[q], patterns[p])); ++q )
+				{
+				}
+			} while ( q < p );
+
+			if ( total + length + 1 > DDNS_MATCHER_MAX_STATE )
+			{
+				break;
+			}
+			total		+= length;
+			pointers[p]	= patterns[p];
+		}
+		count = p;
+
+		size = 1 + rand() % (sizeof(text) - 1);
+		for ( i = 0; i < size; ++i )
+		{
+			text[i] = (0 == rand() % 50) ? (char)0xE5 : (char)('a' + rand() % alphabet);
+		}
+
+		if ( 0 != ddns_matcher_init(&matcher, pointers, count) )
+		{
+			printf("random case %lu: FAIL to build the matcher\n", n);
+			++failed;
+			continue;
+		}
+
+		/**
+		 *	Step 2: the matcher, over random blocks.
+		 */
+		memset(&scanned, 0, sizeof(scanned));
+		state = 0;
+		for ( i = 0; i < size; i += block )
+		{
+			block			= 1 + rand() % 64;
+			block			= (size - i < block) ? size - i : block;
+			scanned.base	= i;
+			ddns_matcher_scan(&matcher, &state, &(text[i]), block, &getip_scan_keep, &scanned);
+		}
+
+		/**
+		 *	Step 3: brute force, the longest pattern first at every byte.
+		 */
+		memset(&expected, 0, sizeof(expected));
+		for ( end = 1; end <= size; ++end )
+		{
+			for ( length = 6; length > 0; --length )
+			{
+				for ( p = 0; p < count; ++p )
+				{
+					if (	(strlen(patterns[p]) == length)
+						&&	(length <= end)
+						&&	(0 == memcmp(&(text[end - length]), patterns[p], length)) )
+					{
+						getip_scan_keep(p, end, &expected);
+					}
+				}
+			}
+		}
+
+		if (	(scanned.count != expected.count)
+			||	(0 != memcmp(scanned.pattern, expected.pattern,
+							 expected.count * sizeof(expected.pattern[0])))
+			||	(0 != memcmp(scanned.offset, expected.offset,
+							 expected.count * sizeof(expected.offset[0]))) )
+		{
+			printf(	"random case %lu: FAIL, %lu matches, %lu expected\n",
+					n, (unsigned long)scanned.count, (unsigned long)expected.count );
+			++failed;
+		}
+	}
+
+	printf("random cases    : %lu, %d failed\n", rounds, failed);
+
+	return failed;
+}
+
+int main(int argc, char * argv[])
+{
+	static const char * BUILT[] = { "baidu", "ip138" };
+
+	struct dnspod_getip_matcher	*	matcher	= NULL;
+	char						*	page	= NULL;
+	size_t							size	= 0;
+	unsigned long					rounds	= 10000;
+	int								failed	= 0;
+	int								first	= 1;
+	int								i		= 0;
+
+	if ( (argc > 2) && (0 == strcmp("-n", argv[1])) )
+	{
+		rounds	= strtoul(argv[2], NULL, 10);
+		first	= 3;
+	}
+
+	matcher = (struct dnspod_getip_matcher*)malloc(sizeof(*matcher));
+	if ( (NULL == matcher) || (0 != dnspod_getip_matcher_init(matcher, dnspod_getip_table)) )
+	{
+		fprintf(stderr, "can't build the matcher.\n");
+		return 1;
+	}
+	printf("%u states for the signatures of all servers\n", matcher->matcher.state_cnt);
+
+	if ( first < argc )
+	{
+		for ( i = first; i < argc; ++i )
+		{
+			page = getip_scan_load(argv[i], &size);
+			if ( NULL == page )
+			{
+				fprintf(stderr, "%s: can't read it.\n", argv[i]);
+				++failed;
+				continue;
+			}
+			failed += getip_scan_page(matcher, argv[i], page, size);
+			free(page);
+		}
+	}
+	else
+	{
+		for ( i = 0; i < (int)_countof(BUILT); ++i )
+		{
+			page = getip_scan_build(BUILT[i], &size);
+			if ( NULL == page )
+			{
+				return 1;
+			}
+			failed += getip_scan_page(matcher, BUILT[i], page, size);
+			free(page);
+		}
+	}
+
+	failed += getip_scan_random(rounds);
+	free(matcher);
+
+	return (0 == failed) ? 0 : 1;
+}
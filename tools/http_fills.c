@@ -0,0 +1,174 @@
+/*
+ *	This file is part of 'ddns'.
+ *
+ *	'ddns' is free software; you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published
+ *	by the Free Software Foundation; either version 3 of the License,
+ *	or (at your option) any later version.
+ *
+ *	'ddns' is distributed in the hope that it will be useful, but
+ *	WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with 'ddns'; if not, write to the Free Software Foundation, Inc.,
+ *	51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*
+ *	Count the reads from the socket (recv, or SSL_read over TLS) which fill
+ *	the receive buffer of a connection while a large page is received:
+ *
+ *		./page_server.py 8080 &
+ *		./http_fills http://127.0.0.1:8080/length http://127.0.0.1:8080/chunked \
+ *			http://127.0.0.1:8080/headers
+ *
+ *		./page_server.py 8443 102400 cert.pem key.pem &
+ *		./http_fills https://127.0.0.1:8443/length
+ *
+ *	Headers, chunk lines and bodies are all taken from the receive buffer, so
+ *	a read should bring many KB. It fails if a response took less than 1 KB
+ *	per read on average, which would mean the data is read a few bytes at a
+ *	time again.
+ *
+ *	It includes "http.c" to count the reads of the module.
+ */
+
+#include "ddns_socket.h"	/* recv */
+#include "http.h"			/* HTTP_SUPPORT_SSL_OPENSSL */
+#if defined(HTTP_SUPPORT_SSL_OPENSSL) && HTTP_SUPPORT_SSL_OPENSSL
+#	include <openssl/ssl.h>	/* SSL_read */
+#endif
+
+#define HTTP_FILLS_MIN_AVERAGE	1024	/* least bytes per read on average */
+
+static unsigned long	http_fills_reads	= 0;	/* recv & SSL_read calls */
+static unsigned long	http_fills_bytes	= 0;	/* bytes they returned */
+
+/**
+ *	recv of the module, which counts the calls and the bytes.
+ *
+ *	@param[in]	socket	: the socket to read from.
+ *	@param[out]	buffer	: buffer to store the received data.
+ *	@param[in]	size	: size of [buffer] in bytes.
+ *	@param[in]	flags	: flags of recv.
+ *
+ *	@return	what recv returns.
+ */
+static int http_fills_recv(ddns_socket socket, void * buffer, size_t size, int flags)
+{
+	int result = (int)recv(socket, buffer, size, flags);
+
+	++http_fills_reads;
+	if ( result > 0 )
+	{
+		http_fills_bytes += result;
+	}
+
+	return result;
+}
+
+#if defined(HTTP_SUPPORT_SSL_OPENSSL) && HTTP_SUPPORT_SSL_OPENSSL
+/**
+ *	SSL_read of the module, which counts the calls and the bytes.
+ *
+ *	@param[in]	ssl		: the TLS connection to read from.
+ *	@param[out]	buffer	: buffer to store the received data.
+ *	@param[in]	size	: size of [buffer] in bytes.
+ *
+ *	@return	what SSL_read returns.
+ */
+static int http_fills_ssl_read(SSL * ssl, void * buffer, int size)
+{
+	int result = SSL_read(ssl, buffer, size);
+
+	++http_fills_reads;
+	if ( result > 0 )
+	{
+		http_fills_bytes += result;
+	}
+
+	return result;
+}
+#endif
+
+#define recv(socket, buffer, size, flags)	http_fills_recv(socket, buffer, size, flags)
+#define SSL_read(ssl, buffer, size)			http_fills_ssl_read(ssl, buffer, size)
+
+#include "http.c"
+
+#undef recv
+#undef SSL_read
+
+/**
+ *	Count the bytes of the response body.
+ *
+ *	@param[in]		data	: a block of the response body.
+ *	@param[in]		size	: size of [data] in bytes.
+ *	@param[in/out]	param	: the byte counter.
+ */
+static void http_fills_count(const char * data, size_t size, void * param)
+{
+	(void)data;
+	*(size_t*)param += size;
+}
+
+int main(int argc, char * argv[])
+{
+	struct http_request	*	request		= NULL;
+	size_t					received	= 0;
+	int						status		= 0;
+	int						failed		= 0;
+	int						i			= 0;
+
+	if ( argc < 2 )
+	{
+		fprintf(stderr, "usage: %s <url>...\n", argv[0]);
+		return 1;
+	}
+
+	ddns_socket_init();
+	http_init();
+
+	for ( i = 1; i < argc; ++i )
+	{
+		http_fills_reads	= 0;
+		http_fills_bytes	= 0;
+		received			= 0;
+		status				= 0;
+
+		request = http_create_request(http_method_get, argv[i], 10);
+		if ( NULL != request )
+		{
+			if ( 0 == http_connect(request) )
+			{
+				status = http_send_request(request, NULL, 0);
+			}
+			if (	(0 != status)
+				&&	(0 == http_get_response_ex(request, &http_fills_count, &received)) )
+			{
+				status = 0;
+			}
+			http_destroy_request(request);
+		}
+
+		printf(	"%-36s: status %d, %6lu body bytes, %6lu bytes in %4lu reads "
+				"(%lu at best)\n",
+				argv[i], status, (unsigned long)received,
+				http_fills_bytes, http_fills_reads,
+				(http_fills_bytes + HTTP_RECV_BUFFER_SIZE - 1) / HTTP_RECV_BUFFER_SIZE );
+
+		if (	(200 != status)
+			||	(0 == http_fills_reads)
+			||	(http_fills_bytes / http_fills_reads < HTTP_FILLS_MIN_AVERAGE) )
+		{
+			printf("FAIL\n");
+			++failed;
+		}
+	}
+
+	http_uninit();
+	ddns_socket_uninit();
+
+	return (0 == failed) ? 0 : 1;
+}
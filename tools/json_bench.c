@@ -0,0 +1,413 @@
+/*
+ *	This file is part of 'ddns'.
+ *
+ *	'ddns' is free software; you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published
+ *	by the Free Software Foundation; either version 3 of the License,
+ *	or (at your option) any later version.
+ *
+ *	'ddns' is distributed in the hope that it will be useful, but
+ *	WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with 'ddns'; if not, write to the Free Software Foundation, Inc.,
+ *	51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*
+ *	Parse a synthetic DNSPod "Record.List" response of many records, fed in
+ *	blocks of 4 KB as the HTTP module does, with a tree built one value at a
+ *	time (dom), a tree built in an arena (arena), and with events only
+ *	(stream). The peak heap, allocations and time of every parse are shown:
+ *
+ *		./json_bench
+ *		./json_bench 10000 20
+ *
+ *	The arguments are the count of records (10000 by default), and how many
+ *	times each parse is repeated (10 by default).
+ *
+ *	It includes "json.c" to count the heap used by the parser.
+ */
+
+#include <stdio.h>			/* printf	*/
+#include <stdlib.h>			/* malloc	*/
+#include <string.h>			/* strcmp	*/
+#include "ddns_string.h"	/* c99_snprintf, ... */
+#include "ddns_sync.h"		/* ddns_sync_clock */
+
+#define JSON_BENCH_HEADER	16		/* keeps the alignment of malloc */
+#define JSON_BENCH_BLOCK	4096	/* size of a block fed to the parser */
+
+static size_t			json_bench_heap		= 0;	/* bytes in use */
+static size_t			json_bench_peak		= 0;	/* most bytes in use */
+static unsigned long	json_bench_allocs	= 0;	/* malloc & realloc calls */
+
+/**
+ *	malloc of the parser, which counts the bytes in use.
+ *
+ *	@param[in]	size	: bytes to be allocated.
+ *
+ *	@return	the allocated block, or NULL.
+ */
+static void * json_bench_malloc(size_t size)
+{
+	char * block = (char*)malloc(JSON_BENCH_HEADER + size);
+
+	if ( NULL == block )
+	{
+		return NULL;
+	}
+
+	*(size_t*)block = size;
+	json_bench_heap += size;
+	++json_bench_allocs;
+	if ( json_bench_heap > json_bench_peak )
+	{
+		json_bench_peak = json_bench_heap;
+	}
+
+	return block + JSON_BENCH_HEADER;
+}
+
+/**
+ *	free of the parser.
+ *
+ *	@param[in]	ptr		: a block returned by [json_bench_malloc], or NULL.
+ */
+static void json_bench_free(void * ptr)
+{
+	char * block = (char*)ptr - JSON_BENCH_HEADER;
+
+	if ( NULL != ptr )
+	{
+		json_bench_heap -= *(size_t*)block;
+		free(block);
+	}
+}
+
+/**
+ *	realloc of the parser.
+ *
+ *	@param[in]	ptr		: a block returned by [json_bench_malloc], or NULL.
+ *	@param[in]	size	: the new size in bytes.
+ *
+ *	@return	the reallocated block, or NULL, in which case [ptr] is kept.
+ */
+static void * json_bench_realloc(void * ptr, size_t size)
+{
+	char * block = NULL;
+
+	if ( NULL == ptr )
+	{
+		return json_bench_malloc(size);
+	}
+
+	block = (char*)realloc((char*)ptr - JSON_BENCH_HEADER, JSON_BENCH_HEADER + size);
+	if ( NULL == block )
+	{
+		return NULL;
+	}
+
+	json_bench_heap += size - *(size_t*)block;
+	*(size_t*)block = size;
+	++json_bench_allocs;
+	if ( json_bench_heap > json_bench_peak )
+	{
+		json_bench_peak = json_bench_heap;
+	}
+
+	return block + JSON_BENCH_HEADER;
+}
+
+#define malloc(size)		json_bench_malloc(size)
+#define realloc(ptr, size)	json_bench_realloc(ptr, size)
+#define free(ptr)			json_bench_free(ptr)
+
+#include "json.c"
+
+#undef malloc
+#undef realloc
+#undef free
+
+/* what a parse found, to check that every mode read all records */
+struct json_bench_result
+{
+	unsigned long	records;	/* records of "records"	*/
+	unsigned long	checksum;	/* sum of the "id" of every record */
+	int				depth;		/* of the stream		*/
+	int				in_records;	/* depth of "records"	*/
+	int				is_id;		/* the last key is "id"	*/
+	int				is_records;	/* the last key is "records" */
+};
+
+/**
+ *	Build a "Record.List" response.
+ *
+ *	@param[in]	records	: count of records.
+ *	@param[out]	size	: length of the response.
+ *
+ *	@return	the response, free it by [free].
+ */
+static char * json_bench_build(unsigned long records, size_t * size)
+{
+	static const char HEAD[] =
+		"{\"status\":{\"code\":\"1\",\"message\":\"Action completed successful\","
+		"\"created_at\":\"2024-01-01 00:00:00\"},"
+		"\"domain\":{\"id\":\"1\",\"name\":\"example.com\",\"punycode\":\"example.com\","
+		"\"grade\":\"DP_Free\",\"owner\":\"user@example.com\",\"ext_status\":\"\","
+		"\"ttl\":600,\"min_ttl\":600,\"dnspod_ns\":[\"f1g1ns1.dnspod.net\","
+		"\"f1g1ns2.dnspod.net\"],\"status\":\"enable\"},"
+		"\"info\":{\"sub_domains\":\"%lu\",\"record_total\":\"%lu\"},"
+		"\"records\":[";
+	static const char RECORD[] =
+		"%s{\"id\":\"%lu\",\"ttl\":\"600\",\"value\":\"192.0.2.%lu\","
+		"\"enabled\":\"1\",\"status\":\"enabled\","
+		"\"updated_on\":\"2024-01-01 00:00:00\",\"name\":\"host%lu\","
+		"\"line\":\"\\u9ed8\\u8ba4\",\"line_id\":\"0\",\"type\":\"A\","
+		"\"weight\":null,\"monitor_status\":\"\",\"remark\":\"\","
+		"\"use_aqb\":\"no\",\"mx\":\"0\"}";
+
+	size_t			capacity	= 512 + records * 400;
+	size_t			length		= 0;
+	unsigned long	i			= 0;
+	char		*	text		= (char*)malloc(capacity);
+
+	if ( NULL == text )
+	{
+		return NULL;
+	}
+
+	length = c99_snprintf(text, capacity, HEAD, records, records);
+	for ( i = 0; i < records; ++i )
+	{
+		length += c99_snprintf(	&(text[length]), capacity - length, RECORD,
+								(0 == i) ? "" : ",", i + 1, i % 250 + 1, i );
+	}
+	length += c99_snprintf(&(text[length]), capacity - length, "]}");
+
+	*size = length;
+	return text;
+}
+
+/**
+ *	Event handler of the stream parse, counts the records.
+ *
+ *	@param[in]		event	: type of the event.
+ *	@param[in]		value	: the key or the value.
+ *	@param[in/out]	param	: the [json_bench_result].
+ *
+ *	@return	always 0 to continue.
+ */
+static int json_bench_event(
+	enum json_event_type		event,
+	struct json_value		*	value,
+	void					*	param
+	)
+{
+	struct json_bench_result * result = (struct json_bench_result*)param;
+
+	switch ( event )
+	{
+	case json_event_start_object:
+	case json_event_start_array:
+		++result->depth;
+		if ( (json_event_start_array == event) && (0 != result->is_records) )
+		{
+			result->in_records = result->depth;
+		}
+		else if ( (0 != result->in_records) && (result->in_records + 1 == result->depth) )
+		{
+			++result->records;
+		}
+		result->is_records = 0;
+		break;
+
+	case json_event_end_object:
+	case json_event_end_array:
+		if ( result->in_records == result->depth )
+		{
+			result->in_records = 0;
+		}
+		--result->depth;
+		break;
+
+	case json_event_key:
+		result->is_id		= (0 == strcmp("id", json_string_get(value)));
+		result->is_records	= (0 == strcmp("records", json_string_get(value)));
+		break;
+
+	case json_event_string:
+		if (	(0 != result->is_id)
+			&&	(0 != result->in_records)
+			&&	(result->in_records + 1 == result->depth) )
+		{
+			result->checksum += strtoul(json_string_get(value), NULL, 10);
+		}
+		result->is_id		= 0;
+		result->is_records	= 0;
+		break;
+
+	default:
+		result->is_id		= 0;
+		result->is_records	= 0;
+		break;
+	}
+
+	return 0;
+}
+
+/**
+ *	Walk the records of a parsed response, as [dnspod_list_record] did.
+ *
+ *	@param[in]	root	: the parsed response.
+ *	@param[out]	result	: what was found.
+ */
+static void json_bench_walk(struct json_value * root, struct json_bench_result * result)
+{
+	struct json_value	*	records	= json_object_peek(root, "records");
+	struct json_value	*	id		= NULL;
+	unsigned long			count	= json_array_size(records);
+	unsigned long			i		= 0;
+
+	for ( i = 0; i < count; ++i )
+	{
+		id = json_object_peek(json_array_peek(records, i), "id");
+		if ( NULL != id )
+		{
+			++result->records;
+			result->checksum += strtoul(json_string_get(id), NULL, 10);
+		}
+	}
+}
+
+/**
+ *	Parse the response once.
+ *
+ *	@param[in]	mode	: "dom", "arena" or "stream".
+ *	@param[in]	text	: the response.
+ *	@param[in]	size	: length of [text].
+ *	@param[out]	result	: what was found.
+ *
+ *	@return	0 if the response is parsed, otherwise -1.
+ */
+static int json_bench_parse(
+	const char				*	mode,
+	const char				*	text,
+	size_t						size,
+	struct json_bench_result *	result
+	)
+{
+	struct json_context	*	json_ctx	= NULL;
+	struct json_value	*	root		= NULL;
+	size_t					offset		= 0;
+	size_t					block		= 0;
+	int						status		= 0;
+
+	memset(result, 0, sizeof(*result));
+	if ( 0 == strcmp("dom", mode) )
+	{
+		json_ctx = json_create_context(20);
+	}
+	else if ( 0 == strcmp("arena", mode) )
+	{
+		json_ctx = json_create_arena_context(20);
+	}
+	else
+	{
+		json_ctx = json_create_event_context(20, &json_bench_event, result);
+	}
+	if ( NULL == json_ctx )
+	{
+		return -1;
+	}
+
+	for ( offset = 0; (0 == status) && (offset < size); offset += block )
+	{
+		block	= (size - offset < JSON_BENCH_BLOCK) ? size - offset : JSON_BENCH_BLOCK;
+		status	= json_read(json_ctx, &(text[offset]), block);
+	}
+	if ( (0 == status) && (0 != json_finalize_context(json_ctx)) )
+	{
+		status = -1;
+	}
+
+	if ( (0 == status) && (0 != strcmp("stream", mode)) )
+	{
+		root = json_get_value(json_ctx);
+		json_bench_walk(root, result);
+		json_destroy(root);
+	}
+	json_destroy_context(json_ctx);
+
+	return status;
+}
+
+int main(int argc, char * argv[])
+{
+	static const char * MODES[] = { "dom", "arena", "stream" };
+
+	struct json_bench_result	result;
+	char					*	text		= NULL;
+	size_t						size		= 0;
+	unsigned long				records		= 10000;
+	unsigned long				expected	= 0;
+	unsigned long				start		= 0;
+	unsigned long				elapsed		= 0;
+	int							rounds		= 10;
+	int							failed		= 0;
+	int							i			= 0;
+	unsigned int				m			= 0;
+
+	if ( argc > 1 )
+	{
+		records = strtoul(argv[1], NULL, 10);
+	}
+	if ( argc > 2 )
+	{
+		rounds = atoi(argv[2]);
+	}
+	if ( (0 == records) || (rounds <= 0) )
+	{
+		fprintf(stderr, "usage: %s [records] [rounds]\n", argv[0]);
+		return 1;
+	}
+
+	text = json_bench_build(records, &size);
+	if ( NULL == text )
+	{
+		fprintf(stderr, "insufficient memory.\n");
+		return 1;
+	}
+	expected = records * (records + 1) / 2;
+	printf("%lu records, %lu bytes\n", records, (unsigned long)size);
+
+	for ( m = 0; m < _countof(MODES); ++m )
+	{
+		json_bench_peak		= 0;
+		json_bench_allocs	= 0;
+		elapsed				= 0;
+		for ( i = 0; i < rounds; ++i )
+		{
+			start = ddns_sync_clock();
+			if (	(0 != json_bench_parse(MODES[m], text, size, &result))
+				||	(records != result.records)
+				||	(expected != result.checksum) )
+			{
+				fprintf(stderr, "%s: parse failed, %lu records found.\n",
+						MODES[m], result.records);
+				++failed;
+				break;
+			}
+			elapsed += ddns_sync_clock() - start;
+		}
+
+		printf("%-8s: %8.2f ms, peak heap %10lu bytes, %9lu allocations\n",
+				MODES[m], (double)elapsed / rounds,
+				(unsigned long)json_bench_peak, json_bench_allocs / rounds);
+	}
+
+	free(text);
+
+	return (0 == failed) ? 0 : 1;
+}
@@ -0,0 +1,214 @@
+/*
+ *	This file is part of 'ddns'.
+ *
+ *	'ddns' is free software; you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published
+ *	by the Free Software Foundation; either version 3 of the License,
+ *	or (at your option) any later version.
+ *
+ *	'ddns' is distributed in the hope that it will be useful, but
+ *	WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with 'ddns'; if not, write to the Free Software Foundation, Inc.,
+ *	51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*
+ *	Member lookup of json objects of 8, 64 and 1024 keys. For every size it
+ *	times the parse that builds the object (and its hash index, beyond 8
+ *	members), the lookups by [json_object_find], and the same lookups by a
+ *	walk of the member list, as it was done without an index:
+ *
+ *		./json_lookup
+ *		./json_lookup 5000000
+ *
+ *	The argument is the count of lookups of every size (2000000 by default).
+ *	The order of the members, and their values after a parse, a replace by
+ *	[json_object_set] and a [json_duplicate], are checked as well.
+ *
+ *	It includes "json.c" to reach [json_object_find].
+ */
+
+#include "json.c"
+#include "ddns_string.h"	/* c99_snprintf, ... */
+#include "ddns_sync.h"		/* ddns_sync_clock */
+
+#define JSON_LOOKUP_MAX_KEYS	1024
+
+static char json_lookup_keys[JSON_LOOKUP_MAX_KEYS + 1][16];
+
+/**
+ *	Find a member by walking the member list.
+ *
+ *	@param[in]	var		: the [json_value] object of type [json_type_object].
+ *	@param[in]	key		: name of the member.
+ *
+ *	@return		Return the name-value pair if found, otherwise NULL.
+ */
+static json_pair * json_lookup_walk(struct json_value * var, const char * key)
+{
+	json_pair * pairs = NULL;
+
+	for ( pairs = var->value.object.pairs; NULL != pairs; pairs = pairs->next )
+	{
+		if ( 0 == strcmp(pairs->name->value.string.value, key) )
+		{
+			break;
+		}
+	}
+
+	return pairs;
+}
+
+/**
+ *	Check the members of an object, in order, [value] of the first one.
+ *
+ *	@param[in]	var		: the object.
+ *	@param[in]	keys	: count of members.
+ *	@param[in]	first	: value of "member_0".
+ *
+ *	@return	non-zero if every member is in place.
+ */
+static int json_lookup_check(struct json_value * var, int keys, int first)
+{
+	json_pair	*	pairs	= var->value.object.pairs;
+	int				i		= 0;
+
+	for ( i = 0; i < keys; ++i, pairs = pairs->next )
+	{
+		if (	(NULL == pairs)
+			||	(0 != strcmp(pairs->name->value.string.value, json_lookup_keys[i]))
+			||	(json_object_find(var, json_lookup_keys[i]) != pairs)
+			||	(json_number_get(pairs->value) != ((0 == i) ? first : i)) )
+		{
+			return 0;
+		}
+	}
+
+	return (NULL == pairs) && (NULL == json_object_find(var, json_lookup_keys[keys]));
+}
+
+int main(int argc, char * argv[])
+{
+	static const int SIZES[] = { 8, 64, 1024 };
+
+	struct json_context	*	json_ctx	= NULL;
+	struct json_value	*	object		= NULL;
+	struct json_value	*	copy		= NULL;
+	char					buffer[64];
+	unsigned long			lookups		= 2000000;
+	unsigned long			found		= 0;
+	unsigned long			start		= 0;
+	unsigned long			parse_time	= 0;
+	unsigned long			find_time	= 0;
+	unsigned long			walk_time	= 0;
+	unsigned long			capacity	= 0;
+	unsigned long			n			= 0;
+	int						keys		= 0;
+	int						failed		= 0;
+	int						length		= 0;
+	int						i			= 0;
+	int						s			= 0;
+
+	if ( argc > 1 )
+	{
+		lookups = strtoul(argv[1], NULL, 10);
+	}
+	if ( 0 == lookups )
+	{
+		fprintf(stderr, "usage: %s [lookups]\n", argv[0]);
+		return 1;
+	}
+
+	for ( i = 0; i <= JSON_LOOKUP_MAX_KEYS; ++i )
+	{
+		c99_snprintf(json_lookup_keys[i], sizeof(json_lookup_keys[i]), "member_%d", i);
+	}
+
+	for ( s = 0; s < (int)_countof(SIZES); ++s )
+	{
+		keys = SIZES[s];
+
+		/**
+		 *	Step 1: parse {"member_0":0,"member_1":1,...} 100 times.
+		 */
+		start = ddns_sync_clock();
+		for ( n = 0; n < 100; ++n )
+		{
+			json_destroy(object);
+			json_ctx = json_create_context(4);
+			json_readchr(json_ctx, '{');
+			for ( i = 0; i < keys; ++i )
+			{
+				length = c99_snprintf(	buffer, sizeof(buffer), "%s\"%s\":%d",
+										(0 == i) ? "" : ",", json_lookup_keys[i], i );
+				json_read(json_ctx, buffer, length);
+			}
+			json_readchr(json_ctx, '}');
+			json_finalize_context(json_ctx);
+			object = json_get_value(json_ctx);
+			json_destroy_context(json_ctx);
+		}
+		parse_time	= ddns_sync_clock() - start;
+		capacity	= object->value.object.capacity;
+
+		/**
+		 *	Step 2: the same lookups, by the index and by the list.
+		 */
+		found	= 0;
+		start	= ddns_sync_clock();
+		for ( n = 0; n < lookups; ++n )
+		{
+			if ( NULL != json_object_find(object, json_lookup_keys[n % keys]) )
+			{
+				++found;
+			}
+		}
+		find_time = ddns_sync_clock() - start;
+
+		start	= ddns_sync_clock();
+		for ( n = 0; n < lookups; ++n )
+		{
+			if ( NULL != json_lookup_walk(object, json_lookup_keys[n % keys]) )
+			{
+				++found;
+			}
+		}
+		walk_time = ddns_sync_clock() - start;
+
+		/**
+		 *	Step 3: the members are in place after a parse, a replace and
+		 *			a copy.
+		 */
+		if (	(lookups * 2 != found)
+			||	(0 == json_lookup_check(object, keys, 0)) )
+		{
+			printf("keys=%-5d: FAIL after parse\n", keys);
+			++failed;
+		}
+		json_object_set(object, json_lookup_keys[0],
+						json_duplicate(object->value.object.last->value));
+		copy = json_duplicate(object);
+		if (	(0 == json_lookup_check(object, keys, keys - 1))
+			||	(NULL == copy)
+			||	(0 == json_lookup_check(copy, keys, keys - 1)) )
+		{
+			printf("keys=%-5d: FAIL after replace\n", keys);
+			++failed;
+		}
+		json_destroy(copy);
+		json_destroy(object);
+		object = NULL;
+
+		printf(	"keys=%-5d: parse %7.1f us, find %6.1f ns, walk %7.1f ns, "
+				"index %lu slots\n",
+				keys, parse_time * 1000.0 / 100,
+				find_time * 1000000.0 / lookups,
+				walk_time * 1000000.0 / lookups,
+				capacity );
+	}
+
+	return (0 == failed) ? 0 : 1;
+}
@@ -0,0 +1,171 @@
+/*
+ *	This file is part of 'ddns'.
+ *
+ *	'ddns' is free software; you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published
+ *	by the Free Software Foundation; either version 3 of the License,
+ *	or (at your option) any later version.
+ *
+ *	'ddns' is distributed in the hope that it will be useful, but
+ *	WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with 'ddns'; if not, write to the Free Software Foundation, Inc.,
+ *	51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*
+ *	Check that looking up a parsed response by [json_object_peek] and
+ *	[json_array_peek] allocates nothing, while [json_object_get] and
+ *	[json_array_get] copy what they return:
+ *
+ *		./json_peek
+ *
+ *	Every lookup is counted over the members of a small "Record.List"
+ *	response, found and missing ones. It fails if a peek allocates.
+ *
+ *	It includes "json.c" to count the allocations of the module.
+ */
+
+#include <stdio.h>			/* printf	*/
+#include <stdlib.h>			/* malloc	*/
+#include <string.h>			/* strlen	*/
+
+static unsigned long json_peek_allocs = 0;	/* malloc & realloc calls */
+
+/**
+ *	malloc of the module, which counts the calls.
+ *
+ *	@param[in]	size	: bytes to be allocated.
+ *
+ *	@return	the allocated block, or NULL.
+ */
+static void * json_peek_malloc(size_t size)
+{
+	++json_peek_allocs;
+	return malloc(size);
+}
+
+/**
+ *	realloc of the module, which counts the calls.
+ *
+ *	@param[in]	ptr		: the block to be resized, or NULL.
+ *	@param[in]	size	: the new size in bytes.
+ *
+ *	@return	the reallocated block, or NULL.
+ */
+static void * json_peek_realloc(void * ptr, size_t size)
+{
+	++json_peek_allocs;
+	return realloc(ptr, size);
+}
+
+#define malloc(size)		json_peek_malloc(size)
+#define realloc(ptr, size)	json_peek_realloc(ptr, size)
+
+#include "json.c"
+
+#undef malloc
+#undef realloc
+
+static const char JSON_PEEK_RESPONSE[] =
+	"{\"status\":{\"code\":\"1\",\"message\":\"Action completed successful\"},"
+	"\"domain\":{\"id\":\"1\",\"name\":\"example.com\",\"ttl\":600},"
+	"\"records\":["
+	"{\"id\":\"1\",\"name\":\"@\",\"type\":\"A\",\"value\":\"192.0.2.1\"},"
+	"{\"id\":\"2\",\"name\":\"www\",\"type\":\"A\",\"value\":\"192.0.2.2\"},"
+	"{\"id\":\"3\",\"name\":\"mail\",\"type\":\"MX\",\"value\":\"mx.example.com\"}"
+	"]}";
+
+/* keys looked up in every record, the last ones are missing */
+static const char * JSON_PEEK_KEYS[] =
+{
+	"id", "name", "type", "value", "ttl", "enabled", ""
+};
+
+int main(void)
+{
+	struct json_context	*	json_ctx	= NULL;
+	struct json_value	*	root		= NULL;
+	struct json_value	*	records		= NULL;
+	struct json_value	*	record		= NULL;
+	struct json_value	*	value		= NULL;
+	unsigned long			peek_allocs	= 0;
+	unsigned long			get_allocs	= 0;
+	unsigned long			lookups		= 0;
+	unsigned long			found		= 0;
+	unsigned long			count		= 0;
+	unsigned long			i			= 0;
+	unsigned int			k			= 0;
+
+	json_ctx = json_create_context(20);
+	if (	(NULL == json_ctx)
+		||	(0 != json_read(json_ctx, JSON_PEEK_RESPONSE, strlen(JSON_PEEK_RESPONSE)))
+		||	(0 != json_finalize_context(json_ctx))
+		||	(NULL == (root = json_get_value(json_ctx))) )
+	{
+		fprintf(stderr, "failed to parse the response.\n");
+		return 1;
+	}
+	json_destroy_context(json_ctx);
+
+	/**
+	 *	Step 1: the same lookups by peek, then by get.
+	 */
+	json_peek_allocs = 0;
+	records	= json_object_peek(root, "records");
+	count	= json_array_size(records);
+	for ( i = 0; i <= count; ++i )
+	{
+		record = json_array_peek(records, i);
+		++lookups;
+		for ( k = 0; k < sizeof(JSON_PEEK_KEYS) / sizeof(JSON_PEEK_KEYS[0]); ++k )
+		{
+			if ( NULL != json_object_peek(record, JSON_PEEK_KEYS[k]) )
+			{
+				++found;
+			}
+			++lookups;
+		}
+	}
+	if ( NULL != json_object_peek(json_object_peek(root, "status"), "code") )
+	{
+		++found;
+	}
+	lookups += 3;
+	peek_allocs = json_peek_allocs;
+
+	json_peek_allocs = 0;
+	records	= json_object_get(root, "records");
+	for ( i = 0; i <= count; ++i )
+	{
+		record = json_array_get(records, i);
+		for ( k = 0; k < sizeof(JSON_PEEK_KEYS) / sizeof(JSON_PEEK_KEYS[0]); ++k )
+		{
+			value = json_object_get(record, (char*)JSON_PEEK_KEYS[k]);
+			json_destroy(value);
+		}
+		json_destroy(record);
+	}
+	json_destroy(records);
+	get_allocs = json_peek_allocs;
+
+	json_destroy(root);
+
+	/**
+	 *	Step 2: report.
+	 */
+	printf("%lu lookups, %lu values found\n", lookups, found);
+	printf("peek: %lu allocations\n", peek_allocs);
+	printf("get : %lu allocations\n", get_allocs);
+
+	if ( (0 != peek_allocs) || (13 != found) )
+	{
+		printf("FAIL\n");
+		return 1;
+	}
+
+	printf("pass\n");
+	return 0;
+}
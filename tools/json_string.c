@@ -0,0 +1,222 @@
+/*
+ *	This file is part of 'ddns'.
+ *
+ *	'ddns' is free software; you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published
+ *	by the Free Software Foundation; either version 3 of the License,
+ *	or (at your option) any later version.
+ *
+ *	'ddns' is distributed in the hope that it will be useful, but
+ *	WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with 'ddns'; if not, write to the Free Software Foundation, Inc.,
+ *	51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*
+ *	Parse throughput of long string values. A document of a few strings of
+ *	the given length is parsed by [json_read] in blocks of 4 KB, which
+ *	appends a run of plain characters at once, and by [json_readchr] one
+ *	character at a time:
+ *
+ *		./json_string
+ *		./json_string 1048576 8
+ *
+ *	The arguments are the length of every string (65536 by default) and the
+ *	count of strings (16 by default). Every 64th character of a string is an
+ *	escape, so both the fast and the slow path of a string are taken. The
+ *	parsed strings are compared with the expected ones.
+ */
+
+#include <stdio.h>			/* printf	*/
+#include <stdlib.h>			/* malloc	*/
+#include <string.h>			/* memcmp	*/
+#include "ddns_sync.h"		/* ddns_sync_clock */
+#include "json.h"			/* json_read, ... */
+
+#define JSON_STRING_BLOCK	4096	/* size of a block fed to [json_read] */
+
+/**
+ *	Build the document, an array of strings.
+ *
+ *	@param[in]	length	: length of every string, after unescaping.
+ *	@param[in]	count	: count of strings.
+ *	@param[out]	size	: length of the document.
+ *	@param[out]	plain	: a string as it should be parsed, free it by [free].
+ *
+ *	@return	the document, free it by [free].
+ */
+static char * json_string_build(
+	size_t			length,
+	unsigned long	count,
+	size_t		*	size,
+	char		**	plain
+	)
+{
+	char	*	text	= (char*)malloc(count * (length * 2 + 4) + 2);
+	char	*	string	= (char*)malloc(length + 1);
+	size_t		offset	= 0;
+	size_t		i		= 0;
+	unsigned long n		= 0;
+
+	if ( (NULL == text) || (NULL == string) )
+	{
+		free(text);
+		free(string);
+		return NULL;
+	}
+
+	for ( i = 0; i < length; ++i )
+	{
+		string[i] = (63 == i % 64) ? '"' : (char)('a' + i % 26);
+	}
+	string[length] = '\0';
+
+	text[offset++] = '[';
+	for ( n = 0; n < count; ++n )
+	{
+		if ( 0 != n )
+		{
+			text[offset++] = ',';
+		}
+		text[offset++] = '"';
+		for ( i = 0; i < length; ++i )
+		{
+			if ( '"' == string[i] )
+			{
+				text[offset++] = '\\';
+			}
+			text[offset++] = string[i];
+		}
+		text[offset++] = '"';
+	}
+	text[offset++] = ']';
+
+	*size	= offset;
+	*plain	= string;
+	return text;
+}
+
+/**
+ *	Parse the document once.
+ *
+ *	@param[in]	text	: the document.
+ *	@param[in]	size	: length of [text].
+ *	@param[in]	by_char	: non-zero to feed it by [json_readchr].
+ *
+ *	@return	the parsed array, or NULL.
+ */
+static struct json_value * json_string_parse(
+	const char	*	text,
+	size_t			size,
+	int				by_char
+	)
+{
+	struct json_context	*	json_ctx	= json_create_arena_context(4);
+	struct json_value	*	root		= NULL;
+	size_t					offset		= 0;
+	size_t					block		= 0;
+	int						status		= 0;
+
+	if ( NULL == json_ctx )
+	{
+		return NULL;
+	}
+
+	for ( offset = 0; (0 == status) && (offset < size); offset += block )
+	{
+		if ( 0 != by_char )
+		{
+			block	= 1;
+			status	= json_readchr(json_ctx, text[offset]);
+		}
+		else
+		{
+			block	= (size - offset < JSON_STRING_BLOCK) ? size - offset : JSON_STRING_BLOCK;
+			status	= json_read(json_ctx, &(text[offset]), block);
+		}
+	}
+	if ( (0 == status) && (0 == json_finalize_context(json_ctx)) )
+	{
+		root = json_get_value(json_ctx);
+	}
+	json_destroy_context(json_ctx);
+
+	return root;
+}
+
+int main(int argc, char * argv[])
+{
+	static const char * MODES[] = { "json_read", "json_readchr" };
+
+	struct json_value	*	root		= NULL;
+	struct json_value	*	value		= NULL;
+	char				*	text		= NULL;
+	char				*	plain		= NULL;
+	size_t					size		= 0;
+	size_t					length		= 65536;
+	unsigned long			count		= 16;
+	unsigned long			start		= 0;
+	unsigned long			elapsed		= 0;
+	unsigned long			i			= 0;
+	int						failed		= 0;
+	int						m			= 0;
+
+	if ( argc > 1 )
+	{
+		length = (size_t)strtoul(argv[1], NULL, 10);
+	}
+	if ( argc > 2 )
+	{
+		count = strtoul(argv[2], NULL, 10);
+	}
+	if ( (0 == length) || (0 == count) )
+	{
+		fprintf(stderr, "usage: %s [length] [count]\n", argv[0]);
+		return 1;
+	}
+
+	text = json_string_build(length, count, &size, &plain);
+	if ( NULL == text )
+	{
+		fprintf(stderr, "insufficient memory.\n");
+		return 1;
+	}
+	printf("%lu strings of %lu characters, %lu bytes\n",
+			count, (unsigned long)length, (unsigned long)size);
+
+	for ( m = 0; m < 2; ++m )
+	{
+		start	= ddns_sync_clock();
+		root	= json_string_parse(text, size, m);
+		elapsed	= ddns_sync_clock() - start;
+
+		for ( i = 0; i < count; ++i )
+		{
+			value = json_array_peek(root, i);
+			if (	(NULL == value)
+				||	(0 != memcmp(json_string_get(value), plain, length + 1)) )
+			{
+				break;
+			}
+		}
+		if ( (i < count) || (json_array_size(root) != count) )
+		{
+			printf("%-12s: FAIL, string %lu differs\n", MODES[m], i);
+			++failed;
+		}
+		else
+		{
+			printf("%-12s: %6lu ms, %8.1f MB/s\n", MODES[m], elapsed,
+					size / 1048576.0 / ((0 != elapsed) ? elapsed / 1000.0 : 0.001));
+		}
+		json_destroy(root);
+	}
+
+	free(text);
+	free(plain);
+
+	return (0 == failed) ? 0 : 1;
+}
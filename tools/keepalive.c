@@ -0,0 +1,148 @@
+/*
+ *	This file is part of 'ddns'.
+ *
+ *	'ddns' is free software; you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published
+ *	by the Free Software Foundation; either version 3 of the License,
+ *	or (at your option) any later version.
+ *
+ *	'ddns' is distributed in the hope that it will be useful, but
+ *	WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with 'ddns'; if not, write to the Free Software Foundation, Inc.,
+ *	51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*
+ *	Send a sequence of keep-alive requests, one after another, and print the
+ *	status and body size of each. Run it against keepalive_server.py, whose
+ *	log tells which connection served every request:
+ *
+ *		./keepalive_server.py 8080 &
+ *		./keepalive http://127.0.0.1:8080 get:/length get:/chunked \
+ *			get:/empty head:/length post:/length get:/chunked
+ *
+ *	All of the requests above should be served by one connection. Restart
+ *	the server with --drop-reused to check the retry of a request whose
+ *	pooled connection was closed by the server:
+ *
+ *		./keepalive http://127.0.0.1:8080 get:/length get:/length
+ *		./keepalive http://127.0.0.1:8080 get:/length post:/length
+ *
+ *	The second GET is sent again on a new connection and succeeds, the POST
+ *	fails and the server sees it only once.
+ */
+
+#include <stdio.h>			/* printf	*/
+#include <string.h>			/* strchr	*/
+#include "ddns_string.h"	/* c99_snprintf, ... */
+#include "ddns_socket.h"	/* ddns_socket_init, ... */
+#include "http.h"			/* http_init, ... */
+
+/**
+ *	Count the bytes of the response body.
+ *
+ *	@param[in]		data	: a block of the response body.
+ *	@param[in]		size	: size of [data] in bytes.
+ *	@param[in/out]	param	: the byte counter.
+ */
+static void keepalive_count(const char * data, size_t size, void * param)
+{
+	(void)data;
+	*(size_t*)param += size;
+}
+
+int main(int argc, char * argv[])
+{
+	static const struct
+	{
+		const char				*	name;
+		enum http_request_type		method;
+	} methods[] =
+	{
+		{ "get:",	http_method_get		},
+		{ "head:",	http_method_head	},
+		{ "post:",	http_method_post	},
+		{ "put:",	http_method_put		},
+		{ "delete:",	http_method_delete	},
+	};
+
+	struct http_request	*	request		= NULL;
+	const char			*	path		= NULL;
+	char					url[1024];
+	size_t					received	= 0;
+	int						status		= 0;
+	int						failed		= 0;
+	int						i			= 0;
+	unsigned int			m			= 0;
+
+	if ( argc < 3 )
+	{
+		fprintf(stderr, "usage: %s <base url> <method>:<path>...\n", argv[0]);
+		return 1;
+	}
+
+	ddns_socket_init();
+	http_init();
+
+	for ( i = 2; i < argc; ++i )
+	{
+		path = strchr(argv[i], ':');
+		for ( m = 0; m < sizeof(methods) / sizeof(methods[0]); ++m )
+		{
+			if (	(NULL != path)
+				&&	(0 == strncmp(argv[i], methods[m].name, path - argv[i] + 1)) )
+			{
+				break;
+			}
+		}
+		if ( m >= sizeof(methods) / sizeof(methods[0]) )
+		{
+			fprintf(stderr, "%s: unknown request\n", argv[i]);
+			++failed;
+			continue;
+		}
+
+		c99_snprintf(url, sizeof(url), "%s%s", argv[1], path + 1);
+		request		= http_create_request(methods[m].method, url, 10);
+		status		= 0;
+		received	= 0;
+		if ( NULL != request )
+		{
+			http_set_option(request, HTTP_OPTION_KEEPALIVE, 1);
+			if ( 0 == http_connect(request) )
+			{
+				/* a small form for the methods with a body */
+				if (	(http_method_post == methods[m].method)
+					||	(http_method_put == methods[m].method) )
+				{
+					status = http_send_request(request, "a=b", 3);
+				}
+				else
+				{
+					status = http_send_request(request, NULL, 0);
+				}
+			}
+			if (	(0 != status)
+				&&	(0 == http_get_response_ex(request, &keepalive_count, &received)) )
+			{
+				status = 0;
+			}
+			http_destroy_request(request);
+		}
+
+		printf("%-24s: status %d, %u body bytes\n",
+				argv[i], status, (unsigned int)received);
+		if ( 0 == status )
+		{
+			++failed;
+		}
+	}
+
+	http_uninit();
+	ddns_socket_uninit();
+
+	return (0 == failed) ? 0 : 1;
+}
@@ -0,0 +1,119 @@
+#!/usr/bin/env python3
+#
+#  This file is part of 'ddns'.
+#
+#  'ddns' is free software; you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published
+#  by the Free Software Foundation; either version 3 of the License,
+#  or (at your option) any later version.
+#
+#  'ddns' is distributed in the hope that it will be useful, but
+#  WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with 'ddns'; if not, write to the Free Software Foundation, Inc.,
+#  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+#
+
+"""Plain HTTP/1.1 server with persistent connections, for tools/keepalive.
+
+Usage: keepalive_server.py <port> [--drop-reused]
+
+Every request is logged to stderr with the number of its connection, so
+reused and new connections can be told apart. Resources:
+
+    /length     a body framed by Content-Length
+    /chunked    a chunked body with a trailer
+    /empty      204 No Content
+    anything else gets 404 with a Content-Length body
+
+With --drop-reused the server answers only the first request of every
+connection. It reads the next one and closes the connection without an
+answer, like a server that dropped an idle connection just as it was
+reused.
+"""
+
+import socketserver
+import sys
+import threading
+
+BODY = b''.join(b'line %d of the body\n' % i for i in range(2000))
+
+lock = threading.Lock()
+connections = 0
+
+
+class Handler(socketserver.StreamRequestHandler):
+
+    def handle(self):
+        global connections
+        with lock:
+            connections += 1
+            conn = connections
+        served = 0
+        while True:
+            request = self.read_request()
+            if request is None:
+                break
+            method, path = request
+            served += 1
+            sys.stderr.write('connection %d request %d: %s %s\n'
+                             % (conn, served, method, path))
+            sys.stderr.flush()
+            if DROP_REUSED and served > 1:
+                break
+            self.answer(method, path)
+
+    def read_request(self):
+        line = self.rfile.readline()
+        if not line.strip():
+            return None
+        method, path = line.decode('latin-1').split()[:2]
+        length = 0
+        while True:
+            header = self.rfile.readline()
+            if header in (b'\r\n', b'\n', b''):
+                break
+            name, _, value = header.decode('latin-1').partition(':')
+            if name.strip().lower() == 'content-length':
+                length = int(value)
+        self.rfile.read(length)
+        return method, path
+
+    def answer(self, method, path):
+        head = (method == 'HEAD')
+        if path == '/length':
+            self.send(b'200 OK', b'Content-Length: %d\r\n' % len(BODY),
+                      b'' if head else BODY)
+        elif path == '/chunked':
+            body = b''
+            if not head:
+                for i in range(0, len(BODY), 1000):
+                    chunk = BODY[i:i + 1000]
+                    body += b'%x\r\n%s\r\n' % (len(chunk), chunk)
+                body += b'0\r\nX-Trailer: 1\r\n\r\n'
+            self.send(b'200 OK', b'Transfer-Encoding: chunked\r\n', body)
+        elif path == '/empty':
+            self.send(b'204 No Content', b'', b'')
+        else:
+            self.send(b'404 Not Found', b'Content-Length: 10\r\n',
+                      b'' if head else b'not found\n')
+
+    def send(self, status, headers, body):
+        self.wfile.write(b'HTTP/1.1 ' + status + b'\r\n' + headers
+                         + b'Connection: keep-alive\r\n\r\n' + body)
+        self.wfile.flush()
+
+
+class Server(socketserver.ThreadingTCPServer):
+    allow_reuse_address = True
+    daemon_threads = True
+
+
+if __name__ == '__main__':
+    if len(sys.argv) < 2:
+        sys.exit(__doc__)
+    DROP_REUSED = ('--drop-reused' in sys.argv[2:])
+    Server(('127.0.0.1', int(sys.argv[1])), Handler).serve_forever()
@@ -0,0 +1,77 @@
+/*
+ *	This file is part of 'ddns'.
+ *
+ *	'ddns' is free software; you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published
+ *	by the Free Software Foundation; either version 3 of the License,
+ *	or (at your option) any later version.
+ *
+ *	'ddns' is distributed in the hope that it will be useful, but
+ *	WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with 'ddns'; if not, write to the Free Software Foundation, Inc.,
+ *	51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*
+ *	Print when the watcher of network interfaces wakes the context up:
+ *
+ *		./netif_watch <netif> <seconds>
+ *
+ *	It starts the watcher of an account reading its IP address from
+ *	[netif], then prints the time of every wakeup in ms until [seconds]
+ *	passed. netif_watch.sh changes the addresses of a veth pair in a
+ *	network namespace meanwhile, and checks the wakeups.
+ *
+ *	It includes "ddns.c" to reach [ddns_watcher_start].
+ */
+
+#include "ddns.c"
+
+int main(int argc, char * argv[])
+{
+	struct ddns_context	context;
+	struct ddns_watcher	watcher;
+	unsigned long		start		= 0;
+	unsigned long		duration	= 0;
+	unsigned long		elapsed		= 0;
+	int					wakeups		= 0;
+
+	if ( (argc < 3) || (atoi(argv[2]) <= 0) )
+	{
+		fprintf(stderr, "usage: %s <netif> <seconds>\n", argv[0]);
+		return 1;
+	}
+	duration = (unsigned long)atoi(argv[2]) * 1000;
+
+	ddns_initcontext(&context);
+	c99_strncpy(context.netif, argv[1], _countof(context.netif));
+
+	if ( 0 == ddns_watcher_start(&watcher, &context) )
+	{
+		fprintf(stderr, "can't start the watcher.\n");
+		return 1;
+	}
+	printf("watching %s\n", context.netif);
+	fflush(stdout);
+
+	start = ddns_sync_clock();
+	while ( (elapsed = ddns_sync_clock() - start) < duration )
+	{
+		if ( 0 != ddns_sync_event_wait(&(context.wakeup_event), duration - elapsed) )
+		{
+			ddns_sync_event_reset(&(context.wakeup_event));
+			printf("wakeup at %lu ms\n", ddns_sync_clock() - start);
+			fflush(stdout);
+			++wakeups;
+		}
+	}
+
+	ddns_watcher_stop(&watcher);
+	printf("%d wakeups\n", wakeups);
+	ddns_clearcontext(&context);
+
+	return 0;
+}
@@ -0,0 +1,81 @@
+#!/bin/sh
+#
+#  This file is part of 'ddns'.
+#
+#  'ddns' is free software; you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published
+#  by the Free Software Foundation; either version 3 of the License,
+#  or (at your option) any later version.
+#
+#  'ddns' is distributed in the hope that it will be useful, but
+#  WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with 'ddns'; if not, write to the Free Software Foundation, Inc.,
+#  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+#
+
+#
+#  Check the watcher of network interfaces in a network namespace, as root:
+#
+#      make -C tools netif_watch
+#      sudo tools/netif_watch.sh
+#
+#  A veth pair ddns0/ddns1 is created in the namespace, and netif_watch
+#  watches ddns0 for 16 seconds while the script
+#
+#      at 1s    adds an address to ddns1, which must not wake it up,
+#      at 2s    adds an address to ddns0, which must wake it up once after
+#               the quiet time of 2 seconds,
+#      at 6s    flaps ddns0 every half a second for 4 seconds, which must
+#               wake it up once only, after the link keeps quiet.
+#
+#  It fails unless there are exactly 2 wakeups, at about 4s and 11.5s.
+#
+
+NETNS=ddns_watch
+WATCH="$(dirname "$0")/netif_watch"
+OUTPUT=$(mktemp)
+
+run() {
+	ip netns exec $NETNS "$@"
+}
+
+ip netns add $NETNS || exit 1
+trap 'ip netns del $NETNS; rm -f "$OUTPUT"' EXIT
+
+run ip link set lo up
+run ip link add ddns0 type veth peer name ddns1
+run ip link set ddns0 up
+run ip link set ddns1 up
+
+run "$WATCH" ddns0 16 > "$OUTPUT" &
+PID=$!
+
+sleep 1
+run ip addr add 203.0.113.5/24 dev ddns1
+sleep 1
+run ip addr add 203.0.113.7/24 dev ddns0
+sleep 4
+for i in 1 2 3 4 5 6 7 8; do
+	run ip addr flush dev ddns0
+	run ip addr add 198.51.100.$i/24 dev ddns0
+	sleep 0.5
+done
+wait $PID
+
+cat "$OUTPUT"
+
+# the wakeups must be 2, about 4s and 11.5s with a second more, as the ip
+# commands take some time too
+awk '/^wakeup at/ { t[n++] = $3 }
+	END {
+		if ( 2 != n || t[0] < 3500 || t[0] > 5000 || t[1] < 11000 || t[1] > 12500 )
+		{
+			print "FAIL"
+			exit 1
+		}
+		print "OK"
+	}' "$OUTPUT"
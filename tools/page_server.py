@@ -0,0 +1,93 @@
+#!/usr/bin/env python3
+#
+#  This file is part of 'ddns'.
+#
+#  'ddns' is free software; you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published
+#  by the Free Software Foundation; either version 3 of the License,
+#  or (at your option) any later version.
+#
+#  'ddns' is distributed in the hope that it will be useful, but
+#  WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with 'ddns'; if not, write to the Free Software Foundation, Inc.,
+#  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+#
+
+"""HTTP server of a large page, for tools/http_fills.
+
+Usage: page_server.py <port> [size] [cert.pem key.pem]
+
+The page is [size] bytes of HTML (102400 by default), served as a whole
+by one write to the socket. With a certificate and a key it's served
+over TLS. Resources:
+
+    /length     the page framed by Content-Length
+    /chunked    the page in chunks of 1000 bytes, then a trailer
+    /headers    the page after 50 extra header lines
+
+The connection is closed after every answer.
+"""
+
+import socketserver
+import ssl
+import sys
+
+
+class Handler(socketserver.StreamRequestHandler):
+
+    def handle(self):
+        line = self.rfile.readline()
+        if not line.strip():
+            return
+        path = line.decode('latin-1').split()[1]
+        while self.rfile.readline() not in (b'\r\n', b'\n', b''):
+            pass
+
+        headers = b''
+        if path == '/chunked':
+            body = b''
+            for i in range(0, len(PAGE), 1000):
+                chunk = PAGE[i:i + 1000]
+                body += b'%x\r\n%s\r\n' % (len(chunk), chunk)
+            body += b'0\r\nX-Trailer: 1\r\n\r\n'
+            headers = b'Transfer-Encoding: chunked\r\n'
+        else:
+            body = PAGE
+            headers = b'Content-Length: %d\r\n' % len(PAGE)
+            if path == '/headers':
+                headers += b''.join(b'X-Header-%d: %s\r\n' % (i, b'v' * 40)
+                                    for i in range(50))
+        self.wfile.write(b'HTTP/1.1 200 OK\r\nContent-Type: text/html\r\n'
+                         + headers + b'Connection: close\r\n\r\n' + body)
+        self.wfile.flush()
+
+
+class Server(socketserver.ThreadingTCPServer):
+    allow_reuse_address = True
+    daemon_threads = True
+
+
+def build_page(size):
+    line = b'<p>line %06d of the page, <a href="/more">more</a></p>\n'
+    page = b'<html><body>\n'
+    i = 0
+    while len(page) < size:
+        page += line % i
+        i += 1
+    return page[:size]
+
+
+if __name__ == '__main__':
+    if len(sys.argv) < 2:
+        sys.exit(__doc__)
+    PAGE = build_page(int(sys.argv[2]) if len(sys.argv) > 2 else 102400)
+    server = Server(('127.0.0.1', int(sys.argv[1])), Handler)
+    if len(sys.argv) > 4:
+        tls = ssl.SSLContext(ssl.PROTOCOL_TLS_SERVER)
+        tls.load_cert_chain(sys.argv[3], sys.argv[4])
+        server.socket = tls.wrap_socket(server.socket, server_side=True)
+    server.serve_forever()
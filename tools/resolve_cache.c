@@ -0,0 +1,165 @@
+/*
+ *	This file is part of 'ddns'.
+ *
+ *	'ddns' is free software; you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published
+ *	by the Free Software Foundation; either version 3 of the License,
+ *	or (at your option) any later version.
+ *
+ *	'ddns' is distributed in the hope that it will be useful, but
+ *	WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with 'ddns'; if not, write to the Free Software Foundation, Inc.,
+ *	51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*
+ *	Check [ddns_socket_resolve] against the stub resolver dns_stub.py, which
+ *	answers in 0.3s, or 3s for slow.* names:
+ *
+ *		sudo ./resolve_cache.sh
+ *
+ *	resolve_cache.sh runs it in a network namespace whose resolv.conf names
+ *	the stub only. Every step prints the addresses and the time it took, and
+ *	fails unless
+ *
+ *		fast.test	resolves in 0.3s, then at once from the cache;
+ *		nx.test		fails in 0.3s, then at once from the cache;
+ *		slow.test	gives up by a deadline of 1s, then by the exit signal
+ *					0.2s later, then resolves at once once the lookup that
+ *					went on has filled the cache;
+ *		par.test	resolves in 8 threads at a time;
+ *		127.0.0.1	resolves at once with no query.
+ *
+ *	resolve_cache.sh checks that the stub was asked for every name once.
+ */
+
+#include <arpa/inet.h>		/* inet_ntoa */
+#include <stdio.h>
+#include <stdlib.h>
+#include "ddns_socket.h"
+#include "ddns_string.h"	/* _countof */
+#include "ddns_sync.h"
+
+#define RESOLVE_CACHE_THREADS	8
+#define RESOLVE_CACHE_AT_ONCE	50		/* ms of an answer from the cache */
+
+static struct ddns_sync_event	resolve_cache_timer;		/* never set */
+static int						resolve_cache_stop	= 0;	/* exit signal of a step */
+
+/**
+ *	Resolve a name once, print the result.
+ *
+ *	@param[in]	addr		: the host name.
+ *	@param[in]	budget		: ms to wait at most.
+ *	@param[in]	expected	: count of addresses expected.
+ *	@param[in]	min_time	: ms the step must take at least.
+ *	@param[in]	max_time	: ms the step must take at most.
+ *
+ *	@return	Return 0 if the step went as expected, otherwise 1.
+ */
+static int resolve_cache_step(
+	const char	*	addr,
+	unsigned long	budget,
+	int				expected,
+	unsigned long	min_time,
+	unsigned long	max_time
+	)
+{
+	struct ddns_deadline	deadline;
+	struct in_addr			addr_list[4];
+	unsigned long			start		= ddns_sync_clock();
+	unsigned long			elapsed		= 0;
+	int						addr_cnt	= 0;
+	int						failed		= 0;
+
+	ddns_deadline_init(&deadline, budget);
+	addr_cnt	= ddns_socket_resolve(	addr, addr_list, _countof(addr_list),
+										&deadline, &resolve_cache_stop );
+	elapsed		= ddns_sync_clock() - start;
+	failed		= (addr_cnt != expected) || (elapsed < min_time) || (elapsed > max_time);
+
+	printf(	"%-10s: %d addresses %-10s %5lu ms%s\n",
+			addr, addr_cnt, (addr_cnt > 0) ? inet_ntoa(addr_list[0]) : "",
+			elapsed, (0 != failed) ? "  FAIL" : "" );
+
+	return failed;
+}
+
+/**
+ *	Set the exit signal a while later.
+ *
+ *	@param[in]	param	: not used.
+ */
+static void resolve_cache_signal(void * param)
+{
+	(void)param;
+
+	ddns_sync_event_wait(&resolve_cache_timer, 200);
+	resolve_cache_stop = 1;
+}
+
+/**
+ *	Resolve "par.test", one of the concurrent threads.
+ *
+ *	@param[out]	param	: the count of addresses.
+ */
+static void resolve_cache_parallel(void * param)
+{
+	struct ddns_deadline	deadline;
+	struct in_addr			addr_list[4];
+
+	ddns_deadline_init(&deadline, 5000);
+	*(int*)param = ddns_socket_resolve(	"par.test", addr_list, _countof(addr_list),
+										&deadline, NULL );
+}
+
+int main(void)
+{
+	struct ddns_sync_thread	threads[RESOLVE_CACHE_THREADS];
+	int						results[RESOLVE_CACHE_THREADS];
+	int						resolved	= 0;
+	int						failed		= 0;
+	int						i			= 0;
+
+	ddns_socket_init();
+	ddns_sync_event_init(&resolve_cache_timer);
+
+	failed += resolve_cache_step("fast.test", 5000, 1, 250, 1000);
+	failed += resolve_cache_step("fast.test", 5000, 1, 0, RESOLVE_CACHE_AT_ONCE);
+	failed += resolve_cache_step("nx.test", 5000, 0, 250, 1000);
+	failed += resolve_cache_step("nx.test", 5000, 0, 0, RESOLVE_CACHE_AT_ONCE);
+
+	failed += resolve_cache_step("slow.test", 1000, 0, 950, 1200);
+	resolve_cache_stop = 0;
+	ddns_sync_thread_create(&threads[0], &resolve_cache_signal, NULL);
+	failed += resolve_cache_step("slow.test", 5000, 0, 150, 400);
+	ddns_sync_thread_join(&threads[0]);
+	resolve_cache_stop = 0;
+	ddns_sync_event_wait(&resolve_cache_timer, 3000);
+	failed += resolve_cache_step("slow.test", 5000, 1, 0, RESOLVE_CACHE_AT_ONCE);
+
+	for ( i = 0; i < RESOLVE_CACHE_THREADS; ++i )
+	{
+		results[i] = -1;
+		ddns_sync_thread_create(&threads[i], &resolve_cache_parallel, &results[i]);
+	}
+	for ( i = 0; i < RESOLVE_CACHE_THREADS; ++i )
+	{
+		ddns_sync_thread_join(&threads[i]);
+		resolved += (results[i] > 0) ? 1 : 0;
+	}
+	printf("par.test  : resolved in %d of %d threads%s\n",
+			resolved, RESOLVE_CACHE_THREADS,
+			(RESOLVE_CACHE_THREADS != resolved) ? "  FAIL" : "");
+	failed += (RESOLVE_CACHE_THREADS != resolved) ? 1 : 0;
+
+	failed += resolve_cache_step("127.0.0.1", 5000, 1, 0, RESOLVE_CACHE_AT_ONCE);
+
+	ddns_sync_event_destroy(&resolve_cache_timer);
+	ddns_socket_uninit();
+
+	return (0 == failed) ? 0 : 1;
+}
@@ -0,0 +1,64 @@
+#!/bin/sh
+#
+#  This file is part of 'ddns'.
+#
+#  'ddns' is free software; you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published
+#  by the Free Software Foundation; either version 3 of the License,
+#  or (at your option) any later version.
+#
+#  'ddns' is distributed in the hope that it will be useful, but
+#  WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with 'ddns'; if not, write to the Free Software Foundation, Inc.,
+#  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+#
+
+#
+#  Check the resolver cache against a stub resolver, as root:
+#
+#      make -C tools resolve_cache
+#      sudo tools/resolve_cache.sh
+#
+#  resolve_cache and dns_stub.py run in a network namespace, whose
+#  resolv.conf (/etc/netns/<namespace>/resolv.conf, which "ip netns exec"
+#  mounts on /etc/resolv.conf) names the stub only. It fails if a step of
+#  resolve_cache fails, or the stub wasn't asked for every name once.
+#
+
+NETNS=ddns_resolve
+TOOLS="$(dirname "$0")"
+QUERIES=$(mktemp)
+
+run() {
+	ip netns exec $NETNS "$@"
+}
+
+ip netns add $NETNS || exit 1
+mkdir -p /etc/netns/$NETNS
+echo "nameserver 127.0.0.1" > /etc/netns/$NETNS/resolv.conf
+trap 'kill $STUB 2>/dev/null; ip netns del $NETNS; rm -rf /etc/netns/$NETNS "$QUERIES"' EXIT
+
+run ip link set lo up
+# not by run, so that $! is the stub itself
+ip netns exec $NETNS "$TOOLS/dns_stub.py" 127.0.0.1 "$QUERIES" &
+STUB=$!
+sleep 1
+
+run "$TOOLS/resolve_cache"
+FAILED=$?
+
+echo "--- A queries seen by the stub:"
+awk '$2 == 1 { print $1 }' "$QUERIES" | sort | uniq -c
+for name in fast.test nx.test slow.test par.test; do
+	if [ 1 -ne "$(grep -c "^$name 1\$" "$QUERIES")" ]; then
+		echo "$name: FAIL"
+		FAILED=1
+	fi
+done
+
+[ 0 -eq $FAILED ] && echo OK || echo FAIL
+exit $FAILED
@@ -0,0 +1,192 @@
+/*
+ *	This file is part of 'ddns'.
+ *
+ *	'ddns' is free software; you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published
+ *	by the Free Software Foundation; either version 3 of the License,
+ *	or (at your option) any later version.
+ *
+ *	'ddns' is distributed in the hope that it will be useful, but
+ *	WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with 'ddns'; if not, write to the Free Software Foundation, Inc.,
+ *	51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*
+ *	Time from SIGTERM to the end of a wait, with an interval of an hour:
+ *
+ *		./shutdown
+ *		./shutdown 20
+ *
+ *	The signal handler does what the one of ddns does: it sets [exit_signal]
+ *	and the wakeup event of the context. Each round waits in [ddns_wait], as
+ *	between the updates of one account, and in [ddns_account_wait] with an
+ *	account pending on a socket that never gets ready, as [ddns_execute]
+ *	does. The signal is sent by another thread 200ms after the wait starts.
+ *	The argument is the count of rounds (5 by default). It fails if any wait
+ *	didn't end within 100ms of the signal.
+ *
+ *	It includes "ddns.c" to reach [ddns_account_wait].
+ */
+
+#include "ddns.c"
+#include <signal.h>			/* signal, kill	*/
+#include <sys/socket.h>		/* socketpair	*/
+
+#define SHUTDOWN_DELAY			200		/* ms before the signal is sent */
+#define SHUTDOWN_MAX_LATENCY	100		/* ms from the signal to the end */
+
+static struct ddns_context		shutdown_ctx;
+static struct ddns_sync_event	shutdown_timer;			/* never set */
+static unsigned long			shutdown_sent	= 0;	/* when the signal was sent */
+
+/**
+ *	Handle SIGTERM like ddns does.
+ *
+ *	@param[in]	code	: the signal.
+ */
+static void shutdown_handle_signal(int code)
+{
+	(void)code;
+	shutdown_ctx.exit_signal = 1;
+	ddns_sync_event_set(&(shutdown_ctx.wakeup_event));
+}
+
+/**
+ *	Send SIGTERM to the process a while later.
+ *
+ *	@param[in]	param	: not used.
+ */
+static void shutdown_send_signal(void * param)
+{
+	(void)param;
+
+	ddns_sync_event_wait(&shutdown_timer, SHUTDOWN_DELAY);
+	shutdown_sent = ddns_sync_clock();
+	kill(getpid(), SIGTERM);
+}
+
+/**
+ *	Wait one round, until the signal.
+ *
+ *	@param[in]	scheduler	: non-zero to wait as [ddns_execute] does,
+ *							  otherwise as [ddns_wait].
+ *	@param[in]	account		: a pending account for [scheduler].
+ *
+ *	@return	ms from the signal to the end of the wait, or -1 if the wait
+ *			ended for another reason.
+ */
+static long shutdown_round(int scheduler, struct ddns_account * account)
+{
+	struct ddns_sync_thread	thread;
+	int						ready_cnt	= 0;
+	int						stopped		= 0;
+	long					latency		= 0;
+
+	shutdown_ctx.exit_signal = 0;
+	ddns_sync_event_reset(&(shutdown_ctx.wakeup_event));
+	shutdown_sent = 0;
+
+	if ( 0 != ddns_sync_thread_create(&thread, &shutdown_send_signal, NULL) )
+	{
+		return -1;
+	}
+
+	if ( 0 != scheduler )
+	{
+		/* the signal may end the poll with EINTR, [ddns_execute] checks
+		 * [exit_signal] after the wait whatever it returned */
+		ddns_account_wait(	&shutdown_ctx, account, 1,
+							(unsigned long)shutdown_ctx.interval * 1000,
+							&ready_cnt );
+		stopped = shutdown_ctx.exit_signal;
+	}
+	else
+	{
+		stopped = (0 == ddns_wait(&shutdown_ctx));
+	}
+	latency = (long)(ddns_sync_clock() - shutdown_sent);
+
+	ddns_sync_thread_join(&thread);
+
+	return ((0 != stopped) && (0 != shutdown_sent)) ? latency : -1;
+}
+
+int main(int argc, char * argv[])
+{
+	static const char * NAMES[] = { "ddns_wait", "ddns_account_wait" };
+
+	struct ddns_account	account;
+	ddns_socket			sockets[2];
+	long				latency	= 0;
+	long				worst	= 0;
+	int					rounds	= 5;
+	int					failed	= 0;
+	int					i		= 0;
+	int					m		= 0;
+
+	if ( argc > 1 )
+	{
+		rounds = atoi(argv[1]);
+	}
+	if ( rounds <= 0 )
+	{
+		fprintf(stderr, "usage: %s [rounds]\n", argv[0]);
+		return 1;
+	}
+
+	ddns_initcontext(&shutdown_ctx);
+	ddns_sync_event_init(&shutdown_timer);
+	shutdown_ctx.interval = 3600;
+	signal(SIGTERM, &shutdown_handle_signal);
+
+	/* nothing is ever written to the other end */
+	if ( 0 != socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) )
+	{
+		fprintf(stderr, "can't create the sockets.\n");
+		return 1;
+	}
+	memset(&account, 0, sizeof(account));
+	account.context	= &shutdown_ctx;
+	account.state	= ddns_account_pending;
+	account.socket	= sockets[0];
+	account.events	= DDNS_EVENT_READ;
+
+	for ( m = 0; m < 2; ++m )
+	{
+		worst = 0;
+		for ( i = 0; i < rounds; ++i )
+		{
+			latency = shutdown_round(m, &account);
+			if ( (latency < 0) || (latency > SHUTDOWN_MAX_LATENCY) )
+			{
+				worst = -1;
+				break;
+			}
+			if ( latency > worst )
+			{
+				worst = latency;
+			}
+		}
+
+		if ( worst < 0 )
+		{
+			printf("%-18s: FAIL in round %d (%ld ms)\n", NAMES[m], i + 1, latency);
+			++failed;
+		}
+		else
+		{
+			printf("%-18s: %d rounds, %ld ms at most\n", NAMES[m], rounds, worst);
+		}
+	}
+
+	close(sockets[0]);
+	close(sockets[1]);
+	ddns_clearcontext(&shutdown_ctx);
+	ddns_sync_event_destroy(&shutdown_timer);
+
+	return (0 == failed) ? 0 : 1;
+}
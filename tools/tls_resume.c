@@ -0,0 +1,85 @@
+/*
+ *	This file is part of 'ddns'.
+ *
+ *	'ddns' is free software; you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published
+ *	by the Free Software Foundation; either version 3 of the License,
+ *	or (at your option) any later version.
+ *
+ *	'ddns' is distributed in the hope that it will be useful, but
+ *	WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with 'ddns'; if not, write to the Free Software Foundation, Inc.,
+ *	51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*
+ *	Send the same HTTPS request several times, each on a new connection, and
+ *	report how many TLS handshakes were full and how many were resumed.
+ *
+ *	Start a local TLS server, for example:
+ *
+ *		openssl req -x509 -newkey rsa:2048 -nodes -days 1 -subj /CN=localhost \
+ *			-keyout key.pem -out cert.pem
+ *		openssl s_server -www -accept 4433 -cert cert.pem -key key.pem
+ *
+ *	Add -tls1_2 or -tls1_3 to the server to check one protocol version, then
+ *	run:
+ *
+ *		./tls_resume https://127.0.0.1:4433/ 10
+ *
+ *	With the shared SSL context and the session cache, only the first request
+ *	should make a full handshake.
+ */
+
+#include <stdio.h>			/* printf	*/
+#include <stdlib.h>			/* atoi		*/
+#include "ddns_socket.h"	/* ddns_socket_init, ... */
+#include "http.h"			/* http_init, ... */
+
+int main(int argc, char * argv[])
+{
+	struct http_request	*	request		= NULL;
+	unsigned long			handshakes	= 0;
+	unsigned long			resumed		= 0;
+	int						count		= 0;
+	int						failed		= 0;
+	int						i			= 0;
+
+	if ( argc < 2 )
+	{
+		fprintf(stderr, "usage: %s <https url> [count]\n", argv[0]);
+		return 1;
+	}
+	count = (argc > 2) ? atoi(argv[2]) : 10;
+
+	ddns_socket_init();
+	http_init();
+
+	for ( i = 0; i < count; ++i )
+	{
+		request = http_create_request(http_method_get, argv[1], 10);
+		if (	(NULL == request)
+			||	(0 != http_connect(request))
+			||	(0 == http_send_request(request, NULL, 0))
+			||	(0 == http_get_response_ex(request, NULL, NULL)) )
+		{
+			++failed;
+		}
+		if ( NULL != request )
+		{
+			http_destroy_request(request);
+		}
+	}
+
+	http_get_ssl_statistics(&handshakes, &resumed);
+	printf("requests=%d failed=%d full handshakes=%lu resumed=%lu\n",
+			count, failed, handshakes, resumed);
+
+	http_uninit();
+	ddns_socket_uninit();
+
+	return (0 == failed) ? 0 : 1;
+}